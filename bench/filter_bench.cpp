@@ -0,0 +1,116 @@
+// pq filter throughput on a generated document of users, compared with
+// shelling out to jq for the same filters. Each line reports the best time
+// for running the compiled filter on the parsed tree, for parsing the JSON
+// text plus running the filter (what `pq <file> '<filter>'` does), and for
+// `jq -c '<filter>' <file>` when jq is on the PATH.
+//
+//   filter_bench [users] [repeats]
+
+#include <ps/parsec.h>
+#include <ps/json.h>
+#include <ps/pq/filter.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+ps::Dictionary make_users(int count) {
+    const char* teams[] = {"ops", "dev", "data", "web"};
+    std::vector<ps::Dictionary> users;
+    for (int i = 0; i < count; ++i) {
+        ps::Dictionary user;
+        user["id"] = i;
+        user["name"] = "user" + std::to_string(i);
+        user["email"] = "user" + std::to_string(i) + "@example.org";
+        user["age"] = 18 + (i * 7) % 60;
+        user["team"] = teams[i % 4];
+        user["active"] = i % 3 != 0;
+        user["score"] = 0.5 * static_cast<double>((i * 13) % 200);
+        user["tags"] = std::vector<std::string>{"t" + std::to_string(i % 5), "t" + std::to_string(i % 7)};
+        users.push_back(user);
+    }
+    ps::Dictionary doc;
+    doc["users"] = users;
+    doc["meta"]["count"] = count;
+    return doc;
+}
+
+template <typename Fn>
+double best_of(int repeats, Fn fn) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// Quotes `text` for /bin/sh
+std::string shell_quote(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "'";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 50000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    const std::vector<std::string> filters = {
+        ".meta.count",
+        "[.users[] | select(.age > 40) | .name] | length",
+        ".users | map(.score) | add / length",
+        ".users | group_by(.team) | map({team: .[0].team, n: length})",
+        "[.users[] | {name, email} | select(.email | test(\"7@\"))] | length",
+        "reduce .users[] as $u ({}; .[$u.team] += $u.age)",
+        ".users |= map(select(.active)) | .users | length",
+    };
+
+    ps::Dictionary data = make_users(count);
+    const std::string text = data.dump(0, true);
+    const std::string path = "filter_bench_input.json";
+    std::ofstream(path) << text;
+    bool have_jq = std::system("jq --version > /dev/null 2>&1") == 0;
+
+    std::cout << "users x" << count << ", " << text.size() / 1024 << " KiB (best of " << repeats << ")\n";
+    for (const auto& source : filters) {
+        ps::pq::Filter filter(source);
+        size_t outputs = 0;
+        auto consume = [&outputs](const ps::Dictionary&) { ++outputs; };
+        double run_ms = best_of(repeats, [&] { filter.run(data, consume); });
+        double parse_ms = best_of(repeats, [&] {
+            ps::Dictionary parsed = ps::parse_json(text);
+            ps::pq::Filter(source).run(parsed, consume);
+        });
+
+        std::cout << "  " << source << "\n    pq filter: " << run_ms << " ms, parse + filter: " << parse_ms
+                  << " ms";
+        if (have_jq) {
+            std::string command = "jq -c " + shell_quote(source) + " " + path + " > /dev/null";
+            double jq_ms = best_of(repeats, [&] {
+                if (std::system(command.c_str()) != 0) std::cerr << "jq failed: " << source << "\n";
+            });
+            std::cout << ", jq: " << jq_ms << " ms";
+        }
+        std::cout << "\n";
+    }
+    std::remove(path.c_str());
+    return 0;
+}
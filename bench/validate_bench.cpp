@@ -0,0 +1,136 @@
+// Validation throughput on schemas/medium_schema.json scaled up: the schema is
+// used as the item schema of an array holding many copies of the example
+// documents, so every keyword in it is exercised once per copy. The last lines
+// time revalidate() after one of the invalid copies has been fixed and the
+// validator generated by parsec-codegen from bench/medium_array_schema.json.
+// The final line validates a million-entry array of bounded doubles, as found
+// in mesh fields such as wall distances.
+//
+//   validate_bench [copies] [repeats]
+
+#include <ps/parsec.h>
+#include <ps/validate.h>
+
+#include "medium_array_validator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open " + path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+ps::Dictionary replicate(const ps::Dictionary& doc, int copies) {
+    std::vector<ps::Dictionary> items(static_cast<size_t>(copies), doc);
+    ps::Dictionary out;
+    out = std::move(items);
+    return out;
+}
+
+// Best-of-N wall time in milliseconds, plus the error count of the last run
+std::pair<double, size_t> time_validate(const ps::Dictionary& data,
+                                        const ps::Dictionary& schema,
+                                        int repeats) {
+    double best = 1e300;
+    size_t errors = 0;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = ps::validate_all(data, schema);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+        errors = result.errors.size();
+    }
+    return {best, errors};
+}
+
+// Best-of-N wall time for revalidating after one item of `data` was replaced
+std::pair<double, size_t> time_revalidate(const ps::Dictionary& data,
+                                          const ps::Dictionary& schema,
+                                          const ps::Dictionary& replacement,
+                                          int repeats) {
+    ps::ValidationResult previous = ps::validate_all(data, schema);
+    ps::Dictionary edited = data;
+    int index = edited.size() / 2;
+    edited[index] = replacement;
+    const std::vector<std::string> changed = {"[" + std::to_string(index) + "]"};
+
+    double best = 1e300;
+    size_t errors = 0;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = ps::revalidate(previous, edited, schema, changed);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+        errors = result.errors.size();
+    }
+    return {best, errors};
+}
+
+// Best-of-N wall time for the generated validator
+std::pair<double, size_t> time_generated(const ps::Dictionary& data, int repeats) {
+    double best = 1e300;
+    size_t errors = 0;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = generated::validate_medium_array(data);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+        errors = result.errors.size();
+    }
+    return {best, errors};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int copies = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+    const std::string root = PARSEC_SOURCE_DIR;
+
+    ps::Dictionary item_schema = ps::parse_json(read_file(root + "/schemas/medium_schema.json"));
+    ps::Dictionary schema;
+    schema["type"] = "array";
+    schema["items"] = item_schema;
+
+    ps::Dictionary good = ps::parse(read_file(root + "/examples/medium_schema_check.ron"));
+    ps::Dictionary bad = ps::parse(read_file(root + "/examples/medium_schema_fail.ron"));
+
+    auto [good_ms, good_errors] = time_validate(replicate(good, copies), schema, repeats);
+    auto [bad_ms, bad_errors] = time_validate(replicate(bad, copies), schema, repeats);
+    auto [edit_ms, edit_errors] = time_revalidate(replicate(bad, copies), schema, good, repeats);
+    auto [gen_good_ms, gen_good_errors] = time_generated(replicate(good, copies), repeats);
+    auto [gen_bad_ms, gen_bad_errors] = time_generated(replicate(bad, copies), repeats);
+
+    std::cout << "medium_schema x" << copies << " (best of " << repeats << ")\n";
+    std::cout << "  valid documents:   " << good_ms << " ms (" << good_errors << " errors)\n";
+    std::cout << "  invalid documents: " << bad_ms << " ms (" << bad_errors << " errors)\n";
+    std::cout << "  revalidate after fixing one invalid document: " << edit_ms << " ms ("
+              << edit_errors << " errors)\n";
+    std::cout << "  generated validator, valid documents:   " << gen_good_ms << " ms ("
+              << gen_good_errors << " errors)\n";
+    std::cout << "  generated validator, invalid documents: " << gen_bad_ms << " ms ("
+              << gen_bad_errors << " errors)\n";
+
+    ps::Dictionary field_schema = ps::parse_json(R"({"type": "array",
+        "items": {"type": "number", "minimum": 0, "maximum": 1e6}})");
+    std::vector<double> distances(1000000);
+    for (size_t i = 0; i < distances.size(); ++i) distances[i] = 1e-3 * static_cast<double>(i);
+    ps::Dictionary field;
+    field = distances;
+    auto [field_ms, field_errors] = time_validate(field, field_schema, repeats);
+    std::cout << "wall distance field x" << distances.size() << ": " << field_ms << " ms ("
+              << field_errors << " errors)\n";
+    return 0;
+}
@@ -0,0 +1,104 @@
+// pq wildcard extraction over a generated document of records, i.e. what
+// `pq <file> -g 'records/*/name'` does once the file is parsed. Each line
+// reports the best time for writing every match through QueryRunner to
+// /dev/null, and for the same matches formatted the way formatRaw() used to:
+// probing asBool()/asDouble()/asString() with try/catch and streaming each
+// value with operator<<.
+//
+//   wildcard_bench [records] [repeats]
+
+#include <ps/parsec.h>
+#include <ps/pq/cli_args.h>
+#include <ps/pq/navigator.h>
+#include <ps/pq/path_parser.h>
+#include <ps/pq/query_runner.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+ps::Dictionary make_records(int count) {
+    std::vector<ps::Dictionary> records;
+    records.reserve(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        ps::Dictionary record;
+        record["id"] = i;
+        record["name"] = "record" + std::to_string(i);
+        record["score"] = 0.25 * static_cast<double>(i % 1000);
+        record["active"] = i % 3 != 0;
+        records.push_back(std::move(record));
+    }
+    ps::Dictionary doc;
+    doc["records"] = records;
+    return doc;
+}
+
+template <typename Fn>
+double best_of(int repeats, Fn fn) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// The type probing formatRaw() did before it switched on the value's type
+std::string probe_raw(const ps::Dictionary& value) {
+    try {
+        return value.asBool() ? "true" : "false";
+    } catch (...) {}
+    try {
+        double d = value.asDouble();
+        if (d == static_cast<int>(d)) {
+            return std::to_string(static_cast<int>(d));
+        }
+        std::ostringstream oss;
+        oss << d;
+        return oss.str();
+    } catch (...) {}
+    try {
+        return value.asString();
+    } catch (...) {}
+    return value.dump(0, true);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int repeats = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    const std::vector<std::string> paths = {"records/*/name", "records/*/id", "records/*/score",
+                                            "records/*/active"};
+
+    ps::Dictionary data = make_records(count);
+    std::ofstream null("/dev/null");
+
+    std::cout << "records x" << count << " (best of " << repeats << ")\n";
+    for (const auto& path : paths) {
+        const char* argv_get[] = {"pq", "records.json", "-g", path.c_str()};
+        ps::pq::CliArgs args(4, argv_get);
+        double run_ms = best_of(repeats, [&] { ps::pq::QueryRunner().run(args, data, null); });
+
+        auto tokens = ps::pq::PathParser().parse(path);
+        double probe_ms = best_of(repeats, [&] {
+            ps::pq::Navigator().visitWildcard(data, tokens, [&null](const ps::Dictionary& match) {
+                null << probe_raw(match) << "\n";
+            });
+        });
+
+        std::cout << "  " << path << "\n    pq -g: " << run_ms << " ms, try/catch formatting: " << probe_ms
+                  << " ms\n";
+    }
+    return 0;
+}
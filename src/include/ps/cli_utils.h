@@ -13,34 +13,33 @@ namespace cli_utils {
 inline int levenshtein_distance(const std::string& s1, const std::string& s2) {
     const size_t m = s1.size();
     const size_t n = s2.size();
-    
-    // Create a matrix to store distances
-    std::vector<std::vector<int>> dp(m + 1, std::vector<int>(n + 1));
-    
-    // Initialize base cases
-    for (size_t i = 0; i <= m; ++i) {
-        dp[i][0] = static_cast<int>(i);
-    }
+
+    // One row of the distance matrix: row[j] is the distance between the
+    // first i characters of s1 and the first j characters of s2
+    std::vector<int> row(n + 1);
     for (size_t j = 0; j <= n; ++j) {
-        dp[0][j] = static_cast<int>(j);
+        row[j] = static_cast<int>(j);
     }
-    
-    // Fill in the matrix
+
     for (size_t i = 1; i <= m; ++i) {
+        int diagonal = row[0];  // distance for (i - 1, j - 1)
+        row[0] = static_cast<int>(i);
         for (size_t j = 1; j <= n; ++j) {
+            int above = row[j];
             if (s1[i - 1] == s2[j - 1]) {
-                dp[i][j] = dp[i - 1][j - 1];
+                row[j] = diagonal;
             } else {
-                dp[i][j] = 1 + std::min({
-                    dp[i - 1][j],      // deletion
-                    dp[i][j - 1],      // insertion
-                    dp[i - 1][j - 1]   // substitution
+                row[j] = 1 + std::min({
+                    above,         // deletion
+                    row[j - 1],    // insertion
+                    diagonal       // substitution
                 });
             }
+            diagonal = above;
         }
     }
-    
-    return dp[m][n];
+
+    return row[n];
 }
 
 // Find the most similar option from a list of valid options
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include "ps/dictionary.h"
+
+namespace ps {
+
+struct CodegenOptions {
+    // Name of the generated validation function; the other entry points
+    // are derived from it (<name>_passes, <name>_schema)
+    std::string name = "validate_schema";
+    // C++ namespace of the generated code (may be nested, "a::b")
+    std::string ns = "generated";
+    // How the generated source includes the generated header
+    std::string header_include = "validator.h";
+    // Shown in the "generated from" comment, usually the schema path
+    std::string source_label = "schema";
+};
+
+struct GeneratedValidator {
+    std::string header;
+    std::string source;
+};
+
+// Compile `schema` into C++ for an ahead-of-time validator.
+//
+// Each schema node becomes a function that answers whether a value passes it
+// without any issue. Type checks are inlined, enums and consts are embedded as
+// constants and object members are dispatched with a switch on the key. The
+// generated <name>() returns the same ValidationResult as validate_all() with
+// the embedded schema. Documents that pass are answered by the compiled
+// checks alone. Any other document is passed to validate_all() to build the
+// full error report. Nodes that use unevaluatedProperties always defer to
+// validate_all().
+//
+// Throws std::runtime_error if the schema cannot be embedded (e.g. it holds
+// NaN or infinite numbers).
+GeneratedValidator generate_validator(const Dictionary& schema, const CodegenOptions& options);
+
+}  // namespace ps
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "ps/dictionary.h"
+#include "ps/validate.h"
+
+namespace ps {
+
+// The defaults of a schema compiled once, for filling many documents.
+//
+// Construction walks the schema a single time. Each schema node becomes a
+// plan holding the default values it inserts, the keys it covers and the
+// plans of its children. $refs are resolved, and every anyOf/oneOf has a
+// table from the values of its alternatives' "type" enum to the alternative
+// whose defaults apply. Objects inserted for missing object-typed properties
+// are built once as well. apply() is then a structural merge of these plans
+// into the document. It gives the same result as applyDefaults(data, schema).
+//
+// A skeleton owns copies of the default values and does not refer to the
+// schema afterwards. It is immutable, so one skeleton can be shared by
+// several threads. Copies are cheap and share the plans.
+class DefaultsSkeleton {
+public:
+    // Throws std::runtime_error if filling defaults into an empty object
+    // would never end (an object-typed property whose defaults contain the
+    // property again).
+    explicit DefaultsSkeleton(const Dictionary& schema);
+
+    // Same as applyDefaults(data, schema, edits)
+    void apply(Dictionary& data, std::vector<DefaultEdit>* edits = nullptr) const;
+
+    // Same as setDefaults(data, schema)
+    Dictionary applied(const Dictionary& data) const;
+
+    // Number of compiled schema nodes
+    size_t size() const;
+
+    struct Plans;
+
+private:
+    std::shared_ptr<const Plans> plans_;
+};
+
+// validate_with_defaults() for documents that all use one schema: the
+// defaults come from `defaults`, compiled from `schema`.
+ValidationResult validate_with_defaults(Dictionary& data,
+                                        const DefaultsSkeleton& defaults,
+                                        const Dictionary& schema,
+                                        const std::string& raw_content = "",
+                                        const ValidationOptions& options = ValidationOptions{});
+
+// Same, validating against the tables of a compiled schema
+ValidationResult validate_with_defaults(Dictionary& data,
+                                        const DefaultsSkeleton& defaults,
+                                        const CompiledSchema& schema,
+                                        const std::string& raw_content = "",
+                                        const ValidationOptions& options = ValidationOptions{});
+
+}  // namespace ps
@@ -53,6 +53,19 @@ struct Dictionary {
     // scalar state are copied deeply (no shared state with source).
     Dictionary(const Dictionary& d) { *this = d; }
 
+    // Move constructor: takes the maps and scalar of `d`. The moved-from
+    // dictionary is left null, with this object's fresh scalar, so it is safe
+    // to read and to assign to.
+    Dictionary(Dictionary&& d) noexcept
+        : my_type(d.my_type),
+          m_array_map(std::move(d.m_array_map)),
+          m_object_map(std::move(d.m_object_map)) {
+        scalar.swap(d.scalar);
+        d.my_type = TYPE::Null;
+        d.m_array_map.clear();
+        d.m_object_map.clear();
+    }
+
     Dictionary(const std::string& s) {
         my_type = TYPE::String;
         scalar->m_string = s;
@@ -142,7 +155,7 @@ struct Dictionary {
         if (this == &d) return *this;
         my_type = d.my_type;
         // deep-copy the scalar value so this Dictionary does not share state
-        scalar = std::make_shared<DictionaryScalarImpl>(*d.scalar);
+        *scalar = *d.scalar;
 
         // Build new maps first (do not modify `this` while reading `d`),
         // so assigning from a sub-element (e.g. `dict = dict["key"]`) is safe.
@@ -152,9 +165,7 @@ struct Dictionary {
         switch (my_type) {
             case TYPE::Object:
                 for (auto const& p : d.m_object_map) {
-                    Dictionary tmp;  // default construct then assign to get deep-copy
-                    tmp = p.second;
-                    new_object_map.emplace(p.first, std::move(tmp));
+                    new_object_map.emplace_hint(new_object_map.end(), p.first, p.second);
                 }
                 break;
             case TYPE::ObjectArray:
@@ -163,9 +174,7 @@ struct Dictionary {
             case TYPE::StringArray:
             case TYPE::BoolArray:
                 for (auto const& kv : d.m_array_map) {
-                    Dictionary tmp;
-                    tmp = kv.second;
-                    new_array_map.emplace(kv.first, std::move(tmp));
+                    new_array_map.emplace_hint(new_array_map.end(), kv.first, kv.second);
                 }
                 break;
             case TYPE::Null:
@@ -187,6 +196,24 @@ struct Dictionary {
         return *this;
     }
 
+    Dictionary& operator=(Dictionary&& d) noexcept {
+        if (this == &d) return *this;
+        // Take everything from `d` before replacing the maps, which may own `d`
+        // (e.g. `dict = std::move(dict["key"])`).
+        // Like the move constructor, `d` is left null.
+        TYPE type = d.my_type;
+        std::map<std::string, Dictionary> objects = std::move(d.m_object_map);
+        std::map<int, Dictionary> arrays = std::move(d.m_array_map);
+        scalar.swap(d.scalar);
+        d.my_type = TYPE::Null;
+        d.m_object_map.clear();
+        d.m_array_map.clear();
+        my_type = type;
+        m_object_map = std::move(objects);
+        m_array_map = std::move(arrays);
+        return *this;
+    }
+
     Dictionary& operator=(const std::string& s) {
         my_type = TYPE::String;
         scalar->m_string = s;
@@ -302,6 +329,14 @@ struct Dictionary {
 
     bool operator!=(const Dictionary& rhs) const { return not(*this == rhs); }
 
+    // Structural equality in the JSON sense: arrays compare element-wise
+    // regardless of which array kind they are stored as. Scalars compare by
+    // type and value, so 1 and 1.0 are distinct (same as operator==).
+    bool structurallyEquals(const Dictionary& rhs) const;
+
+    // Hash consistent with structurallyEquals(), for use in unordered containers.
+    std::size_t hash() const;
+
     bool isTrue(const std::string& key) const {
         if (my_type != TYPE::Object) return false;
         auto it = m_object_map.find(key);
@@ -718,6 +753,21 @@ struct Dictionary {
         return false;
     }
 
+    // Read-only views for hot loops that must not copy (keys(), items() and
+    // asString() all do). Empty, or throwing for asStringRef(), on other types.
+    const std::map<std::string, Dictionary>& members() const {
+        static const std::map<std::string, Dictionary> none;
+        return my_type == TYPE::Object ? m_object_map : none;
+    }
+    const std::map<int, Dictionary>& elements() const {
+        static const std::map<int, Dictionary> none;
+        return isArrayObject() ? m_array_map : none;
+    }
+    const std::string& asStringRef() const {
+        if (my_type != TYPE::String) throw std::runtime_error("not a string");
+        return scalar->m_string;
+    }
+
     // Convenience predicates for legacy API compatibility
     bool isDict() const { return isMappedObject(); }
     bool isList() const { return isArrayObject(); }
@@ -784,6 +834,79 @@ struct Dictionary {
     }
 };
 
+inline bool Dictionary::structurallyEquals(const Dictionary& rhs) const {
+    if (isArrayObject() || rhs.isArrayObject()) {
+        if (!isArrayObject() || !rhs.isArrayObject()) return false;
+        if (m_array_map.size() != rhs.m_array_map.size()) return false;
+        auto it = m_array_map.begin();
+        auto rit = rhs.m_array_map.begin();
+        for (; it != m_array_map.end(); ++it, ++rit) {
+            if (!it->second.structurallyEquals(rit->second)) return false;
+        }
+        return true;
+    }
+    if (my_type != rhs.my_type) return false;
+    switch (my_type) {
+        case TYPE::Object: {
+            if (m_object_map.size() != rhs.m_object_map.size()) return false;
+            auto it = m_object_map.begin();
+            auto rit = rhs.m_object_map.begin();
+            for (; it != m_object_map.end(); ++it, ++rit) {
+                if (it->first != rit->first) return false;
+                if (!it->second.structurallyEquals(rit->second)) return false;
+            }
+            return true;
+        }
+        default:
+            return *this == rhs;
+    }
+}
+
+inline std::size_t Dictionary::hash() const {
+    auto combine = [](std::size_t seed, std::size_t h) {
+        const auto golden = static_cast<std::size_t>(0x9e3779b97f4a7c15ULL);
+        return seed ^ (h + golden + (seed << 6) + (seed >> 2));
+    };
+    if (isArrayObject()) {
+        std::size_t h = combine(static_cast<std::size_t>(TYPE::ObjectArray), m_array_map.size());
+        for (auto const& p : m_array_map) h = combine(h, p.second.hash());
+        return h;
+    }
+    std::size_t h = static_cast<std::size_t>(my_type);
+    switch (my_type) {
+        case TYPE::Boolean:
+            return combine(h, std::hash<bool>{}(scalar->m_bool));
+        case TYPE::Integer:
+            return combine(h, std::hash<int64_t>{}(scalar->m_int));
+        case TYPE::Double: {
+            // -0.0 == 0.0, so they must hash alike
+            double v = scalar->m_double == 0.0 ? 0.0 : scalar->m_double;
+            return combine(h, std::hash<double>{}(v));
+        }
+        case TYPE::String:
+            return combine(h, std::hash<std::string>{}(scalar->m_string));
+        case TYPE::Object:
+            for (auto const& p : m_object_map) {
+                h = combine(h, std::hash<std::string>{}(p.first));
+                h = combine(h, p.second.hash());
+            }
+            return h;
+        default:
+            return h;
+    }
+}
+
+// Functors for keying unordered containers by Dictionary contents
+struct DictionaryHash {
+    std::size_t operator()(const Dictionary& d) const { return d.hash(); }
+};
+
+struct DictionaryEqual {
+    bool operator()(const Dictionary& a, const Dictionary& b) const {
+        return a.structurallyEquals(b);
+    }
+};
+
 inline std::vector<int> Dictionary::asInt32s() const {
     auto int64s = asInts();
     std::vector<int> out;
@@ -2,6 +2,7 @@
 
 #include <ps/dictionary.h>
 #include <ps/validate.h>
+#include <ps/schema_registry.h>
 #include <ps/parse.h>
 #include <ps/toml.h>
 #include <ps/ini.h>
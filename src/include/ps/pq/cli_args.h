@@ -2,6 +2,7 @@
 
 #include <string>
 #include <optional>
+#include <vector>
 
 namespace ps {
 namespace pq {
@@ -14,25 +15,77 @@ public:
         PRINT,     // Pretty-print the file (default)
         GET,       // Get a value at path
         COUNT,     // Count array elements at path
-        HAS        // Check if path exists
+        HAS,       // Check if path exists
+        FILTER,    // Run a jq-style filter
+        SERVE      // Answer queries over a Unix socket
+    };
+    
+    // One --get/--count/--has action with its path and --default value
+    struct Query {
+        Action action;
+        std::string path;
+        std::optional<std::string> defaultValue;
+    };
+    
+    // A $variable of the filter: --arg name value or --argjson name json
+    struct FilterArgument {
+        std::string name;
+        std::string value;
+        bool isJson;
     };
     
     CliArgs(int argc, const char* argv[]);
     
-    // Accessors
+    // Accessors (action, path and default refer to the first query, the file
+    // path to the first input file)
     Action getAction() const { return action_; }
     const std::string& getFilePath() const { return filePath_; }
-    const std::string& getPath() const { return path_; }
-    bool hasDefault() const { return defaultValue_.has_value(); }
-    const std::string& getDefault() const { return *defaultValue_; }
+    const std::string& getPath() const { return queries_.front().path; }
+    bool hasDefault() const { return !queries_.empty() && queries_.front().defaultValue.has_value(); }
+    const std::string& getDefault() const { return *queries_.front().defaultValue; }
     bool outputAsJson() const { return asJson_; }
+    bool outputAsShell() const { return asShell_; }
+    
+    // All input files in command-line order. Several are given after the
+    // options: pq --get <path> <file>... With none there, or as "-", the
+    // input is read from stdin.
+    const std::vector<std::string>& getFilePaths() const { return filePaths_; }
+    
+    // Gather every document and record of the input into one array (--slurp)
+    bool slurp() const { return slurp_; }
+    
+    // Answer a single query on a JSON file while reading it (--stream). The
+    // input after the answer is not read, so errors there are not reported.
+    bool stream() const { return stream_; }
+    
+    // Worker threads for several input files (--jobs), 0 for one per core
+    unsigned jobs() const { return jobs_; }
+    
+    // Socket of the query daemon (--serve/--client), empty to run locally
+    const std::string& getSocketPath() const { return socketPath_; }
+    
+    // All queries in command-line order
+    const std::vector<Query>& getQueries() const { return queries_; }
+    
+    // The filter of `pq <file> '<filter>'` and its options
+    const std::string& getFilter() const { return filter_; }
+    const std::vector<FilterArgument>& getFilterArguments() const { return filterArguments_; }
+    bool rawOutput() const { return rawOutput_; }
     
 private:
     Action action_ = Action::HELP;
     std::string filePath_;
-    std::string path_;
-    std::optional<std::string> defaultValue_;
+    std::vector<std::string> filePaths_;
+    unsigned jobs_ = 0;
+    bool slurp_ = false;
+    bool stream_ = false;
+    std::vector<Query> queries_;
     bool asJson_ = false;
+    bool asShell_ = false;
+    std::string socketPath_;
+    std::string filter_;
+    std::vector<FilterArgument> filterArguments_;
+    bool rawOutput_ = false;
 };
 
 } // namespace pq
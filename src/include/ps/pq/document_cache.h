@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ps/parsec.h>
+#include <ps/pq/key_index.h>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace ps {
+namespace pq {
+
+// Keeps parsed documents resident, keyed by file path. A document is parsed
+// again when its modification time or size changes on disk.
+class DocumentCache {
+public:
+    // Returns the parsed contents of `path`, reading it on first use or after it
+    // changed. The reference is valid until the next get() for the same path.
+    // Throws std::runtime_error if the file can't be read, or the parse error.
+    const Dictionary& get(const std::string& path);
+    
+    // The key index of the document get(path) returned, built on its first
+    // deep search and dropped when the document is parsed again
+    KeyIndex& index(const std::string& path) { return *entries_.at(path).index; }
+    
+    // Number of documents held
+    size_t size() const { return entries_.size(); }
+    
+    // Drop all documents
+    void clear() { entries_.clear(); }
+    
+private:
+    struct Entry {
+        std::filesystem::file_time_type modified;
+        std::uintmax_t bytes = 0;
+        Dictionary data;
+        std::unique_ptr<KeyIndex> index;
+    };
+    
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+} // namespace pq
+} // namespace ps
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ps/parsec.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ps {
+namespace pq {
+
+// Error raised while running a filter: a failed operation ("Cannot index
+// number with \"a\"") or error(value). try/catch in the filter sees `value`.
+class FilterError : public std::runtime_error {
+public:
+    explicit FilterError(const Dictionary& value);
+
+    const Dictionary& value() const { return value_; }
+
+private:
+    Dictionary value_;
+};
+
+// A jq-style filter such as `.users[] | select(.age > 30) | {name, email}`.
+//
+// The text is parsed once into a tree of evaluation nodes; running it walks
+// the input document by reference, so paths, iteration and select() do not copy
+// the values they pass along. Only constructed values ([...], {...}, arithmetic,
+// updates) are new.
+//
+// Supported: . .foo ."foo" .[e] .[a:b] .[] .. e? | , ( ) literals, string
+// interpolation "\(e)", [e], {a, "b": e, (e): e, $x}, + - * / %, == != < <= > >=,
+// and, or, //, if/elif/else/end, try/catch, reduce, foreach, `e as $x | body`,
+// = |= += -= *= /= %= //=, @text @json @csv @tsv @sh @base64 @base64d @uri
+// @html and the common builtins (length, keys, map, select, sort_by, group_by,
+// to_entries, path, del, paths, test, match, capture, sub, ...). Not supported:
+// def, label/break, destructuring, assigning to slices, input/inputs, and the
+// date, SQL and stream builtins.
+class Filter {
+public:
+    // Compiles `text`. `arguments` are the values of the $variables the filter
+    // may refer to (pq --arg/--argjson).
+    // Throws std::invalid_argument with the column on syntax errors.
+    explicit Filter(const std::string& text,
+                    const std::map<std::string, Dictionary>& arguments = {});
+
+    // Runs the filter on `input` and calls `emit` with each output in order.
+    // An output may be a temporary or point into `input`; copy it to keep it.
+    // Throws FilterError on errors the filter does not catch.
+    void run(const Dictionary& input, const std::function<void(const Dictionary&)>& emit) const;
+
+    // Runs the filter on `input` and returns copies of all outputs
+    std::vector<Dictionary> evaluate(const Dictionary& input) const;
+    
+    // Compact single-line JSON, as tojson and pq print filter outputs
+    static std::string toJson(const Dictionary& value);
+
+private:
+    struct Program;
+    std::shared_ptr<const Program> program_;
+};
+
+} // namespace pq
+} // namespace ps
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <ps/parsec.h>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ps {
+namespace pq {
+
+// Every object member of a document by key name, for answering recursive
+// descent (**/key) without walking the whole tree. Nothing is built until the
+// first visit(); after that each lookup only touches the members with that
+// name. The document must outlive the index and not change while it is used.
+class KeyIndex {
+public:
+    explicit KeyIndex(const Dictionary& root) : root_(root) {}
+    
+    // Calls `visit` with the value of every member named `key` of `from` or
+    // of any object below it, in the order a pre-order walk from `from`
+    // finds them. `from` must be a value of the indexed document.
+    void visit(const Dictionary& from,
+               const std::string& key,
+               const std::function<void(const Dictionary&)>& visit);
+    
+    // Whether the index has been built
+    bool built() const { return built_; }
+    
+private:
+    // A member value with the pre-order number of its object
+    struct Member {
+        size_t parent;
+        const Dictionary* value;
+    };
+    
+    void build();
+    void add(const Dictionary& node, size_t& next);
+    
+    const Dictionary& root_;
+    bool built_ = false;
+    
+    // Members by key, in pre-order of their objects
+    std::unordered_map<std::string, std::vector<Member>> members_;
+    
+    // Pre-order numbers [first, end) of each object and array and everything
+    // below it
+    std::unordered_map<const Dictionary*, std::pair<size_t, size_t>> spans_;
+};
+
+} // namespace pq
+} // namespace ps
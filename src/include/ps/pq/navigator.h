@@ -1,13 +1,24 @@
 #pragma once
 
+#include <ps/pq/key_index.h>
 #include <ps/pq/path_parser.h>
 #include <ps/parsec.h>
+#include <functional>
 #include <vector>
 
 namespace ps {
 namespace pq {
 
-// Navigates through a Dictionary using parsed path tokens
+// Navigates through a Dictionary using parsed path tokens.
+//
+// Negative indices count from the end of an array. Slices ([start:end]) and
+// predicates ([key=value]) select elements of an array in place, like *; a
+// slice only steps through the elements it covers.
+//
+// Recursive descent (**) matches the value it is applied to and every value
+// below it, in pre-order. The rest of the path is matched wherever it exists
+// below those values; unlike with *, a missing key or index there is not an
+// error.
 class Navigator {
 public:
     // Navigate to a single value using path tokens
@@ -17,6 +28,66 @@ public:
     // Navigate with wildcard support - returns multiple results
     // Returns empty vector if no matches found
     std::vector<Dictionary> navigateWildcard(const Dictionary& dict, const std::vector<PathToken>& tokens);
+
+    // Same as navigate(), but returns the value in place instead of a copy.
+    // The reference points into `dict` and is valid as long as `dict` is.
+    const Dictionary& resolve(const Dictionary& dict, const std::vector<PathToken>& tokens) const;
+
+    // Same as navigateWildcard(), but returns pointers to the matches in `dict`
+    std::vector<const Dictionary*> resolveWildcard(const Dictionary& dict,
+                                                   const std::vector<PathToken>& tokens) const;
+
+    // Calls `visit` on each wildcard match in document order as soon as it is
+    // found, without collecting the matches first
+    void visitWildcard(const Dictionary& dict,
+                       const std::vector<PathToken>& tokens,
+                       const std::function<void(const Dictionary&)>& visit) const;
+    
+    // The number of matches visitWildcard() visits. Throws like it does.
+    size_t countMatches(const Dictionary& dict, const std::vector<PathToken>& tokens) const;
+    
+    // Whether `tokens` match at least one value. A key or index missing under
+    // a wildcard is no match rather than an error, as below **; the walk stops
+    // at the first match.
+    bool matchesAny(const Dictionary& dict, const std::vector<PathToken>& tokens) const;
+    
+    // Finds the keys that follow ** in `index` instead of walking the tree.
+    // The index must belong to the document being navigated; nullptr (the
+    // default) walks.
+    void useIndex(KeyIndex* index) { index_ = index; }
+
+private:
+    // Steps from `current` through tokens[begin, end), which hold no wildcard
+    const Dictionary& walk(const Dictionary& current,
+                           const std::vector<PathToken>& tokens,
+                           size_t begin,
+                           size_t end) const;
+
+    // Visits the matches of the tokens from `begin` on below `current`
+    void expand(const Dictionary& current,
+                const std::vector<PathToken>& tokens,
+                size_t begin,
+                const std::function<void(const Dictionary&)>& visit) const;
+    
+    // Visits the matches of the tokens from `begin` on below `node` and each
+    // value under it
+    void descend(const Dictionary& node,
+                 const std::vector<PathToken>& tokens,
+                 size_t begin,
+                 const std::function<void(const Dictionary&)>& visit) const;
+    
+    // Visits the elements of `node` that a slice or predicate token selects
+    void select(const Dictionary& node,
+                const PathToken& token,
+                const std::function<void(const Dictionary&)>& visit) const;
+    
+    // Like expand(), but a path that doesn't exist has no matches
+    void match(const Dictionary& node,
+               const std::vector<PathToken>& tokens,
+               size_t begin,
+               const std::function<void(const Dictionary&)>& visit) const;
+    
+    KeyIndex* index_ = nullptr;
 };
 
 } // namespace pq
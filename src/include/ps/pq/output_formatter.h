@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ps/parsec.h>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -15,12 +16,54 @@ public:
     
     // Format multiple values as raw text (one per line)
     std::string formatRaw(const std::vector<Dictionary>& values);
+    std::string formatRaw(const std::vector<const Dictionary*>& values);
+    
+    // Append the formatRaw()/formatJson() text of `value` to `out`
+    void appendRaw(std::string& out, const Dictionary& value);
+    void appendJson(std::string& out, const Dictionary& value);
     
     // Format a single value as JSON
     std::string formatJson(const Dictionary& value);
     
     // Format multiple values as JSON array
     std::string formatJson(const std::vector<Dictionary>& values);
+    std::string formatJson(const std::vector<const Dictionary*>& values);
+    
+    // Format already formatted text as a shell assignment NAME='text' that is
+    // safe to eval. NAME is `path` in upper case with every other character
+    // replaced by '_' (server/port -> SERVER_PORT).
+    std::string formatShell(const std::string& path, const std::string& text);
+};
+
+// Writes a sequence of values to a stream one at a time, in the same format
+// formatRaw()/formatJson() produce for the whole sequence followed by a newline.
+// Output is collected in a buffer and written to the stream in large blocks:
+// whenever the buffer fills up, in finish(), and on destruction.
+class ResultWriter {
+public:
+    ResultWriter(std::ostream& out, bool asJson);
+    ~ResultWriter();
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+    
+    // Write the next value
+    void write(const Dictionary& value);
+    
+    // Terminate the output (closes the JSON array) and flush it
+    void finish();
+    
+    // Write the buffered output to the stream
+    void flush();
+    
+    // Number of values written so far
+    size_t count() const { return count_; }
+    
+private:
+    OutputFormatter formatter_;
+    std::ostream& out_;
+    bool asJson_;
+    size_t count_ = 0;
+    std::string buffer_;
 };
 
 } // namespace pq
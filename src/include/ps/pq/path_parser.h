@@ -1,45 +1,82 @@
 #pragma once
 
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace ps {
 namespace pq {
 
-// Represents a single token in a path (either a key or an index)
+// Represents a single token in a path: a key, an index (negative counts from
+// the end), a wildcard (*), recursive descent (**), a slice of an array
+// ([start:end]) or the elements of an array whose member has a value
+// ([key=value], [key!=value])
 class PathToken {
 public:
-    enum class Type { Key, Index, Wildcard };
+    enum class Type { Key, Index, Wildcard, Descent, Slice, Predicate };
     
     // Constructors
     static PathToken makeKey(const std::string& key);
     static PathToken makeIndex(int index);
     static PathToken makeWildcard();
+    static PathToken makeDescent();
+    static PathToken makeSlice(std::optional<int> begin, std::optional<int> end);
+    static PathToken makePredicate(const std::string& key, const std::string& value, bool negated);
     
     // Type checks
     bool isKey() const { return type_ == Type::Key; }
     bool isIndex() const { return type_ == Type::Index; }
     bool isWildcard() const { return type_ == Type::Wildcard; }
+    bool isDescent() const { return type_ == Type::Descent; }
+    bool isSlice() const { return type_ == Type::Slice; }
+    bool isPredicate() const { return type_ == Type::Predicate; }
+    
+    // Whether the token can match several values (*, **, slices and predicates)
+    bool matchesMany() const { return type_ != Type::Key && type_ != Type::Index; }
     
     // Accessors
     const std::string& asKey() const;
     int asIndex() const;
     
+    // Slice bounds as written; either may be missing or negative
+    std::optional<int> sliceBegin() const;
+    std::optional<int> sliceEnd() const;
+    
+    // The indices [first, second) the slice selects from an array of `size`
+    // elements, clamped to it as in Python
+    std::pair<int, int> sliceRange(int size) const;
+    
+    // Predicate parts: [key=value] or, negated, [key!=value]
+    const std::string& predicateKey() const;
+    const std::string& predicateValue() const;
+    bool predicateNegated() const;
+    
 private:
     PathToken(Type type, const std::string& key, int index);
     
     Type type_;
     std::string key_;
     int index_;
+    std::string value_;
+    std::optional<int> begin_;
+    std::optional<int> end_;
+    bool negated_ = false;
 };
 
-// Parses slash-separated paths into tokens
+// Parses slash-separated paths into tokens; "." is the root and has none
 class PathParser {
 public:
     std::vector<PathToken> parse(const std::string& path);
     
 private:
     bool isArrayIndex(const std::string& segment);
+    
+    // Splits `path` at `separator`, except inside a segment that starts with [
+    std::vector<std::string> split(const std::string& path, char separator);
+    
+    // Parses a [start:end], [index] or [key=value] segment
+    PathToken parseBracket(const std::string& segment);
 };
 
 } // namespace pq
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <ps/pq/cli_args.h>
+#include <ps/pq/navigator.h>
+#include <ps/pq/output_formatter.h>
+#include <ps/pq/path_parser.h>
+#include <ps/parsec.h>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ps {
+namespace pq {
+
+// Runs the queries of a pq invocation against an already parsed document
+class QueryRunner {
+public:
+    // Writes the results of `args` on `data` to `out` and returns the exit status.
+    // Throws like Navigator when a path is missing and has no default.
+    int run(const CliArgs& args, const Dictionary& data, std::ostream& out);
+    
+    // Whether `args` is a single --get, --count or --has on a .json file with
+    // --stream, which runStreaming() answers while reading the file
+    static bool canStream(const CliArgs& args);
+    
+    // Answers `args` from the JSON text in `in` without parsing all of it
+    // (see StreamQuery). Returns no status, having written nothing, when the
+    // text needs the full parser; run() it on the parsed document instead.
+    std::optional<int> runStreaming(const CliArgs& args, std::istream& in, std::ostream& out);
+    
+    // Answers the queries of `args` on `data`, the contents of `path`, as the
+    // text printed for one of several input files: a "path: result" line per
+    // query, in the format of a multi-query run, or with --as-json a single
+    // {"file": path, "value": result} line ("values" holds one result per
+    // query when there are several). Throws like run().
+    std::string runFile(const CliArgs& args, const std::string& path, const Dictionary& data);
+    
+    // Answers deep searches (**/key) on the documents passed to run() from
+    // `index`, which must belong to them. Building an index costs a few walks
+    // of the tree, so it pays off for documents that stay resident.
+    void useIndex(KeyIndex* index) { navigator_.useIndex(index); }
+    
+private:
+    // Runs the filter of `pq <file> '<filter>'`, writing each output on its own
+    // line as compact JSON (strings unquoted with --raw-output)
+    int runFilter(const CliArgs& args, const Dictionary& data, std::ostream& out);
+    
+    // Evaluates one query of a multi-query invocation and returns its output.
+    // With `oneLine`, wildcard matches are returned as a JSON array instead of
+    // one raw value per line.
+    std::string evaluate(const CliArgs::Query& query,
+                         const Dictionary& data,
+                         bool asJson,
+                         bool oneLine);
+    
+    // The result of one query as a value: the value at the path, the list of
+    // wildcard matches, the count, whether the path exists, or the default
+    Dictionary resolve(const CliArgs::Query& query, const Dictionary& data);
+    
+    // --count: the size of the value at `tokens`, or the number of matches
+    // when the path can match several values
+    size_t count(const Dictionary& data, const std::vector<PathToken>& tokens) const;
+    
+    // --has: whether the value at `tokens` exists, or whether the path
+    // matches any value when it can match several
+    bool has(const Dictionary& data, const std::vector<PathToken>& tokens) const;
+    
+    PathParser pathParser_;
+    Navigator navigator_;
+    OutputFormatter formatter_;
+};
+
+} // namespace pq
+} // namespace ps
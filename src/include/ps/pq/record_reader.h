@@ -0,0 +1,52 @@
+#pragma once
+
+#include <istream>
+#include <string>
+
+namespace ps {
+namespace pq {
+
+// Splits a stream of JSON objects and arrays (one per line as in NDJSON, or
+// separated by any whitespace) into the text of each one as it arrives. Input
+// is read a line at a time, so a record is returned as soon as its last line
+// has been read, and only the current line and record are held in memory.
+//
+// Only brackets, quotes and comments are looked at; each record still has to
+// be parsed.
+class RecordReader {
+public:
+    explicit RecordReader(std::istream& in) : in_(in) {}
+
+    // The first character of the input other than whitespace, without
+    // consuming it; -1 for empty input
+    int peek();
+
+    // Reads the next record into `text` and returns false at the end of the
+    // input. Throws std::runtime_error when the input holds something other
+    // than an object or array between records, or ends inside one; reading
+    // then goes on at the next line.
+    bool next(std::string& text);
+
+    // Line of the input (from 1) on which the last record started
+    size_t line() const { return recordLine_; }
+
+    // Whether all input read so far has been returned, so that the next
+    // next() may have to wait for more
+    bool drained();
+
+    // The input not returned yet, reading the stream to its end
+    std::string rest();
+
+private:
+    // Makes line_[pos_] the next character to read; false at the end of input
+    bool fill();
+
+    std::istream& in_;
+    std::string line_;  // the current line, with its newline
+    size_t pos_ = 0;
+    size_t lineNumber_ = 0;
+    size_t recordLine_ = 0;
+};
+
+} // namespace pq
+} // namespace ps
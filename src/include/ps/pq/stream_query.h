@@ -0,0 +1,116 @@
+#pragma once
+
+#include <ps/pq/path_parser.h>
+#include <ps/parsec.h>
+#include <functional>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace ps {
+namespace pq {
+
+// Answers a path query on JSON text while reading it, without building the
+// document. Only the containers along the path are followed member by
+// member; every other subtree is skipped by matching quotes and brackets, and
+// only the values found are parsed. Reading stops as soon as the answer is
+// known, so a key near the start of a huge file is found without reading the
+// rest of it.
+//
+// Each instance reads its stream once and answers one query. Missing paths
+// throw the same exceptions as Navigator. Input the scanner reads is checked
+// for what the JSON parser would reject along the way (unbalanced brackets,
+// unterminated strings, duplicate keys in the objects on the path); input
+// after the answer is not read at all, so errors there go unreported.
+class StreamQuery {
+public:
+    // Thrown when the text is not JSON the scanner can follow: a comment or
+    // format hint before the root, a syntax error, or a value the JSON parser
+    // only accepts in context. Also thrown for recursive descent (**),
+    // predicates and negative indices or slice bounds. Parse the whole
+    // document instead to get its result or error.
+    class Unsupported : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    explicit StreamQuery(std::istream& in);
+
+    // Calls `visit` with each value at `tokens` in document order, as soon as
+    // it has been read
+    void visit(const std::vector<PathToken>& tokens,
+               const std::function<void(const Dictionary&)>& visit);
+
+    // Whether the value at `tokens` exists. Paths that can match several
+    // values are Unsupported.
+    bool has(const std::vector<PathToken>& tokens);
+
+    // The number of elements or members of the value at `tokens`, 0 for
+    // scalars. Paths that can match several values are Unsupported.
+    int count(const std::vector<PathToken>& tokens);
+
+    // Bytes read from the stream so far
+    size_t bytesRead() const { return offset_ + end_; }
+
+private:
+    // What to do with the value at the end of the path
+    enum class Target { Parse, Count, Exists };
+
+    void run(const std::vector<PathToken>& tokens, Target target);
+
+    // Follows tokens_[depth...] from the value at the read position. With
+    // `consume` (below a wildcard) the value is always read to its end;
+    // otherwise reading stops once the path has been followed.
+    void match(size_t depth, bool consume);
+    void matchKey(size_t depth, bool consume);
+    void matchIndex(size_t depth, bool consume);
+    void matchEach(size_t depth);
+    void arrive();
+    int countChildren();
+
+    // Steps to the next element of an array or member of an object whose
+    // opening bracket has been read; false at the closing one
+    bool nextElement(bool first);
+    bool nextMember(bool first, std::string& key);
+    void checkUnique(std::unordered_set<std::string>& seen, const std::string& key);
+
+    void skipValue();
+    void skipContainer();
+    void skipString();
+    void skipScalar();
+    void skipSpace();
+    void skipComment();
+    std::string readKey();
+
+    void beginCapture(std::string& text);
+    void endCapture();
+
+    int peek();
+    int get();
+    bool fill();
+    [[noreturn]] void unsupported(const std::string& what) const;
+
+    std::istream& in_;
+    std::vector<char> buffer_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+    size_t offset_ = 0;  // stream position of buffer_[0]
+
+    // The value being captured for parsing holds *capture_ followed by
+    // buffer_[captureFrom_, pos_)
+    std::string* capture_ = nullptr;
+    size_t captureFrom_ = 0;
+
+    // The closing brackets skipContainer() expects, innermost last
+    std::string brackets_;
+
+    const std::vector<PathToken>* tokens_ = nullptr;
+    Target target_ = Target::Parse;
+    const std::function<void(const Dictionary&)>* visit_ = nullptr;
+    int count_ = 0;
+};
+
+} // namespace pq
+} // namespace ps
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "ps/dictionary.h"
+
+namespace ps {
+
+// Loads JSON schemas that are split across several files and resolves the
+// $refs between them.
+//
+// A $ref may name another document by a path relative to the referring file
+// ("common.json#/definitions/point") or by the $id declared at the root of a
+// document the registry already knows. Each document is read and parsed once.
+// resolve() then builds a self-contained schema in which every reference into
+// another document is rewritten to a local "#/$defs/..." pointer at a copy of
+// that document. The resolved schema is cached as well, so it can be passed to
+// validate_all() and setDefaults() repeatedly without re-reading anything.
+//
+// $id is honoured on document roots only. All members are safe to call from
+// several threads. Schemas are handed out as shared, immutable documents:
+// one stays valid and unchanged for as long as the caller holds it, even
+// after add() replaces it in the registry or clear() forgets it.
+class SchemaRegistry {
+public:
+    // Parse the schema file at `path`, or return the cached copy.
+    // Throws std::runtime_error if the file cannot be read or parsed.
+    std::shared_ptr<const Dictionary> load(const std::string& path);
+
+    // Make an in-memory schema available under `uri`, as if a document
+    // declaring that $id had been loaded. Replaces an earlier schema with
+    // the same uri and drops cached resolved schemas that may have used it;
+    // schemas already returned keep their contents.
+    void add(const std::string& uri, const Dictionary& schema);
+
+    // Self-contained form of the schema file at `path` (see above).
+    // Throws std::runtime_error if a referenced document cannot be found.
+    std::shared_ptr<const Dictionary> resolve(const std::string& path);
+
+    // Number of distinct documents parsed or added so far
+    size_t document_count() const;
+
+    // Forget every document and resolved schema
+    void clear();
+
+private:
+    struct Document {
+        std::string id;   // $id of the document, or the uri passed to add()
+        std::string dir;  // directory for relative file refs (empty if in-memory)
+        std::shared_ptr<const Dictionary> schema;
+    };
+
+    struct Bundle;
+
+    const std::string& load_locked(const std::string& path);
+    const std::string& locate(const std::string& target, const std::string& from_key);
+    void rewrite_refs(Dictionary& node, const std::string& doc_key, Bundle& bundle);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Document> documents_;  // keyed by canonical path or uri
+    std::map<std::string, std::string> ids_;     // $id -> documents_ key
+    std::map<std::string, std::shared_ptr<const Dictionary>> resolved_;  // documents_ key -> resolved
+};
+
+}  // namespace ps
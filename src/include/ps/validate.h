@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <optional>
 #include <vector>
@@ -40,6 +41,7 @@ struct ValidationError {
     int depth;            // Depth in JSON tree (0 = root)
     ErrorSeverity severity;
     ErrorCategory category;
+    std::string node_path;  // node whose check reported it, dotted form ("cfd.bcs[0]")
 
     ValidationError(const std::string& p,
                     const std::string& msg,
@@ -50,10 +52,59 @@ struct ValidationError {
         : path(p), message(msg), line_number(line), depth(d), severity(sev), category(cat) {}
 };
 
+// Options that bound how much work validate_all does on invalid input
+struct ValidationOptions {
+    // Stop traversing once this many issues have been recorded (0 = no limit)
+    int max_errors = 0;
+
+    // Stop at the first issue; useful when only a yes/no answer is needed.
+    // Equivalent to max_errors = 1.
+    bool stop_on_first_error = false;
+
+    // Skip "Did you mean ...?" suggestions (Levenshtein searches over
+    // declared property names and enum values)
+    bool skip_suggestions = false;
+
+    // Time the validator per schema keyword and location and attach a
+    // ValidationProfile to the result. Adds clock reads to every check.
+    bool profile = false;
+};
+
+// Where validation time went, collected when ValidationOptions::profile is set
+struct ValidationProfile {
+    struct Entry {
+        std::string name;
+        long long calls = 0;
+        double total_ms = 0.0;  // including nested checks
+        double self_ms = 0.0;   // excluding time charged to nested entries
+    };
+
+    // Per schema keyword ("properties", "anyOf", "pattern", ...), by self time
+    std::vector<Entry> keywords;
+    // Per schema location ("$ref #/definitions/bc", "oneOf[2] wall", "pattern ^[a-z]+$"),
+    // by total time
+    std::vector<Entry> locations;
+    long long nodes = 0;    // schema/data node pairs visited
+    double total_ms = 0.0;  // wall time of the whole validation
+
+    // Add the counts and times of `other`, e.g. across the files of a batch
+    void merge(const ValidationProfile& other);
+
+    // Ranked hot list with the first `top` entries of each table
+    std::string format(size_t top = 15) const;
+};
+
 // Result of validation containing all errors found
 struct ValidationResult {
     std::vector<ValidationError> errors;
 
+    // True when the traversal stopped early because the error budget in
+    // ValidationOptions was reached, so `errors` may be incomplete.
+    bool truncated = false;
+
+    // Set when ValidationOptions::profile was requested
+    std::optional<ValidationProfile> profile;
+
     // Check if validation passed (no errors at all)
     bool is_valid() const { return errors.empty(); }
 
@@ -66,20 +117,76 @@ struct ValidationResult {
     std::string format() const;
 };
 
+// A schema prepared for validating many documents.
+//
+// validate_all() on a plain schema builds its lookup tables (hashed sets for
+// enums of more than 16 values, anyOf/oneOf alternatives by discriminator
+// value, declared property names for "did you mean" suggestions) the first time
+// a check needs them, and drops them when it returns. A CompiledSchema builds
+// them for every schema node once, up front. It is immutable afterwards, so one
+// instance can be shared by several threads. Copies are cheap and share the
+// tables.
+class CompiledSchema {
+public:
+    // Copies `schema`
+    explicit CompiledSchema(const Dictionary& schema);
+    explicit CompiledSchema(std::shared_ptr<const Dictionary> schema);
+
+    const Dictionary& schema() const;
+
+    // Number of lookup tables built
+    size_t size() const;
+
+    struct Tables;
+    const Tables& tables() const { return *tables_; }
+
+private:
+    std::shared_ptr<const Tables> tables_;
+};
+
 // New primary API - returns all validation errors
 ValidationResult validate_all(const Dictionary& data,
                               const Dictionary& schema,
                               const std::string& raw_content = "");
 
+// Same as above, with an error budget / fail-fast behavior controlled by `options`
+ValidationResult validate_all(const Dictionary& data,
+                              const Dictionary& schema,
+                              const std::string& raw_content,
+                              const ValidationOptions& options);
+
+// Same as validate_all(data, schema.schema(), ...), using the tables in `schema`
+ValidationResult validate_all(const Dictionary& data,
+                              const CompiledSchema& schema,
+                              const std::string& raw_content = "",
+                              const ValidationOptions& options = ValidationOptions{});
+
+// Incremental form of validate_all for a document edited after `previous`
+// was computed from it. `changed_paths` name every edited node in dotted
+// form ("mesh.boundaries[2].name", "" for the whole document), including
+// keys that were added or removed. Only those subtrees are validated again,
+// together with the checks their ancestors make (required, additional
+// properties, anyOf/oneOf/not, array sizes, ...). Issues elsewhere are
+// carried over from `previous` unchanged, line numbers included, and come
+// before the new ones. A truncated `previous` forces a full validation.
+ValidationResult revalidate(const ValidationResult& previous,
+                            const Dictionary& data,
+                            const Dictionary& schema,
+                            const std::vector<std::string>& changed_paths,
+                            const std::string& raw_content = "",
+                            const ValidationOptions& options = ValidationOptions{});
+
 // Set schema context for better error messages (optional)
 // Call this before validate_all to provide schema file information in error messages
 void set_schema_context(const std::string& filename, const std::string& content);
 
 // Set data filename for better error messages (optional)
+// The data filename is tracked per thread.
 void set_data_filename(const std::string& filename);
 
 // Set original data (before defaults) for better error messages (optional)
-// Call this before validate_all to show original user-provided values in error messages
+// Call this before validate_all to show original user-provided values in error messages.
+// Like the data filename, this is tracked per thread.
 void set_original_data(const Dictionary* data);
 
 // Backward compatible API - returns first error message
@@ -98,4 +205,28 @@ std::optional<std::string> validate(const Dictionary& data,
 // nested object schemas, and `items` for arrays).
 Dictionary setDefaults(const Dictionary& data, const Dictionary& schema);
 
+// One change made by applyDefaults(): the value at `path` (dotted/bracketed,
+// as in validation errors, "" for the document) was added, or replaced
+// `previous`.
+struct DefaultEdit {
+    std::string path;
+    std::optional<Dictionary> previous;  // empty when the value was added
+};
+
+// In-place form of setDefaults(): fills the same defaults into `data`,
+// touching only what is missing. When `edits` is given, every change is
+// appended to it in the order it was made.
+void applyDefaults(Dictionary& data,
+                   const Dictionary& schema,
+                   std::vector<DefaultEdit>* edits = nullptr);
+
+// Fill defaults into `data` in place, then validate it: the same result as
+// validate_all() after setDefaults() with set_original_data() pointing at
+// the document as parsed, without a copy of the whole document. Error
+// messages still show values as written before the defaults were applied.
+ValidationResult validate_with_defaults(Dictionary& data,
+                                        const Dictionary& schema,
+                                        const std::string& raw_content = "",
+                                        const ValidationOptions& options = ValidationOptions{});
+
 }  // namespace ps
@@ -0,0 +1,823 @@
+#include "ps/codegen.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <optional>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "ps/parse.h"
+
+namespace ps {
+
+namespace {
+
+// Keywords that make a schema a schema rather than a bare map of properties
+// (the convenience form accepted by validate_all)
+const char* const kSchemaKeys[] = {"type",
+                                   "properties",
+                                   "items",
+                                   "additionalProperties",
+                                   "unevaluatedProperties",
+                                   "patternProperties",
+                                   "required",
+                                   "enum",
+                                   "allOf",
+                                   "anyOf",
+                                   "oneOf",
+                                   "minItems",
+                                   "maxItems",
+                                   "minProperties",
+                                   "maxProperties",
+                                   "uniqueItems"};
+
+std::string escape_json(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buf;
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+    return out;
+}
+
+// All digits, and always with a '.' or exponent so that it reads back as a double
+std::string format_double(double v) {
+    if (!std::isfinite(v)) throw std::runtime_error("schema holds a non-finite number");
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g", v);
+    std::string s = buf;
+    if (s.find_first_of(".e") == std::string::npos) s += ".0";
+    return s;
+}
+
+// Exact JSON text of `d`. Dictionary::dump() rounds doubles and does not
+// escape keys, so it cannot be used to embed a schema.
+void write_json(std::string& out, const Dictionary& d) {
+    if (d.isMappedObject()) {
+        out.push_back('{');
+        bool first = true;
+        for (const auto& [key, value] : d.members()) {
+            if (!first) out.push_back(',');
+            first = false;
+            out += escape_json(key);
+            out.push_back(':');
+            write_json(out, value);
+        }
+        out.push_back('}');
+        return;
+    }
+    if (d.isArrayObject()) {
+        out.push_back('[');
+        bool first = true;
+        for (const auto& element : d.elements()) {
+            if (!first) out.push_back(',');
+            first = false;
+            write_json(out, element.second);
+        }
+        out.push_back(']');
+        return;
+    }
+    switch (d.type()) {
+        case Dictionary::Boolean:
+            out += d.asBool() ? "true" : "false";
+            break;
+        case Dictionary::Integer:
+            out += std::to_string(d.asInt());
+            break;
+        case Dictionary::Double:
+            out += format_double(d.asDouble());
+            break;
+        case Dictionary::String:
+            out += escape_json(d.asStringRef());
+            break;
+        default:
+            out += "null";
+    }
+}
+
+std::string json_text(const Dictionary& d) {
+    std::string out;
+    write_json(out, d);
+    return out;
+}
+
+// Pieces of a C++ string literal body, one per input byte
+std::vector<std::string> cpp_escaped(const std::string& s) {
+    std::vector<std::string> pieces;
+    pieces.reserve(s.size());
+    for (char c : s) {
+        auto u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            pieces.push_back(std::string("\\") + c);
+        } else if (u < 0x20 || u >= 0x7f) {
+            // Octal escapes have at most three digits, so they cannot run
+            // into the next character the way hex escapes can.
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\%03o", u);
+            pieces.push_back(buf);
+        } else {
+            pieces.push_back(std::string(1, c));
+        }
+    }
+    return pieces;
+}
+
+std::string cpp_literal(const std::string& s) {
+    std::string out = "\"";
+    for (const auto& piece : cpp_escaped(s)) out += piece;
+    return out + "\"";
+}
+
+// Keep arbitrary text from ending a // comment early
+std::string comment_text(const std::string& s) {
+    std::string out;
+    for (char c : s) out.push_back(c == '\n' || c == '\r' ? ' ' : c);
+    return out;
+}
+
+// The same lookups validate_all() uses
+const Dictionary* resolve_local_ref(const Dictionary& root, const std::string& ref) {
+    if (ref.empty() || ref[0] != '#') return nullptr;
+    std::string path = ref;
+    if (path.size() >= 2 && path[1] == '/')
+        path = path.substr(2);
+    else if (path.size() == 1)
+        return &root;
+
+    const Dictionary* cur = &root;
+    size_t pos = 0;
+    while (pos < path.size()) {
+        size_t next = path.find('/', pos);
+        std::string token =
+                    (next == std::string::npos) ? path.substr(pos) : path.substr(pos, next - pos);
+        pos = (next == std::string::npos) ? path.size() : next + 1;
+        if (!cur->has(token)) return nullptr;
+        const Dictionary& v = cur->at(token);
+        if (!v.isMappedObject()) return nullptr;
+        cur = &v;
+    }
+    return cur;
+}
+
+const Dictionary* schema_from_value(const Dictionary& root, const Dictionary& v) {
+    if (v.isMappedObject()) return &v;
+    if (v.type() == Dictionary::String) return resolve_local_ref(root, v.asString());
+    return nullptr;
+}
+
+bool is_true(const Dictionary& node, const char* key) {
+    return node.has(key) && node.at(key).type() == Dictionary::Boolean && node.at(key).asBool();
+}
+
+bool has_string(const Dictionary& node, const char* key) {
+    return node.has(key) && node.at(key).type() == Dictionary::String;
+}
+
+bool has_integer(const Dictionary& node, const char* key) {
+    return node.has(key) && node.at(key).type() == Dictionary::Integer;
+}
+
+// A matched anyOf/oneOf alternative is reported when it is marked deprecated
+bool deprecated_alternative(const Dictionary& root, const Dictionary* sub) {
+    const Dictionary* resolved = sub;
+    if (has_string(*sub, "$ref")) {
+        resolved = resolve_local_ref(root, sub->at("$ref").asString());
+        if (!resolved) resolved = sub;
+    }
+    return is_true(*resolved, "deprecated");
+}
+
+bool valid_regex(const std::string& pattern) {
+    try {
+        std::regex rx(pattern);
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+// Emits one function per schema node. Every function returns whether the
+// value passes that node without validate_all() reporting anything, errors,
+// warnings or deprecations alike. Each keyword below mirrors the check in
+// validate_node().
+class Generator {
+public:
+    Generator(const Dictionary& root, const CodegenOptions& options)
+        : root_(root), options_(options) {}
+
+    std::string source() {
+        const Dictionary* entry = &root_;
+        if (root_.isMappedObject()) {
+            bool keyword = false;
+            for (const char* key : kSchemaKeys) keyword = keyword || root_.has(key);
+            if (!keyword) {
+                wrapper_["type"] = std::string("object");
+                wrapper_["properties"] = root_;
+                entry = &wrapper_;
+            }
+        }
+        function_for(*entry);
+        // Emitting a node can register more nodes
+        for (size_t i = 0; i < nodes_.size(); ++i) emit_function(static_cast<int>(i));
+        return assemble();
+    }
+
+private:
+    using Lines = std::ostringstream;
+
+    int function_for(const Dictionary& node) {
+        auto it = ids_.find(&node);
+        if (it != ids_.end()) return it->second;
+        int id = static_cast<int>(nodes_.size());
+        ids_.emplace(&node, id);
+        nodes_.push_back(&node);
+        return id;
+    }
+
+    std::string call(const Dictionary& node, const std::string& arg) {
+        return "check_" + std::to_string(function_for(node)) + "(" + arg + ")";
+    }
+
+    std::string literal(const Dictionary& value) {
+        literals_.push_back(json_text(value));
+        return "literal_" + std::to_string(literals_.size() - 1) + "()";
+    }
+
+    std::string regex(const std::string& pattern) {
+        patterns_.push_back(pattern);
+        return "regex_" + std::to_string(patterns_.size() - 1) + "()";
+    }
+
+    std::string string_set(const std::vector<std::string>& values) {
+        string_sets_.push_back(values);
+        return "in_set_" + std::to_string(string_sets_.size() - 1);
+    }
+
+    void emit_function(int id) {
+        const Dictionary& node = *nodes_[static_cast<size_t>(id)];
+        Lines& out = functions_;
+        out << "\n";
+        if (has_string(node, "title"))
+            out << "// " << comment_text(node.at("title").asString()) << "\n";
+        Lines body;
+        emit_checks(body, node);
+        const std::string text = body.str();
+        // Nodes without any check do not read their argument
+        bool reads = false;
+        auto ident = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; };
+        for (size_t i = 0; i < text.size() && !reads; ++i) {
+            reads = text[i] == 'd' && (i == 0 || !ident(text[i - 1])) &&
+                    (i + 1 == text.size() || !ident(text[i + 1]));
+        }
+        out << "bool check_" << id << "(const ps::Dictionary&" << (reads ? " d" : "") << ") {\n";
+        out << text;
+        out << "}\n";
+    }
+
+    void emit_checks(Lines& out, const Dictionary& node) {
+        const std::string in = "    ";
+        // $ref replaces every other keyword of the node
+        if (has_string(node, "$ref")) {
+            const std::string ref = node.at("$ref").asString();
+            const Dictionary* target = resolve_local_ref(root_, ref);
+            if (!target) {
+                out << in << "return false;  // unresolved $ref " << comment_text(ref) << "\n";
+            } else {
+                out << in << "return " << call(*target, "d") << ";\n";
+            }
+            return;
+        }
+
+        if (node.has("enum")) {
+            const Dictionary& ev = node.at("enum");
+            if (!ev.isArrayObject()) {
+                out << in << "return false;  // malformed enum, rejected by validate_all()\n";
+                return;
+            }
+            bool all_strings = ev.size() > 0;
+            std::vector<std::string> values;
+            for (const auto& element : ev.elements()) {
+                if (element.second.type() != Dictionary::String) {
+                    all_strings = false;
+                    break;
+                }
+                values.push_back(element.second.asString());
+            }
+            if (all_strings) {
+                out << in << "if (!d.isString() || !" << string_set(values)
+                    << "(d.asStringRef())) return false;\n";
+            } else {
+                out << in << "if (!matches_any(" << literal(ev) << ", d)) return false;\n";
+            }
+        }
+
+        if (node.has("const")) {
+            const Dictionary& value = node.at("const");
+            if (value.type() == Dictionary::String) {
+                out << in << "if (!d.isString() || d.asStringRef() != "
+                    << cpp_literal(value.asString()) << ") return false;\n";
+            } else {
+                out << in << "if (!(" << literal(value) << " == d)) return false;\n";
+            }
+        }
+
+        if (node.has("allOf") && node.at("allOf").isArrayObject()) {
+            for (const auto& element : node.at("allOf").elements()) {
+                const Dictionary* sub = schema_from_value(root_, element.second);
+                if (sub) out << in << "if (!" << call(*sub, "d") << ") return false;\n";
+            }
+        }
+
+        if (node.has("anyOf") && node.at("anyOf").isArrayObject()) {
+            std::vector<const Dictionary*> plain, deprecated;
+            for (const auto& element : node.at("anyOf").elements()) {
+                const Dictionary* sub = schema_from_value(root_, element.second);
+                if (!sub) continue;
+                (deprecated_alternative(root_, sub) ? deprecated : plain).push_back(sub);
+            }
+            if (plain.empty()) {
+                out << in << "return false;  // anyOf without a usable alternative\n";
+                return;
+            }
+            out << in << "{\n";
+            out << in << in << "bool matched = false;\n";
+            for (const Dictionary* sub : plain) {
+                out << in << in << "matched = matched || " << call(*sub, "d") << ";\n";
+            }
+            for (const Dictionary* sub : deprecated) {
+                out << in << in << "if (" << call(*sub, "d")
+                    << ") return false;  // deprecated alternative\n";
+            }
+            out << in << in << "if (!matched) return false;\n";
+            out << in << "}\n";
+        }
+
+        if (node.has("oneOf") && node.at("oneOf").isArrayObject()) {
+            std::vector<const Dictionary*> plain, deprecated;
+            for (const auto& element : node.at("oneOf").elements()) {
+                const Dictionary* sub = schema_from_value(root_, element.second);
+                if (!sub) continue;
+                (deprecated_alternative(root_, sub) ? deprecated : plain).push_back(sub);
+            }
+            if (plain.empty()) {
+                out << in << "return false;  // oneOf without a usable alternative\n";
+                return;
+            }
+            out << in << "{\n";
+            out << in << in << "int matches = 0;\n";
+            for (const Dictionary* sub : plain) {
+                out << in << in << "if (" << call(*sub, "d")
+                    << " && ++matches > 1) return false;\n";
+            }
+            for (const Dictionary* sub : deprecated) {
+                out << in << in << "if (" << call(*sub, "d")
+                    << ") return false;  // deprecated alternative\n";
+            }
+            out << in << in << "if (matches != 1) return false;\n";
+            out << in << "}\n";
+        }
+
+        if (node.has("not")) {
+            const Dictionary* sub = schema_from_value(root_, node.at("not"));
+            if (sub) out << in << "if (" << call(*sub, "d") << ") return false;\n";
+        }
+
+        const bool typed = has_string(node, "type");
+        const std::string t = typed ? node.at("type").asString() : std::string();
+        if (t == "object") {
+            out << in << "if (!d.isMappedObject()) return false;\n";
+            emit_object(out, node, in);
+            out << in << "return true;\n";
+            return;
+        }
+        if (!typed && (node.has("properties") || node.has("required") ||
+                       node.has("additionalProperties") || node.has("patternProperties") ||
+                       node.has("unevaluatedProperties"))) {
+            out << in << "if (d.isMappedObject()) {\n";
+            emit_object(out, node, in + in);
+            out << in << in << "return true;\n";
+            out << in << "}\n";
+        } else if (t == "array") {
+            emit_array(out, node, in);
+            out << in << "return true;\n";
+            return;
+        } else if (t == "string") {
+            emit_string(out, node, in);
+            out << in << "return true;\n";
+            return;
+        } else if (t == "integer") {
+            out << in << "if (!d.isInt()) return false;\n";
+        } else if (t == "number") {
+            out << in << "if (!d.isInt() && !d.isDouble()) return false;\n";
+        } else if (t == "boolean") {
+            out << in << "return d.isBool();\n";
+            return;
+        }
+        emit_numeric(out, node, in);
+        out << in << "return true;\n";
+    }
+
+    void emit_object(Lines& out, const Dictionary& node, const std::string& in) {
+        if (node.has("unevaluatedProperties")) {
+            out << in << "return false;  // unevaluatedProperties: left to validate_all()\n";
+            return;
+        }
+        const Dictionary* properties = nullptr;
+        if (node.has("properties") && node.at("properties").isMappedObject())
+            properties = &node.at("properties");
+
+        std::set<std::string> required;
+        if (node.has("required")) {
+            const Dictionary& r = node.at("required");
+            try {
+                for (const auto& s : r.asStrings()) required.insert(s);
+            } catch (...) {
+                if (r.isArrayObject()) {
+                    for (const auto& element : r.elements()) {
+                        if (element.second.type() == Dictionary::String)
+                            required.insert(element.second.asString());
+                    }
+                }
+            }
+        }
+        if (properties) {
+            for (const auto& [key, prop] : properties->members()) {
+                if (is_true(prop, "required")) required.insert(key);
+            }
+        }
+        for (const auto& name : required) {
+            out << in << "if (!d.has(" << cpp_literal(name) << ")) return false;\n";
+        }
+        if (has_integer(node, "minProperties")) {
+            out << in << "if (d.size() < " << node.at("minProperties").asInt()
+                << "LL) return false;\n";
+        }
+        if (has_integer(node, "maxProperties")) {
+            out << in << "if (d.size() > " << node.at("maxProperties").asInt()
+                << "LL) return false;\n";
+        }
+
+        // Members: declared properties first, then patternProperties, then
+        // additionalProperties, as validate_node() assigns them
+        std::vector<std::pair<std::string, const Dictionary*>> patterns;
+        if (node.has("patternProperties") && node.at("patternProperties").isMappedObject()) {
+            for (const auto& [pattern, value] : node.at("patternProperties").members()) {
+                if (valid_regex(pattern))
+                    patterns.emplace_back(pattern, schema_from_value(root_, value));
+            }
+        }
+        enum { ANY, NONE, SCHEMA } additional = ANY;
+        const Dictionary* additional_schema = nullptr;
+        if (node.has("additionalProperties")) {
+            const Dictionary& ap = node.at("additionalProperties");
+            if (ap.type() == Dictionary::Boolean) {
+                additional = ap.asBool() ? ANY : NONE;
+            } else {
+                additional_schema = schema_from_value(root_, ap);
+                if (additional_schema) additional = SCHEMA;
+            }
+        }
+        const bool declared = properties && properties->size() > 0;
+        if (!declared && patterns.empty()) {
+            if (additional == NONE) {
+                out << in << "if (d.size() > 0) return false;\n";
+                return;
+            }
+            if (additional == ANY) return;
+        }
+
+        // Per member: the code to run and whether it reads the value
+        Lines body;
+        bool uses_value = false;
+        const std::string in2 = in + "    ";
+        if (declared) {
+            std::map<size_t, std::vector<std::string>> by_length;
+            for (const auto& member : properties->members())
+                by_length[member.first.size()].push_back(member.first);
+            body << in2 << "switch (key.size()) {\n";
+            for (const auto& [length, keys] : by_length) {
+                body << in2 << "    case " << length << ":\n";
+                for (const auto& key : keys) {
+                    const Dictionary& prop = properties->at(key);
+                    body << in2 << "        if (key == " << cpp_literal(key) << ") {\n";
+                    if (is_true(prop, "deprecated")) {
+                        body << in2 << "            return false;  // deprecated property\n";
+                    } else {
+                        if (const Dictionary* sub = schema_from_value(root_, prop)) {
+                            body << in2 << "            if (!" << call(*sub, "value")
+                                 << ") return false;\n";
+                            uses_value = true;
+                        }
+                        body << in2 << "            continue;\n";
+                    }
+                    body << in2 << "        }\n";
+                }
+                body << in2 << "        break;\n";
+            }
+            body << in2 << "    default:\n";
+            body << in2 << "        break;\n";
+            body << in2 << "}\n";
+        }
+        for (const auto& [pattern, sub] : patterns) {
+            body << in2 << "if (std::regex_match(key, " << regex(pattern) << ")) {\n";
+            if (sub) {
+                body << in2 << "    if (!" << call(*sub, "value") << ") return false;\n";
+                uses_value = true;
+            }
+            body << in2 << "    continue;\n";
+            body << in2 << "}\n";
+        }
+        if (additional == NONE) {
+            body << in2 << "return false;  // additionalProperties: false\n";
+        } else if (additional == SCHEMA) {
+            body << in2 << "if (!" << call(*additional_schema, "value") << ") return false;\n";
+            uses_value = true;
+        }
+
+        out << in << "for (const auto& member : d.members()) {\n";
+        if (declared || !patterns.empty())
+            out << in2 << "const std::string& key = member.first;\n";
+        if (uses_value) out << in2 << "const ps::Dictionary& value = member.second;\n";
+        out << body.str();
+        out << in << "}\n";
+    }
+
+    void emit_array(Lines& out, const Dictionary& node, const std::string& in) {
+        out << in << "if (!d.isArrayObject()) return false;\n";
+        if (has_integer(node, "minItems"))
+            out << in << "if (d.size() < " << node.at("minItems").asInt() << "LL) return false;\n";
+        if (has_integer(node, "maxItems"))
+            out << in << "if (d.size() > " << node.at("maxItems").asInt() << "LL) return false;\n";
+        if (is_true(node, "uniqueItems")) out << in << "if (has_duplicates(d)) return false;\n";
+
+        // Schemas for leading positions, then for the remaining items
+        std::vector<const Dictionary*> positional;
+        const Dictionary* rest = nullptr;
+        bool rest_forbidden = false;
+        if (node.has("prefixItems") && node.at("prefixItems").isArrayObject()) {
+            for (const auto& element : node.at("prefixItems").elements())
+                positional.push_back(schema_from_value(root_, element.second));
+            if (node.has("items")) rest = schema_from_value(root_, node.at("items"));
+        } else if (node.has("items")) {
+            const Dictionary& items = node.at("items");
+            if (items.isArrayObject()) {
+                for (const auto& element : items.elements())
+                    positional.push_back(schema_from_value(root_, element.second));
+                if (node.has("additionalItems")) {
+                    const Dictionary& extra = node.at("additionalItems");
+                    if (extra.type() == Dictionary::Boolean)
+                        rest_forbidden = !extra.asBool();
+                    else
+                        rest = schema_from_value(root_, extra);
+                }
+            } else {
+                rest = schema_from_value(root_, items);
+            }
+        }
+        bool any_positional = false;
+        for (const Dictionary* sub : positional) any_positional = any_positional || sub;
+        if (rest_forbidden) {
+            out << in << "if (d.size() > " << positional.size() << ") return false;\n";
+        }
+        if (!any_positional && !rest) return;
+
+        const std::string in2 = in + "    ";
+        out << in << "for (const auto& element : d.elements()) {\n";
+        out << in2 << "const ps::Dictionary& item = element.second;\n";
+        if (!positional.empty()) {
+            out << in2 << "if (element.first < " << positional.size() << ") {\n";
+            if (any_positional) {
+                out << in2 << "    switch (element.first) {\n";
+                for (size_t i = 0; i < positional.size(); ++i) {
+                    if (!positional[i]) continue;
+                    out << in2 << "        case " << i << ":\n";
+                    out << in2 << "            if (!" << call(*positional[i], "item")
+                        << ") return false;\n";
+                    out << in2 << "            break;\n";
+                }
+                out << in2 << "        default:\n";
+                out << in2 << "            break;\n";
+                out << in2 << "    }\n";
+            }
+            out << in2 << "    continue;\n";
+            out << in2 << "}\n";
+        }
+        if (rest) out << in2 << "if (!" << call(*rest, "item") << ") return false;\n";
+        out << in << "}\n";
+    }
+
+    void emit_string(Lines& out, const Dictionary& node, const std::string& in) {
+        out << in << "if (!d.isString()) return false;\n";
+        const bool pattern = has_string(node, "pattern") &&
+                             valid_regex(node.at("pattern").asString());
+        if (!has_integer(node, "minLength") && !has_integer(node, "maxLength") && !pattern)
+            return;
+        out << in << "const std::string& s = d.asStringRef();\n";
+        if (has_integer(node, "minLength")) {
+            out << in << "if (static_cast<int>(s.size()) < " << node.at("minLength").asInt()
+                << "LL) return false;\n";
+        }
+        if (has_integer(node, "maxLength")) {
+            out << in << "if (static_cast<int>(s.size()) > " << node.at("maxLength").asInt()
+                << "LL) return false;\n";
+        }
+        if (pattern) {
+            out << in << "if (!std::regex_match(s, " << regex(node.at("pattern").asString())
+                << ")) return false;\n";
+        }
+    }
+
+    void emit_numeric(Lines& out, const Dictionary& node, const std::string& in) {
+        static const std::pair<const char*, const char*> bounds[] = {{"minimum", "<"},
+                                                                    {"exclusiveMinimum", "<="},
+                                                                    {"maximum", ">"},
+                                                                    {"exclusiveMaximum", ">="}};
+        std::vector<std::string> checks;
+        for (const auto& [keyword, op] : bounds) {
+            if (!node.has(keyword)) continue;
+            const Dictionary& b = node.at(keyword);
+            if (b.type() != Dictionary::Integer && b.type() != Dictionary::Double) continue;
+            checks.push_back(std::string("if (v ") + op + " " + format_double(b.asDouble()) +
+                             ") return false;");
+        }
+        if (checks.empty()) return;
+        out << in << "if (d.isInt() || d.isDouble()) {\n";
+        out << in << "    const double v = d.isInt() ? static_cast<double>(d.asInt()) : "
+                     "d.asDouble();\n";
+        for (const auto& check : checks) out << in << "    " << check << "\n";
+        out << in << "}\n";
+    }
+
+    std::string assemble() {
+        const std::string& name = options_.name;
+        Lines out;
+        out << "// Generated by parsec-codegen from " << comment_text(options_.source_label)
+            << ". Do not edit.\n\n";
+        out << "#include \"" << options_.header_include << "\"\n\n";
+        out << "#include <regex>\n#include <string>\n#include <unordered_set>\n";
+        out << "#include <ps/json.h>\n\n";
+        out << "namespace " << options_.ns << " {\n\nnamespace {\n\n";
+
+        out << "const char kSchemaJson[] =\n";
+        std::vector<std::string> pieces = cpp_escaped(json_text(root_));
+        std::string chunk;
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            chunk += pieces[i];
+            if (chunk.size() >= 88 || i + 1 == pieces.size()) {
+                out << "            \"" << chunk << "\"" << (i + 1 == pieces.size() ? ";" : "")
+                    << "\n";
+                chunk.clear();
+            }
+        }
+        if (pieces.empty()) out << "            \"\";\n";
+
+        out << R"(
+struct PtrHash {
+    size_t operator()(const ps::Dictionary* d) const { return d->hash(); }
+};
+struct PtrEqual {
+    bool operator()(const ps::Dictionary* a, const ps::Dictionary* b) const {
+        return a->structurallyEquals(*b);
+    }
+};
+
+[[maybe_unused]] bool has_duplicates(const ps::Dictionary& d) {
+    std::unordered_set<const ps::Dictionary*, PtrHash, PtrEqual> seen;
+    for (const auto& element : d.elements()) {
+        if (!seen.insert(&element.second).second) return true;
+    }
+    return false;
+}
+
+[[maybe_unused]] bool matches_any(const ps::Dictionary& values, const ps::Dictionary& d) {
+    for (const auto& element : values.elements()) {
+        if (element.second.structurallyEquals(d)) return true;
+    }
+    return false;
+}
+)";
+
+        for (size_t i = 0; i < literals_.size(); ++i) {
+            out << "\nconst ps::Dictionary& literal_" << i << "() {\n";
+            out << "    static const ps::Dictionary value =\n";
+            out << "            ps::parse_json(" << cpp_literal("{\"v\":" + literals_[i] + "}")
+                << ").at(\"v\");\n";
+            out << "    return value;\n}\n";
+        }
+        for (size_t i = 0; i < patterns_.size(); ++i) {
+            out << "\nconst std::regex& regex_" << i << "() {\n";
+            out << "    static const std::regex rx(" << cpp_literal(patterns_[i]) << ");\n";
+            out << "    return rx;\n}\n";
+        }
+        for (size_t i = 0; i < string_sets_.size(); ++i) {
+            std::map<size_t, std::vector<std::string>> by_length;
+            for (const auto& v : string_sets_[i]) by_length[v.size()].push_back(v);
+            out << "\nbool in_set_" << i << "(const std::string& s) {\n";
+            out << "    switch (s.size()) {\n";
+            for (const auto& [length, values] : by_length) {
+                out << "        case " << length << ":\n";
+                out << "            return ";
+                for (size_t k = 0; k < values.size(); ++k) {
+                    if (k > 0) out << " ||\n                   ";
+                    out << "s == " << cpp_literal(values[k]);
+                }
+                out << ";\n";
+            }
+            out << "        default:\n            return false;\n    }\n}\n";
+        }
+
+        out << "\n";
+        for (size_t i = 0; i < nodes_.size(); ++i)
+            out << "bool check_" << i << "(const ps::Dictionary& d);\n";
+        out << functions_.str();
+        out << "\n}  // namespace\n\n";
+
+        out << "const ps::Dictionary& " << name << "_schema() {\n";
+        out << "    static const ps::Dictionary schema = ps::parse_json(kSchemaJson);\n";
+        out << "    return schema;\n}\n\n";
+        out << "bool " << name << "_passes(const ps::Dictionary& data) {\n";
+        out << "    return check_0(data);\n}\n\n";
+        out << "ps::ValidationResult " << name << "(const ps::Dictionary& data,\n";
+        out << std::string(name.size() + 22, ' ') << "const std::string& raw_content,\n";
+        out << std::string(name.size() + 22, ' ') << "const ps::ValidationOptions& options) {\n";
+        out << "    if (!options.profile && check_0(data)) return ps::ValidationResult{};\n";
+        out << "    return ps::validate_all(data, " << name
+            << "_schema(), raw_content, options);\n}\n\n";
+        out << "}  // namespace " << options_.ns << "\n";
+        return out.str();
+    }
+
+    const Dictionary& root_;
+    const CodegenOptions& options_;
+    Dictionary wrapper_;  // root of the bare-properties convenience form
+    std::map<const Dictionary*, int> ids_;
+    std::vector<const Dictionary*> nodes_;
+    std::vector<std::string> literals_;  // JSON text of enum and const values
+    std::vector<std::string> patterns_;
+    std::vector<std::vector<std::string>> string_sets_;
+    Lines functions_;
+};
+
+std::string header_text(const CodegenOptions& options) {
+    const std::string& name = options.name;
+    std::ostringstream out;
+    out << "// Generated by parsec-codegen from " << comment_text(options.source_label)
+        << ". Do not edit.\n";
+    out << "#pragma once\n\n#include <string>\n";
+    out << "#include <ps/dictionary.h>\n#include <ps/validate.h>\n\n";
+    out << "namespace " << options.ns << " {\n\n";
+    out << "// The schema this validator was generated from\n";
+    out << "const ps::Dictionary& " << name << "_schema();\n\n";
+    out << "// True if `data` passes without any error, warning or deprecation\n";
+    out << "bool " << name << "_passes(const ps::Dictionary& data);\n\n";
+    out << "// Same result as ps::validate_all(data, " << name
+        << "_schema(), raw_content, options)\n";
+    out << "ps::ValidationResult " << name << "(const ps::Dictionary& data,\n";
+    out << std::string(name.size() + 22, ' ') << "const std::string& raw_content = \"\",\n";
+    out << std::string(name.size() + 22, ' ') << "const ps::ValidationOptions& options = {});\n\n";
+    out << "}  // namespace " << options.ns << "\n";
+    return out.str();
+}
+
+}  // namespace
+
+GeneratedValidator generate_validator(const Dictionary& schema, const CodegenOptions& options) {
+    // Generate from the schema exactly as the embedded copy will parse, so the
+    // compiled checks and the validate_all() fallback see the same values.
+    const Dictionary embedded = parse_json(json_text(schema));
+    Generator generator(embedded, options);
+    GeneratedValidator out;
+    out.source = generator.source();
+    out.header = header_text(options);
+    return out;
+}
+
+}  // namespace ps
@@ -0,0 +1,78 @@
+// parsec-codegen - compile a JSON schema into a C++ validator
+//
+//   parsec-codegen [--name NAME] [--namespace NS] <schema.json> <out.h> <out.cpp>
+//
+// Usually run through the parsec_add_validator() CMake function.
+
+#include <ps/codegen.h>
+#include <ps/schema_registry.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const char* usage =
+            "usage: parsec-codegen [--name NAME] [--namespace NS] <schema.json> <out.h> <out.cpp>\n";
+
+// Leave files that did not change alone, so regenerating does not force a rebuild
+static bool write_if_changed(const std::string& path, const std::string& text) {
+    std::ifstream in(path, std::ios::binary);
+    if (in) {
+        std::string old((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (old == text) return true;
+    }
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+    return static_cast<bool>(out);
+}
+
+int main(int argc, char** argv) {
+    ps::CodegenOptions options;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "--name" || arg == "--namespace") && i + 1 < argc) {
+            (arg == "--name" ? options.name : options.ns) = argv[++i];
+        } else if (arg == "-h" || arg == "--help") {
+            std::cout << usage;
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown argument: " << arg << "\n" << usage;
+            return 2;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 3) {
+        std::cerr << usage;
+        return 2;
+    }
+    const std::string& schema_path = positional[0];
+    const std::string& header_path = positional[1];
+    const std::string& source_path = positional[2];
+
+    options.header_include = fs::path(header_path).filename().string();
+    options.source_label = fs::path(schema_path).filename().string();
+
+    ps::GeneratedValidator generated;
+    try {
+        // $refs into other schema files are bundled, as for parsec --validate
+        ps::SchemaRegistry registry;
+        generated = ps::generate_validator(*registry.resolve(schema_path), options);
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 2;
+    }
+
+    if (!write_if_changed(header_path, generated.header) ||
+        !write_if_changed(source_path, generated.source)) {
+        std::cerr << "error: cannot write " << header_path << " / " << source_path << "\n";
+        return 2;
+    }
+    return 0;
+}
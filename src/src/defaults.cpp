@@ -1,9 +1,12 @@
-#include "ps/validate.h"
+#include "ps/defaults.h"
 
-namespace ps {
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 
-// Helper: deep-copy a Dictionary (copy constructor performs deep copy)
-static Dictionary clone_value(const Dictionary& v) { return v; }
+namespace ps {
 
 // Resolve a local JSON Pointer-style $ref (only supports local refs starting with "#/")
 static const Dictionary* resolve_local_ref(const Dictionary& root, const std::string& ref) {
@@ -31,303 +34,422 @@ static const Dictionary* resolve_local_ref(const Dictionary& root, const std::st
     return cur;
 }
 
-// Recursively apply defaults from schema_node into target (which may be a dict or scalar)
-static Dictionary apply_defaults_to_value(const Dictionary& dataVal,
-                                          const Dictionary& schema_root,
-                                          const Dictionary& schema_node);
-
-static Dictionary apply_defaults_to_object(const Dictionary& input,
-                                           const Dictionary& schema_root,
-                                           const Dictionary& schema_node) {
-    Dictionary out = input;  // copy existing
-
-    // Handle allOf: recursively apply defaults from each schema in the array
-    if (schema_node.has("allOf") && schema_node.at("allOf").isArrayObject()) {
-        const Dictionary& allOfArray = schema_node.at("allOf");
-        for (int i = 0; i < allOfArray.size(); ++i) {
-            const Dictionary* subSchema = &allOfArray[i];
-
-            // Resolve $ref if present
-            if (subSchema->has("$ref") && subSchema->at("$ref").type() == Dictionary::String) {
-                const std::string ref = subSchema->at("$ref").asString();
-                subSchema = resolve_local_ref(schema_root, ref);
-                if (!subSchema) continue;
-            }
+namespace {
+
+// Records applyDefaults() changes when the caller asked for them. The path of
+// the value being filled is only maintained while recording.
+class EditLog {
+public:
+    explicit EditLog(std::vector<DefaultEdit>* edits) : edits_(edits) {}
+
+    bool active() const { return edits_ != nullptr; }
 
-            // Recursively apply defaults from this sub-schema
-            out = apply_defaults_to_object(out, schema_root, *subSchema);
+    void added(const std::string& key) {
+        if (edits_) edits_->push_back({child(key), std::nullopt});
+    }
+    void replaced(const Dictionary& previous) {
+        if (edits_) edits_->push_back({path_, previous});
+    }
+
+    // Moves the current path to a child for the lifetime of the scope
+    class Scope {
+    public:
+        Scope(EditLog& log, const std::string& key) : log_(log), size_(log.path_.size()) {
+            if (log_.active()) log_.path_ = log_.child(key);
         }
-        return out;
+        Scope(EditLog& log, int index) : log_(log), size_(log.path_.size()) {
+            if (log_.active()) log_.path_ += "[" + std::to_string(index) + "]";
+        }
+        ~Scope() { log_.path_.resize(size_); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        EditLog& log_;
+        size_t size_;
+    };
+
+private:
+    std::string child(const std::string& key) const {
+        return path_.empty() ? key : path_ + "." + key;
     }
 
-    // properties
-    const Dictionary* props = nullptr;
-    if (schema_node.has("properties") && schema_node.at("properties").isMappedObject())
-        props = &schema_node.at("properties");
-
-    if (props) {
-        for (auto const& p : props->items()) {
-            const std::string& k = p.first;
-            const Dictionary& propSchemaVal = p.second;
-
-            // Resolve $ref if present, but keep track of original for default value
-            const Dictionary* propSchema = nullptr;
-            const Dictionary* propSchemaForDefault = &propSchemaVal;  // May have 'default' key
-            if (propSchemaVal.isMappedObject()) {
-                if (propSchemaVal.has("$ref") &&
-                    propSchemaVal.at("$ref").type() == Dictionary::String) {
-                    const std::string ref = propSchemaVal.at("$ref").asString();
-                    propSchema = resolve_local_ref(schema_root, ref);
-                } else {
-                    propSchema = &propSchemaVal;
-                }
-            }
+    std::vector<DefaultEdit>* edits_;
+    std::string path_;
+};
+
+}  // namespace
+
+// The compiled form of a schema's defaults. A value plan mirrors what filling
+// defaults into a value does for one (resolved) schema node, an object plan
+// what filling the members of an object does.
+struct DefaultsSkeleton::Plans {
+    // anyOf / oneOf: the alternative picked by the data's "type" member, or
+    // else the first one
+    struct Alternatives {
+        bool present = false;  // the keyword holds an array
+        std::unordered_map<std::string, int> by_type;
+        int first = -1;
+    };
+
+    struct Value {
+        std::optional<Dictionary> null_default;  // replaces an explicit null
+        int object = -1;                         // object schema: plan for the members
+        bool array = false;                      // "type": "array"
+        std::optional<Dictionary> array_default;  // replaces a value that is not an array
+        int items = -1;                          // plan for each item
+        Alternatives any_of;
+        Alternatives one_of;
+    };
+
+    struct Property {
+        std::string key;
+        std::optional<Dictionary> fill;  // inserted when the key is missing
+        int object = -1;                 // plans for a value that is present
+        int value = -1;
+        int nested = -1;  // object plan that builds `fill` for an object-typed property
+    };
+
+    struct Object {
+        bool has_all_of = false;
+        std::vector<int> all_of;  // only these apply when has_all_of
+        std::vector<Property> properties;
+        std::unordered_set<std::string> covered;  // every key under "properties"
+        int additional_object = -1;
+        int additional_value = -1;
+    };
+
+    // Deques, so that adding a plan while compiling never copies the others
+    std::deque<Value> values;
+    std::deque<Object> objects;
+    int root_object = -1;
+    std::optional<Dictionary> root_default;
+};
+
+using Plans = DefaultsSkeleton::Plans;
+
+static void fill_value(const Plans& plans, int id, Dictionary& value, EditLog& log);
+
+static void fill_object(const Plans& plans, int id, Dictionary& out, EditLog& log) {
+    const Plans::Object& plan = plans.objects[static_cast<size_t>(id)];
+    if (plan.has_all_of) {
+        for (int branch : plan.all_of) fill_object(plans, branch, out, log);
+        return;
+    }
 
-            // If key present in input, recursively apply defaults into it
-            if (out.has(k)) {
-                if (propSchema) {
-                    if (out[k].isMappedObject()) {
-                        Dictionary nested = out[k];
-                        Dictionary nested_with =
-                                    apply_defaults_to_object(nested, schema_root, *propSchema);
-                        out[k] = nested_with;
-                    } else {
-                        Dictionary existing = out[k];
-                        Dictionary withDefaults =
-                                    apply_defaults_to_value(existing, schema_root, *propSchema);
-                        out[k] = withDefaults;
-                    }
-                }
-            } else {
-                // Not present: check for default in the original schema (before $ref resolution)
-                // or in the resolved schema
-                if (propSchemaForDefault->has("default")) {
-                    out[k] = clone_value(propSchemaForDefault->at("default"));
-                } else if (propSchema && propSchema->has("default")) {
-                    out[k] = clone_value(propSchema->at("default"));
-                } else if (propSchema && propSchema->has("type") &&
-                           propSchema->at("type").type() == Dictionary::String &&
-                           propSchema->at("type").asString() == "object") {
-                    // If nested object may have defaults inside, create an empty object and apply
-                    // nested defaults
-                    Dictionary empty;
-                    Dictionary nested = apply_defaults_to_object(empty, schema_root, *propSchema);
-                    if (!nested.empty()) out[k] = nested;
-                }
+    for (const auto& prop : plan.properties) {
+        if (out.has(prop.key)) {
+            if (prop.object >= 0) {
+                EditLog::Scope scope(log, prop.key);
+                Dictionary& existing = out[prop.key];
+                if (existing.isMappedObject())
+                    fill_object(plans, prop.object, existing, log);
+                else
+                    fill_value(plans, prop.value, existing, log);
             }
+        } else if (prop.fill) {
+            out[prop.key] = *prop.fill;
+            log.added(prop.key);
         }
     }
 
-    // additionalProperties: if schema object with default, and keys in input not covered by
-    // properties, ensure defaults applied
-    const Dictionary* addSchema = nullptr;
-    if (schema_node.has("additionalProperties") &&
-        schema_node.at("additionalProperties").isMappedObject())
-        addSchema = &schema_node.at("additionalProperties");
-
-    if (addSchema) {
-        for (auto const& pd : out.items()) {
-            const std::string& k = pd.first;
-            if (props && props->has(k)) continue;  // covered by properties
-            // apply defaults into this additional property
-            if (pd.second.isMappedObject()) {
-                Dictionary nested = pd.second;
-                Dictionary nested_with = apply_defaults_to_object(nested, schema_root, *addSchema);
-                out[k] = nested_with;
-            } else {
-                Dictionary existing = pd.second;
-                Dictionary withDefaults =
-                            apply_defaults_to_value(existing, schema_root, *addSchema);
-                out[k] = withDefaults;
-            }
+    if (plan.additional_object >= 0) {
+        for (const auto& k : out.keys()) {
+            if (plan.covered.count(k)) continue;
+            EditLog::Scope scope(log, k);
+            Dictionary& existing = out[k];
+            if (existing.isMappedObject())
+                fill_object(plans, plan.additional_object, existing, log);
+            else
+                fill_value(plans, plan.additional_value, existing, log);
         }
     }
+}
 
-    return out;
+// Follow anyOf/oneOf to the alternative whose defaults apply; false if there is none
+static bool fill_alternative(const Plans& plans,
+                             const Plans::Alternatives& alternatives,
+                             Dictionary& value,
+                             EditLog& log) {
+    if (!alternatives.present) return false;
+    if (value.isMappedObject() && value.has("type")) {
+        auto it = alternatives.by_type.find(value.at("type").asString());
+        if (it != alternatives.by_type.end()) {
+            fill_value(plans, it->second, value, log);
+            return true;
+        }
+    }
+    if (alternatives.first < 0) return false;
+    fill_value(plans, alternatives.first, value, log);
+    return true;
 }
 
-static Dictionary apply_defaults_to_value(const Dictionary& dataVal,
-                                          const Dictionary& schema_root,
-                                          const Dictionary& schema_node) {
-    // Resolve $ref if present
-    const Dictionary* actual_schema = &schema_node;
-    if (schema_node.has("$ref") && schema_node.at("$ref").type() == Dictionary::String) {
-        const std::string ref = schema_node.at("$ref").asString();
-        const Dictionary* resolved = resolve_local_ref(schema_root, ref);
-        if (resolved) {
-            actual_schema = resolved;
+static void fill_value(const Plans& plans, int id, Dictionary& value, EditLog& log) {
+    const Plans::Value& plan = plans.values[static_cast<size_t>(id)];
+
+    // Only an explicit null counts as missing; other user values are kept
+    if (plan.null_default && value.type() == Dictionary::Null) {
+        log.replaced(value);
+        value = *plan.null_default;
+        return;
+    }
+
+    if (plan.object >= 0) {
+        // A value that is not an object is replaced by one holding the defaults
+        if (!value.isMappedObject()) {
+            log.replaced(value);
+            value = Dictionary();
         }
+        fill_object(plans, plan.object, value, log);
+        return;
     }
 
-    // If schema_node has a 'default' and dataVal is explicitly null, return default.
-    // Do NOT treat scalar values (int/string/bool) as "missing" — those are user
-    // provided values and must be preserved. Only apply the schema default when
-    // the provided value is actually null/absent.
-    if (dataVal.type() == Dictionary::Null) {
-        if (actual_schema->has("default")) return clone_value(actual_schema->at("default"));
+    if (plan.array) {
+        if (!value.isArrayObject()) {
+            if (plan.array_default) {
+                log.replaced(value);
+                value = *plan.array_default;
+                return;
+            }
+        } else if (plan.items >= 0) {
+            for (int i = 0; i < value.size(); ++i) {
+                EditLog::Scope scope(log, i);
+                fill_value(plans, plan.items, value.at(i), log);
+            }
+            return;
+        }
     }
 
-    // If schema type is object, recurse
-    // Also treat schemas with "properties" as object schemas even without explicit type
-    bool isObjectSchema = false;
-    if (actual_schema->has("type") && actual_schema->at("type").type() == Dictionary::String &&
-        actual_schema->at("type").asString() == "object") {
-        isObjectSchema = true;
+    if (fill_alternative(plans, plan.any_of, value, log)) return;
+    fill_alternative(plans, plan.one_of, value, log);
+}
+
+namespace {
+
+// Builds the plans of DefaultsSkeleton, one per schema node reached from the
+// root. Nodes are keyed by address, so a $ref cycle reuses its plan.
+class SkeletonCompiler {
+public:
+    explicit SkeletonCompiler(const Dictionary& root) : root_(root) {}
+
+    Plans compile() {
+        // Resolve root-level $ref if present
+        const Dictionary* effective = resolve(root_);
+
+        // Top-level: an object schema (type object, or properties without a
+        // type) fills members; otherwise a default replaces a scalar document
+        if (is_string(*effective, "type", "object") || effective->has("properties")) {
+            plans_.root_object = object_plan(*effective);
+        } else if (effective->has("default")) {
+            plans_.root_default = effective->at("default");
+        }
+
+        // Objects inserted for missing object-typed properties, built once
+        state_.assign(plans_.objects.size(), UNBUILT);
+        for (size_t i = 0; i < plans_.objects.size(); ++i) build_fills(static_cast<int>(i));
+        return std::move(plans_);
     }
-    if (actual_schema->has("properties")) {
-        isObjectSchema = true;
+
+private:
+    static bool is_string(const Dictionary& node, const char* key, const char* value) {
+        return node.has(key) && node.at(key).type() == Dictionary::String &&
+               node.at(key).asStringRef() == value;
     }
-    
-    if (isObjectSchema) {
-        Dictionary inObj;
-        if (dataVal.isMappedObject()) inObj = dataVal;
-        Dictionary outObj = apply_defaults_to_object(inObj, schema_root, *actual_schema);
-        return outObj;
+
+    // `node` itself, or the target of its local $ref when that resolves
+    const Dictionary* resolve(const Dictionary& node) const {
+        if (node.has("$ref") && node.at("$ref").type() == Dictionary::String) {
+            if (const Dictionary* target =
+                        resolve_local_ref(root_, node.at("$ref").asStringRef()))
+                return target;
+        }
+        return &node;
     }
 
-    // If type is array
-    if (actual_schema->has("type") && actual_schema->at("type").type() == Dictionary::String &&
-        actual_schema->at("type").asString() == "array") {
-        if (!dataVal.isArrayObject()) {
-            if (actual_schema->has("default")) return clone_value(actual_schema->at("default"));
+    int value_plan(const Dictionary& node) {
+        const Dictionary* actual = resolve(node);
+        auto found = value_ids_.find(actual);
+        if (found != value_ids_.end()) return found->second;
+        int id = static_cast<int>(plans_.values.size());
+        value_ids_.emplace(actual, id);
+        plans_.values.emplace_back();
+
+        Plans::Value plan;
+        if (actual->has("default")) plan.null_default = actual->at("default");
+        if (is_string(*actual, "type", "object") || actual->has("properties")) {
+            plan.object = object_plan(*actual);
         } else {
-            if (actual_schema->has("items") && actual_schema->at("items").isMappedObject() &&
-                dataVal.isArrayObject()) {
-                const Dictionary* itemSchema = &actual_schema->at("items");
-                std::vector<Dictionary> outList;
-                for (int i = 0; i < dataVal.size(); ++i) {
-                    const Dictionary& el = dataVal[i];
-                    outList.push_back(apply_defaults_to_value(el, schema_root, *itemSchema));
-                }
-                Dictionary arr;
-                arr = outList;
-                return arr;
+            if (is_string(*actual, "type", "array")) {
+                plan.array = true;
+                if (actual->has("default")) plan.array_default = actual->at("default");
+                if (actual->has("items") && actual->at("items").isMappedObject())
+                    plan.items = value_plan(actual->at("items"));
             }
+            plan.any_of = alternatives(*actual, "anyOf");
+            plan.one_of = alternatives(*actual, "oneOf");
         }
+        plans_.values[static_cast<size_t>(id)] = std::move(plan);
+        return id;
+    }
+
+    Plans::Alternatives alternatives(const Dictionary& node, const char* keyword) {
+        Plans::Alternatives out;
+        if (!node.has(keyword) || !node.at(keyword).isArrayObject()) return out;
+        out.present = true;
+        const Dictionary& options = node.at(keyword);
+        for (const auto& element : options.elements()) {
+            const Dictionary* alt = &element.second;
+            if (alt->has("$ref") && alt->at("$ref").type() == Dictionary::String) {
+                alt = resolve_local_ref(root_, alt->at("$ref").asStringRef());
+                if (!alt) continue;
+            }
+            // An alternative is picked by the values of its "type" property enum;
+            // the first alternative listing a value wins
+            if (!alt->has("properties") || !alt->at("properties").has("type")) continue;
+            const Dictionary& typeProp = alt->at("properties").at("type");
+            if (!typeProp.has("enum") || !typeProp.at("enum").isArrayObject()) continue;
+            for (const auto& option : typeProp.at("enum").elements()) {
+                if (option.second.type() != Dictionary::String) continue;
+                const std::string& name = option.second.asStringRef();
+                if (!out.by_type.count(name)) out.by_type.emplace(name, value_plan(*alt));
+            }
+        }
+        if (options.size() > 0) out.first = value_plan(options[0]);
+        return out;
     }
 
-    // Handle anyOf: try each alternative and apply defaults from the first matching schema
-    // We determine a match by checking if the data is an object with a "type" field that
-    // matches one of the alternatives, or by trying to apply and checking for consistency.
-    if (actual_schema->has("anyOf") && actual_schema->at("anyOf").isArrayObject()) {
-        const Dictionary& anyOfArray = actual_schema->at("anyOf");
-
-        // If dataVal is an object with a "type" field, try to find matching schema
-        if (dataVal.isMappedObject() && dataVal.has("type")) {
-            std::string dataType = dataVal.at("type").asString();
-
-            // Try each alternative to find one with matching type enum
-            for (int i = 0; i < anyOfArray.size(); ++i) {
-                const Dictionary* altSchema = &anyOfArray[i];
-
-                // Resolve $ref if present
-                if (altSchema->has("$ref") && altSchema->at("$ref").type() == Dictionary::String) {
-                    const std::string ref = altSchema->at("$ref").asString();
-                    altSchema = resolve_local_ref(schema_root, ref);
-                    if (!altSchema) continue;
+    int object_plan(const Dictionary& node) {
+        auto found = object_ids_.find(&node);
+        if (found != object_ids_.end()) return found->second;
+        int id = static_cast<int>(plans_.objects.size());
+        object_ids_.emplace(&node, id);
+        plans_.objects.emplace_back();
+
+        Plans::Object plan;
+        if (node.has("allOf") && node.at("allOf").isArrayObject()) {
+            plan.has_all_of = true;
+            for (const auto& element : node.at("allOf").elements()) {
+                const Dictionary* sub = &element.second;
+                if (sub->has("$ref") && sub->at("$ref").type() == Dictionary::String) {
+                    sub = resolve_local_ref(root_, sub->at("$ref").asStringRef());
+                    if (!sub) continue;
                 }
+                plan.all_of.push_back(object_plan(*sub));
+            }
+            plans_.objects[static_cast<size_t>(id)] = std::move(plan);
+            return id;
+        }
 
-                // Check if this alternative has type enum matching our data
-                if (altSchema->has("properties") && altSchema->at("properties").has("type")) {
-                    const Dictionary& typeProp = altSchema->at("properties").at("type");
-                    if (typeProp.has("enum") && typeProp.at("enum").isArrayObject()) {
-                        const Dictionary& enumArray = typeProp.at("enum");
-                        for (int j = 0; j < enumArray.size(); ++j) {
-                            if (enumArray[j].type() == Dictionary::String &&
-                                enumArray[j].asString() == dataType) {
-                                // Found matching schema - apply defaults from it
-                                return apply_defaults_to_value(dataVal, schema_root, *altSchema);
-                            }
-                        }
-                    }
+        if (node.has("properties") && node.at("properties").isMappedObject()) {
+            plan.properties.reserve(node.at("properties").members().size());
+            for (const auto& [key, propSchemaVal] : node.at("properties").members()) {
+                plan.covered.insert(key);
+                Plans::Property prop;
+                prop.key = key;
+                // Resolve $ref, but a default next to the $ref takes precedence
+                const Dictionary* propSchema = nullptr;
+                if (propSchemaVal.isMappedObject()) {
+                    const bool is_ref = propSchemaVal.has("$ref") &&
+                                        propSchemaVal.at("$ref").type() == Dictionary::String;
+                    propSchema = is_ref ? resolve_local_ref(root_,
+                                                            propSchemaVal.at("$ref").asStringRef())
+                                        : &propSchemaVal;
                 }
+                if (propSchema) {
+                    prop.object = object_plan(*propSchema);
+                    prop.value = value_plan(*propSchema);
+                }
+                if (propSchemaVal.has("default")) {
+                    prop.fill = propSchemaVal.at("default");
+                } else if (propSchema && propSchema->has("default")) {
+                    prop.fill = propSchema->at("default");
+                } else if (propSchema && is_string(*propSchema, "type", "object")) {
+                    prop.nested = prop.object;
+                }
+                if (prop.object >= 0 || prop.fill || prop.nested >= 0)
+                    plan.properties.push_back(std::move(prop));
             }
         }
 
-        // If no type-based match, just try the first alternative
-        if (anyOfArray.size() > 0) {
-            return apply_defaults_to_value(dataVal, schema_root, anyOfArray[0]);
+        if (node.has("additionalProperties") &&
+            node.at("additionalProperties").isMappedObject()) {
+            const Dictionary& additional = node.at("additionalProperties");
+            plan.additional_object = object_plan(additional);
+            plan.additional_value = value_plan(additional);
         }
+        plans_.objects[static_cast<size_t>(id)] = std::move(plan);
+        return id;
     }
 
-    // Handle oneOf similarly to anyOf
-    if (actual_schema->has("oneOf") && actual_schema->at("oneOf").isArrayObject()) {
-        const Dictionary& oneOfArray = actual_schema->at("oneOf");
-
-        if (dataVal.isMappedObject() && dataVal.has("type")) {
-            std::string dataType = dataVal.at("type").asString();
+    // Build `fill` for the object-typed properties of object plan `id` by
+    // filling an empty object, after the plans that filling reaches
+    void build_fills(int id) {
+        auto& state = state_[static_cast<size_t>(id)];
+        if (state == BUILT) return;
+        if (state == BUILDING)
+            throw std::runtime_error("schema defaults for an object contain that object again");
+        state = BUILDING;
+        Plans::Object& plan = plans_.objects[static_cast<size_t>(id)];
+        for (int branch : plan.all_of) build_fills(branch);
+        for (auto& prop : plan.properties) {
+            if (prop.nested < 0) continue;
+            build_fills(prop.nested);
+            Dictionary nested;
+            EditLog quiet(nullptr);
+            fill_object(plans_, prop.nested, nested, quiet);
+            if (!nested.empty()) prop.fill = std::move(nested);
+        }
+        state_[static_cast<size_t>(id)] = BUILT;
+    }
 
-            for (int i = 0; i < oneOfArray.size(); ++i) {
-                const Dictionary* altSchema = &oneOfArray[i];
+    enum State { UNBUILT, BUILDING, BUILT };
 
-                if (altSchema->has("$ref") && altSchema->at("$ref").type() == Dictionary::String) {
-                    const std::string ref = altSchema->at("$ref").asString();
-                    altSchema = resolve_local_ref(schema_root, ref);
-                    if (!altSchema) continue;
-                }
+    const Dictionary& root_;
+    Plans plans_;
+    std::unordered_map<const Dictionary*, int> value_ids_;
+    std::unordered_map<const Dictionary*, int> object_ids_;
+    std::vector<State> state_;
+};
 
-                if (altSchema->has("properties") && altSchema->at("properties").has("type")) {
-                    const Dictionary& typeProp = altSchema->at("properties").at("type");
-                    if (typeProp.has("enum") && typeProp.at("enum").isArrayObject()) {
-                        const Dictionary& enumArray = typeProp.at("enum");
-                        for (int j = 0; j < enumArray.size(); ++j) {
-                            if (enumArray[j].type() == Dictionary::String &&
-                                enumArray[j].asString() == dataType) {
-                                return apply_defaults_to_value(dataVal, schema_root, *altSchema);
-                            }
-                        }
-                    }
-                }
-            }
-        }
+}  // namespace
 
-        if (oneOfArray.size() > 0) {
-            return apply_defaults_to_value(dataVal, schema_root, oneOfArray[0]);
-        }
-    }
+DefaultsSkeleton::DefaultsSkeleton(const Dictionary& schema)
+    : plans_(std::make_shared<const Plans>(SkeletonCompiler(schema).compile())) {}
 
-    // Otherwise return dataVal unchanged
-    return dataVal;
-}
+size_t DefaultsSkeleton::size() const { return plans_->values.size() + plans_->objects.size(); }
 
-Dictionary setDefaults(const Dictionary& data, const Dictionary& schema) {
-    // Use schema as root for $ref resolution in future work; for now pass schema through
-
-    // Resolve root-level $ref if present
-    const Dictionary* effectiveSchema = &schema;
-    if (schema.has("$ref") && schema.at("$ref").type() == Dictionary::String) {
-        const Dictionary* resolved = resolve_local_ref(schema, schema.at("$ref").asString());
-        if (resolved) {
-            effectiveSchema = resolved;
+void DefaultsSkeleton::apply(Dictionary& data, std::vector<DefaultEdit>* edits) const {
+    EditLog log(edits);
+    if (plans_->root_object >= 0) {
+        if (!data.isMappedObject()) {
+            log.replaced(data);
+            data = Dictionary();
         }
+        fill_object(*plans_, plans_->root_object, data, log);
+        return;
     }
 
-    // Top-level: if schema declares type object OR has properties (implying object type),
-    // apply object defaults; otherwise if default exists, use it
-    bool isObjectSchema = false;
-    if (effectiveSchema->has("type") && effectiveSchema->at("type").type() == Dictionary::String &&
-        effectiveSchema->at("type").asString() == "object") {
-        isObjectSchema = true;
-    }
-    // Also treat schemas with "properties" as object schemas even without explicit type
-    if (effectiveSchema->has("properties")) {
-        isObjectSchema = true;
-    }
-    
-    if (isObjectSchema) {
-        Dictionary inObj;
-        if (data.isMappedObject()) inObj = data;
-        Dictionary outObj = apply_defaults_to_object(inObj, schema, *effectiveSchema);
-        return outObj;
+    // If schema has a top-level default and data is not object/array, use the default
+    if (plans_->root_default && !data.isMappedObject() && !data.isArrayObject()) {
+        log.replaced(data);
+        data = *plans_->root_default;
     }
+}
 
-    // If schema has a top-level default and data is not object/array, return default
-    if ((!data.isMappedObject() && !data.isArrayObject()) && effectiveSchema->has("default")) {
-        return clone_value(effectiveSchema->at("default"));
-    }
+Dictionary DefaultsSkeleton::applied(const Dictionary& data) const {
+    Dictionary out = data;
+    apply(out);
+    return out;
+}
 
-    // Otherwise return the input dictionary unchanged
-    return data;
+void applyDefaults(Dictionary& data, const Dictionary& schema, std::vector<DefaultEdit>* edits) {
+    DefaultsSkeleton(schema).apply(data, edits);
+}
+
+Dictionary setDefaults(const Dictionary& data, const Dictionary& schema) {
+    Dictionary out = data;
+    applyDefaults(out, schema);
+    return out;
 }
 
 }  // namespace ps
@@ -385,8 +385,7 @@ namespace {
             // push opener for diagnostics
             opener_stack.push_back(Opener{'[', line, col});
             std::vector<Dictionary> out_values;
-            bool allInt = true, allDouble = true, allString = true, allBool = true,
-                 allObject = true;
+            bool allInt = true, allDouble = true, allString = true, allBool = true;
             skip_ws();
             if (peek() == ']') {
                 get();
@@ -396,43 +395,31 @@ namespace {
                 return res;
             }
             while (true) {
-                Dictionary v = parse_value();
-                out_values.emplace_back(v);
+                out_values.emplace_back(parse_value());
                 // detect homogeneous primitive lists
-                switch (v.type()) {
+                switch (out_values.back().type()) {
                     case Dictionary::Integer:
                         allDouble = false;
                         allString = false;
                         allBool = false;
-                        allObject = false;
                         break;
                     case Dictionary::Double:
                         allInt = false;
                         allString = false;
                         allBool = false;
-                        allObject = false;
                         break;
                     case Dictionary::String:
                         allInt = false;
                         allDouble = false;
                         allBool = false;
-                        allObject = false;
                         break;
                     case Dictionary::Boolean:
                         allInt = false;
                         allDouble = false;
                         allString = false;
-                        allObject = false;
-                        break;
-                    case Dictionary::Object:
-                        allInt = false;
-                        allDouble = false;
-                        allString = false;
-                        allBool = false;
                         break;
                     default:
                         allInt = allDouble = allString = allBool = false;
-                        allObject = false;
                         break;
                 }
                 skip_ws();
@@ -501,13 +488,8 @@ namespace {
                 res = bv;
                 return res;
             }
-            if (allObject) {
-                std::vector<Dictionary> ov = out_values;
-                res = ov;
-                return res;
-            }
-            // default: return as object array of heterogeneous Dictionaries
-            res = out_values;
+            // all objects, or heterogeneous Dictionaries: return as object array
+            res = std::move(out_values);
             return res;
         }
 
@@ -581,7 +563,7 @@ namespace {
                                 std::string("duplicate key '") + k.asString() + "'", line, col);
                     throw JsonParseError(msg, line, col);
                 }
-                d[k.asString()] = v;
+                d[k.asString()] = std::move(v);
                 skip_ws();
                 char c = peek();
                 if (c == '}') {
@@ -8,8 +8,17 @@
 #include <ps/yaml.h>
 #include <ps/parse.h>
 #include <ps/validate.h>
+#include <ps/defaults.h>
+#include <ps/schema_registry.h>
 #include <ps/cli_utils.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
 
 // The real `ps::validate` implementation is provided in `validate.cpp`.
 // Do not provide a local stub here so the CLI calls the library implementation.
@@ -43,7 +52,8 @@ void print_help() {
     std::cout << "parsec - Parse and validate JSON/RON/TOML/INI/YAML configuration files\n\n";
     std::cout << "USAGE:\n";
     std::cout << "  parsec [--json|--ron|--toml|--ini|--yaml] <file>\n";
-    std::cout << "  parsec --validate [--no-defaults] <schema.json> <file>\n";
+    std::cout << "  parsec --validate [--no-defaults] [--jobs N] [--profile] <schema.json> "
+                 "<file>... [@filelist]\n";
     std::cout << "  parsec --fill-defaults <schema.json> <input> <output>\n";
     std::cout << "  parsec --convert <yaml|json|ron|toml> <input> [output]\n\n";
     std::cout << "OPTIONS:\n";
@@ -52,6 +62,8 @@ void print_help() {
     std::cout << "  --json/ron/toml/ini/yaml  Force specific parser\n";
     std::cout << "  --validate       Validate against JSON schema\n";
     std::cout << "  --no-defaults    Skip applying schema defaults (with --validate)\n";
+    std::cout << "  --jobs, -j N     Validate files with N worker threads (with --validate)\n";
+    std::cout << "  --profile        Report time spent per schema keyword (with --validate)\n";
     std::cout << "  --fill-defaults  Apply schema defaults and write output\n";
     std::cout << "  --convert        Convert between formats\n";
 }
@@ -68,7 +80,8 @@ int main(int argc, char** argv) {
 
     if (argc < 2) {
         std::cerr << "usage:\n  parsec [--auto|--json|--ron|--toml|--ini] <file>\n  parsec "
-                     "--validate [--no-defaults] <schema.json> <file>\n  parsec --fill-defaults "
+                     "--validate [--no-defaults] [--jobs N] [--profile] <schema.json> <file>...\n"
+                     "  parsec --fill-defaults "
                      "<schema.json> <input> <output>\n  parsec --convert "
                      "<yaml|json|ron|toml> <input> [output]\n";
         std::cerr << "\nUse 'parsec --help' for more information.\n";
@@ -93,35 +106,82 @@ int main(int argc, char** argv) {
         return 2;
     }
 
-    // Special validate mode: parse schema (JSON) and validate the given file against it
+    // Special validate mode: parse schema (JSON) once and validate one or more files against it
     if (std::string(argv[1]) == "--validate") {
+        static const char* validate_usage =
+                    "usage: parsec --validate [--no-defaults] [--jobs N] [--profile] <schema.json> "
+                    "<file>... [@filelist]\n";
+        static const std::vector<std::string> validate_options = {
+                    "--no-defaults", "--jobs", "-j", "--profile"};
+
         bool apply_defaults = true;
-        int schema_idx = 2;
-        int data_idx = 3;
-        int expected_argc = 4;
-
-        // Check for --no-defaults flag
-        if (argc >= 3 && std::string(argv[2]) == "--no-defaults") {
-            apply_defaults = false;
-            schema_idx = 3;
-            data_idx = 4;
-            expected_argc = 5;
-        }
-        // Check for typos in the second argument if it looks like an option
-        else if (argc >= 3 && isOption(argv[2])) {
-            static const std::vector<std::string> validate_options = {"--no-defaults"};
-            std::string error_msg = ps::cli_utils::create_unknown_arg_error(argv[2], validate_options);
-            std::cerr << error_msg << "\n";
-            std::cerr << "usage: parsec --validate [--no-defaults] <schema.json> <file>\n";
-            return 2;
+        ps::ValidationOptions options;
+        bool batch_requested = false;
+        unsigned jobs = 0;  // 0 = one worker per hardware thread
+        std::vector<std::string> positional;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--no-defaults") {
+                apply_defaults = false;
+            } else if (arg == "--profile") {
+                options.profile = true;
+            } else if (arg == "--jobs" || arg == "-j") {
+                if (i + 1 >= argc) {
+                    std::cerr << arg << " requires a worker count\n" << validate_usage;
+                    return 2;
+                }
+                try {
+                    int n = std::stoi(argv[++i]);
+                    if (n < 0) throw std::invalid_argument("negative");
+                    jobs = static_cast<unsigned>(n);
+                } catch (...) {
+                    std::cerr << "error: invalid worker count '" << argv[i] << "'\n";
+                    return 2;
+                }
+                batch_requested = true;
+            } else if (isOption(arg)) {
+                // Check for typos in flags
+                std::string error_msg = ps::cli_utils::create_unknown_arg_error(arg, validate_options);
+                std::cerr << error_msg << "\n";
+                std::cerr << validate_usage;
+                return 2;
+            } else {
+                positional.push_back(arg);
+            }
         }
 
-        if (argc != expected_argc) {
-            std::cerr << "usage: parsec --validate [--no-defaults] <schema.json> <file>\n";
+        if (positional.size() < 2) {
+            std::cerr << validate_usage;
             return 2;
         }
-        std::string schema_path = argv[schema_idx];
-        std::string data_path = argv[data_idx];
+        std::string schema_path = positional[0];
+
+        // Data files: plain paths, or @filelist (one path per line, '#' comments allowed)
+        std::vector<std::string> data_paths;
+        for (size_t i = 1; i < positional.size(); ++i) {
+            const std::string& p = positional[i];
+            if (p.size() > 1 && p[0] == '@') {
+                std::ifstream list(p.substr(1));
+                if (!list) {
+                    std::cerr << "error: cannot open file list: " << p.substr(1) << "\n";
+                    return 2;
+                }
+                std::string line;
+                while (std::getline(list, line)) {
+                    while (!line.empty() && (line.back() == '\r' || line.back() == ' ' ||
+                                             line.back() == '\t'))
+                        line.pop_back();
+                    size_t first = line.find_first_not_of(" \t");
+                    if (first == std::string::npos || line[first] == '#') continue;
+                    data_paths.push_back(line.substr(first));
+                }
+                batch_requested = true;
+            } else {
+                data_paths.push_back(p);
+            }
+        }
+        if (data_paths.size() > 1) batch_requested = true;
+
         std::ifstream sin(schema_path);
         if (!sin) {
             std::cerr << "error: cannot open schema: " << schema_path << "\n";
@@ -129,49 +189,161 @@ int main(int argc, char** argv) {
         }
         std::string schema_content((std::istreambuf_iterator<char>(sin)),
                                    std::istreambuf_iterator<char>());
+        // $refs into other schema files are resolved once, up front
+        ps::SchemaRegistry registry;
+        std::shared_ptr<const ps::Dictionary> resolved;
+        std::optional<ps::DefaultsSkeleton> defaults;  // compiled once for every file
         try {
-            auto schema = ps::parse(schema_content);
-
-            // Set schema context for better error messages
-            ps::set_schema_context(schema_path, schema_content);
+            resolved = registry.resolve(schema_path);
+            if (apply_defaults) defaults.emplace(*resolved);
+        } catch (const std::exception& e) {
+            std::cerr << "schema parse error: " << e.what() << "\n";
+            return 2;
+        }
+        const ps::Dictionary& schema = *resolved;
+
+        // Set schema context for better error messages (shared, read-only while validating)
+        ps::set_schema_context(schema_path, schema_content);
+
+        if (!batch_requested) {
+            const std::string& data_path = data_paths[0];
+            try {
+                std::ifstream in(data_path);
+                if (!in) {
+                    std::cerr << "error: cannot open file: " << data_path << "\n";
+                    return 2;
+                }
+                std::string content((std::istreambuf_iterator<char>(in)),
+                                    std::istreambuf_iterator<char>());
+
+                // Set data filename for better error messages
+                ps::set_data_filename(data_path);
+
+                ps::Dictionary data = ps::parse(content);
+
+                // Apply defaults from schema if requested. Error messages still
+                // show the user's input, not the defaults.
+                auto result = defaults ? ps::validate_with_defaults(data, *defaults, schema,
+                                                                    content, options)
+                                       : ps::validate_all(data, schema, content, options);
+                if (result.profile) std::cerr << result.profile->format();
+                if (!result.is_valid()) {
+                    std::cerr << result.format();
+                    return 1;
+                }
+                std::cout << "OK: validation passed\n";
+                return 0;
+            } catch (const std::exception& e) {
+                std::cerr << "schema parse error: " << e.what() << "\n";
+                return 2;
+            }
+        }
 
+        // Batch mode: validate files concurrently, report in input order
+        struct FileResult {
+            int status = 0;  // 0 = passed, 1 = validation failed, 2 = unreadable/unparsable
+            std::string report;
+            bool done = false;
+        };
+        std::vector<FileResult> results(data_paths.size());
+        const ps::CompiledSchema compiled(resolved);  // lookup tables shared by every file
+        ps::ValidationProfile profile;  // merged over all files with --profile
+        std::mutex results_mutex;
+        std::condition_variable results_ready;
+        std::atomic<size_t> next_file{0};
+
+        auto validate_file = [&](const std::string& data_path, FileResult& r) {
             std::ifstream in(data_path);
             if (!in) {
-                std::cerr << "error: cannot open file: " << data_path << "\n";
-                return 2;
+                r.status = 2;
+                r.report = "error: cannot open file: " + data_path + "\n";
+                return;
             }
             std::string content((std::istreambuf_iterator<char>(in)),
                                 std::istreambuf_iterator<char>());
-
-            // Set data filename for better error messages
-            ps::set_data_filename(data_path);
-
-            ps::Dictionary data = ps::parse(content);
-            ps::Dictionary original_data = data;  // Keep a copy before applying defaults
-
-            // Apply defaults from schema if requested
-            if (apply_defaults) {
-                data = ps::setDefaults(data, schema);
+            try {
+                // Per-thread error-message context (see set_data_filename)
+                ps::set_data_filename(data_path);
+                ps::Dictionary data = ps::parse(content);
+                auto result = defaults ? ps::validate_with_defaults(data, *defaults, compiled,
+                                                                    content, options)
+                                       : ps::validate_all(data, compiled, content, options);
+                if (result.profile) {
+                    std::lock_guard<std::mutex> lock(results_mutex);
+                    profile.merge(*result.profile);
+                }
+                if (!result.is_valid()) {
+                    r.status = 1;
+                    r.report = result.format();
+                }
+            } catch (const std::exception& e) {
+                r.status = 2;
+                r.report = std::string("parse error: ") + e.what() + "\n";
             }
+        };
 
-            // Set original data for better error messages (shows user input, not defaults)
-            ps::set_original_data(&original_data);
+        auto worker = [&]() {
+            for (;;) {
+                size_t i = next_file.fetch_add(1);
+                if (i >= data_paths.size()) return;
+                FileResult r;
+                validate_file(data_paths[i], r);
+                {
+                    std::lock_guard<std::mutex> lock(results_mutex);
+                    results[i].status = r.status;
+                    results[i].report = std::move(r.report);
+                    results[i].done = true;
+                }
+                results_ready.notify_all();
+            }
+        };
 
-            auto result = ps::validate_all(data, schema, content);
-            if (!result.is_valid()) {
-                std::cerr << result.format();
-                return 1;
+        if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+        jobs = static_cast<unsigned>(std::min<size_t>(jobs, data_paths.size()));
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        workers.reserve(jobs);
+        for (unsigned t = 0; t < jobs; ++t) workers.emplace_back(worker);
+
+        // Stream per-file results in input order as soon as each one is ready
+        size_t passed = 0, failed = 0, errored = 0;
+        for (size_t i = 0; i < data_paths.size(); ++i) {
+            FileResult r;
+            {
+                std::unique_lock<std::mutex> lock(results_mutex);
+                results_ready.wait(lock, [&] { return results[i].done; });
+                r.status = results[i].status;
+                r.report = std::move(results[i].report);
+            }
+            if (r.status == 0) {
+                ++passed;
+                std::cout << "OK: " << data_paths[i] << "\n";
+            } else {
+                if (r.status == 1)
+                    ++failed;
+                else
+                    ++errored;
+                std::cout << std::flush;
+                std::cerr << "FAILED: " << data_paths[i] << "\n" << r.report << std::flush;
             }
-            std::cout << "OK: validation passed\n";
-            
-            // Clear the original data pointer (it's going out of scope)
-            ps::set_original_data(nullptr);
-            
-            return 0;
-        } catch (const std::exception& e) {
-            std::cerr << "schema parse error: " << e.what() << "\n";
-            return 2;
         }
+        for (auto& w : workers) w.join();
+
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double rate = secs > 0.0 ? static_cast<double>(data_paths.size()) / secs : 0.0;
+        std::ostringstream summary;
+        summary.setf(std::ios::fixed);
+        summary.precision(2);
+        summary << "Validated " << data_paths.size() << " file" << (data_paths.size() != 1 ? "s" : "")
+                << " in " << secs << " s (" << rate << " files/s, " << jobs << " job"
+                << (jobs != 1 ? "s" : "") << "): " << passed << " passed, " << failed << " failed";
+        if (errored > 0) summary << ", " << errored << " unreadable";
+        std::cout << summary.str() << "\n";
+        if (options.profile) std::cerr << profile.format();
+
+        if (errored > 0) return 2;
+        return failed > 0 ? 1 : 0;
     }
 
     // Fill defaults mode: --fill-defaults <schema.json> <input> <output>
@@ -189,8 +361,6 @@ int main(int argc, char** argv) {
             std::cerr << "error: cannot open schema: " << schema_path << "\n";
             return 2;
         }
-        std::string schema_content((std::istreambuf_iterator<char>(sin)),
-                                   std::istreambuf_iterator<char>());
 
         std::ifstream in(data_path);
         if (!in) {
@@ -200,10 +370,11 @@ int main(int argc, char** argv) {
         std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
 
         try {
-            auto schema = ps::parse(schema_content);
+            ps::SchemaRegistry registry;
+            const auto schema = registry.resolve(schema_path);
             ps::Dictionary data = ps::parse(content);
 
-            ps::Dictionary completed = ps::setDefaults(data, schema);
+            ps::Dictionary completed = ps::setDefaults(data, *schema);
 
             std::ofstream out_file(out_path);
             if (!out_file) {
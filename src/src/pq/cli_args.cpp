@@ -1,5 +1,6 @@
 #include <ps/pq/cli_args.h>
 #include <ps/cli_utils.h>
+#include <algorithm>
 #include <stdexcept>
 #include <string>
 
@@ -12,14 +13,52 @@ CliArgs::CliArgs(int argc, const char* argv[]) {
         return;
     }
     
-    // First argument is the file path
-    filePath_ = argv[1];
+    // --serve <socket> runs the query daemon, --client <socket> sends the rest of
+    // the arguments to it
+    int first = 1;
+    std::string mode = argv[1];
+    if (mode == "--serve" || mode == "--client") {
+        if (argc < 3) {
+            throw std::invalid_argument(mode + " requires a socket path argument");
+        }
+        socketPath_ = argv[2];
+        if (mode == "--serve") {
+            if (argc > 3) {
+                throw std::invalid_argument("--serve takes no other arguments");
+            }
+            action_ = Action::SERVE;
+            return;
+        }
+        first = 3;
+        if (argc < 4) {
+            action_ = Action::HELP;
+            return;
+        }
+    }
     
-    // If only file is provided, default to print
-    if (argc == 2) {
-        action_ = Action::PRINT;
+    // The file comes first (pq <file> ...), or every bare argument after the
+    // options is a file (pq --get <path> <file>...). The daemon client only
+    // takes the first form.
+    std::string head = argv[first];
+    if (head == "--help" || head == "-h") {
+        action_ = Action::HELP;
         return;
     }
+    bool filesLast = head.size() > 1 && head[0] == '-';
+    if (filesLast && !socketPath_.empty()) {
+        throw std::invalid_argument("--client expects the file before the query");
+    }
+    if (!filesLast) {
+        filePaths_.push_back(head);
+        filePath_ = head;
+        
+        // If only file is provided, default to print
+        if (argc == first + 1) {
+            action_ = Action::PRINT;
+            return;
+        }
+        ++first;
+    }
     
     // Valid options for error suggestions
     static const std::vector<std::string> valid_options = {
@@ -27,48 +66,127 @@ CliArgs::CliArgs(int argc, const char* argv[]) {
         "--count",
         "--has",
         "--default", "-d",
-        "--as-json"
+        "--as-json",
+        "--as-shell",
+        "--raw-output", "-r",
+        "--arg",
+        "--argjson",
+        "--jobs", "-j",
+        "--slurp", "-s",
+        "--stream"
     };
     
     // Parse flags
-    for (int i = 2; i < argc; ++i) {
+    std::optional<std::string> pendingDefault;  // --default given before its query
+    for (int i = first; i < argc; ++i) {
         std::string arg = argv[i];
         
+        Action action = Action::HELP;
         if (arg == "--get" || arg == "-g") {
-            action_ = Action::GET;
-            if (i + 1 >= argc) {
-                throw std::invalid_argument("--get requires a path argument");
-            }
-            path_ = argv[++i];
+            action = Action::GET;
+        } else if (arg == "--count") {
+            action = Action::COUNT;
+        } else if (arg == "--has") {
+            action = Action::HAS;
         }
-        else if (arg == "--count") {
-            action_ = Action::COUNT;
-            if (i + 1 >= argc) {
-                throw std::invalid_argument("--count requires a path argument");
-            }
-            path_ = argv[++i];
-        }
-        else if (arg == "--has") {
-            action_ = Action::HAS;
+        
+        if (action != Action::HELP) {
             if (i + 1 >= argc) {
-                throw std::invalid_argument("--has requires a path argument");
+                std::string flag = action == Action::GET ? "--get" : arg;
+                throw std::invalid_argument(flag + " requires a path argument");
             }
-            path_ = argv[++i];
+            queries_.push_back({action, argv[++i], pendingDefault});
+            pendingDefault.reset();
         }
         else if (arg == "--default" || arg == "-d") {
             if (i + 1 >= argc) {
                 throw std::invalid_argument("--default requires a value argument");
             }
-            defaultValue_ = argv[++i];
+            // Applies to the query it follows, or to the next one if none came yet
+            if (queries_.empty()) {
+                pendingDefault = argv[++i];
+            } else {
+                queries_.back().defaultValue = argv[++i];
+            }
         }
         else if (arg == "--as-json") {
             asJson_ = true;
         }
+        else if (arg == "--as-shell") {
+            asShell_ = true;
+        }
+        else if (arg == "--raw-output" || arg == "-r") {
+            rawOutput_ = true;
+        }
+        else if (arg == "--arg" || arg == "--argjson") {
+            if (i + 2 >= argc) {
+                throw std::invalid_argument(arg + " requires a name and a value argument");
+            }
+            filterArguments_.push_back({argv[i + 1], argv[i + 2], arg == "--argjson"});
+            i += 2;
+        }
+        else if (arg == "--jobs" || arg == "-j") {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument(arg + " requires a worker count");
+            }
+            std::string count = argv[++i];
+            if (count.empty() || count.size() > 6 ||
+                count.find_first_not_of("0123456789") != std::string::npos) {
+                throw std::invalid_argument("Invalid worker count: " + count);
+            }
+            jobs_ = static_cast<unsigned>(std::stoul(count));
+        }
+        else if (arg == "--slurp" || arg == "-s") {
+            slurp_ = true;
+        }
+        else if (arg == "--stream") {
+            stream_ = true;
+        }
+        else if (filesLast && (arg == "-" || (!arg.empty() && arg[0] != '-'))) {
+            filePaths_.push_back(arg);
+        }
+        else if (!arg.empty() && arg[0] != '-') {
+            // A bare argument is the filter: pq data.json '.users[] | .name'
+            if (!filter_.empty()) {
+                throw std::invalid_argument("Unexpected argument: " + arg + " (only one filter is allowed)");
+            }
+            filter_ = arg;
+        }
         else {
             std::string error_msg = cli_utils::create_unknown_arg_error(arg, valid_options);
             throw std::invalid_argument(error_msg);
         }
     }
+    
+    if (!filter_.empty()) {
+        if (!queries_.empty()) {
+            throw std::invalid_argument("A filter can't be combined with --get, --count or --has");
+        }
+        action_ = Action::FILTER;
+        return;
+    }
+    
+    if (filesLast) {
+        // pq --get <path> reads stdin, as in `tail -f log.ndjson | pq -g level`
+        if (filePaths_.empty()) {
+            filePaths_.push_back("-");
+        }
+        filePath_ = filePaths_.front();
+    }
+    if (std::count(filePaths_.begin(), filePaths_.end(), "-") > 1) {
+        throw std::invalid_argument("stdin (-) can only be read once");
+    }
+    if (filePath_ == "-" && !socketPath_.empty()) {
+        throw std::invalid_argument("--client can't send stdin to the daemon");
+    }
+    if (filePaths_.size() > 1 && asShell_) {
+        throw std::invalid_argument("--as-shell takes a single input file");
+    }
+    
+    // Options without any query fall back to help
+    if (!queries_.empty()) {
+        action_ = queries_.front().action;
+    }
 }
 
 } // namespace pq
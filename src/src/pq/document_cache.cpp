@@ -0,0 +1,42 @@
+#include <ps/pq/document_cache.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace ps {
+namespace pq {
+
+const Dictionary& DocumentCache::get(const std::string& path) {
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(path, ec);
+    std::uintmax_t bytes = ec ? 0 : std::filesystem::file_size(path, ec);
+    if (ec) {
+        entries_.erase(path);
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    
+    auto it = entries_.find(path);
+    if (it != entries_.end() && it->second.modified == modified && it->second.bytes == bytes) {
+        return it->second.data;
+    }
+    
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    
+    // Parse before touching the cache so a broken edit doesn't leave a half entry
+    Dictionary data = ps::parse(buffer.str(), false, path);
+    Entry& entry = entries_[path];
+    entry.modified = modified;
+    entry.bytes = bytes;
+    entry.data = std::move(data);
+    entry.index = std::make_unique<KeyIndex>(entry.data);
+    return entry.data;
+}
+
+} // namespace pq
+} // namespace ps
@@ -0,0 +1,39 @@
+#include <ps/pq/filter.h>
+#include "filter_eval.h"
+#include "filter_parser.h"
+
+namespace ps {
+namespace pq {
+
+struct Filter::Program {
+    filter::ExprPtr root;
+};
+
+FilterError::FilterError(const Dictionary& value)
+    : std::runtime_error(filter::errorMessage(value)), value_(value) {}
+
+Filter::Filter(const std::string& text, const std::map<std::string, Dictionary>& arguments) {
+    auto program = std::make_shared<Program>();
+    program->root = filter::parse(text, arguments);
+    program_ = std::move(program);
+}
+
+void Filter::run(const Dictionary& input, const std::function<void(const Dictionary&)>& emit) const {
+    // Errors from `emit` itself pass through unchanged; anything else the
+    // filter raised becomes a FilterError
+    filter::guarded(
+            filter::Emit(emit),
+            [&](filter::Emit out) { program_->root->eval(input, nullptr, out); },
+            [](const Dictionary& error) { throw FilterError(error); });
+}
+
+std::vector<Dictionary> Filter::evaluate(const Dictionary& input) const {
+    std::vector<Dictionary> outputs;
+    run(input, [&outputs](const Dictionary& value) { outputs.push_back(value); });
+    return outputs;
+}
+
+std::string Filter::toJson(const Dictionary& value) { return filter::json(value); }
+
+} // namespace pq
+} // namespace ps
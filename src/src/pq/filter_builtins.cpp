@@ -0,0 +1,1432 @@
+#include "filter_eval.h"
+
+#include <ps/json.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <regex>
+#include <unordered_map>
+
+namespace ps {
+namespace pq {
+namespace filter {
+
+// A compiled pattern. std::regex has no named groups, so `(?<name>...)` is
+// rewritten to a plain group and the name kept here by group number.
+struct Regex {
+    std::regex re;
+    std::vector<std::string> names;  // names[g - 1] for group g, empty if unnamed
+    bool global = false;             // the "g" flag
+};
+
+// ---------------------------------------------------------------------------
+// Formats (@csv etc.)
+// ---------------------------------------------------------------------------
+
+namespace {
+
+std::string formatJson(const Dictionary& v) { return json(v); }
+
+template <typename Cell>
+std::string formatRow(const Dictionary& v, const char* name, const char* separator, Cell cell) {
+    if (!v.isArrayObject()) {
+        fail(describe(v) + " cannot be " + name + "-formatted, only an array can be");
+    }
+    std::string out;
+    bool first = true;
+    for (const auto* element : items(v)) {
+        if (!first) out += separator;
+        first = false;
+        if (element->isNull()) continue;
+        if (element->isString()) {
+            out += cell(element->asStringRef());
+        } else if (element->isBool() || isNumber(*element)) {
+            out += json(*element);
+        } else {
+            fail(describe(*element) + " is not valid in a " + name + " row");
+        }
+    }
+    return out;
+}
+
+std::string formatCsv(const Dictionary& v) {
+    return formatRow(v, "csv", ",", [](const std::string& s) {
+        std::string out = "\"";
+        for (char c : s) out += c == '"' ? std::string("\"\"") : std::string(1, c);
+        return out + "\"";
+    });
+}
+
+std::string formatTsv(const Dictionary& v) {
+    return formatRow(v, "tsv", "\t", [](const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            switch (c) {
+                case '\\': out += "\\\\"; break;
+                case '\t': out += "\\t"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                default: out += c;
+            }
+        }
+        return out;
+    });
+}
+
+std::string shellQuote(const std::string& s) {
+    std::string out = "'";
+    for (char c : s) out += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    return out + "'";
+}
+
+std::string formatSh(const Dictionary& v) {
+    std::vector<const Dictionary*> words = v.isArrayObject() ? items(v) : std::vector<const Dictionary*>{&v};
+    std::string out;
+    for (size_t i = 0; i < words.size(); ++i) {
+        const Dictionary& word = *words[i];
+        if (i) out += ' ';
+        if (word.isArrayObject() || word.isMappedObject()) {
+            fail(describe(word) + " can not be escaped for shell");
+        }
+        out += word.isString() ? shellQuote(word.asStringRef()) : json(word);
+    }
+    return out;
+}
+
+const char kBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string formatBase64(const Dictionary& v) {
+    std::string in = toText(v);
+    std::string out;
+    for (size_t i = 0; i < in.size(); i += 3) {
+        uint32_t chunk = static_cast<unsigned char>(in[i]) << 16;
+        if (i + 1 < in.size()) chunk |= static_cast<unsigned char>(in[i + 1]) << 8;
+        if (i + 2 < in.size()) chunk |= static_cast<unsigned char>(in[i + 2]);
+        out += kBase64[(chunk >> 18) & 0x3f];
+        out += kBase64[(chunk >> 12) & 0x3f];
+        out += i + 1 < in.size() ? kBase64[(chunk >> 6) & 0x3f] : '=';
+        out += i + 2 < in.size() ? kBase64[chunk & 0x3f] : '=';
+    }
+    return out;
+}
+
+std::string formatBase64d(const Dictionary& v) {
+    std::string in = toText(v);
+    std::string out;
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : in) {
+        const char* found = c ? std::strchr(kBase64, c) : nullptr;
+        if (!found) {
+            if (c == '=') break;
+            fail(describe(v) + " is not valid base64 data");
+        }
+        buffer = (buffer << 6) | static_cast<uint32_t>(found - kBase64);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out += static_cast<char>((buffer >> bits) & 0xff);
+        }
+    }
+    return out;
+}
+
+std::string formatUri(const Dictionary& v) {
+    std::string out;
+    for (char c : toText(v)) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (std::isalnum(u) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += c;
+        } else {
+            char buffer[4];
+            std::snprintf(buffer, sizeof(buffer), "%%%02X", u);
+            out += buffer;
+        }
+    }
+    return out;
+}
+
+std::string formatHtml(const Dictionary& v) {
+    std::string out;
+    for (char c : toText(v)) {
+        switch (c) {
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '&': out += "&amp;"; break;
+            case '\'': out += "&#39;"; break;
+            case '"': out += "&quot;"; break;
+            default: out += c;
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+std::string formatText(const Dictionary& v) { return toText(v); }
+
+FormatFn findFormat(const std::string& name) {
+    static const std::unordered_map<std::string, FormatFn> formats = {
+            {"text", formatText},     {"json", formatJson}, {"csv", formatCsv},
+            {"tsv", formatTsv},       {"sh", formatSh},     {"base64", formatBase64},
+            {"base64d", formatBase64d}, {"uri", formatUri}, {"html", formatHtml},
+    };
+    auto it = formats.find(name);
+    return it == formats.end() ? nullptr : it->second;
+}
+
+// ---------------------------------------------------------------------------
+// Builtins
+// ---------------------------------------------------------------------------
+
+namespace {
+
+// A builtin computed from its input alone
+template <Dictionary (*F)(const Dictionary&)>
+void unary(const Call&, const Dictionary& in, const Env*, Emit emit) {
+    emit(F(in));
+}
+
+// A builtin of its input and each output of its one argument
+template <Dictionary (*F)(const Dictionary&, const Dictionary&)>
+void binary(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& a) { emit(F(in, a)); });
+}
+
+// A builtin that passes its input through when `P` holds, like select()
+template <bool (*P)(const Dictionary&)>
+void selector(const Call&, const Dictionary& in, const Env*, Emit emit) {
+    if (P(in)) emit(in);
+}
+
+template <bool (*P)(const Dictionary&)>
+void selectorPaths(const Call&, const Dictionary& in, const Env*, Path& path, PathEmit emit) {
+    if (P(in)) emit(path, in);
+}
+
+Dictionary length(const Dictionary& in) {
+    if (in.isNull()) return Dictionary(int64_t(0));
+    if (in.isBool()) fail(describe(in) + " has no length");
+    if (in.isInt()) return Dictionary(in.asInt() < 0 ? -in.asInt() : in.asInt());
+    if (in.isDouble()) return Dictionary(std::fabs(in.asDouble()));
+    if (in.isString()) return Dictionary(static_cast<int64_t>(utf8Length(in.asStringRef())));
+    return Dictionary(static_cast<int64_t>(in.size()));
+}
+
+Dictionary utf8ByteLength(const Dictionary& in) {
+    if (!in.isString()) fail(describe(in) + " only strings have UTF-8 byte length");
+    return Dictionary(static_cast<int64_t>(in.asStringRef().size()));
+}
+
+Dictionary logicalNot(const Dictionary& in) { return Dictionary(!truthy(in)); }
+
+Dictionary keys(const Dictionary& in) {
+    std::vector<Dictionary> out;
+    if (in.isMappedObject()) {
+        for (const auto& member : in.members()) out.emplace_back(member.first);
+    } else if (in.isArrayObject()) {
+        for (int64_t i = 0; i < in.size(); ++i) out.emplace_back(i);
+    } else {
+        fail(describe(in) + " has no keys");
+    }
+    return array(std::move(out));
+}
+
+Dictionary type(const Dictionary& in) { return Dictionary(typeName(in)); }
+
+Dictionary toString(const Dictionary& in) { return in.isString() ? in : Dictionary(json(in)); }
+
+Dictionary toJson(const Dictionary& in) { return Dictionary(json(in)); }
+
+Dictionary toNumber(const Dictionary& in) {
+    if (isNumber(in)) return in;
+    if (!in.isString()) fail(describe(in) + " cannot be parsed as a number");
+    const std::string& s = in.asStringRef();
+    const char* begin = s.c_str();
+    char* end = nullptr;
+    if (s.find_first_of(".eE") == std::string::npos) {
+        errno = 0;
+        long long n = std::strtoll(begin, &end, 10);
+        if (!s.empty() && *end == '\0' && errno == 0) return Dictionary(static_cast<int64_t>(n));
+    }
+    double x = std::strtod(begin, &end);
+    if (s.empty() || *end != '\0' || std::isspace(static_cast<unsigned char>(s[0]))) {
+        fail("Cannot parse '" + s + "' as JSON");
+    }
+    return Dictionary(x);
+}
+
+Dictionary fromJson(const Dictionary& in) {
+    if (!in.isString()) fail(describe(in) + " cannot be parsed as JSON");
+    Dictionary parsed;
+    try {
+        // Wrapped so that scalars parse too
+        parsed = parse_json("[" + in.asStringRef() + "]");
+    } catch (const std::exception& e) {
+        fail(std::string(e.what()) + " (while parsing '" + in.asStringRef() + "')");
+    }
+    if (parsed.size() != 1) fail("Cannot parse '" + in.asStringRef() + "' as JSON");
+    return parsed.at(0);
+}
+
+int lowerAscii(int c) { return std::tolower(c); }
+int upperAscii(int c) { return std::toupper(c); }
+
+template <int (*Convert)(int)>
+Dictionary asciiCase(const Dictionary& in) {
+    if (!in.isString()) fail(describe(in) + " cannot be case-converted, as it is not a string");
+    std::string out = in.asStringRef();
+    for (auto& c : out) {
+        if (static_cast<unsigned char>(c) < 0x80) c = static_cast<char>(Convert(static_cast<unsigned char>(c)));
+    }
+    return Dictionary(out);
+}
+
+Dictionary explode(const Dictionary& in) {
+    if (!in.isString()) fail(describe(in) + " cannot be exploded, as it is not a string");
+    std::vector<Dictionary> out;
+    for (uint32_t cp : codepoints(in.asStringRef())) out.emplace_back(static_cast<int64_t>(cp));
+    return array(std::move(out));
+}
+
+Dictionary implode(const Dictionary& in) {
+    if (!in.isArrayObject()) fail(describe(in) + " cannot be imploded, as it is not an array");
+    std::string out;
+    for (const auto* cp : items(in)) {
+        if (!isNumber(*cp)) fail("Unicode codepoint must be numeric");
+        appendUtf8(out, static_cast<uint32_t>(toDouble(*cp)));
+    }
+    return Dictionary(out);
+}
+
+bool startsWith(const std::string& s, const std::string& prefix) {
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+Dictionary ltrimstr(const Dictionary& in, const Dictionary& prefix) {
+    if (in.isString() && prefix.isString() && startsWith(in.asStringRef(), prefix.asStringRef())) {
+        return Dictionary(in.asStringRef().substr(prefix.asStringRef().size()));
+    }
+    return in;
+}
+
+Dictionary rtrimstr(const Dictionary& in, const Dictionary& suffix) {
+    const std::string& s = in.isString() ? in.asStringRef() : std::string();
+    if (in.isString() && suffix.isString() && endsWith(s, suffix.asStringRef())) {
+        return Dictionary(s.substr(0, s.size() - suffix.asStringRef().size()));
+    }
+    return in;
+}
+
+Dictionary startsWithFn(const Dictionary& in, const Dictionary& prefix) {
+    if (!in.isString() || !prefix.isString()) fail("startswith() requires string inputs");
+    return Dictionary(startsWith(in.asStringRef(), prefix.asStringRef()));
+}
+
+Dictionary endsWithFn(const Dictionary& in, const Dictionary& suffix) {
+    if (!in.isString() || !suffix.isString()) fail("endswith() requires string inputs");
+    return Dictionary(endsWith(in.asStringRef(), suffix.asStringRef()));
+}
+
+template <bool Left, bool Right>
+Dictionary trim(const Dictionary& in) {
+    if (!in.isString()) fail(describe(in) + " cannot be trimmed, as it is not a string");
+    const std::string& s = in.asStringRef();
+    const char* space = " \t\n\r\f\v";
+    size_t begin = Left ? s.find_first_not_of(space) : 0;
+    if (begin == std::string::npos) return Dictionary(std::string());
+    size_t end = Right ? s.find_last_not_of(space) + 1 : s.size();
+    return Dictionary(s.substr(begin, end - begin));
+}
+
+Dictionary splitFn(const Dictionary& in, const Dictionary& separator) {
+    if (!in.isString() || !separator.isString()) fail("split input and separator must be strings");
+    return split(in.asStringRef(), separator.asStringRef());
+}
+
+Dictionary join(const Dictionary& in, const Dictionary& separator) {
+    if (!in.isArrayObject()) failIterate(in);
+    if (!separator.isString()) fail(describe(separator) + " is not a valid separator");
+    std::string out;
+    bool first = true;
+    for (const auto* element : items(in)) {
+        if (!first) out += separator.asStringRef();
+        first = false;
+        if (element->isNull()) continue;
+        if (element->isArrayObject() || element->isMappedObject()) {
+            fail("Cannot join with " + typeName(*element));
+        }
+        out += toText(*element);
+    }
+    return Dictionary(out);
+}
+
+Dictionary toEntries(const Dictionary& in) {
+    std::vector<Dictionary> out;
+    if (in.isMappedObject()) {
+        for (const auto& member : in.members()) {
+            Dictionary entry;
+            entry["key"] = member.first;
+            entry["value"] = member.second;
+            out.push_back(entry);
+        }
+    } else if (in.isArrayObject()) {
+        for (const auto& element : in.elements()) {
+            Dictionary entry;
+            entry["key"] = static_cast<int64_t>(element.first);
+            entry["value"] = element.second;
+            out.push_back(entry);
+        }
+    } else {
+        fail(describe(in) + " has no keys");
+    }
+    return array(std::move(out));
+}
+
+Dictionary fromEntries(const Dictionary& in) {
+    Dictionary out;
+    iterate(in, [&](const Dictionary& entry) {
+        if (!entry.isMappedObject()) fail("Cannot index " + typeName(entry) + " with \"key\"");
+        const Dictionary* key = &nullValue();
+        for (const char* name : {"key", "k", "name", "Name", "K", "Key"}) {
+            if (truthy(fieldOf(entry, name))) {
+                key = &fieldOf(entry, name);
+                break;
+            }
+        }
+        const Dictionary* value = &nullValue();
+        for (const char* name : {"value", "v", "Value", "V"}) {
+            if (entry.has(name)) {
+                value = &entry.at(name);
+                break;
+            }
+        }
+        out[toText(*key)] = *value;
+    });
+    return out;
+}
+
+bool hasKey(const Dictionary& in, const Dictionary& key) {
+    if (in.isMappedObject() && key.isString()) return in.has(key.asStringRef());
+    if (in.isArrayObject() && isNumber(key)) {
+        double i = toDouble(key);
+        return i >= 0 && i < in.size();
+    }
+    fail("Cannot check whether " + typeName(in) + " has a " + typeName(key) + " key");
+}
+
+Dictionary has(const Dictionary& in, const Dictionary& key) { return Dictionary(hasKey(in, key)); }
+
+Dictionary inFn(const Dictionary& in, const Dictionary& object) { return Dictionary(hasKey(object, in)); }
+
+bool containsValue(const Dictionary& a, const Dictionary& b) {
+    if (typeName(a) != typeName(b)) {
+        fail(describe(a) + " and " + describe(b) + " cannot have their containment checked");
+    }
+    if (a.isMappedObject()) {
+        for (const auto& member : b.members()) {
+            if (!a.has(member.first) || !containsValue(a.at(member.first), member.second)) return false;
+        }
+        return true;
+    }
+    if (a.isArrayObject()) {
+        auto candidates = items(a);
+        for (const auto* wanted : items(b)) {
+            bool found = false;
+            for (const auto* candidate : candidates) {
+                if (typeName(*candidate) == typeName(*wanted) && containsValue(*candidate, *wanted)) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) return false;
+        }
+        return true;
+    }
+    if (a.isString()) return a.asStringRef().find(b.asStringRef()) != std::string::npos;
+    return equal(a, b);
+}
+
+Dictionary contains(const Dictionary& in, const Dictionary& b) { return Dictionary(containsValue(in, b)); }
+
+Dictionary inside(const Dictionary& in, const Dictionary& b) { return Dictionary(containsValue(b, in)); }
+
+const std::vector<const Dictionary*> sortedItems(const Dictionary& in, const char* verb) {
+    if (!in.isArrayObject()) fail(describe(in) + " cannot be " + verb + ", as it is not an array");
+    auto out = items(in);
+    std::stable_sort(out.begin(), out.end(), [](const Dictionary* a, const Dictionary* b) {
+        return compare(*a, *b) < 0;
+    });
+    return out;
+}
+
+Dictionary sort(const Dictionary& in) { return array(sortedItems(in, "sorted")); }
+
+Dictionary unique(const Dictionary& in) {
+    std::vector<const Dictionary*> out;
+    for (const auto* value : sortedItems(in, "sorted")) {
+        if (out.empty() || !equal(*out.back(), *value)) out.push_back(value);
+    }
+    return array(out);
+}
+
+Dictionary minimum(const Dictionary& in) {
+    auto sorted = sortedItems(in, "sorted");
+    return sorted.empty() ? Dictionary::null() : *sorted.front();
+}
+
+Dictionary maximum(const Dictionary& in) {
+    auto sorted = sortedItems(in, "sorted");
+    return sorted.empty() ? Dictionary::null() : *sorted.back();
+}
+
+Dictionary addAll(const Dictionary& in) {
+    if (in.isNull()) return Dictionary::null();
+    if (!in.isArrayObject() && !in.isMappedObject()) failIterate(in);
+    Slot acc = std::make_unique<Dictionary>(Dictionary::null());
+    for (const auto* value : items(in)) acc = std::make_unique<Dictionary>(add(*acc, *value));
+    return *acc;
+}
+
+Dictionary reverse(const Dictionary& in) {
+    if (in.isNull()) return emptyArray();
+    if (in.isString()) {
+        auto text = codepoints(in.asStringRef());
+        std::string out;
+        for (auto it = text.rbegin(); it != text.rend(); ++it) appendUtf8(out, *it);
+        return Dictionary(out);
+    }
+    if (!in.isArrayObject()) fail("Cannot reverse " + describe(in));
+    auto out = items(in);
+    std::reverse(out.begin(), out.end());
+    return array(out);
+}
+
+void flattenInto(std::vector<const Dictionary*>& out, const Dictionary& in, double depth) {
+    for (const auto* value : items(in)) {
+        if (value->isArrayObject() && depth > 0) {
+            flattenInto(out, *value, depth - 1);
+        } else {
+            out.push_back(value);
+        }
+    }
+}
+
+Dictionary flattenTo(const Dictionary& in, const Dictionary& depth) {
+    if (!isNumber(depth)) fail("flatten depth must be a number");
+    if (toDouble(depth) < 0) fail("flatten depth must not be negative");
+    if (!in.isArrayObject()) fail("Cannot flatten " + describe(in));
+    std::vector<const Dictionary*> out;
+    flattenInto(out, in, toDouble(depth));
+    return array(out);
+}
+
+Dictionary flatten(const Dictionary& in) { return flattenTo(in, Dictionary(1e9)); }
+
+template <bool All>
+Dictionary anyAll(const Dictionary& in) {
+    for (const auto* value : items(in)) {
+        if (truthy(*value) != All) return Dictionary(!All);
+    }
+    if (!in.isArrayObject() && !in.isMappedObject()) failIterate(in);
+    return Dictionary(All);
+}
+
+template <double (*F)(double)>
+Dictionary math(const Dictionary& in) {
+    if (!isNumber(in)) fail(describe(in) + " number required");
+    return number(F(toDouble(in)));
+}
+
+double roundHalfAway(double x) { return std::round(x); }
+double exp10(double x) { return std::pow(10.0, x); }
+
+Dictionary abs(const Dictionary& in) {
+    if (in.isInt()) return Dictionary(in.asInt() < 0 ? -in.asInt() : in.asInt());
+    if (!in.isDouble()) fail(describe(in) + " has no absolute value");
+    return Dictionary(std::fabs(in.asDouble()));
+}
+
+bool isArray(const Dictionary& v) { return v.isArrayObject(); }
+bool isObject(const Dictionary& v) { return v.isMappedObject(); }
+bool isIterable(const Dictionary& v) { return v.isArrayObject() || v.isMappedObject(); }
+bool isBoolean(const Dictionary& v) { return v.isBool(); }
+bool isNumberValue(const Dictionary& v) { return isNumber(v); }
+bool isStringValue(const Dictionary& v) { return v.isString(); }
+bool isNullValue(const Dictionary& v) { return v.isNull(); }
+bool isScalar(const Dictionary& v) { return !isIterable(v); }
+bool isNotNull(const Dictionary& v) { return !v.isNull(); }
+
+Dictionary isNan(const Dictionary& in) {
+    if (!isNumber(in)) fail(describe(in) + " number required");
+    return Dictionary(std::isnan(toDouble(in)));
+}
+
+Dictionary isInfinite(const Dictionary& in) {
+    if (!isNumber(in)) fail(describe(in) + " number required");
+    return Dictionary(std::isinf(toDouble(in)));
+}
+
+Dictionary isNormal(const Dictionary& in) {
+    if (!isNumber(in)) fail(describe(in) + " number required");
+    return Dictionary(std::isnormal(toDouble(in)));
+}
+
+// Positions of `needle` in a string (in code points) or an array
+Dictionary indices(const Dictionary& in, const Dictionary& needle) {
+    if (in.isNull()) return Dictionary::null();
+    std::vector<Dictionary> out;
+    if (in.isString() && needle.isString()) {
+        const std::string& s = in.asStringRef();
+        const std::string& n = needle.asStringRef();
+        if (n.empty()) return Dictionary::null();
+        for (size_t at = s.find(n); at != std::string::npos; at = s.find(n, at + 1)) {
+            out.emplace_back(static_cast<int64_t>(utf8Length(s.substr(0, at))));
+        }
+        return array(std::move(out));
+    }
+    if (!in.isArrayObject()) fail("Cannot determine the indices of " + describe(needle) + " in " + describe(in));
+    auto haystack = items(in);
+    auto wanted = needle.isArrayObject() ? items(needle) : std::vector<const Dictionary*>{&needle};
+    if (wanted.empty()) return Dictionary::null();
+    for (size_t i = 0; i + wanted.size() <= haystack.size(); ++i) {
+        bool match = true;
+        for (size_t j = 0; j < wanted.size() && match; ++j) match = equal(*haystack[i + j], *wanted[j]);
+        if (match) out.emplace_back(static_cast<int64_t>(i));
+    }
+    return array(std::move(out));
+}
+
+Dictionary firstIndex(const Dictionary& in, const Dictionary& needle) {
+    Dictionary all = indices(in, needle);
+    return all.isArrayObject() && all.size() > 0 ? all.at(0) : Dictionary::null();
+}
+
+Dictionary lastIndex(const Dictionary& in, const Dictionary& needle) {
+    Dictionary all = indices(in, needle);
+    return all.isArrayObject() && all.size() > 0 ? all.at(all.size() - 1) : Dictionary::null();
+}
+
+Regex compileRegex(const Dictionary& pattern, const Dictionary* flags) {
+    if (!pattern.isString()) fail(describe(pattern) + " cannot be matched, as it is not a string");
+    const std::string& text = pattern.asStringRef();
+    Regex compiled;
+    auto options = std::regex::ECMAScript;
+    if (flags && !flags->isNull()) {
+        if (!flags->isString()) fail(describe(*flags) + " is not a string");
+        for (char c : flags->asStringRef()) {
+            if (c == 'i') {
+                options |= std::regex::icase;
+            } else if (c == 'g') {
+                compiled.global = true;
+            } else if (!std::strchr("nx", c)) {
+                fail(flags->asStringRef() + " is not a valid modifier string");
+            }
+        }
+    }
+    
+    std::string source;
+    bool inClass = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '\\' && i + 1 < text.size()) {
+            source += text.substr(i++, 2);
+            continue;
+        }
+        if (inClass) {
+            inClass = c != ']';
+        } else if (c == '[') {
+            inClass = true;
+        } else if (c == '(' && text.compare(i + 1, 2, "?<") == 0 && i + 3 < text.size() &&
+                   text[i + 3] != '=' && text[i + 3] != '!') {
+            size_t close = text.find('>', i + 3);
+            if (close == std::string::npos) {
+                fail(text + " (at offset " + std::to_string(i) + ") is not a valid regex: unterminated group name");
+            }
+            compiled.names.push_back(text.substr(i + 3, close - i - 3));
+            source += '(';
+            i = close;
+            continue;
+        } else if (c == '(' && text.compare(i + 1, 1, "?") != 0) {
+            compiled.names.emplace_back();
+        }
+        source += c;
+    }
+    try {
+        compiled.re = std::regex(source, options);
+    } catch (const std::regex_error& e) {
+        fail(text + " (at offset 0) is not a valid regex: " + e.what());
+    }
+    return compiled;
+}
+
+// Calls `then` with each regex the call's pattern (and flags) argument gives
+template <typename Then>
+void eachRegex(const Call& call, const Dictionary& in, const Env* env, Then then) {
+    if (!in.isString()) fail(describe(in) + " cannot be matched, as it is not a string");
+    if (call.regex) {
+        then(*call.regex);
+        return;
+    }
+    int flags = call.builtin->regexFlags;
+    call.arg(0).eval(in, env, [&](const Dictionary& pattern) {
+        if (flags <= 0) {
+            then(compileRegex(pattern, nullptr));
+            return;
+        }
+        call.arg(static_cast<size_t>(flags)).eval(in, env, [&](const Dictionary& f) {
+            then(compileRegex(pattern, &f));
+        });
+    });
+}
+
+// Offsets and lengths in match objects count code points, like length
+Dictionary codepointCount(std::string::const_iterator begin, std::string::const_iterator end) {
+    int64_t n = 0;
+    for (auto it = begin; it != end; ++it) {
+        if ((static_cast<unsigned char>(*it) & 0xc0) != 0x80) ++n;
+    }
+    return Dictionary(n);
+}
+
+// {name: text} for the named groups of `m`, as sub's replacement and capture see them
+Dictionary namedCaptures(const Regex& regex, const std::smatch& m) {
+    Dictionary out;
+    for (size_t g = 1; g < m.size() && g <= regex.names.size(); ++g) {
+        if (regex.names[g - 1].empty()) continue;
+        out[regex.names[g - 1]] = m[g].matched ? Dictionary(m[g].str()) : Dictionary::null();
+    }
+    return out;
+}
+
+void test(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    eachRegex(call, in, env, [&](const Regex& regex) {
+        emit(Dictionary(std::regex_search(in.asStringRef(), regex.re)));
+    });
+}
+
+// Calls `then` with each match of `regex` in `s`: every match with the g
+// flag (or when `all` is set), otherwise the first
+template <typename Then>
+void eachMatch(const Regex& regex, const std::string& s, bool all, Then then) {
+    for (std::sregex_iterator it(s.begin(), s.end(), regex.re), end; it != end; ++it) {
+        then(*it);
+        if (!all && !regex.global) break;
+    }
+}
+
+void match(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    eachRegex(call, in, env, [&](const Regex& regex) {
+        const std::string& s = in.asStringRef();
+        eachMatch(regex, s, false, [&](const std::smatch& m) {
+            std::vector<Dictionary> captures;
+            for (size_t g = 1; g < m.size(); ++g) {
+                Dictionary capture;
+                capture["offset"] = m[g].matched ? codepointCount(s.begin(), m[g].first) : Dictionary(-1);
+                capture["length"] = codepointCount(m[g].first, m[g].second);
+                capture["string"] = m[g].matched ? Dictionary(m[g].str()) : Dictionary::null();
+                bool named = g <= regex.names.size() && !regex.names[g - 1].empty();
+                capture["name"] = named ? Dictionary(regex.names[g - 1]) : Dictionary::null();
+                captures.push_back(capture);
+            }
+            Dictionary out;
+            out["offset"] = codepointCount(s.begin(), m[0].first);
+            out["length"] = codepointCount(m[0].first, m[0].second);
+            out["string"] = m.str();
+            out["captures"] = array(std::move(captures));
+            emit(out);
+        });
+    });
+}
+
+void capture(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    eachRegex(call, in, env, [&](const Regex& regex) {
+        eachMatch(regex, in.asStringRef(), false, [&](const std::smatch& m) {
+            emit(namedCaptures(regex, m));
+        });
+    });
+}
+
+void scan(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    eachRegex(call, in, env, [&](const Regex& regex) {
+        eachMatch(regex, in.asStringRef(), true, [&](const std::smatch& m) {
+            if (m.size() == 1) {
+                emit(Dictionary(m.str()));
+                return;
+            }
+            std::vector<Dictionary> groups;
+            for (size_t g = 1; g < m.size(); ++g) {
+                groups.push_back(m[g].matched ? Dictionary(m[g].str()) : Dictionary::null());
+            }
+            emit(array(std::move(groups)));
+        });
+    });
+}
+
+// split/2: the pieces of the input between the matches
+Dictionary splitOn(const Regex& regex, const std::string& s) {
+    std::vector<Dictionary> parts;
+    auto position = s.cbegin();
+    eachMatch(regex, s, true, [&](const std::smatch& m) {
+        parts.emplace_back(std::string(position, m[0].first));
+        position = m[0].second;
+    });
+    parts.emplace_back(std::string(position, s.cend()));
+    return array(std::move(parts));
+}
+
+void splitRegex(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    eachRegex(call, in, env, [&](const Regex& regex) { emit(splitOn(regex, in.asStringRef())); });
+}
+
+void splits(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    eachRegex(call, in, env, [&](const Regex& regex) {
+        Dictionary parts = splitOn(regex, in.asStringRef());
+        for (const auto& part : parts.elements()) emit(part.second);
+    });
+}
+
+template <bool Global>
+void substitute(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    eachRegex(call, in, env, [&](const Regex& regex) {
+        const std::string& s = in.asStringRef();
+        std::string out;
+        auto position = s.cbegin();
+        auto flags = std::regex_constants::match_default;
+        std::smatch m;
+        while (position != s.cend() && std::regex_search(position, s.cend(), m, regex.re, flags)) {
+            out.append(position, m[0].first);
+            // The replacement sees the named captures, {} without any
+            Slot replacement = firstOutput(call.arg(1), namedCaptures(regex, m), env);
+            if (replacement && !replacement->isString()) {
+                fail(describe(*replacement) + " cannot be added to a string");
+            }
+            if (replacement) out += replacement->asStringRef();
+            position = m[0].second;
+            if (m[0].length() == 0) out += *position++;
+            flags |= std::regex_constants::match_prev_avail;
+            if (!Global && !regex.global) break;
+        }
+        out.append(position, s.cend());
+        emit(Dictionary(out));
+    });
+}
+
+void empty(const Call&, const Dictionary&, const Env*, Emit) {}
+
+void emptyPaths(const Call&, const Dictionary&, const Env*, Path&, PathEmit) {}
+
+void error0(const Call&, const Dictionary& in, const Env*, Emit) { throw FilterError(in); }
+
+void error1(const Call& call, const Dictionary& in, const Env* env, Emit) {
+    call.arg(0).eval(in, env, [](const Dictionary& message) { throw FilterError(message); });
+}
+
+void values(const Call&, const Dictionary& in, const Env*, Emit emit) {
+    if (!in.isNull()) emit(in);
+}
+
+void select(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& c) {
+        if (truthy(c)) emit(in);
+    });
+}
+
+void selectPaths(const Call& call, const Dictionary& in, const Env* env, Path& path, PathEmit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& c) {
+        if (truthy(c)) emit(path, in);
+    });
+}
+
+void map(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    std::vector<Dictionary> out;
+    iterate(in, [&](const Dictionary& v) {
+        call.arg(0).eval(v, env, [&](const Dictionary& r) { out.push_back(r); });
+    });
+    emit(array(std::move(out)));
+}
+
+void mapValues(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    // .[] |= f: the first output of f replaces each value, none deletes it
+    if (in.isArrayObject()) {
+        std::vector<Dictionary> out;
+        for (const auto* value : items(in)) {
+            if (Slot r = firstOutput(call.arg(0), *value, env)) out.push_back(*r);
+        }
+        emit(array(std::move(out)));
+    } else if (in.isMappedObject()) {
+        Dictionary out;
+        for (const auto& member : in.members()) {
+            if (Slot r = firstOutput(call.arg(0), member.second, env)) out[member.first] = *r;
+        }
+        emit(out);
+    } else {
+        failIterate(in);
+    }
+}
+
+void recurse0(const Call&, const Dictionary& in, const Env*, Emit emit) { recurseAll(in, emit); }
+
+void recurse0Paths(const Call&, const Dictionary& in, const Env*, Path& path, PathEmit emit) {
+    recurseAllPaths(in, path, emit);
+}
+
+void recurseWith(const Expr& f, const Expr* condition, const Dictionary& in, const Env* env, Emit emit) {
+    emit(in);
+    f.eval(in, env, [&](const Dictionary& child) {
+        if (condition) {
+            Slot keep = firstOutput(*condition, child, env);
+            if (!keep || !truthy(*keep)) return;
+        }
+        recurseWith(f, condition, child, env, emit);
+    });
+}
+
+void recurse1(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    recurseWith(call.arg(0), nullptr, in, env, emit);
+}
+
+void recurse2(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    recurseWith(call.arg(0), &call.arg(1), in, env, emit);
+}
+
+void recursePathsWith(const Expr& f, const Dictionary& in, const Env* env, Path& path, PathEmit emit) {
+    emit(path, in);
+    f.paths(in, env, path, [&](Path& p, const Dictionary& child) { recursePathsWith(f, child, env, p, emit); });
+}
+
+void recurse1Paths(const Call& call, const Dictionary& in, const Env* env, Path& path, PathEmit emit) {
+    recursePathsWith(call.arg(0), in, env, path, emit);
+}
+
+void walkWith(const Expr& f, const Dictionary& in, const Env* env, Emit emit) {
+    if (in.isArrayObject()) {
+        std::vector<Dictionary> children;
+        for (const auto* value : items(in)) {
+            walkWith(f, *value, env, [&](const Dictionary& v) { children.push_back(v); });
+        }
+        f.eval(array(std::move(children)), env, emit);
+    } else if (in.isMappedObject()) {
+        Dictionary rebuilt;
+        for (const auto& member : in.members()) {
+            Slot last;
+            walkWith(f, member.second, env, [&](const Dictionary& v) { last = std::make_unique<Dictionary>(v); });
+            if (last) rebuilt[member.first] = *last;
+        }
+        f.eval(rebuilt, env, emit);
+    } else {
+        f.eval(in, env, emit);
+    }
+}
+
+void walk(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    walkWith(call.arg(0), in, env, emit);
+}
+
+// The elements of `in` with the [f] key of each, stably sorted by key
+std::vector<std::pair<Dictionary, const Dictionary*>> sortedBy(const Call& call,
+                                                               const Dictionary& in,
+                                                               const Env* env,
+                                                               const char* verb) {
+    if (!in.isArrayObject()) fail(describe(in) + " cannot be " + verb + ", as it is not an array");
+    std::vector<std::pair<Dictionary, const Dictionary*>> out;
+    for (const auto* value : items(in)) out.emplace_back(array(collect(call.arg(0), *value, env)), value);
+    std::stable_sort(out.begin(), out.end(), [](const auto& a, const auto& b) {
+        return compare(a.first, b.first) < 0;
+    });
+    return out;
+}
+
+void sortBy(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    std::vector<const Dictionary*> out;
+    for (const auto& entry : sortedBy(call, in, env, "sorted")) out.push_back(entry.second);
+    emit(array(out));
+}
+
+void groupBy(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    auto sorted = sortedBy(call, in, env, "grouped");
+    std::vector<Dictionary> groups;
+    std::vector<const Dictionary*> group;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (i > 0 && !equal(sorted[i - 1].first, sorted[i].first)) {
+            groups.push_back(array(group));
+            group.clear();
+        }
+        group.push_back(sorted[i].second);
+    }
+    if (!group.empty()) groups.push_back(array(group));
+    emit(array(std::move(groups)));
+}
+
+void uniqueBy(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    auto sorted = sortedBy(call, in, env, "sorted");
+    std::vector<const Dictionary*> out;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (i == 0 || !equal(sorted[i - 1].first, sorted[i].first)) out.push_back(sorted[i].second);
+    }
+    emit(array(out));
+}
+
+template <bool Max>
+void extremeBy(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    auto sorted = sortedBy(call, in, env, "sorted");
+    if (sorted.empty()) {
+        emit(nullValue());
+        return;
+    }
+    if (!Max) {
+        emit(*sorted.front().second);
+        return;
+    }
+    // jq's max_by picks the last of equal maxima
+    emit(*sorted.back().second);
+}
+
+template <bool All>
+void anyAllOf(const Expr& generator, const Expr& condition, const Dictionary& in, const Env* env, Emit emit) {
+    bool result = All;
+    int stop = 0;
+    try {
+        generator.eval(in, env, [&](const Dictionary& v) {
+            condition.eval(v, env, [&](const Dictionary& c) {
+                if (truthy(c) != All) {
+                    result = !All;
+                    throw Stop{&stop};
+                }
+            });
+        });
+    } catch (const Stop& s) {
+        if (s.owner != &stop) throw;
+    }
+    emit(Dictionary(result));
+}
+
+template <bool All>
+void anyAll1(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    Iterate elements(nullptr);
+    anyAllOf<All>(elements, call.arg(0), in, env, emit);
+}
+
+template <bool All>
+void anyAll2(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    anyAllOf<All>(call.arg(0), call.arg(1), in, env, emit);
+}
+
+void pow2(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(1).eval(in, env, [&](const Dictionary& b) {
+        call.arg(0).eval(in, env, [&](const Dictionary& a) {
+            if (!isNumber(a) || !isNumber(b)) fail(describe(a) + " number required");
+            emit(number(std::pow(toDouble(a), toDouble(b))));
+        });
+    });
+}
+
+void emitRange(double from, double upto, double by, Emit emit) {
+    if (by > 0) {
+        for (double x = from; x < upto; x += by) emit(number(x));
+    } else if (by < 0) {
+        for (double x = from; x > upto; x += by) emit(number(x));
+    }
+}
+
+double rangeBound(const Dictionary& v) {
+    if (!isNumber(v)) fail("Range bounds must be numeric");
+    return toDouble(v);
+}
+
+void range1(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& upto) { emitRange(0, rangeBound(upto), 1, emit); });
+}
+
+void range2(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& from) {
+        call.arg(1).eval(in, env, [&](const Dictionary& upto) {
+            emitRange(rangeBound(from), rangeBound(upto), 1, emit);
+        });
+    });
+}
+
+void range3(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& from) {
+        call.arg(1).eval(in, env, [&](const Dictionary& upto) {
+            call.arg(2).eval(in, env, [&](const Dictionary& by) {
+                emitRange(rangeBound(from), rangeBound(upto), rangeBound(by), emit);
+            });
+        });
+    });
+}
+
+void path(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    Path buffer;
+    call.arg(0).paths(in, env, buffer, [&](Path& p, const Dictionary&) { emit(pathToArray(p)); });
+}
+
+void paths0(const Call&, const Dictionary& in, const Env*, Emit emit) {
+    Path buffer;
+    recurseAllPaths(in, buffer, [&](Path& p, const Dictionary&) {
+        if (!p.empty()) emit(pathToArray(p));
+    });
+}
+
+void pathsWhere(const Expr& f, const Dictionary& in, const Env* env, Emit emit) {
+    Path buffer;
+    recurseAllPaths(in, buffer, [&](Path& p, const Dictionary& v) {
+        if (p.empty()) return;
+        f.eval(v, env, [&](const Dictionary& c) {
+            if (truthy(c)) emit(pathToArray(p));
+        });
+    });
+}
+
+void paths1(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    pathsWhere(call.arg(0), in, env, emit);
+}
+
+void leafPaths(const Call&, const Dictionary& in, const Env* env, Emit emit) {
+    Call scalars;
+    static const Builtin scalarsBuiltin{selector<isScalar>, nullptr};
+    scalars.builtin = &scalarsBuiltin;
+    pathsWhere(scalars, in, env, emit);
+}
+
+void getpath(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& p) { emit(getPath(in, arrayToPath(p))); });
+}
+
+void getpathPaths(const Call& call, const Dictionary& in, const Env* env, Path& path, PathEmit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& p) {
+        Path relative = arrayToPath(p);
+        size_t size = path.size();
+        path.insert(path.end(), relative.begin(), relative.end());
+        emit(path, getPath(in, relative));
+        path.resize(size, PathToken::makeIndex(0));
+    });
+}
+
+void setpath(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(1).eval(in, env, [&](const Dictionary& value) {
+        call.arg(0).eval(in, env, [&](const Dictionary& p) {
+            Dictionary out = in;
+            setPath(out, arrayToPath(p), value);
+            emit(out);
+        });
+    });
+}
+
+void delpaths(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& list) {
+        if (!list.isArrayObject()) fail("Paths must be specified as an array");
+        std::vector<Path> doomed;
+        for (const auto* p : items(list)) doomed.push_back(arrayToPath(*p));
+        Dictionary out = in;
+        deletePaths(out, std::move(doomed));
+        emit(out);
+    });
+}
+
+void del(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    Dictionary out = in;
+    deletePaths(out, collectPaths(call.arg(0), in, env));
+    emit(out);
+}
+
+void toEntriesWith(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    std::vector<Dictionary> entries;
+    iterate(toEntries(in), [&](const Dictionary& entry) {
+        call.arg(0).eval(entry, env, [&](const Dictionary& r) { entries.push_back(r); });
+    });
+    emit(fromEntries(array(std::move(entries))));
+}
+
+void first0(const Call&, const Dictionary& in, const Env*, Emit emit) { emit(elementOf(in, 0)); }
+
+void first0Paths(const Call&, const Dictionary& in, const Env*, Path& path, PathEmit emit) {
+    path.push_back(PathToken::makeIndex(0));
+    emit(path, elementOf(in, 0));
+    path.pop_back();
+}
+
+void last0(const Call&, const Dictionary& in, const Env*, Emit emit) { emit(elementOf(in, -1)); }
+
+void last0Paths(const Call&, const Dictionary& in, const Env*, Path& path, PathEmit emit) {
+    path.push_back(PathToken::makeIndex(-1));
+    emit(path, elementOf(in, -1));
+    path.pop_back();
+}
+
+// Emits at most `n` outputs of `f`
+void limitOutputs(int64_t n, const Expr& f, const Dictionary& in, const Env* env, Emit emit) {
+    if (n <= 0) return;
+    int64_t seen = 0;
+    int stop = 0;
+    try {
+        f.eval(in, env, [&](const Dictionary& v) {
+            emit(v);
+            if (++seen == n) throw Stop{&stop};
+        });
+    } catch (const Stop& s) {
+        if (s.owner != &stop) throw;
+    }
+}
+
+void limitPaths(int64_t n, const Expr& f, const Dictionary& in, const Env* env, Path& path, PathEmit emit) {
+    if (n <= 0) return;
+    int64_t seen = 0;
+    int stop = 0;
+    try {
+        f.paths(in, env, path, [&](Path& p, const Dictionary& v) {
+            emit(p, v);
+            if (++seen == n) throw Stop{&stop};
+        });
+    } catch (const Stop& s) {
+        if (s.owner != &stop) throw;
+    }
+}
+
+void first1(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    limitOutputs(1, call.arg(0), in, env, emit);
+}
+
+void first1Paths(const Call& call, const Dictionary& in, const Env* env, Path& path, PathEmit emit) {
+    limitPaths(1, call.arg(0), in, env, path, emit);
+}
+
+void last1(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    Slot last;
+    call.arg(0).eval(in, env, [&](const Dictionary& v) { last = std::make_unique<Dictionary>(v); });
+    if (last) emit(*last);
+}
+
+int64_t count(const Dictionary& n) {
+    if (!isNumber(n)) fail("Invalid limit: " + describe(n));
+    return static_cast<int64_t>(toDouble(n));
+}
+
+void limit(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& n) { limitOutputs(count(n), call.arg(1), in, env, emit); });
+}
+
+void limitPathsBuiltin(const Call& call, const Dictionary& in, const Env* env, Path& path, PathEmit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& n) {
+        limitPaths(count(n), call.arg(1), in, env, path, emit);
+    });
+}
+
+void nth1(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& n) { emit(indexOf(in, n)); });
+}
+
+void nth2(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& n) {
+        int64_t wanted = count(n);
+        if (wanted < 0) fail("Out of bounds negative array index");
+        Slot found;
+        int64_t seen = 0;
+        limitOutputs(wanted + 1, call.arg(1), in, env, [&](const Dictionary& v) {
+            if (seen++ == wanted) found = std::make_unique<Dictionary>(v);
+        });
+        if (found) emit(*found);
+    });
+}
+
+void until(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& done) {
+        if (truthy(done)) {
+            emit(in);
+        } else {
+            call.arg(1).eval(in, env, [&](const Dictionary& next) { until(call, next, env, emit); });
+        }
+    });
+}
+
+void whileLoop(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    call.arg(0).eval(in, env, [&](const Dictionary& going) {
+        if (!truthy(going)) return;
+        emit(in);
+        call.arg(1).eval(in, env, [&](const Dictionary& next) { whileLoop(call, next, env, emit); });
+    });
+}
+
+void repeatLoop(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    emit(in);
+    call.arg(0).eval(in, env, [&](const Dictionary& next) { repeatLoop(call, next, env, emit); });
+}
+
+void isEmpty(const Call& call, const Dictionary& in, const Env* env, Emit emit) {
+    emit(Dictionary(!firstOutput(call.arg(0), in, env)));
+}
+
+void infinite(const Call&, const Dictionary&, const Env*, Emit emit) {
+    emit(Dictionary(std::numeric_limits<double>::infinity()));
+}
+
+void nan(const Call&, const Dictionary&, const Env*, Emit emit) {
+    emit(Dictionary(std::numeric_limits<double>::quiet_NaN()));
+}
+
+void debug(const Call&, const Dictionary& in, const Env*, Emit emit) {
+    std::cerr << "[\"DEBUG:\"," << json(in) << "]" << std::endl;
+    emit(in);
+}
+
+} // namespace
+
+const Builtin* findBuiltin(const std::string& name, size_t arity) {
+    static const std::unordered_map<std::string, Builtin> builtins = {
+            {"empty/0", {empty, emptyPaths}},
+            {"error/0", {error0, emptyPaths}},
+            {"error/1", {error1, emptyPaths}},
+            {"not/0", {unary<logicalNot>, nullptr}},
+            {"length/0", {unary<length>, nullptr}},
+            {"utf8bytelength/0", {unary<utf8ByteLength>, nullptr}},
+            {"keys/0", {unary<keys>, nullptr}},
+            {"keys_unsorted/0", {unary<keys>, nullptr}},
+            {"values/0", {values, selectorPaths<isNotNull>}},
+            {"type/0", {unary<type>, nullptr}},
+            {"tostring/0", {unary<toString>, nullptr}},
+            {"tonumber/0", {unary<toNumber>, nullptr}},
+            {"tojson/0", {unary<toJson>, nullptr}},
+            {"fromjson/0", {unary<fromJson>, nullptr}},
+            {"ascii_downcase/0", {unary<asciiCase<lowerAscii>>, nullptr}},
+            {"ascii_upcase/0", {unary<asciiCase<upperAscii>>, nullptr}},
+            {"explode/0", {unary<explode>, nullptr}},
+            {"implode/0", {unary<implode>, nullptr}},
+            {"ltrimstr/1", {binary<ltrimstr>, nullptr}},
+            {"rtrimstr/1", {binary<rtrimstr>, nullptr}},
+            {"startswith/1", {binary<startsWithFn>, nullptr}},
+            {"endswith/1", {binary<endsWithFn>, nullptr}},
+            {"trim/0", {unary<trim<true, true>>, nullptr}},
+            {"ltrim/0", {unary<trim<true, false>>, nullptr}},
+            {"rtrim/0", {unary<trim<false, true>>, nullptr}},
+            {"split/1", {binary<splitFn>, nullptr}},
+            {"join/1", {binary<join>, nullptr}},
+            {"test/1", {test, nullptr, 0}},
+            {"test/2", {test, nullptr, 1}},
+            {"scan/1", {scan, nullptr, 0}},
+            {"scan/2", {scan, nullptr, 1}},
+            {"match/1", {match, nullptr, 0}},
+            {"match/2", {match, nullptr, 1}},
+            {"capture/1", {capture, nullptr, 0}},
+            {"capture/2", {capture, nullptr, 1}},
+            {"split/2", {splitRegex, nullptr, 1}},
+            {"splits/1", {splits, nullptr, 0}},
+            {"splits/2", {splits, nullptr, 1}},
+            {"sub/2", {substitute<false>, nullptr, 0}},
+            {"sub/3", {substitute<false>, nullptr, 2}},
+            {"gsub/2", {substitute<true>, nullptr, 0}},
+            {"gsub/3", {substitute<true>, nullptr, 2}},
+            {"indices/1", {binary<indices>, nullptr}},
+            {"index/1", {binary<firstIndex>, nullptr}},
+            {"rindex/1", {binary<lastIndex>, nullptr}},
+            {"to_entries/0", {unary<toEntries>, nullptr}},
+            {"from_entries/0", {unary<fromEntries>, nullptr}},
+            {"with_entries/1", {toEntriesWith, nullptr}},
+            {"has/1", {binary<has>, nullptr}},
+            {"in/1", {binary<inFn>, nullptr}},
+            {"contains/1", {binary<contains>, nullptr}},
+            {"inside/1", {binary<inside>, nullptr}},
+            {"select/1", {select, selectPaths}},
+            {"map/1", {map, nullptr}},
+            {"map_values/1", {mapValues, nullptr}},
+            {"recurse/0", {recurse0, recurse0Paths}},
+            {"recurse/1", {recurse1, recurse1Paths}},
+            {"recurse/2", {recurse2, nullptr}},
+            {"walk/1", {walk, nullptr}},
+            {"sort/0", {unary<sort>, nullptr}},
+            {"sort_by/1", {sortBy, nullptr}},
+            {"group_by/1", {groupBy, nullptr}},
+            {"unique/0", {unary<unique>, nullptr}},
+            {"unique_by/1", {uniqueBy, nullptr}},
+            {"min/0", {unary<minimum>, nullptr}},
+            {"max/0", {unary<maximum>, nullptr}},
+            {"min_by/1", {extremeBy<false>, nullptr}},
+            {"max_by/1", {extremeBy<true>, nullptr}},
+            {"add/0", {unary<addAll>, nullptr}},
+            {"reverse/0", {unary<reverse>, nullptr}},
+            {"flatten/0", {unary<flatten>, nullptr}},
+            {"flatten/1", {binary<flattenTo>, nullptr}},
+            {"any/0", {unary<anyAll<false>>, nullptr}},
+            {"all/0", {unary<anyAll<true>>, nullptr}},
+            {"any/1", {anyAll1<false>, nullptr}},
+            {"all/1", {anyAll1<true>, nullptr}},
+            {"any/2", {anyAll2<false>, nullptr}},
+            {"all/2", {anyAll2<true>, nullptr}},
+            {"floor/0", {unary<math<std::floor>>, nullptr}},
+            {"ceil/0", {unary<math<std::ceil>>, nullptr}},
+            {"round/0", {unary<math<roundHalfAway>>, nullptr}},
+            {"sqrt/0", {unary<math<std::sqrt>>, nullptr}},
+            {"fabs/0", {unary<math<std::fabs>>, nullptr}},
+            {"abs/0", {unary<abs>, nullptr}},
+            {"log/0", {unary<math<std::log>>, nullptr}},
+            {"log2/0", {unary<math<std::log2>>, nullptr}},
+            {"log10/0", {unary<math<std::log10>>, nullptr}},
+            {"exp/0", {unary<math<std::exp>>, nullptr}},
+            {"exp2/0", {unary<math<std::exp2>>, nullptr}},
+            {"exp10/0", {unary<math<exp10>>, nullptr}},
+            {"pow/2", {pow2, nullptr}},
+            {"infinite/0", {infinite, nullptr}},
+            {"nan/0", {nan, nullptr}},
+            {"isnan/0", {unary<isNan>, nullptr}},
+            {"isinfinite/0", {unary<isInfinite>, nullptr}},
+            {"isnormal/0", {unary<isNormal>, nullptr}},
+            {"range/1", {range1, nullptr}},
+            {"range/2", {range2, nullptr}},
+            {"range/3", {range3, nullptr}},
+            {"path/1", {path, nullptr}},
+            {"paths/0", {paths0, nullptr}},
+            {"paths/1", {paths1, nullptr}},
+            {"leaf_paths/0", {leafPaths, nullptr}},
+            {"getpath/1", {getpath, getpathPaths}},
+            {"setpath/2", {setpath, nullptr}},
+            {"delpaths/1", {delpaths, nullptr}},
+            {"del/1", {del, nullptr}},
+            {"first/0", {first0, first0Paths}},
+            {"last/0", {last0, last0Paths}},
+            {"first/1", {first1, first1Paths}},
+            {"last/1", {last1, nullptr}},
+            {"limit/2", {limit, limitPathsBuiltin}},
+            {"nth/1", {nth1, nullptr}},
+            {"nth/2", {nth2, nullptr}},
+            {"until/2", {until, nullptr}},
+            {"while/2", {whileLoop, nullptr}},
+            {"repeat/1", {repeatLoop, nullptr}},
+            {"isempty/1", {isEmpty, nullptr}},
+            {"arrays/0", {selector<isArray>, selectorPaths<isArray>}},
+            {"objects/0", {selector<isObject>, selectorPaths<isObject>}},
+            {"iterables/0", {selector<isIterable>, selectorPaths<isIterable>}},
+            {"booleans/0", {selector<isBoolean>, selectorPaths<isBoolean>}},
+            {"numbers/0", {selector<isNumberValue>, selectorPaths<isNumberValue>}},
+            {"strings/0", {selector<isStringValue>, selectorPaths<isStringValue>}},
+            {"nulls/0", {selector<isNullValue>, selectorPaths<isNullValue>}},
+            {"scalars/0", {selector<isScalar>, selectorPaths<isScalar>}},
+            {"debug/0", {debug, nullptr}},
+    };
+    auto it = builtins.find(name + "/" + std::to_string(arity));
+    return it == builtins.end() ? nullptr : &it->second;
+}
+
+void precompileRegex(Call& call) {
+    int flags = call.builtin->regexFlags;
+    if (flags < 0) return;
+    const Dictionary* pattern = call.args[0]->constant();
+    const Dictionary* options = flags > 0 ? call.args[static_cast<size_t>(flags)]->constant() : nullptr;
+    if (!pattern || (flags > 0 && !options)) return;
+    try {
+        call.regex = std::make_shared<const Regex>(compileRegex(*pattern, options));
+    } catch (const FilterError&) {
+        // Reported when the filter runs, like any other runtime error
+    }
+}
+
+} // namespace filter
+} // namespace pq
+} // namespace ps
@@ -0,0 +1,720 @@
+#include "filter_eval.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <set>
+
+namespace ps {
+namespace pq {
+namespace filter {
+
+namespace {
+
+const Dictionary& lookup(const Env* env, size_t depth) {
+    for (size_t i = 0; i < depth; ++i) env = env->parent;
+    return *env->value;
+}
+
+// The child of `node` at `token`, created (as null) if missing
+Dictionary& writableChild(Dictionary& node, const PathToken& token) {
+    if (token.isKey()) {
+        const std::string& key = token.asKey();
+        if (node.isNull()) node = Dictionary();
+        if (!node.isMappedObject()) fieldOf(node, key);  // throws the type error
+        if (!node.has(key)) node[key] = Dictionary::null();
+        return node[key];
+    }
+    if (node.isNull()) node = emptyArray();
+    if (!node.isArrayObject()) elementOf(node, token.asIndex());
+    int size = node.size();
+    int index = token.asIndex();
+    if (index < 0) index += size;
+    if (index < 0) fail("Out of bounds negative array index");
+    for (int i = size; i <= index; ++i) node[i] = Dictionary::null();
+    return node.at(index);
+}
+
+// jq orders path components as values: numbers before strings
+bool pathLess(const Path& a, const Path& b) {
+    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+        const auto& x = a[i];
+        const auto& y = b[i];
+        if (x.isKey() != y.isKey()) return !x.isKey();
+        if (x.isKey()) {
+            if (x.asKey() != y.asKey()) return x.asKey() < y.asKey();
+        } else if (x.asIndex() != y.asIndex()) {
+            return x.asIndex() < y.asIndex();
+        }
+    }
+    return a.size() < b.size();
+}
+
+bool sameToken(const PathToken& a, const PathToken& b) {
+    if (a.isKey() != b.isKey()) return false;
+    return a.isKey() ? a.asKey() == b.asKey() : a.asIndex() == b.asIndex();
+}
+
+void iteratePaths(const Dictionary& in, Path& path, PathEmit emit) {
+    if (in.isArrayObject()) {
+        for (const auto& element : in.elements()) {
+            path.push_back(PathToken::makeIndex(element.first));
+            emit(path, element.second);
+            path.pop_back();
+        }
+    } else if (in.isMappedObject()) {
+        for (const auto& member : in.members()) {
+            path.push_back(PathToken::makeKey(member.first));
+            emit(path, member.second);
+            path.pop_back();
+        }
+    } else if (!in.isNull()) {
+        // Iterating a path that does not exist yet gives no paths
+        failIterate(in);
+    }
+}
+
+// Runs `target` (or passes `in` through when there is none) and calls `then`
+// with each output
+template <typename Then>
+void eachTarget(const Expr* target, const Dictionary& in, const Env* env, Then then) {
+    if (target) {
+        target->eval(in, env, then);
+    } else {
+        then(in);
+    }
+}
+
+template <typename Then>
+void eachTargetPath(const Expr* target,
+                    const Dictionary& in,
+                    const Env* env,
+                    Path& path,
+                    Then then) {
+    if (target) {
+        target->paths(in, env, path, then);
+    } else {
+        then(path, in);
+    }
+}
+
+Dictionary slice(const Dictionary& v, const Dictionary& from, const Dictionary& to) {
+    if (v.isNull()) return Dictionary::null();
+    if ((!from.isNull() && !isNumber(from)) || (!to.isNull() && !isNumber(to))) {
+        fail("Start and end indices of an array slice must be numbers");
+    }
+    if (!v.isArrayObject() && !v.isString()) fail("Cannot index " + typeName(v) + " with object");
+
+    std::vector<uint32_t> text;
+    int64_t size = 0;
+    if (v.isString()) {
+        text = codepoints(v.asStringRef());
+        size = static_cast<int64_t>(text.size());
+    } else {
+        size = v.size();
+    }
+    auto clamp = [size](const Dictionary& bound, int64_t otherwise) {
+        if (bound.isNull()) return otherwise;
+        int64_t i = static_cast<int64_t>(std::floor(toDouble(bound)));
+        if (i < 0) i += size;
+        return std::max<int64_t>(0, std::min(i, size));
+    };
+    int64_t begin = clamp(from, 0);
+    int64_t end = std::max(begin, clamp(to, size));
+
+    if (v.isString()) {
+        std::string out;
+        for (int64_t i = begin; i < end; ++i) appendUtf8(out, text[static_cast<size_t>(i)]);
+        return Dictionary(out);
+    }
+    std::vector<const Dictionary*> out;
+    for (int64_t i = begin; i < end; ++i) out.push_back(&v.at(static_cast<int>(i)));
+    return array(out);
+}
+
+// Bounds are evaluated against the input of the slice, not the target;
+// an omitted bound is null
+template <typename Then>
+void sliceBound(const Expr* e, const Dictionary& in, const Env* env, Then then) {
+    if (e) {
+        e->eval(in, env, then);
+    } else {
+        then(nullValue());
+    }
+}
+
+Dictionary apply(Op op, const Dictionary& a, const Dictionary& b) {
+    switch (op) {
+        case Op::Add: return add(a, b);
+        case Op::Sub: return subtract(a, b);
+        case Op::Mul: return multiply(a, b);
+        case Op::Div: return divide(a, b);
+        case Op::Mod: return modulo(a, b);
+        case Op::Eq: return Dictionary(equal(a, b));
+        case Op::Ne: return Dictionary(!equal(a, b));
+        case Op::Lt: return Dictionary(compare(a, b) < 0);
+        case Op::Le: return Dictionary(compare(a, b) <= 0);
+        case Op::Gt: return Dictionary(compare(a, b) > 0);
+        case Op::Ge: return Dictionary(compare(a, b) >= 0);
+    }
+    return Dictionary::null();
+}
+
+// lhs |= f on a copy of `in`: each path gets the first output of f, or is
+// deleted when f has none
+Dictionary modify(const Expr& lhs, const Dictionary& in, const Env* env, const Expr& update) {
+    Dictionary out = in;
+    std::vector<Path> doomed;
+    for (const auto& path : collectPaths(lhs, in, env)) {
+        Slot first = firstOutput(update, getPath(out, path), env);
+        if (first) {
+            setPath(out, path, std::move(*first));
+        } else {
+            doomed.push_back(path);
+        }
+    }
+    if (!doomed.empty()) deletePaths(out, std::move(doomed));
+    return out;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Paths
+// ---------------------------------------------------------------------------
+
+Dictionary pathToArray(const Path& path) {
+    std::vector<Dictionary> out;
+    out.reserve(path.size());
+    for (const auto& token : path) {
+        if (token.isKey()) {
+            out.emplace_back(token.asKey());
+        } else {
+            out.emplace_back(static_cast<int64_t>(token.asIndex()));
+        }
+    }
+    return array(std::move(out));
+}
+
+Path arrayToPath(const Dictionary& value) {
+    if (!value.isArrayObject()) fail("Path must be specified as an array");
+    Path path;
+    for (const auto* token : items(value)) {
+        if (token->isString()) {
+            path.push_back(PathToken::makeKey(token->asStringRef()));
+        } else if (isNumber(*token)) {
+            path.push_back(PathToken::makeIndex(static_cast<int>(std::floor(toDouble(*token)))));
+        } else {
+            fail("Cannot index with " + typeName(*token) + " in a path");
+        }
+    }
+    return path;
+}
+
+const Dictionary& getPath(const Dictionary& root, const Path& path) {
+    const Dictionary* node = &root;
+    for (const auto& token : path) {
+        if (node->isNull()) return nullValue();
+        node = token.isKey() ? &fieldOf(*node, token.asKey()) : &elementOf(*node, token.asIndex());
+    }
+    return *node;
+}
+
+void setPath(Dictionary& root, const Path& path, Dictionary value) {
+    Dictionary* node = &root;
+    for (const auto& token : path) node = &writableChild(*node, token);
+    *node = std::move(value);
+}
+
+void deletePaths(Dictionary& root, std::vector<Path> paths) {
+    // Delete the last paths first so earlier array indices stay valid, and
+    // rebuild each array once for all of its deleted elements
+    std::sort(paths.begin(), paths.end(), [](const Path& a, const Path& b) { return pathLess(b, a); });
+    for (size_t i = 0; i < paths.size();) {
+        const Path& path = paths[i];
+        if (path.empty()) {
+            root = Dictionary::null();
+            return;
+        }
+        size_t end = i + 1;
+        while (end < paths.size() && paths[end].size() == path.size() &&
+               std::equal(path.begin(), path.end() - 1, paths[end].begin(), sameToken)) {
+            ++end;
+        }
+
+        Dictionary* parent = &root;
+        for (size_t t = 0; t + 1 < path.size() && parent; ++t) {
+            const auto& token = path[t];
+            if (token.isKey()) {
+                parent = parent->isMappedObject() && parent->has(token.asKey())
+                                 ? &parent->at(token.asKey())
+                                 : nullptr;
+            } else {
+                int size = parent->isArrayObject() ? parent->size() : 0;
+                int index = token.asIndex() < 0 ? token.asIndex() + size : token.asIndex();
+                parent = index >= 0 && index < size ? &parent->at(index) : nullptr;
+            }
+        }
+
+        if (parent && !parent->isNull()) {
+            if (path.back().isKey()) {
+                if (!parent->isMappedObject()) {
+                    fail("Cannot delete field at object index of " + typeName(*parent));
+                }
+                for (size_t p = i; p < end; ++p) parent->erase(paths[p].back().asKey());
+            } else {
+                if (!parent->isArrayObject()) {
+                    fail("Cannot delete field at index of " + typeName(*parent));
+                }
+                int size = parent->size();
+                std::set<int> doomed;
+                for (size_t p = i; p < end; ++p) {
+                    int index = paths[p].back().asIndex();
+                    doomed.insert(index < 0 ? index + size : index);
+                }
+                std::vector<const Dictionary*> kept;
+                for (const auto& element : parent->elements()) {
+                    if (!doomed.count(element.first)) kept.push_back(&element.second);
+                }
+                *parent = array(kept);
+            }
+        }
+        i = end;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Evaluation
+// ---------------------------------------------------------------------------
+
+// Calls `emit` with `in` and every value below it, parents first
+void recurseAll(const Dictionary& in, Emit emit) {
+    emit(in);
+    if (in.isArrayObject()) {
+        for (const auto& element : in.elements()) recurseAll(element.second, emit);
+    } else if (in.isMappedObject()) {
+        for (const auto& member : in.members()) recurseAll(member.second, emit);
+    }
+}
+
+void recurseAllPaths(const Dictionary& in, Path& path, PathEmit emit) {
+    emit(path, in);
+    if (in.isArrayObject()) {
+        for (const auto& element : in.elements()) {
+            path.push_back(PathToken::makeIndex(element.first));
+            recurseAllPaths(element.second, path, emit);
+            path.pop_back();
+        }
+    } else if (in.isMappedObject()) {
+        for (const auto& member : in.members()) {
+            path.push_back(PathToken::makeKey(member.first));
+            recurseAllPaths(member.second, path, emit);
+            path.pop_back();
+        }
+    }
+}
+
+[[noreturn]] void failIterate(const Dictionary& v) {
+    fail(v.isNull() ? std::string("Cannot iterate over null") : "Cannot iterate over " + describe(v));
+}
+
+void iterate(const Dictionary& in, Emit emit) {
+    if (in.isArrayObject()) {
+        for (const auto& element : in.elements()) emit(element.second);
+    } else if (in.isMappedObject()) {
+        for (const auto& member : in.members()) emit(member.second);
+    } else {
+        failIterate(in);
+    }
+}
+
+// The first output of `e`, without running it any further
+Slot firstOutput(const Expr& e, const Dictionary& in, const Env* env) {
+    Slot first;
+    int stop = 0;
+    try {
+        e.eval(in, env, [&](const Dictionary& v) {
+            first = std::make_unique<Dictionary>(v);
+            throw Stop{&stop};
+        });
+    } catch (const Stop& s) {
+        if (s.owner != &stop) throw;
+    }
+    return first;
+}
+
+std::vector<Dictionary> collect(const Expr& e, const Dictionary& in, const Env* env) {
+    std::vector<Dictionary> out;
+    e.eval(in, env, [&](const Dictionary& v) { out.push_back(v); });
+    return out;
+}
+
+std::vector<Path> collectPaths(const Expr& expr, const Dictionary& in, const Env* env) {
+    std::vector<Path> out;
+    Path path;
+    expr.paths(in, env, path, [&](Path& p, const Dictionary&) { out.push_back(p); });
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Evaluation nodes
+// ---------------------------------------------------------------------------
+
+void Expr::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    (void)path;
+    (void)emit;
+    eval(in, env, [](const Dictionary& value) {
+        std::string text = json(value);
+        if (text.size() > 11) text = text.substr(0, 10) + "...";
+        fail("Invalid path expression with result " + text);
+    });
+}
+
+void Identity::eval(const Dictionary& in, const Env*, Emit emit) const { emit(in); }
+
+void Identity::paths(const Dictionary& in, const Env*, Path& path, PathEmit emit) const {
+    emit(path, in);
+}
+
+void RecurseAll::eval(const Dictionary& in, const Env*, Emit emit) const { recurseAll(in, emit); }
+
+void RecurseAll::paths(const Dictionary& in, const Env*, Path& path, PathEmit emit) const {
+    recurseAllPaths(in, path, emit);
+}
+
+void Literal::eval(const Dictionary&, const Env*, Emit emit) const { emit(value); }
+
+const Dictionary* Literal::constant() const { return &value; }
+
+void Variable::eval(const Dictionary&, const Env* env, Emit emit) const {
+    emit(lookup(env, depth));
+}
+
+void Field::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    eachTarget(target.get(), in, env, [&](const Dictionary& v) { emit(fieldOf(v, key)); });
+}
+
+void Field::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    eachTargetPath(target.get(), in, env, path, [&](Path& p, const Dictionary& v) {
+        p.push_back(PathToken::makeKey(key));
+        emit(p, fieldOf(v, key));
+        p.pop_back();
+    });
+}
+
+void Index::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    eachTarget(target.get(), in, env, [&](const Dictionary& v) {
+        index->eval(in, env, [&](const Dictionary& i) { emit(indexOf(v, i)); });
+    });
+}
+
+void Index::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    eachTargetPath(target.get(), in, env, path, [&](Path& p, const Dictionary& v) {
+        index->eval(in, env, [&](const Dictionary& i) {
+            const Dictionary& found = indexOf(v, i);
+            p.push_back(i.isString() ? PathToken::makeKey(i.asStringRef())
+                                     : PathToken::makeIndex(static_cast<int>(std::floor(toDouble(i)))));
+            emit(p, found);
+            p.pop_back();
+        });
+    });
+}
+
+void Slice::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    eachTarget(target.get(), in, env, [&](const Dictionary& v) {
+        sliceBound(to.get(), in, env, [&](const Dictionary& end) {
+            sliceBound(from.get(), in, env, [&](const Dictionary& begin) {
+                emit(slice(v, begin, end));
+            });
+        });
+    });
+}
+
+void Iterate::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    eachTarget(target.get(), in, env, [&](const Dictionary& v) { iterate(v, emit); });
+}
+
+void Iterate::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    eachTargetPath(target.get(), in, env, path, [&](Path& p, const Dictionary& v) {
+        iteratePaths(v, p, emit);
+    });
+}
+
+void Pipe::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    lhs->eval(in, env, [&](const Dictionary& v) { rhs->eval(v, env, emit); });
+}
+
+void Pipe::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    lhs->paths(in, env, path, [&](Path& p, const Dictionary& v) { rhs->paths(v, env, p, emit); });
+}
+
+void Comma::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    lhs->eval(in, env, emit);
+    rhs->eval(in, env, emit);
+}
+
+void Comma::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    lhs->paths(in, env, path, emit);
+    rhs->paths(in, env, path, emit);
+}
+
+void Neg::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    operand->eval(in, env, [&](const Dictionary& v) { emit(negate(v)); });
+}
+
+void Binary::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    // Like jq, the right-hand side is the outer loop: (1,2) + (10,20) gives 11 12 21 22
+    if (const Dictionary* c = rhs->constant()) {
+        lhs->eval(in, env, [&](const Dictionary& a) { emit(apply(op, a, *c)); });
+        return;
+    }
+    rhs->eval(in, env, [&](const Dictionary& b) {
+        lhs->eval(in, env, [&](const Dictionary& a) { emit(apply(op, a, b)); });
+    });
+}
+
+void And::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    lhs->eval(in, env, [&](const Dictionary& a) {
+        if (!truthy(a)) {
+            emit(Dictionary(false));
+            return;
+        }
+        rhs->eval(in, env, [&](const Dictionary& b) { emit(Dictionary(truthy(b))); });
+    });
+}
+
+void Or::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    lhs->eval(in, env, [&](const Dictionary& a) {
+        if (truthy(a)) {
+            emit(Dictionary(true));
+            return;
+        }
+        rhs->eval(in, env, [&](const Dictionary& b) { emit(Dictionary(truthy(b))); });
+    });
+}
+
+void Alternative::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    bool any = false;
+    guarded(
+            emit,
+            [&](Emit out) {
+                lhs->eval(in, env, [&](const Dictionary& v) {
+                    if (truthy(v)) {
+                        any = true;
+                        out(v);
+                    }
+                });
+            },
+            [](const Dictionary&) {});
+    if (!any) rhs->eval(in, env, emit);
+}
+
+void Alternative::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    bool any = false;
+    guarded(
+            emit,
+            [&](PathEmit out) {
+                lhs->paths(in, env, path, [&](Path& p, const Dictionary& v) {
+                    if (truthy(v)) {
+                        any = true;
+                        out(p, v);
+                    }
+                });
+            },
+            [](const Dictionary&) {});
+    if (!any) rhs->paths(in, env, path, emit);
+}
+
+void If::eval(const Dictionary& in, const Env* env, Emit emit) const { branch(0, in, env, emit); }
+
+void If::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    branchPaths(0, in, env, path, emit);
+}
+
+void If::branch(size_t i, const Dictionary& in, const Env* env, Emit emit) const {
+    if (i == conditions.size()) {
+        eachTarget(otherwise.get(), in, env, emit);
+        return;
+    }
+    conditions[i].first->eval(in, env, [&](const Dictionary& c) {
+        if (truthy(c)) {
+            conditions[i].second->eval(in, env, emit);
+        } else {
+            branch(i + 1, in, env, emit);
+        }
+    });
+}
+
+void If::branchPaths(size_t i, const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    if (i == conditions.size()) {
+        eachTargetPath(otherwise.get(), in, env, path, emit);
+        return;
+    }
+    conditions[i].first->eval(in, env, [&](const Dictionary& c) {
+        if (truthy(c)) {
+            conditions[i].second->paths(in, env, path, emit);
+        } else {
+            branchPaths(i + 1, in, env, path, emit);
+        }
+    });
+}
+
+void Try::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    guarded(
+            emit,
+            [&](Emit out) { body->eval(in, env, out); },
+            [&](const Dictionary& error) {
+                if (handler) handler->eval(error, env, emit);
+            });
+}
+
+void Try::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    guarded(
+            emit,
+            [&](PathEmit out) { body->paths(in, env, path, out); },
+            [&](const Dictionary&) {});
+}
+
+void Reduce::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    init->eval(in, env, [&](const Dictionary& initial) {
+        Slot acc = std::make_unique<Dictionary>(initial);
+        source->eval(in, env, [&](const Dictionary& x) {
+            Env frame{env, &x};
+            Slot next;
+            update->eval(*acc, &frame, [&](const Dictionary& v) { next = std::make_unique<Dictionary>(v); });
+            acc = next ? std::move(next) : std::make_unique<Dictionary>(Dictionary::null());
+        });
+        emit(*acc);
+    });
+}
+
+void Foreach::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    init->eval(in, env, [&](const Dictionary& initial) {
+        Slot acc = std::make_unique<Dictionary>(initial);
+        source->eval(in, env, [&](const Dictionary& x) {
+            Env frame{env, &x};
+            Slot next;
+            update->eval(*acc, &frame, [&](const Dictionary& v) {
+                next = std::make_unique<Dictionary>(v);
+                eachTarget(extract.get(), *next, &frame, emit);
+            });
+            if (next) acc = std::move(next);
+        });
+    });
+}
+
+void As::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    source->eval(in, env, [&](const Dictionary& x) {
+        Env frame{env, &x};
+        body->eval(in, &frame, emit);
+    });
+}
+
+void As::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    source->eval(in, env, [&](const Dictionary& x) {
+        Env frame{env, &x};
+        body->paths(in, &frame, path, emit);
+    });
+}
+
+void Update::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    if (kind == Assign::Modify) {
+        emit(modify(*lhs, in, env, *rhs));
+        return;
+    }
+    // The right-hand side sees the original input; one result per value
+    rhs->eval(in, env, [&](const Dictionary& value) {
+        Dictionary out = in;
+        for (const auto& path : collectPaths(*lhs, in, env)) {
+            if (kind == Assign::Set) {
+                setPath(out, path, value);
+                continue;
+            }
+            const Dictionary& current = getPath(out, path);
+            if (kind == Assign::Alternative) {
+                if (!truthy(current)) setPath(out, path, value);
+            } else {
+                setPath(out, path, apply(op, current, value));
+            }
+        }
+        emit(out);
+    });
+}
+
+void ArrayCons::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    std::vector<Dictionary> values;
+    if (body) body->eval(in, env, [&](const Dictionary& v) { values.push_back(v); });
+    emit(array(std::move(values)));
+}
+
+void ObjectCons::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    Dictionary out;
+    build(0, out, in, env, emit);
+}
+
+void ObjectCons::build(size_t i, Dictionary& out, const Dictionary& in, const Env* env, Emit emit) const {
+    if (i == entries.size()) {
+        emit(out);
+        return;
+    }
+    const Entry& entry = entries[i];
+    auto withKey = [&](const std::string& key) {
+        entry.value->eval(in, env, [&](const Dictionary& v) {
+            std::optional<Dictionary> previous;
+            if (out.has(key)) previous = out.at(key);
+            out[key] = v;
+            build(i + 1, out, in, env, emit);
+            if (previous) {
+                out[key] = *previous;
+            } else {
+                out.erase(key);
+            }
+        });
+    };
+    if (!entry.key) {
+        withKey(entry.name);
+        return;
+    }
+    entry.key->eval(in, env, [&](const Dictionary& k) {
+        if (!k.isString()) fail("Object keys must be strings");
+        withKey(k.asStringRef());
+    });
+}
+
+void StringInterp::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    std::string tail;
+    build(parts.size(), tail, in, env, emit);
+}
+
+void StringInterp::build(size_t n, const std::string& tail, const Dictionary& in, const Env* env, Emit emit) const {
+    if (n == 0) {
+        emit(Dictionary(tail));
+        return;
+    }
+    const auto& part = parts[n - 1];
+    if (!part.second) {
+        build(n - 1, part.first + tail, in, env, emit);
+        return;
+    }
+    part.second->eval(in, env, [&](const Dictionary& v) {
+        build(n - 1, format(v) + tail, in, env, emit);
+    });
+}
+
+void Format::eval(const Dictionary& in, const Env*, Emit emit) const { emit(Dictionary(format(in))); }
+
+void Call::eval(const Dictionary& in, const Env* env, Emit emit) const {
+    builtin->eval(*this, in, env, emit);
+}
+
+void Call::paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const {
+    if (builtin->paths) {
+        builtin->paths(*this, in, env, path, emit);
+    } else {
+        Expr::paths(in, env, path, emit);
+    }
+}
+
+} // namespace filter
+} // namespace pq
+} // namespace ps
@@ -0,0 +1,439 @@
+#pragma once
+
+#include "filter_value.h"
+
+#include <ps/pq/filter.h>
+#include <ps/pq/path_parser.h>
+#include <exception>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ps {
+namespace pq {
+namespace filter {
+
+// The expression tree a filter is parsed into, and what evaluating it needs.
+// The nodes are defined in filter_eval.cpp, the builtins and @formats in
+// filter_builtins.cpp.
+
+// Non-owning reference to a callable. Outputs are passed down the pipeline
+// through these instead of std::function so that no closure is allocated.
+template <typename Signature>
+class FunctionRef;
+
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+public:
+    template <typename F,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<F>, FunctionRef>::value>>
+    FunctionRef(F&& f)
+        : object_(const_cast<void*>(static_cast<const void*>(std::addressof(f)))),
+          call_([](void* object, Args... args) -> R {
+              return (*static_cast<std::remove_reference_t<F>*>(object))(std::forward<Args>(args)...);
+          }) {}
+
+    R operator()(Args... args) const { return call_(object_, std::forward<Args>(args)...); }
+
+private:
+    void* object_;
+    R (*call_)(void*, Args...);
+};
+
+using Emit = FunctionRef<void(const Dictionary&)>;
+using Path = std::vector<PathToken>;
+// Called with the path of each output and the value found there (null when
+// the path does not exist yet). The path buffer is shared; copy it to keep it.
+using PathEmit = FunctionRef<void(Path&, const Dictionary&)>;
+
+// $variables in scope, innermost first. The parser resolves each variable to
+// its depth so lookups don't compare names.
+struct Env {
+    const Env* parent;
+    const Dictionary* value;
+};
+
+// Thrown through a guarded emit: the error came from downstream of a try (or
+// //), which must not catch it
+struct Downstream {
+    std::exception_ptr error;
+};
+
+// Thrown by first(), limit() etc. to stop a generator early; `owner` is the
+// frame that catches it
+struct Stop {
+    const void* owner;
+};
+
+// Runs `body` with `emit` and passes errors raised by `body` itself (not by
+// the consumers of its outputs) to `onError`
+template <typename EmitFn, typename Body, typename OnError>
+void guarded(EmitFn emit, Body body, OnError onError) {
+    auto wrapped = [&emit](auto&... args) {
+        try {
+            emit(args...);
+        } catch (...) {
+            throw Downstream{std::current_exception()};
+        }
+    };
+    try {
+        body(EmitFn(wrapped));
+    } catch (const Downstream& downstream) {
+        std::rethrow_exception(downstream.error);
+    } catch (const FilterError& e) {
+        onError(e.value());
+    } catch (const std::exception& e) {
+        onError(Dictionary(std::string(e.what())));
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Paths
+// ---------------------------------------------------------------------------
+
+Dictionary pathToArray(const Path& path);
+Path arrayToPath(const Dictionary& value);
+const Dictionary& getPath(const Dictionary& root, const Path& path);
+void setPath(Dictionary& root, const Path& path, Dictionary value);
+void deletePaths(Dictionary& root, std::vector<Path> paths);
+
+// ---------------------------------------------------------------------------
+// Expressions
+// ---------------------------------------------------------------------------
+
+struct Expr {
+    virtual ~Expr() = default;
+
+    // Calls `emit` with each output of this expression for input `in`
+    virtual void eval(const Dictionary& in, const Env* env, Emit emit) const = 0;
+
+    // Calls `emit` with the path (relative to the input, appended to `path`) of
+    // each output, for path(), del() and the assignment operators
+    virtual void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const;
+
+    // The value of the expression when it does not depend on its input
+    virtual const Dictionary* constant() const { return nullptr; }
+};
+
+using ExprPtr = std::unique_ptr<Expr>;
+
+enum class Op { Add, Sub, Mul, Div, Mod, Eq, Ne, Lt, Le, Gt, Ge };
+
+enum class Assign { Set, Modify, Arithmetic, Alternative };
+
+using FormatFn = std::string (*)(const Dictionary&);
+
+struct Call;
+struct Regex;
+
+struct Builtin {
+    void (*eval)(const Call& call, const Dictionary& in, const Env* env, Emit emit);
+    // Null when the builtin can't be used in path expressions
+    void (*paths)(const Call& call, const Dictionary& in, const Env* env, Path& path, PathEmit emit);
+    // For regex builtins: the argument holding the flags, 0 for none; -1 for
+    // other builtins
+    int regexFlags = -1;
+};
+
+struct Identity : Expr {
+    void eval(const Dictionary& in, const Env*, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env*, Path& path, PathEmit emit) const override;
+};
+
+struct RecurseAll : Expr {
+    void eval(const Dictionary& in, const Env*, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env*, Path& path, PathEmit emit) const override;
+};
+
+struct Literal : Expr {
+    explicit Literal(Dictionary v) : value(v) {}
+
+    void eval(const Dictionary&, const Env*, Emit emit) const override;
+
+    const Dictionary* constant() const override;
+
+    Dictionary value;
+};
+
+struct Variable : Expr {
+    explicit Variable(size_t d) : depth(d) {}
+
+    void eval(const Dictionary&, const Env* env, Emit emit) const override;
+
+    size_t depth;
+};
+
+struct Field : Expr {
+    Field(ExprPtr t, std::string k) : target(std::move(t)), key(std::move(k)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const override;
+
+    ExprPtr target;
+    std::string key;
+};
+
+struct Index : Expr {
+    Index(ExprPtr t, ExprPtr i) : target(std::move(t)), index(std::move(i)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const override;
+
+    ExprPtr target;
+    ExprPtr index;
+};
+
+struct Slice : Expr {
+    Slice(ExprPtr t, ExprPtr f, ExprPtr e) : target(std::move(t)), from(std::move(f)), to(std::move(e)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    ExprPtr target;
+    ExprPtr from;
+    ExprPtr to;
+};
+
+struct Iterate : Expr {
+    explicit Iterate(ExprPtr t) : target(std::move(t)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const override;
+
+    ExprPtr target;
+};
+
+struct Pipe : Expr {
+    Pipe(ExprPtr l, ExprPtr r) : lhs(std::move(l)), rhs(std::move(r)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const override;
+
+    ExprPtr lhs;
+    ExprPtr rhs;
+};
+
+struct Comma : Expr {
+    Comma(ExprPtr l, ExprPtr r) : lhs(std::move(l)), rhs(std::move(r)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const override;
+
+    ExprPtr lhs;
+    ExprPtr rhs;
+};
+
+struct Neg : Expr {
+    explicit Neg(ExprPtr o) : operand(std::move(o)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    ExprPtr operand;
+};
+
+struct Binary : Expr {
+    Binary(Op o, ExprPtr l, ExprPtr r) : op(o), lhs(std::move(l)), rhs(std::move(r)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    Op op;
+    ExprPtr lhs;
+    ExprPtr rhs;
+};
+
+struct And : Expr {
+    And(ExprPtr l, ExprPtr r) : lhs(std::move(l)), rhs(std::move(r)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    ExprPtr lhs;
+    ExprPtr rhs;
+};
+
+struct Or : Expr {
+    Or(ExprPtr l, ExprPtr r) : lhs(std::move(l)), rhs(std::move(r)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    ExprPtr lhs;
+    ExprPtr rhs;
+};
+
+// a // b: the truthy outputs of a, or else the outputs of b. Errors in a count
+// as no output.
+struct Alternative : Expr {
+    Alternative(ExprPtr l, ExprPtr r) : lhs(std::move(l)), rhs(std::move(r)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const override;
+
+    ExprPtr lhs;
+    ExprPtr rhs;
+};
+
+struct If : Expr {
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const override;
+
+    void branch(size_t i, const Dictionary& in, const Env* env, Emit emit) const;
+
+    void branchPaths(size_t i, const Dictionary& in, const Env* env, Path& path, PathEmit emit) const;
+
+    // if/elif conditions and their branches; `otherwise` is null without else
+    std::vector<std::pair<ExprPtr, ExprPtr>> conditions;
+    ExprPtr otherwise;
+};
+
+struct Try : Expr {
+    Try(ExprPtr b, ExprPtr h) : body(std::move(b)), handler(std::move(h)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const override;
+
+    ExprPtr body;
+    ExprPtr handler;
+};
+
+struct Reduce : Expr {
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    ExprPtr source;
+    ExprPtr init;
+    ExprPtr update;
+};
+
+struct Foreach : Expr {
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    ExprPtr source;
+    ExprPtr init;
+    ExprPtr update;
+    ExprPtr extract;
+};
+
+// source as $x | body
+struct As : Expr {
+    As(ExprPtr s, ExprPtr b) : source(std::move(s)), body(std::move(b)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const override;
+
+    ExprPtr source;
+    ExprPtr body;
+};
+
+struct Update : Expr {
+    Update(Assign k, Op o, ExprPtr l, ExprPtr r) : kind(k), op(o), lhs(std::move(l)), rhs(std::move(r)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    Assign kind;
+    Op op;
+    ExprPtr lhs;
+    ExprPtr rhs;
+};
+
+struct ArrayCons : Expr {
+    explicit ArrayCons(ExprPtr b) : body(std::move(b)) {}
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    ExprPtr body;
+};
+
+struct ObjectCons : Expr {
+    struct Entry {
+        std::string name;  // used when `key` is null
+        ExprPtr key;
+        ExprPtr value;
+    };
+
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    // Fills entries i.. into `out`, emitting one object per combination of
+    // key and value outputs. `out` is restored before returning.
+    void build(size_t i, Dictionary& out, const Dictionary& in, const Env* env, Emit emit) const;
+
+    std::vector<Entry> entries;
+};
+
+// "text \(e) text", optionally with a format (@csv "...") applied to each e
+struct StringInterp : Expr {
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    // Like jq, later interpolations are the outer loop
+    void build(size_t n, const std::string& tail, const Dictionary& in, const Env* env, Emit emit) const;
+
+    // Literal text, or an expression when the second member is set
+    std::vector<std::pair<std::string, ExprPtr>> parts;
+    FormatFn format = nullptr;
+};
+
+struct Format : Expr {
+    explicit Format(FormatFn f) : format(f) {}
+
+    void eval(const Dictionary& in, const Env*, Emit emit) const override;
+
+    FormatFn format;
+};
+
+struct Call : Expr {
+    void eval(const Dictionary& in, const Env* env, Emit emit) const override;
+
+    void paths(const Dictionary& in, const Env* env, Path& path, PathEmit emit) const override;
+
+    const Expr& arg(size_t i) const { return *args[i]; }
+
+    const Builtin* builtin = nullptr;
+    std::vector<ExprPtr> args;
+    // Regex builtins with a literal pattern compile it once here
+    std::shared_ptr<const Regex> regex;
+};
+
+// Calls `emit` with `in` and every value below it, parents first
+void recurseAll(const Dictionary& in, Emit emit);
+void recurseAllPaths(const Dictionary& in, Path& path, PathEmit emit);
+
+[[noreturn]] void failIterate(const Dictionary& v);
+void iterate(const Dictionary& in, Emit emit);
+
+// The accumulator of reduce/foreach lives behind a pointer so each step can
+// replace it without copying the value again
+using Slot = std::unique_ptr<Dictionary>;
+
+// The first output of `e`, without running it any further
+Slot firstOutput(const Expr& e, const Dictionary& in, const Env* env);
+std::vector<Dictionary> collect(const Expr& e, const Dictionary& in, const Env* env);
+std::vector<Path> collectPaths(const Expr& expr, const Dictionary& in, const Env* env);
+
+// ---------------------------------------------------------------------------
+// Builtins and formats
+// ---------------------------------------------------------------------------
+
+// The format named by @name, or null
+FormatFn findFormat(const std::string& name);
+
+// The format of plain "\(...)" interpolation
+std::string formatText(const Dictionary& v);
+
+// The builtin name/arity, or null
+const Builtin* findBuiltin(const std::string& name, size_t arity);
+
+// Compiles the pattern of a regex builtin once when it is a literal
+void precompileRegex(Call& call);
+
+} // namespace filter
+} // namespace pq
+} // namespace ps
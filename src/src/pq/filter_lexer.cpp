@@ -0,0 +1,212 @@
+#include "filter_lexer.h"
+#include "filter_value.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace ps {
+namespace pq {
+namespace filter {
+
+namespace {
+
+bool isIdentStart(char c) { return std::isalpha(static_cast<unsigned char>(c)) || c == '_'; }
+bool isIdentChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+
+} // namespace
+
+[[noreturn]] void syntaxError(size_t column, const std::string& message) {
+    throw std::invalid_argument("Syntax error at column " + std::to_string(column) + ": " + message);
+}
+
+Token Lexer::next() {
+    skipSpace();
+    Token token;
+    token.column = column(pos_);
+    if (pos_ >= text_.size()) return token;
+
+    char c = text_[pos_];
+    if (c == '"') {
+        token.kind = TokenKind::String;
+        token.parts = readString();
+        return token;
+    }
+    if (std::isdigit(static_cast<unsigned char>(c))) {
+        token.kind = TokenKind::Number;
+        token.number = readNumber();
+        return token;
+    }
+    if (isIdentStart(c)) {
+        token.kind = TokenKind::Ident;
+        token.text = readIdent();
+        return token;
+    }
+    if ((c == '$' || c == '@') && pos_ + 1 < text_.size() && isIdentStart(text_[pos_ + 1])) {
+        ++pos_;
+        token.kind = c == '$' ? TokenKind::Variable : TokenKind::Format;
+        token.text = readIdent();
+        return token;
+    }
+    if (c == '.' && pos_ + 1 < text_.size() && isIdentStart(text_[pos_ + 1])) {
+        ++pos_;
+        token.kind = TokenKind::Field;
+        token.text = readIdent();
+        return token;
+    }
+
+    static const char* const punctuation[] = {"//=", "|=", "+=", "-=", "*=", "/=", "%=", "//", "==",
+                                              "!=",  "<=", ">=", "..", ".",  "[",  "]",  "{",  "}",
+                                              "(",   ")",  "|",  ",",  ":",  ";",  "=",  "<",  ">",
+                                              "+",   "-",  "*",  "/",  "%",  "?"};
+    for (const char* p : punctuation) {
+        size_t n = std::strlen(p);
+        if (text_.compare(pos_, n, p) == 0) {
+            token.kind = TokenKind::Punct;
+            token.text = p;
+            pos_ += n;
+            return token;
+        }
+    }
+    syntaxError(token.column, std::string("unexpected character '") + c + "'");
+}
+
+size_t Lexer::column(size_t pos) const { return offset_ + pos + 1; }
+
+void Lexer::skipSpace() {
+    while (pos_ < text_.size()) {
+        if (std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+            ++pos_;
+        } else if (text_[pos_] == '#') {
+            while (pos_ < text_.size() && text_[pos_] != '\n') ++pos_;
+        } else {
+            break;
+        }
+    }
+}
+
+std::string Lexer::readIdent() {
+    size_t start = pos_;
+    while (pos_ < text_.size() && isIdentChar(text_[pos_])) ++pos_;
+    return text_.substr(start, pos_ - start);
+}
+
+Dictionary Lexer::readNumber() {
+    size_t start = pos_;
+    bool integer = true;
+    while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+    if (pos_ < text_.size() && text_[pos_] == '.') {
+        integer = false;
+        ++pos_;
+        while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+    }
+    if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+        integer = false;
+        ++pos_;
+        if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) ++pos_;
+        while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) ++pos_;
+    }
+    std::string digits = text_.substr(start, pos_ - start);
+    if (integer && digits.size() < 16) return Dictionary(static_cast<int64_t>(std::stoll(digits)));
+    return Dictionary(std::strtod(digits.c_str(), nullptr));
+}
+
+size_t Lexer::skipString(size_t i) const {
+    size_t start = i++;
+    while (i < text_.size()) {
+        if (text_[i] == '\\') {
+            i = i + 1 < text_.size() && text_[i + 1] == '(' ? skipNested(i + 2) + 1 : i + 2;
+        } else if (text_[i] == '"') {
+            return i + 1;
+        } else {
+            ++i;
+        }
+    }
+    syntaxError(column(start), "unterminated string");
+}
+
+size_t Lexer::skipNested(size_t i) const {
+    size_t start = i;
+    int depth = 1;
+    while (i < text_.size()) {
+        char c = text_[i];
+        if (c == '"') {
+            i = skipString(i);
+            continue;
+        }
+        if (c == '(') ++depth;
+        if (c == ')' && --depth == 0) return i;
+        ++i;
+    }
+    syntaxError(column(start), "unterminated string interpolation");
+}
+
+unsigned Lexer::readHex(size_t at) const {
+    if (at + 4 > text_.size()) syntaxError(column(at), "invalid \\u escape");
+    unsigned value = 0;
+    for (size_t i = at; i < at + 4; ++i) {
+        char c = text_[i];
+        if (!std::isxdigit(static_cast<unsigned char>(c))) syntaxError(column(at), "invalid \\u escape");
+        value = value * 16 + static_cast<unsigned>(std::isdigit(static_cast<unsigned char>(c))
+                                                            ? c - '0'
+                                                            : std::tolower(c) - 'a' + 10);
+    }
+    return value;
+}
+
+std::vector<StringPart> Lexer::readString() {
+    size_t start = pos_++;
+    std::vector<StringPart> parts;
+    std::string literal;
+    while (true) {
+        if (pos_ >= text_.size()) syntaxError(column(start), "unterminated string");
+        char c = text_[pos_++];
+        if (c == '"') break;
+        if (c != '\\') {
+            literal += c;
+            continue;
+        }
+        if (pos_ >= text_.size()) syntaxError(column(start), "unterminated string");
+        char e = text_[pos_++];
+        switch (e) {
+            case 'n': literal += '\n'; break;
+            case 't': literal += '\t'; break;
+            case 'r': literal += '\r'; break;
+            case 'b': literal += '\b'; break;
+            case 'f': literal += '\f'; break;
+            case '"':
+            case '\\':
+            case '/': literal += e; break;
+            case 'u': {
+                uint32_t cp = readHex(pos_);
+                pos_ += 4;
+                if (cp >= 0xd800 && cp < 0xdc00 && text_.compare(pos_, 2, "\\u") == 0) {
+                    uint32_t low = readHex(pos_ + 2);
+                    if (low >= 0xdc00 && low < 0xe000) {
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                        pos_ += 6;
+                    }
+                }
+                appendUtf8(literal, cp);
+                break;
+            }
+            case '(': {
+                if (!literal.empty()) parts.push_back({literal, false, 0});
+                literal.clear();
+                size_t end = skipNested(pos_);
+                parts.push_back({text_.substr(pos_, end - pos_), true, offset_ + pos_});
+                pos_ = end + 1;
+                break;
+            }
+            default:
+                syntaxError(column(pos_ - 2), std::string("invalid escape '\\") + e + "'");
+        }
+    }
+    if (!literal.empty() || parts.empty()) parts.push_back({literal, false, 0});
+    return parts;
+}
+
+} // namespace filter
+} // namespace pq
+} // namespace ps
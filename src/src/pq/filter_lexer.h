@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ps/dictionary.h>
+#include <string>
+#include <vector>
+
+namespace ps {
+namespace pq {
+namespace filter {
+
+enum class TokenKind { End, Number, String, Ident, Field, Variable, Format, Punct };
+
+struct StringPart {
+    std::string text;  // literal text, or the source of an interpolated expression
+    bool interpolation;
+    size_t column;
+};
+
+struct Token {
+    TokenKind kind = TokenKind::End;
+    std::string text;  // identifier, field/variable/format name or punctuation
+    Dictionary number;
+    std::vector<StringPart> parts;
+    size_t column = 0;
+
+    bool is(const char* punct) const { return kind == TokenKind::Punct && text == punct; }
+    bool isKeyword(const char* word) const { return kind == TokenKind::Ident && text == word; }
+};
+
+// Throws the std::invalid_argument a malformed filter is reported with
+[[noreturn]] void syntaxError(size_t column, const std::string& message);
+
+// Splits filter text into tokens, one at a time
+class Lexer {
+public:
+    // `offset` is the column of `text` within the whole filter (for the
+    // expressions inside "\(...)")
+    Lexer(std::string text, size_t offset) : text_(std::move(text)), offset_(offset) {}
+
+    Token next();
+
+private:
+    size_t column(size_t pos) const;
+
+    void skipSpace();
+
+    std::string readIdent();
+
+    Dictionary readNumber();
+
+    // Index just past the string starting at `i`
+    size_t skipString(size_t i) const;
+
+    // Index of the ')' closing the interpolation that starts at `i`
+    size_t skipNested(size_t i) const;
+
+    unsigned readHex(size_t at) const;
+
+    std::vector<StringPart> readString();
+
+    std::string text_;
+    size_t offset_;
+    size_t pos_ = 0;
+};
+
+} // namespace filter
+} // namespace pq
+} // namespace ps
@@ -0,0 +1,529 @@
+#include "filter_parser.h"
+#include "filter_lexer.h"
+
+#include <map>
+#include <optional>
+#include <set>
+
+namespace ps {
+namespace pq {
+namespace filter {
+
+namespace {
+
+// Recursive descent over jq's precedence levels, lowest first:
+// |  ,  //  = |= += ...  or  and  == < ...  + -  * / %  unary -  postfix
+class Parser {
+public:
+    Parser(const std::string& text, const std::map<std::string, Dictionary>& arguments)
+        : lexer_(text, 0), arguments_(arguments) {
+        advance();
+    }
+
+    ExprPtr parseProgram() {
+        ExprPtr root = parsePipe(true);
+        if (current_.kind != TokenKind::End) unexpected();
+        return root;
+    }
+
+private:
+    void advance() {
+        if (lookahead_) {
+            current_ = std::move(*lookahead_);
+            lookahead_.reset();
+        } else {
+            current_ = lexer_.next();
+        }
+    }
+
+    const Token& peekNext() {
+        if (!lookahead_) lookahead_ = lexer_.next();
+        return *lookahead_;
+    }
+
+    [[noreturn]] void unexpected() const {
+        if (current_.kind == TokenKind::End) syntaxError(current_.column, "unexpected end of filter");
+        std::string text = current_.kind == TokenKind::String ? std::string("string") : "'" + current_.text + "'";
+        if (current_.kind == TokenKind::Number) text = json(current_.number);
+        syntaxError(current_.column, "unexpected " + text);
+    }
+
+    void expect(const char* punct) {
+        if (!current_.is(punct)) {
+            if (current_.kind == TokenKind::End) {
+                syntaxError(current_.column, std::string("expected '") + punct + "' before end of filter");
+            }
+            unexpected();
+        }
+        advance();
+    }
+
+    void expectKeyword(const char* word) {
+        if (!current_.isKeyword(word)) {
+            syntaxError(current_.column, std::string("expected '") + word + "'");
+        }
+        advance();
+    }
+
+    std::string expectVariable() {
+        if (current_.kind != TokenKind::Variable) syntaxError(current_.column, "expected a $variable");
+        std::string name = current_.text;
+        advance();
+        return name;
+    }
+
+    ExprPtr parsePipe(bool allowComma) {
+        bool saved = allowComma_;
+        allowComma_ = allowComma;
+        ExprPtr lhs = parseComma();
+        if (current_.is("|")) {
+            advance();
+            lhs = std::make_unique<Pipe>(std::move(lhs), parsePipe(allowComma));
+        }
+        allowComma_ = saved;
+        return lhs;
+    }
+
+    ExprPtr parseComma() {
+        ExprPtr lhs = parseAlternative();
+        while (allowComma_ && current_.is(",")) {
+            advance();
+            lhs = std::make_unique<Comma>(std::move(lhs), parseAlternative());
+        }
+        return lhs;
+    }
+
+    ExprPtr parseAlternative() {
+        ExprPtr lhs = parseAssignment();
+        if (current_.is("//")) {
+            advance();
+            return std::make_unique<Alternative>(std::move(lhs), parseAlternative());
+        }
+        return lhs;
+    }
+
+    ExprPtr parseAssignment() {
+        ExprPtr lhs = parseOr();
+        static const std::map<std::string, std::pair<Assign, Op>> operators = {
+                {"=", {Assign::Set, Op::Add}},          {"|=", {Assign::Modify, Op::Add}},
+                {"+=", {Assign::Arithmetic, Op::Add}},  {"-=", {Assign::Arithmetic, Op::Sub}},
+                {"*=", {Assign::Arithmetic, Op::Mul}},  {"/=", {Assign::Arithmetic, Op::Div}},
+                {"%=", {Assign::Arithmetic, Op::Mod}},  {"//=", {Assign::Alternative, Op::Add}},
+        };
+        if (current_.kind != TokenKind::Punct) return lhs;
+        auto it = operators.find(current_.text);
+        if (it == operators.end()) return lhs;
+        advance();
+        ExprPtr rhs = parseOr();
+        return std::make_unique<Update>(it->second.first, it->second.second, std::move(lhs), std::move(rhs));
+    }
+
+    ExprPtr parseOr() {
+        ExprPtr lhs = parseAnd();
+        while (current_.isKeyword("or")) {
+            advance();
+            lhs = std::make_unique<Or>(std::move(lhs), parseAnd());
+        }
+        return lhs;
+    }
+
+    ExprPtr parseAnd() {
+        ExprPtr lhs = parseComparison();
+        while (current_.isKeyword("and")) {
+            advance();
+            lhs = std::make_unique<And>(std::move(lhs), parseComparison());
+        }
+        return lhs;
+    }
+
+    ExprPtr parseComparison() {
+        ExprPtr lhs = parseAdditive();
+        static const std::map<std::string, Op> operators = {{"==", Op::Eq}, {"!=", Op::Ne}, {"<", Op::Lt},
+                                                            {"<=", Op::Le}, {">", Op::Gt},  {">=", Op::Ge}};
+        if (current_.kind != TokenKind::Punct) return lhs;
+        auto it = operators.find(current_.text);
+        if (it == operators.end()) return lhs;
+        advance();
+        return std::make_unique<Binary>(it->second, std::move(lhs), parseAdditive());
+    }
+
+    ExprPtr parseAdditive() {
+        ExprPtr lhs = parseMultiplicative();
+        while (current_.is("+") || current_.is("-")) {
+            Op op = current_.is("+") ? Op::Add : Op::Sub;
+            advance();
+            lhs = std::make_unique<Binary>(op, std::move(lhs), parseMultiplicative());
+        }
+        return lhs;
+    }
+
+    ExprPtr parseMultiplicative() {
+        ExprPtr lhs = parseUnary();
+        while (current_.is("*") || current_.is("/") || current_.is("%")) {
+            Op op = current_.is("*") ? Op::Mul : current_.is("/") ? Op::Div : Op::Mod;
+            advance();
+            lhs = std::make_unique<Binary>(op, std::move(lhs), parseUnary());
+        }
+        return lhs;
+    }
+
+    ExprPtr parseUnary() {
+        if (!current_.is("-")) return parsePostfix(true);
+        advance();
+        if (current_.kind == TokenKind::Number) {
+            Dictionary value = negate(current_.number);
+            advance();
+            return std::make_unique<Literal>(value);
+        }
+        return std::make_unique<Neg>(parseUnary());
+    }
+
+    // A term with its suffixes (.foo, [e], ?) and, when `allowAs`, a
+    // following `as $x | body`
+    ExprPtr parsePostfix(bool allowAs) {
+        ExprPtr term = parsePrimary();
+        while (true) {
+            if (current_.kind == TokenKind::Field) {
+                term = std::make_unique<Field>(std::move(term), current_.text);
+                advance();
+            } else if (current_.is(".") && peekNext().kind == TokenKind::String) {
+                advance();
+                term = parseQuotedField(std::move(term));
+            } else if (current_.is(".") && peekNext().is("[")) {
+                advance();
+                term = parseBracket(std::move(term));
+            } else if (current_.is("[")) {
+                term = parseBracket(std::move(term));
+            } else if (current_.is("?")) {
+                advance();
+                term = std::make_unique<Try>(std::move(term), nullptr);
+            } else {
+                break;
+            }
+        }
+        if (allowAs && current_.isKeyword("as")) {
+            advance();
+            std::string name = expectVariable();
+            expect("|");
+            scope_.push_back(name);
+            ExprPtr body = parsePipe(allowComma_);
+            scope_.pop_back();
+            return std::make_unique<As>(std::move(term), std::move(body));
+        }
+        return term;
+    }
+
+    // ."name" (or ."\(e)") on `target`; the string is the current token
+    ExprPtr parseQuotedField(ExprPtr target) {
+        ExprPtr key = parseString(current_, nullptr);
+        advance();
+        if (const Dictionary* name = key->constant()) {
+            return std::make_unique<Field>(std::move(target), name->asStringRef());
+        }
+        return std::make_unique<Index>(std::move(target), std::move(key));
+    }
+
+    // [], [e], [e:e], [:e] and [e:] on `target`
+    ExprPtr parseBracket(ExprPtr target) {
+        expect("[");
+        if (current_.is("]")) {
+            advance();
+            return std::make_unique<Iterate>(std::move(target));
+        }
+        ExprPtr from;
+        if (!current_.is(":")) from = parsePipe(true);
+        if (current_.is(":")) {
+            advance();
+            ExprPtr to;
+            if (!current_.is("]")) to = parsePipe(true);
+            expect("]");
+            return std::make_unique<Slice>(std::move(target), std::move(from), std::move(to));
+        }
+        expect("]");
+        const Dictionary* key = from->constant();
+        if (key && key->isString()) return std::make_unique<Field>(std::move(target), key->asStringRef());
+        return std::make_unique<Index>(std::move(target), std::move(from));
+    }
+
+    ExprPtr parsePrimary() {
+        Token token = current_;
+        switch (token.kind) {
+            case TokenKind::End:
+                unexpected();
+            case TokenKind::Number:
+                advance();
+                return std::make_unique<Literal>(token.number);
+            case TokenKind::String:
+                advance();
+                return parseString(token, nullptr);
+            case TokenKind::Format: {
+                FormatFn format = findFormat(token.text);
+                if (!format) syntaxError(token.column, "@" + token.text + " is not a valid format");
+                advance();
+                if (current_.kind == TokenKind::String) {
+                    Token text = current_;
+                    advance();
+                    return parseString(text, format);
+                }
+                return std::make_unique<Format>(format);
+            }
+            case TokenKind::Field:
+                advance();
+                return std::make_unique<Field>(nullptr, token.text);
+            case TokenKind::Variable:
+                advance();
+                return variable(token);
+            case TokenKind::Ident:
+                return parseKeywordOrCall();
+            case TokenKind::Punct:
+                break;
+        }
+
+        if (token.is(".")) {
+            if (peekNext().kind == TokenKind::String) {
+                advance();
+                return parseQuotedField(nullptr);
+            }
+            if (peekNext().is("[")) {
+                advance();
+                return parseBracket(nullptr);
+            }
+            advance();
+            return std::make_unique<Identity>();
+        }
+        if (token.is("..")) {
+            advance();
+            return std::make_unique<RecurseAll>();
+        }
+        if (token.is("(")) {
+            advance();
+            ExprPtr inner = parsePipe(true);
+            expect(")");
+            return inner;
+        }
+        if (token.is("[")) {
+            advance();
+            if (current_.is("]")) {
+                advance();
+                return std::make_unique<ArrayCons>(nullptr);
+            }
+            ExprPtr body = parsePipe(true);
+            expect("]");
+            return std::make_unique<ArrayCons>(std::move(body));
+        }
+        if (token.is("{")) return parseObject();
+        unexpected();
+    }
+
+    ExprPtr variable(const Token& token) {
+        for (size_t i = scope_.size(); i-- > 0;) {
+            if (scope_[i] == token.text) return std::make_unique<Variable>(scope_.size() - 1 - i);
+        }
+        auto it = arguments_.find(token.text);
+        if (it != arguments_.end()) return std::make_unique<Literal>(it->second);
+        syntaxError(token.column, "$" + token.text + " is not defined");
+    }
+
+    ExprPtr parseString(const Token& token, FormatFn format) {
+        if (token.parts.size() == 1 && !token.parts.front().interpolation) {
+            return std::make_unique<Literal>(Dictionary(token.parts.front().text));
+        }
+        auto interp = std::make_unique<StringInterp>();
+        interp->format = format ? format : formatText;
+        for (const auto& part : token.parts) {
+            if (part.interpolation) {
+                interp->parts.emplace_back(std::string(), parseEmbedded(part.text, part.column));
+            } else {
+                interp->parts.emplace_back(part.text, nullptr);
+            }
+        }
+        return interp;
+    }
+
+    // Parses the expression of a "\(...)" with the variables in scope here
+    ExprPtr parseEmbedded(const std::string& text, size_t offset) {
+        Lexer savedLexer = lexer_;
+        Token savedCurrent = current_;
+        std::optional<Token> savedLookahead = lookahead_;
+        lexer_ = Lexer(text, offset);
+        lookahead_.reset();
+        advance();
+        ExprPtr expr = parsePipe(true);
+        if (current_.kind != TokenKind::End) unexpected();
+        lexer_ = savedLexer;
+        current_ = savedCurrent;
+        lookahead_ = savedLookahead;
+        return expr;
+    }
+
+    ExprPtr parseObject() {
+        expect("{");
+        auto object = std::make_unique<ObjectCons>();
+        while (!current_.is("}")) {
+            ObjectCons::Entry entry;
+            Token token = current_;
+            if (token.kind == TokenKind::Ident) {
+                entry.name = token.text;
+                advance();
+            } else if (token.kind == TokenKind::Variable) {
+                // {$x} is {x: $x}
+                advance();
+                entry.name = token.text;
+                entry.value = variable(token);
+            } else if (token.kind == TokenKind::String) {
+                advance();
+                ExprPtr key = parseString(token, nullptr);
+                if (const Dictionary* name = key->constant()) {
+                    entry.name = name->asStringRef();
+                } else {
+                    entry.key = std::move(key);
+                }
+            } else if (token.is("(")) {
+                advance();
+                entry.key = parsePipe(true);
+                expect(")");
+                if (!current_.is(":")) syntaxError(current_.column, "expected ':' after a computed key");
+            } else {
+                syntaxError(token.column, "object keys must be names, strings or (expressions)");
+            }
+
+            if (!entry.value) {
+                if (current_.is(":")) {
+                    advance();
+                    entry.value = parsePipe(false);
+                } else if (entry.key) {
+                    syntaxError(current_.column, "expected ':' after an interpolated key");
+                } else {
+                    entry.value = std::make_unique<Field>(nullptr, entry.name);
+                }
+            }
+            object->entries.push_back(std::move(entry));
+            if (!current_.is(",")) break;
+            advance();
+        }
+        expect("}");
+        return object;
+    }
+
+    ExprPtr parseKeywordOrCall() {
+        Token token = current_;
+        const std::string& word = token.text;
+        if (word == "true" || word == "false") {
+            advance();
+            return std::make_unique<Literal>(Dictionary(word == "true"));
+        }
+        if (word == "null") {
+            advance();
+            return std::make_unique<Literal>(Dictionary::null());
+        }
+        if (word == "if") return parseIf();
+        if (word == "try") {
+            advance();
+            ExprPtr body = parsePostfix(false);
+            ExprPtr handler;
+            if (current_.isKeyword("catch")) {
+                advance();
+                handler = parsePostfix(false);
+            }
+            return std::make_unique<Try>(std::move(body), std::move(handler));
+        }
+        if (word == "reduce" || word == "foreach") return parseFold(word == "foreach");
+        if (word == "def" || word == "label" || word == "import" || word == "include") {
+            syntaxError(token.column, "'" + word + "' is not supported by pq filters");
+        }
+        static const std::set<std::string> reserved = {"then", "elif", "else", "end", "as",
+                                                        "catch", "and",  "or"};
+        if (reserved.count(word)) unexpected();
+
+        advance();
+        auto call = std::make_unique<Call>();
+        if (current_.is("(")) {
+            advance();
+            while (true) {
+                call->args.push_back(parsePipe(true));
+                if (current_.is(")")) break;
+                expect(";");
+            }
+            advance();
+        }
+        call->builtin = findBuiltin(word, call->args.size());
+        if (!call->builtin) {
+            syntaxError(token.column, word + "/" + std::to_string(call->args.size()) + " is not defined");
+        }
+        precompileRegex(*call);
+        return call;
+    }
+
+    ExprPtr parseIf() {
+        expectKeyword("if");
+        auto node = std::make_unique<If>();
+        while (true) {
+            ExprPtr condition = parsePipe(true);
+            expectKeyword("then");
+            ExprPtr branch = parsePipe(true);
+            node->conditions.emplace_back(std::move(condition), std::move(branch));
+            if (current_.isKeyword("elif")) {
+                advance();
+                continue;
+            }
+            break;
+        }
+        if (current_.isKeyword("else")) {
+            advance();
+            node->otherwise = parsePipe(true);
+        }
+        expectKeyword("end");
+        return node;
+    }
+
+    // reduce SOURCE as $x (INIT; UPDATE) and foreach SOURCE as $x (INIT; UPDATE; EXTRACT)
+    ExprPtr parseFold(bool isForeach) {
+        advance();
+        ExprPtr source = parsePostfix(false);
+        expectKeyword("as");
+        std::string name = expectVariable();
+        expect("(");
+        ExprPtr init = parsePipe(true);
+        expect(";");
+        scope_.push_back(name);
+        ExprPtr update = parsePipe(true);
+        ExprPtr extract;
+        if (isForeach && current_.is(";")) {
+            advance();
+            extract = parsePipe(true);
+        }
+        scope_.pop_back();
+        expect(")");
+
+        if (isForeach) {
+            auto node = std::make_unique<Foreach>();
+            node->source = std::move(source);
+            node->init = std::move(init);
+            node->update = std::move(update);
+            node->extract = std::move(extract);
+            return node;
+        }
+        auto node = std::make_unique<Reduce>();
+        node->source = std::move(source);
+        node->init = std::move(init);
+        node->update = std::move(update);
+        return node;
+    }
+
+    Lexer lexer_;
+    Token current_;
+    std::optional<Token> lookahead_;
+    const std::map<std::string, Dictionary>& arguments_;
+    std::vector<std::string> scope_;
+    bool allowComma_ = true;
+};
+
+} // namespace
+
+ExprPtr parse(const std::string& text, const std::map<std::string, Dictionary>& arguments) {
+    return Parser(text, arguments).parseProgram();
+}
+
+} // namespace filter
+} // namespace pq
+} // namespace ps
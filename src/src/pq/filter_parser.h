@@ -0,0 +1,19 @@
+#pragma once
+
+#include "filter_eval.h"
+
+#include <map>
+#include <string>
+
+namespace ps {
+namespace pq {
+namespace filter {
+
+// Parses a whole filter. `arguments` are the $names given with --arg and
+// --argjson; they are substituted as literals. Throws std::invalid_argument
+// on syntax errors.
+ExprPtr parse(const std::string& text, const std::map<std::string, Dictionary>& arguments);
+
+} // namespace filter
+} // namespace pq
+} // namespace ps
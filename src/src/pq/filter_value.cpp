@@ -0,0 +1,462 @@
+#include "filter_value.h"
+
+#include <ps/pq/filter.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace ps {
+namespace pq {
+namespace filter {
+
+namespace {
+
+// Integer arithmetic stays exact below this magnitude and falls back to double
+// above it, the way jq's doubles lose precision past 2^53
+const double kExactIntLimit = 9e15;
+
+} // namespace
+
+std::string typeName(const Dictionary& v) {
+    if (v.isNull()) return "null";
+    if (v.isBool()) return "boolean";
+    if (isNumber(v)) return "number";
+    if (v.isString()) return "string";
+    if (v.isArrayObject()) return "array";
+    return "object";
+}
+
+Dictionary number(double x) {
+    if (std::isfinite(x) && x == std::floor(x) && std::fabs(x) < kExactIntLimit) {
+        return Dictionary(static_cast<int64_t>(x));
+    }
+    return Dictionary(x);
+}
+
+namespace {
+
+std::string formatNumber(double x) {
+    if (std::isnan(x)) return "null";
+    if (std::isinf(x)) return x > 0 ? "1.7976931348623157e+308" : "-1.7976931348623157e+308";
+    char buffer[32];
+    if (x == std::floor(x) && std::fabs(x) < 1e17) {
+        std::snprintf(buffer, sizeof(buffer), "%.0f", x);
+        return buffer;
+    }
+    // Shortest of %.15g..%.17g that reads back as the same double
+    for (int precision = 15; precision <= 17; ++precision) {
+        std::snprintf(buffer, sizeof(buffer), "%.*g", precision, x);
+        if (std::strtod(buffer, nullptr) == x) break;
+    }
+    return buffer;
+}
+
+void writeString(std::string& out, const std::string& s) {
+    out += '"';
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned char>(c));
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+void writeJson(std::string& out, const Dictionary& v) {
+    if (v.isNull()) {
+        out += "null";
+    } else if (v.isBool()) {
+        out += v.asBool() ? "true" : "false";
+    } else if (v.isInt()) {
+        out += std::to_string(v.asInt());
+    } else if (v.isDouble()) {
+        out += formatNumber(v.asDouble());
+    } else if (v.isString()) {
+        writeString(out, v.asStringRef());
+    } else if (v.isArrayObject()) {
+        out += '[';
+        bool first = true;
+        for (const auto& element : v.elements()) {
+            if (!first) out += ',';
+            first = false;
+            writeJson(out, element.second);
+        }
+        out += ']';
+    } else {
+        out += '{';
+        bool first = true;
+        for (const auto& member : v.members()) {
+            if (!first) out += ',';
+            first = false;
+            writeString(out, member.first);
+            out += ':';
+            writeJson(out, member.second);
+        }
+        out += '}';
+    }
+}
+
+} // namespace
+
+std::string json(const Dictionary& v) {
+    std::string out;
+    writeJson(out, v);
+    return out;
+}
+
+// `number (42)` as used in error messages, truncated like jq does
+std::string describe(const Dictionary& v) {
+    std::string text = json(v);
+    if (text.size() > 11) text = text.substr(0, 10) + "...";
+    return typeName(v) + " (" + text + ")";
+}
+
+std::string errorMessage(const Dictionary& value) {
+    if (value.isString()) return value.asStringRef();
+    return json(value) + " (not a string)";
+}
+
+[[noreturn]] void fail(const std::string& message) { throw FilterError(Dictionary(message)); }
+
+std::string toText(const Dictionary& v) { return v.isString() ? v.asStringRef() : json(v); }
+
+namespace {
+
+// Total order of jq values: null < false < true < numbers < strings < arrays < objects
+int rank(const Dictionary& v) {
+    if (v.isNull()) return 0;
+    if (v.isBool()) return v.asBool() ? 2 : 1;
+    if (isNumber(v)) return 3;
+    if (v.isString()) return 4;
+    if (v.isArrayObject()) return 5;
+    return 6;
+}
+
+} // namespace
+
+int compare(const Dictionary& a, const Dictionary& b) {
+    int ra = rank(a);
+    int rb = rank(b);
+    if (ra != rb) return ra < rb ? -1 : 1;
+    switch (ra) {
+        case 3: {
+            if (a.isInt() && b.isInt()) {
+                int64_t x = a.asInt();
+                int64_t y = b.asInt();
+                return x < y ? -1 : (x > y ? 1 : 0);
+            }
+            double x = toDouble(a);
+            double y = toDouble(b);
+            return x < y ? -1 : (x > y ? 1 : 0);
+        }
+        case 4: {
+            int c = a.asStringRef().compare(b.asStringRef());
+            return c < 0 ? -1 : (c > 0 ? 1 : 0);
+        }
+        case 5: {
+            const auto& x = a.elements();
+            const auto& y = b.elements();
+            auto i = x.begin();
+            auto j = y.begin();
+            for (; i != x.end() && j != y.end(); ++i, ++j) {
+                int c = compare(i->second, j->second);
+                if (c != 0) return c;
+            }
+            if (i == x.end() && j == y.end()) return 0;
+            return i == x.end() ? -1 : 1;
+        }
+        case 6: {
+            // Objects compare by their sorted key sets first, then value by value
+            const auto& x = a.members();
+            const auto& y = b.members();
+            auto i = x.begin();
+            auto j = y.begin();
+            for (; i != x.end() && j != y.end(); ++i, ++j) {
+                int c = i->first.compare(j->first);
+                if (c != 0) return c < 0 ? -1 : 1;
+            }
+            if (i != x.end() || j != y.end()) return i == x.end() ? -1 : 1;
+            for (i = x.begin(), j = y.begin(); i != x.end(); ++i, ++j) {
+                int c = compare(i->second, j->second);
+                if (c != 0) return c;
+            }
+            return 0;
+        }
+        default:
+            return 0;
+    }
+}
+
+bool equal(const Dictionary& a, const Dictionary& b) { return compare(a, b) == 0; }
+
+std::vector<const Dictionary*> items(const Dictionary& v) {
+    std::vector<const Dictionary*> out;
+    if (v.isArrayObject()) {
+        out.reserve(v.elements().size());
+        for (const auto& element : v.elements()) out.push_back(&element.second);
+    } else if (v.isMappedObject()) {
+        out.reserve(v.members().size());
+        for (const auto& member : v.members()) out.push_back(&member.second);
+    }
+    return out;
+}
+
+Dictionary array(std::vector<Dictionary> values) {
+    Dictionary out;
+    out = std::move(values);
+    return out;
+}
+
+Dictionary array(const std::vector<const Dictionary*>& values) {
+    std::vector<Dictionary> copies;
+    copies.reserve(values.size());
+    for (const auto* value : values) copies.push_back(*value);
+    return array(std::move(copies));
+}
+
+Dictionary emptyArray() { return Dictionary(std::vector<Dictionary>{}); }
+
+Dictionary add(const Dictionary& a, const Dictionary& b) {
+    if (a.isNull()) return b;
+    if (b.isNull()) return a;
+    if (a.isInt() && b.isInt()) {
+        double approx = static_cast<double>(a.asInt()) + static_cast<double>(b.asInt());
+        if (std::fabs(approx) < kExactIntLimit) return Dictionary(a.asInt() + b.asInt());
+        return Dictionary(approx);
+    }
+    if (isNumber(a) && isNumber(b)) return Dictionary(toDouble(a) + toDouble(b));
+    if (a.isString() && b.isString()) return Dictionary(a.asStringRef() + b.asStringRef());
+    if (a.isArrayObject() && b.isArrayObject()) {
+        std::vector<const Dictionary*> all = items(a);
+        for (const auto* value : items(b)) all.push_back(value);
+        return array(all);
+    }
+    if (a.isMappedObject() && b.isMappedObject()) {
+        Dictionary out = a;
+        for (const auto& member : b.members()) out[member.first] = member.second;
+        return out;
+    }
+    fail(describe(a) + " and " + describe(b) + " cannot be added");
+}
+
+Dictionary subtract(const Dictionary& a, const Dictionary& b) {
+    if (a.isInt() && b.isInt()) {
+        double approx = static_cast<double>(a.asInt()) - static_cast<double>(b.asInt());
+        if (std::fabs(approx) < kExactIntLimit) return Dictionary(a.asInt() - b.asInt());
+        return Dictionary(approx);
+    }
+    if (isNumber(a) && isNumber(b)) return Dictionary(toDouble(a) - toDouble(b));
+    if (a.isArrayObject() && b.isArrayObject()) {
+        std::vector<const Dictionary*> kept;
+        auto removed = items(b);
+        for (const auto* value : items(a)) {
+            bool found = false;
+            for (const auto* other : removed) {
+                if (equal(*value, *other)) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found) kept.push_back(value);
+        }
+        return array(kept);
+    }
+    fail(describe(a) + " and " + describe(b) + " cannot be subtracted");
+}
+
+namespace {
+
+Dictionary deepMerge(const Dictionary& a, const Dictionary& b) {
+    Dictionary out = a;
+    for (const auto& member : b.members()) {
+        if (out.has(member.first) && out.at(member.first).isMappedObject() &&
+            member.second.isMappedObject()) {
+            out[member.first] = deepMerge(out.at(member.first), member.second);
+        } else {
+            out[member.first] = member.second;
+        }
+    }
+    return out;
+}
+
+Dictionary repeat(const std::string& s, double times) {
+    if (times <= 0) return Dictionary::null();
+    int64_t n = static_cast<int64_t>(std::ceil(times));
+    std::string out;
+    out.reserve(s.size() * static_cast<size_t>(n));
+    for (int64_t i = 0; i < n; ++i) out += s;
+    return Dictionary(out);
+}
+
+} // namespace
+
+Dictionary multiply(const Dictionary& a, const Dictionary& b) {
+    if (a.isInt() && b.isInt()) {
+        double approx = static_cast<double>(a.asInt()) * static_cast<double>(b.asInt());
+        if (std::fabs(approx) < kExactIntLimit) return Dictionary(a.asInt() * b.asInt());
+        return Dictionary(approx);
+    }
+    if (isNumber(a) && isNumber(b)) return Dictionary(toDouble(a) * toDouble(b));
+    if (a.isString() && isNumber(b)) return repeat(a.asStringRef(), toDouble(b));
+    if (isNumber(a) && b.isString()) return repeat(b.asStringRef(), toDouble(a));
+    if (a.isMappedObject() && b.isMappedObject()) return deepMerge(a, b);
+    fail(describe(a) + " and " + describe(b) + " cannot be multiplied");
+}
+
+Dictionary divide(const Dictionary& a, const Dictionary& b) {
+    if (isNumber(a) && isNumber(b)) {
+        if (toDouble(b) == 0.0) {
+            fail(describe(a) + " and " + describe(b) +
+                 " cannot be divided because the divisor is zero");
+        }
+        if (a.isInt() && b.isInt() && a.asInt() % b.asInt() == 0) {
+            return Dictionary(a.asInt() / b.asInt());
+        }
+        return Dictionary(toDouble(a) / toDouble(b));
+    }
+    if (a.isString() && b.isString()) return split(a.asStringRef(), b.asStringRef());
+    fail(describe(a) + " and " + describe(b) + " cannot be divided");
+}
+
+Dictionary modulo(const Dictionary& a, const Dictionary& b) {
+    if (isNumber(a) && isNumber(b)) {
+        int64_t x = a.isInt() ? a.asInt() : static_cast<int64_t>(toDouble(a));
+        int64_t y = b.isInt() ? b.asInt() : static_cast<int64_t>(toDouble(b));
+        if (y == 0) {
+            fail(describe(a) + " and " + describe(b) +
+                 " cannot be divided because the divisor is zero");
+        }
+        if (y < 0) y = -y;
+        return Dictionary(x % y);
+    }
+    fail(describe(a) + " and " + describe(b) + " cannot be divided");
+}
+
+Dictionary negate(const Dictionary& v) {
+    if (v.isInt()) return Dictionary(-v.asInt());
+    if (v.isDouble()) return Dictionary(-v.asDouble());
+    fail(describe(v) + " cannot be negated");
+}
+
+// .key on `v`; null when the key is missing or `v` is null
+const Dictionary& fieldOf(const Dictionary& v, const std::string& key) {
+    if (v.isMappedObject()) {
+        const auto& members = v.members();
+        auto it = members.find(key);
+        return it == members.end() ? nullValue() : it->second;
+    }
+    if (v.isNull()) return nullValue();
+    std::string quoted;
+    writeString(quoted, key);
+    fail("Cannot index " + typeName(v) + " with " + quoted);
+}
+
+// .[index] on `v`; negative indices count from the end
+const Dictionary& elementOf(const Dictionary& v, double index) {
+    if (v.isArrayObject()) {
+        const auto& elements = v.elements();
+        int64_t i = static_cast<int64_t>(std::floor(index));
+        int64_t size = static_cast<int64_t>(elements.size());
+        if (i < 0) i += size;
+        if (i < 0 || i >= size) return nullValue();
+        auto it = elements.find(static_cast<int>(i));
+        return it == elements.end() ? nullValue() : it->second;
+    }
+    if (v.isNull()) return nullValue();
+    fail("Cannot index " + typeName(v) + " with number");
+}
+
+const Dictionary& indexOf(const Dictionary& v, const Dictionary& index) {
+    if (index.isString()) return fieldOf(v, index.asStringRef());
+    if (isNumber(index)) return elementOf(v, toDouble(index));
+    if (v.isNull()) return nullValue();
+    fail("Cannot index " + typeName(v) + " with " + typeName(index));
+}
+
+// ---------------------------------------------------------------------------
+// UTF-8 strings (lengths, slices and explode count code points, like jq)
+// ---------------------------------------------------------------------------
+
+std::vector<uint32_t> codepoints(const std::string& s) {
+    std::vector<uint32_t> out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size();) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        int extra = c < 0x80 ? 0 : (c >> 5) == 0x6 ? 1 : (c >> 4) == 0xe ? 2 : (c >> 3) == 0x1e ? 3 : 0;
+        uint32_t cp = extra == 0 ? c : (c & (0x3f >> extra));
+        size_t j = 1;
+        for (; j <= static_cast<size_t>(extra) && i + j < s.size(); ++j) {
+            cp = (cp << 6) | (static_cast<unsigned char>(s[i + j]) & 0x3f);
+        }
+        out.push_back(cp);
+        i += j;
+    }
+    return out;
+}
+
+void appendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xc0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xe0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+}
+
+size_t utf8Length(const std::string& s) {
+    size_t n = 0;
+    for (char c : s) {
+        if ((static_cast<unsigned char>(c) & 0xc0) != 0x80) ++n;
+    }
+    return n;
+}
+
+Dictionary split(const std::string& s, const std::string& separator) {
+    std::vector<Dictionary> parts;
+    if (s.empty()) return emptyArray();
+    if (separator.empty()) {
+        for (uint32_t cp : codepoints(s)) {
+            std::string one;
+            appendUtf8(one, cp);
+            parts.emplace_back(one);
+        }
+        return array(std::move(parts));
+    }
+    size_t start = 0;
+    while (true) {
+        size_t found = s.find(separator, start);
+        if (found == std::string::npos) {
+            parts.emplace_back(s.substr(start));
+            break;
+        }
+        parts.emplace_back(s.substr(start, found - start));
+        start = found + separator.size();
+    }
+    return array(std::move(parts));
+}
+
+} // namespace filter
+} // namespace pq
+} // namespace ps
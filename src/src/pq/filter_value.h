@@ -0,0 +1,85 @@
+#pragma once
+
+#include <ps/dictionary.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ps {
+namespace pq {
+namespace filter {
+
+// Operations on jq values, shared by the filter's parser, evaluator and
+// builtins. Errors are raised as FilterError through fail().
+
+// The small predicates run for every value a filter touches, so they are
+// defined here where every part of the filter can inline them
+
+inline const Dictionary& nullValue() {
+    static const Dictionary value = Dictionary::null();
+    return value;
+}
+
+inline bool isNumber(const Dictionary& v) { return v.isInt() || v.isDouble(); }
+
+inline double toDouble(const Dictionary& v) { return v.asDouble(); }
+
+inline bool truthy(const Dictionary& v) {
+    if (v.isNull()) return false;
+    if (v.isBool()) return v.asBool();
+    return true;
+}
+
+std::string typeName(const Dictionary& v);
+
+// A number, stored as an integer when `x` is one
+Dictionary number(double x);
+
+// Compact JSON text, formatted like jq prints it
+std::string json(const Dictionary& v);
+
+// `number (42)` as used in error messages, truncated like jq does
+std::string describe(const Dictionary& v);
+
+// The message of a FilterError raised with `value`
+std::string errorMessage(const Dictionary& value);
+
+[[noreturn]] void fail(const std::string& message);
+
+// Strings as they are, anything else as JSON
+std::string toText(const Dictionary& v);
+
+// Total order of jq values: null < false < true < numbers < strings < arrays < objects
+int compare(const Dictionary& a, const Dictionary& b);
+bool equal(const Dictionary& a, const Dictionary& b);
+
+// The elements of an array or the values of an object, in order
+std::vector<const Dictionary*> items(const Dictionary& v);
+Dictionary array(std::vector<Dictionary> values);
+Dictionary array(const std::vector<const Dictionary*>& values);
+Dictionary emptyArray();
+
+Dictionary add(const Dictionary& a, const Dictionary& b);
+Dictionary subtract(const Dictionary& a, const Dictionary& b);
+Dictionary multiply(const Dictionary& a, const Dictionary& b);
+Dictionary divide(const Dictionary& a, const Dictionary& b);
+Dictionary modulo(const Dictionary& a, const Dictionary& b);
+Dictionary negate(const Dictionary& v);
+
+// .key on `v`; null when the key is missing or `v` is null
+const Dictionary& fieldOf(const Dictionary& v, const std::string& key);
+
+// .[index] on `v`; negative indices count from the end
+const Dictionary& elementOf(const Dictionary& v, double index);
+
+const Dictionary& indexOf(const Dictionary& v, const Dictionary& index);
+
+// UTF-8 strings (lengths, slices and explode count code points, like jq)
+std::vector<uint32_t> codepoints(const std::string& s);
+void appendUtf8(std::string& out, uint32_t cp);
+size_t utf8Length(const std::string& s);
+Dictionary split(const std::string& s, const std::string& separator);
+
+} // namespace filter
+} // namespace pq
+} // namespace ps
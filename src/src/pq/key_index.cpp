@@ -0,0 +1,56 @@
+#include <ps/pq/key_index.h>
+#include <algorithm>
+
+namespace ps {
+namespace pq {
+
+void KeyIndex::visit(const Dictionary& from,
+                     const std::string& key,
+                     const std::function<void(const Dictionary&)>& visit) {
+    if (!built_) {
+        build();
+    }
+    
+    // Scalars have no members, at any depth
+    auto span = spans_.find(&from);
+    auto members = members_.find(key);
+    if (span == spans_.end() || members == members_.end()) {
+        return;
+    }
+    
+    const auto& list = members->second;
+    auto it = std::lower_bound(list.begin(), list.end(), span->second.first,
+                               [](const Member& member, size_t first) { return member.parent < first; });
+    for (; it != list.end() && it->parent < span->second.second; ++it) {
+        visit(*it->value);
+    }
+}
+
+void KeyIndex::build() {
+    size_t next = 0;
+    add(root_, next);
+    built_ = true;
+}
+
+void KeyIndex::add(const Dictionary& node, size_t& next) {
+    size_t number = next++;
+    if (node.isMappedObject()) {
+        // All members first, so each list stays in order of the objects
+        for (const auto& member : node.members()) {
+            members_[member.first].push_back({number, &member.second});
+        }
+        for (const auto& member : node.members()) {
+            add(member.second, next);
+        }
+    } else if (node.isArrayObject()) {
+        for (const auto& element : node.elements()) {
+            add(element.second, next);
+        }
+    } else {
+        return;
+    }
+    spans_[&node] = {number, next};
+}
+
+} // namespace pq
+} // namespace ps
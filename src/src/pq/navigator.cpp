@@ -1,103 +1,251 @@
 #include <ps/pq/navigator.h>
+#include <cstdlib>
 #include <stdexcept>
 #include <sstream>
 
 namespace ps {
 namespace pq {
 
+namespace {
+
+// Whether `value` is written as `text` in a path: strings as they are,
+// numbers by value, booleans and null by name
+bool equals(const Dictionary& value, const std::string& text) {
+    switch (value.type()) {
+        case Dictionary::TYPE::String:
+            return value.asStringRef() == text;
+        case Dictionary::TYPE::Integer:
+        case Dictionary::TYPE::Double: {
+            char* end = nullptr;
+            double number = std::strtod(text.c_str(), &end);
+            return !text.empty() && *end == '\0' && number == value.asDouble();
+        }
+        case Dictionary::TYPE::Boolean:
+            return text == (value.asBool() ? "true" : "false");
+        case Dictionary::TYPE::Null:
+            return text == "null";
+        default:
+            return false;
+    }
+}
+
+bool accepts(const PathToken& predicate, const Dictionary& element) {
+    const auto& members = element.members();
+    auto it = members.find(predicate.predicateKey());
+    bool equal = it != members.end() && equals(it->second, predicate.predicateValue());
+    return equal != predicate.predicateNegated();
+}
+
+} // namespace
+
 Dictionary Navigator::navigate(const Dictionary& dict, const std::vector<PathToken>& tokens) {
-    if (tokens.empty()) {
-        return dict;
+    // Only the value found is copied, not the subtrees on the way to it
+    return resolve(dict, tokens);
+}
+
+std::vector<Dictionary> Navigator::navigateWildcard(const Dictionary& dict, const std::vector<PathToken>& tokens) {
+    std::vector<Dictionary> results;
+    visitWildcard(dict, tokens, [&results](const Dictionary& match) {
+        results.push_back(match);
+    });
+    return results;
+}
+
+const Dictionary& Navigator::resolve(const Dictionary& dict,
+                                     const std::vector<PathToken>& tokens) const {
+    for (const auto& token : tokens) {
+        if (token.matchesMany()) {
+            throw std::invalid_argument("Wildcards require navigateWildcard(), not navigate()");
+        }
     }
+    return walk(dict, tokens, 0, tokens.size());
+}
+
+std::vector<const Dictionary*> Navigator::resolveWildcard(
+        const Dictionary& dict, const std::vector<PathToken>& tokens) const {
+    std::vector<const Dictionary*> results;
+    expand(dict, tokens, 0, [&results](const Dictionary& match) {
+        results.push_back(&match);
+    });
+    return results;
+}
+
+void Navigator::visitWildcard(const Dictionary& dict,
+                              const std::vector<PathToken>& tokens,
+                              const std::function<void(const Dictionary&)>& visit) const {
+    expand(dict, tokens, 0, visit);
+}
+
+size_t Navigator::countMatches(const Dictionary& dict, const std::vector<PathToken>& tokens) const {
+    size_t count = 0;
+    expand(dict, tokens, 0, [&count](const Dictionary&) { ++count; });
+    return count;
+}
+
+bool Navigator::matchesAny(const Dictionary& dict, const std::vector<PathToken>& tokens) const {
+    // Thrown out of the walk at the first match
+    struct Found {};
+    try {
+        match(dict, tokens, 0, [](const Dictionary&) { throw Found{}; });
+    } catch (const Found&) {
+        return true;
+    }
+    return false;
+}
+
+const Dictionary& Navigator::walk(const Dictionary& current,
+                                  const std::vector<PathToken>& tokens,
+                                  size_t begin,
+                                  size_t end) const {
+    const Dictionary* node = &current;
     
-    Dictionary current = dict;
-    
-    for (size_t i = 0; i < tokens.size(); ++i) {
+    for (size_t i = begin; i < end; ++i) {
         const auto& token = tokens[i];
         
-        if (token.isWildcard()) {
-            throw std::invalid_argument("Wildcards require navigateWildcard(), not navigate()");
-        }
-        
         if (token.isKey()) {
             const std::string& key = token.asKey();
-            if (!current.has(key)) {
+            if (!node->has(key)) {
                 std::ostringstream oss;
                 oss << "Key '" << key << "' not found";
                 throw std::out_of_range(oss.str());
             }
-            current = current.at(key);
+            node = &node->at(key);
         } else if (token.isIndex()) {
             int index = token.asIndex();
             
             // Check if current is an array
-            if (current.size() == 0) {
+            if (node->size() == 0) {
                 throw std::out_of_range("Cannot index into empty value");
             }
             
-            // Try to access by index
-            if (index < 0 || index >= static_cast<int>(current.size())) {
+            // Try to access by index, from the end if negative
+            int position = index < 0 ? index + node->size() : index;
+            if (position < 0 || position >= static_cast<int>(node->size())) {
                 std::ostringstream oss;
-                oss << "Index " << index << " out of range (size: " << current.size() << ")";
+                oss << "Index " << index << " out of range (size: " << node->size() << ")";
                 throw std::out_of_range(oss.str());
             }
             
-            current = current.at(index);
+            node = &node->at(position);
         }
     }
     
-    return current;
+    return *node;
 }
 
-std::vector<Dictionary> Navigator::navigateWildcard(const Dictionary& dict, const std::vector<PathToken>& tokens) {
-    std::vector<Dictionary> results;
-    
-    if (tokens.empty()) {
-        results.push_back(dict);
-        return results;
+void Navigator::expand(const Dictionary& current,
+                       const std::vector<PathToken>& tokens,
+                       size_t begin,
+                       const std::function<void(const Dictionary&)>& visit) const {
+    // Find the next wildcard position
+    size_t wildcardPos = begin;
+    while (wildcardPos < tokens.size() && !tokens[wildcardPos].matchesMany()) {
+        ++wildcardPos;
     }
     
-    // Find first wildcard position
-    size_t wildcardPos = tokens.size();
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        if (tokens[i].isWildcard()) {
-            wildcardPos = i;
-            break;
+    // Navigate to the point before the wildcard
+    const Dictionary& node = walk(current, tokens, begin, wildcardPos);
+    if (wildcardPos == tokens.size()) {
+        visit(node);
+        return;
+    }
+    if (tokens[wildcardPos].isDescent()) {
+        descend(node, tokens, wildcardPos + 1, visit);
+        return;
+    }
+    if (!tokens[wildcardPos].isWildcard()) {
+        // Objects have no elements to slice or filter, as with *
+        if (!node.isArrayObject() && node.size() > 0) {
+            throw std::logic_error("Not a list");
         }
+        select(node, tokens[wildcardPos], [&](const Dictionary& element) {
+            expand(element, tokens, wildcardPos + 1, visit);
+        });
+        return;
     }
     
-    // If no wildcard, use regular navigate
-    if (wildcardPos == tokens.size()) {
-        results.push_back(navigate(dict, tokens));
-        return results;
+    // Expand wildcard - visit all elements in place and handle the remaining
+    // path (which might have more wildcards) below each of them
+    int size = node.size();
+    for (int i = 0; i < size; ++i) {
+        expand(node.at(i), tokens, wildcardPos + 1, visit);
+    }
+}
+
+void Navigator::descend(const Dictionary& node,
+                        const std::vector<PathToken>& tokens,
+                        size_t begin,
+                        const std::function<void(const Dictionary&)>& visit) const {
+    if (index_ && begin < tokens.size() && tokens[begin].isKey()) {
+        index_->visit(node, tokens[begin].asKey(), [&](const Dictionary& member) {
+            match(member, tokens, begin + 1, visit);
+        });
+        return;
     }
     
-    // Navigate to the point before the wildcard
-    std::vector<PathToken> beforeWildcard(tokens.begin(), tokens.begin() + wildcardPos);
-    Dictionary current = beforeWildcard.empty() ? dict : navigate(dict, beforeWildcard);
-    
-    // Expand wildcard - iterate over all elements
-    std::vector<Dictionary> wildcardResults;
-    size_t size = static_cast<size_t>(current.size());
-    for (size_t i = 0; i < size; ++i) {
-        wildcardResults.push_back(current.at(static_cast<int>(i)));
+    match(node, tokens, begin, visit);
+    for (const auto& member : node.members()) {
+        descend(member.second, tokens, begin, visit);
+    }
+    for (const auto& element : node.elements()) {
+        descend(element.second, tokens, begin, visit);
+    }
+}
+
+void Navigator::match(const Dictionary& node,
+                      const std::vector<PathToken>& tokens,
+                      size_t begin,
+                      const std::function<void(const Dictionary&)>& visit) const {
+    if (begin == tokens.size()) {
+        visit(node);
+        return;
     }
     
-    // If there are tokens after the wildcard, navigate each result
-    if (wildcardPos + 1 < tokens.size()) {
-        std::vector<PathToken> afterWildcard(tokens.begin() + wildcardPos + 1, tokens.end());
-        
-        for (const auto& item : wildcardResults) {
-            // Recursively handle remaining path (might have more wildcards)
-            auto subResults = navigateWildcard(item, afterWildcard);
-            results.insert(results.end(), subResults.begin(), subResults.end());
+    const auto& token = tokens[begin];
+    if (token.isKey()) {
+        const auto& members = node.members();
+        auto it = members.find(token.asKey());
+        if (it != members.end()) {
+            match(it->second, tokens, begin + 1, visit);
+        }
+    } else if (token.isIndex()) {
+        const auto& elements = node.elements();
+        int index = token.asIndex();
+        auto it = elements.find(index < 0 ? index + static_cast<int>(elements.size()) : index);
+        if (it != elements.end()) {
+            match(it->second, tokens, begin + 1, visit);
         }
+    } else if (token.isWildcard()) {
+        for (const auto& element : node.elements()) {
+            match(element.second, tokens, begin + 1, visit);
+        }
+    } else if (!token.isDescent()) {
+        select(node, token, [&](const Dictionary& element) {
+            match(element, tokens, begin + 1, visit);
+        });
     } else {
-        // No more tokens after wildcard, return all items
-        results = wildcardResults;
+        descend(node, tokens, begin + 1, visit);
+    }
+}
+
+void Navigator::select(const Dictionary& node,
+                       const PathToken& token,
+                       const std::function<void(const Dictionary&)>& visit) const {
+    // Elements are kept by index, so a slice starts at its first element
+    // instead of stepping through those before it
+    const auto& elements = node.elements();
+    if (token.isSlice()) {
+        auto range = token.sliceRange(static_cast<int>(elements.size()));
+        for (auto it = elements.lower_bound(range.first); it != elements.end() && it->first < range.second; ++it) {
+            visit(it->second);
+        }
+        return;
+    }
+    for (const auto& element : elements) {
+        if (accepts(token, element.second)) {
+            visit(element.second);
+        }
     }
-    
-    return results;
 }
 
 } // namespace pq
@@ -1,52 +1,88 @@
 #include <ps/pq/output_formatter.h>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <cstdio>
 #include <sstream>
 
 namespace ps {
 namespace pq {
 
+namespace {
+
+// Output collected by ResultWriter before it is written to the stream
+const size_t WRITE_BUFFER_SIZE = 256 * 1024;
+
+void appendInteger(std::string& out, int64_t value) {
+    char digits[24];
+    auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    out.append(digits, end);
+}
+
+} // namespace
+
 std::string OutputFormatter::formatRaw(const Dictionary& value) {
-    // For scalars, output raw value without quotes
-    try {
-        // Try boolean first (before integer)
-        bool b = value.asBool();
-        return b ? "true" : "false";
-    } catch (...) {}
-    
-    try {
-        // Try double before integer to preserve decimal values
-        double d = value.asDouble();
-        // Check if it's actually an integer value
-        if (d == static_cast<int>(d)) {
-            return std::to_string(static_cast<int>(d));
-        }
-        std::ostringstream oss;
-        oss << d;
-        return oss.str();
-    } catch (...) {}
-    
-    try {
-        // Try string (output without quotes for shell use)
-        return value.asString();
-    } catch (...) {}
-    
-    // If it's an object or complex type, return JSON
-    return value.dump(0, true);
+    std::string text;
+    appendRaw(text, value);
+    return text;
 }
 
 std::string OutputFormatter::formatRaw(const std::vector<Dictionary>& values) {
-    if (values.empty()) {
-        return "";
+    std::string text;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) {
+            text += '\n';
+        }
+        appendRaw(text, values[i]);
     }
-    
-    std::ostringstream oss;
+    return text;
+}
+
+std::string OutputFormatter::formatRaw(const std::vector<const Dictionary*>& values) {
+    std::string text;
     for (size_t i = 0; i < values.size(); ++i) {
-        oss << formatRaw(values[i]);
-        if (i + 1 < values.size()) {
-            oss << "\n";
+        if (i > 0) {
+            text += '\n';
         }
+        appendRaw(text, *values[i]);
     }
-    
-    return oss.str();
+    return text;
+}
+
+void OutputFormatter::appendRaw(std::string& out, const Dictionary& value) {
+    // Scalars are written without quotes for shell use
+    switch (value.type()) {
+        case Dictionary::Boolean:
+            out += value.asBool() ? "true" : "false";
+            return;
+        case Dictionary::Integer:
+            appendInteger(out, value.asInt());
+            return;
+        case Dictionary::Double: {
+            // Whole numbers are written without a decimal point
+            double d = value.asDouble();
+            if (d >= INT_MIN && d <= INT_MAX && d == static_cast<int>(d)) {
+                appendInteger(out, static_cast<int>(d));
+                return;
+            }
+            // %g is what operator<< writes by default
+            char digits[32];
+            int n = std::snprintf(digits, sizeof(digits), "%g", d);
+            out.append(digits, static_cast<size_t>(n));
+            return;
+        }
+        case Dictionary::String:
+            out += value.asStringRef();
+            return;
+        default:
+            // Objects, arrays and null are written as JSON
+            out += value.dump(0, true);
+            return;
+    }
+}
+
+void OutputFormatter::appendJson(std::string& out, const Dictionary& value) {
+    out += value.dump(0, true);
 }
 
 std::string OutputFormatter::formatJson(const Dictionary& value) {
@@ -72,5 +108,84 @@ std::string OutputFormatter::formatJson(const std::vector<Dictionary>& values) {
     return oss.str();
 }
 
+std::string OutputFormatter::formatJson(const std::vector<const Dictionary*>& values) {
+    std::ostringstream oss;
+    oss << "[";
+    for (size_t i = 0; i < values.size(); ++i) {
+        oss << formatJson(*values[i]);
+        if (i + 1 < values.size()) {
+            oss << ",";
+        }
+    }
+    oss << "]";
+    
+    return oss.str();
+}
+
+std::string OutputFormatter::formatShell(const std::string& path, const std::string& text) {
+    std::string name;
+    for (char c : path) {
+        unsigned char u = static_cast<unsigned char>(c);
+        name += std::isalnum(u) ? static_cast<char>(std::toupper(u)) : '_';
+    }
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+        name.insert(name.begin(), '_');
+    }
+    
+    // Single quotes keep everything literal; a quote itself is written as '\''
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    quoted += "'";
+    
+    return name + "=" + quoted;
+}
+
+ResultWriter::ResultWriter(std::ostream& out, bool asJson)
+    : out_(out), asJson_(asJson) {
+    buffer_.reserve(WRITE_BUFFER_SIZE);
+}
+
+ResultWriter::~ResultWriter() {
+    // Whatever was written before an error still reaches the stream
+    flush();
+}
+
+void ResultWriter::write(const Dictionary& value) {
+    if (asJson_) {
+        buffer_ += count_ == 0 ? '[' : ',';
+        formatter_.appendJson(buffer_, value);
+    } else {
+        formatter_.appendRaw(buffer_, value);
+        buffer_ += '\n';
+    }
+    ++count_;
+    if (buffer_.size() >= WRITE_BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void ResultWriter::finish() {
+    if (asJson_) {
+        buffer_ += count_ == 0 ? "[]\n" : "]\n";
+    } else if (count_ == 0) {
+        buffer_ += '\n';
+    }
+    flush();
+}
+
+void ResultWriter::flush() {
+    if (buffer_.empty()) {
+        return;
+    }
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+}
+
 } // namespace pq
 } // namespace ps
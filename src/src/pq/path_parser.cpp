@@ -1,6 +1,6 @@
 #include <ps/pq/path_parser.h>
+#include <algorithm>
 #include <stdexcept>
-#include <sstream>
 #include <cctype>
 
 namespace ps {
@@ -19,6 +19,24 @@ PathToken PathToken::makeWildcard() {
     return PathToken(Type::Wildcard, "", -1);
 }
 
+PathToken PathToken::makeDescent() {
+    return PathToken(Type::Descent, "", -1);
+}
+
+PathToken PathToken::makeSlice(std::optional<int> begin, std::optional<int> end) {
+    PathToken token(Type::Slice, "", -1);
+    token.begin_ = begin;
+    token.end_ = end;
+    return token;
+}
+
+PathToken PathToken::makePredicate(const std::string& key, const std::string& value, bool negated) {
+    PathToken token(Type::Predicate, key, -1);
+    token.value_ = value;
+    token.negated_ = negated;
+    return token;
+}
+
 PathToken::PathToken(Type type, const std::string& key, int index)
     : type_(type), key_(key), index_(index) {}
 
@@ -36,15 +54,69 @@ int PathToken::asIndex() const {
     return index_;
 }
 
+std::optional<int> PathToken::sliceBegin() const {
+    if (type_ != Type::Slice) {
+        throw std::logic_error("PathToken is not a slice");
+    }
+    return begin_;
+}
+
+std::optional<int> PathToken::sliceEnd() const {
+    if (type_ != Type::Slice) {
+        throw std::logic_error("PathToken is not a slice");
+    }
+    return end_;
+}
+
+std::pair<int, int> PathToken::sliceRange(int size) const {
+    auto clamp = [size](std::optional<int> bound, int missing) {
+        if (!bound) {
+            return missing;
+        }
+        int index = *bound < 0 ? *bound + size : *bound;
+        return std::min(std::max(index, 0), size);
+    };
+    int first = clamp(sliceBegin(), 0);
+    int last = clamp(sliceEnd(), size);
+    return {first, std::max(first, last)};
+}
+
+const std::string& PathToken::predicateKey() const {
+    if (type_ != Type::Predicate) {
+        throw std::logic_error("PathToken is not a predicate");
+    }
+    return key_;
+}
+
+const std::string& PathToken::predicateValue() const {
+    if (type_ != Type::Predicate) {
+        throw std::logic_error("PathToken is not a predicate");
+    }
+    return value_;
+}
+
+bool PathToken::predicateNegated() const {
+    if (type_ != Type::Predicate) {
+        throw std::logic_error("PathToken is not a predicate");
+    }
+    return negated_;
+}
+
 // PathParser implementation
 std::vector<PathToken> PathParser::parse(const std::string& path) {
     if (path.empty()) {
         throw std::invalid_argument("Path cannot be empty");
     }
     
-    // Auto-detect separator: prefer slash, fall back to dot
+    // The document itself, such as the array of --slurp
+    if (path == ".") {
+        return {};
+    }
+    
+    // Auto-detect separator: prefer slash, fall back to dot. Neither counts
+    // inside [...], as in items/[version=1.2].
     char separator = '/';
-    if (path.find('/') == std::string::npos && path.find('.') != std::string::npos) {
+    if (split(path, '/').size() == 1 && split(path, '.').size() > 1) {
         separator = '.';
     }
     
@@ -61,25 +133,31 @@ std::vector<PathToken> PathParser::parse(const std::string& path) {
     }
     
     std::vector<PathToken> tokens;
-    std::stringstream ss(path);
-    std::string segment;
-    
-    while (std::getline(ss, segment, separator)) {
+    for (const auto& segment : split(path, separator)) {
         if (segment.empty()) {
             throw std::invalid_argument("Path cannot contain empty segments (double slashes)");
         }
         
+        // Recursive descent: this value and everything below it. Repeating it
+        // would only find the same values again.
+        if (segment == "**") {
+            if (tokens.empty() || !tokens.back().isDescent()) {
+                tokens.push_back(PathToken::makeDescent());
+            }
+        }
         // Check for wildcard
-        if (segment == "*") {
+        else if (segment == "*") {
             tokens.push_back(PathToken::makeWildcard());
         }
-        // Check if segment is a valid non-negative integer
-        else if (isArrayIndex(segment)) {
+        // Slices and predicates
+        else if (segment[0] == '[') {
+            tokens.push_back(parseBracket(segment));
+        }
+        // Check if segment is an integer; negative ones count from the end
+        else if (isArrayIndex(segment) ||
+                 (segment[0] == '-' && segment.length() > 1 && isArrayIndex(segment.substr(1)))) {
             int index = std::stoi(segment);
             tokens.push_back(PathToken::makeIndex(index));
-        } else if (segment[0] == '-' && segment.length() > 1 && isArrayIndex(segment.substr(1))) {
-            // Negative index - not allowed
-            throw std::invalid_argument("Array indices must be non-negative");
         } else {
             // Treat as a key
             tokens.push_back(PathToken::makeKey(segment));
@@ -89,6 +167,76 @@ std::vector<PathToken> PathParser::parse(const std::string& path) {
     return tokens;
 }
 
+std::vector<std::string> PathParser::split(const std::string& path, char separator) {
+    std::vector<std::string> segments(1);
+    bool inBracket = false;
+    bool inQuotes = false;
+    for (char c : path) {
+        std::string& segment = segments.back();
+        if (inBracket) {
+            if (c == '"') {
+                inQuotes = !inQuotes;
+            } else if (c == ']' && !inQuotes) {
+                inBracket = false;
+            }
+        } else if (c == separator) {
+            segments.emplace_back();
+            continue;
+        } else if (c == '[' && segment.empty()) {
+            inBracket = true;
+        }
+        segment += c;
+    }
+    
+    if (inBracket) {
+        throw std::invalid_argument("Path has an unclosed '[': " + segments.back());
+    }
+    return segments;
+}
+
+PathToken PathParser::parseBracket(const std::string& segment) {
+    std::string error = "Expected [start:end], [index] or [key=value] in path, got " + segment;
+    if (segment.size() < 2 || segment.back() != ']') {
+        throw std::invalid_argument(error);
+    }
+    std::string inner = segment.substr(1, segment.size() - 2);
+    auto unquote = [](const std::string& text) {
+        if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+            return text.substr(1, text.size() - 2);
+        }
+        return text;
+    };
+    
+    // [key=value], [key!=value]
+    size_t equals = inner.find('=');
+    if (equals != std::string::npos) {
+        bool negated = equals > 0 && inner[equals - 1] == '!';
+        std::string key = unquote(inner.substr(0, negated ? equals - 1 : equals));
+        if (key.empty()) {
+            throw std::invalid_argument("Predicate has no key: " + segment);
+        }
+        return PathToken::makePredicate(key, unquote(inner.substr(equals + 1)), negated);
+    }
+    
+    auto parseIndex = [this, &error](const std::string& text) {
+        bool negative = !text.empty() && text[0] == '-';
+        if (!isArrayIndex(negative ? text.substr(1) : text)) {
+            throw std::invalid_argument(error);
+        }
+        return std::stoi(text);
+    };
+    
+    // [start:end], either bound optional
+    size_t colon = inner.find(':');
+    if (colon != std::string::npos) {
+        std::string begin = inner.substr(0, colon);
+        std::string end = inner.substr(colon + 1);
+        return PathToken::makeSlice(begin.empty() ? std::nullopt : std::optional<int>(parseIndex(begin)),
+                                    end.empty() ? std::nullopt : std::optional<int>(parseIndex(end)));
+    }
+    return PathToken::makeIndex(parseIndex(inner));
+}
+
 bool PathParser::isArrayIndex(const std::string& segment) {
     if (segment.empty()) {
         return false;
@@ -0,0 +1,130 @@
+#include "pq_batch.h"
+#include "pq_records.h"
+
+#include <ps/parsec.h>
+#include <ps/pq/filter.h>
+#include <ps/pq/query_runner.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ps {
+namespace pq {
+
+namespace {
+
+struct FileResult {
+    std::string output;
+    std::vector<std::string> errors;  // empty when answered
+    bool done = false;
+};
+
+void answerFile(const CliArgs& args, const std::string& path, FileResult& result) {
+    std::ifstream file;
+    std::istream* in = nullptr;
+    try {
+        in = &openInput(path, file);
+    } catch (const std::runtime_error&) {
+        result.errors.push_back("Failed to open file");
+        return;
+    }
+    QueryRunner runner;
+    try {
+        if (!isRecordInput(path)) {
+            std::stringstream content;
+            content << in->rdbuf();
+            Dictionary data = ps::parse(content.str(), false, path);
+            result.output = runner.runFile(args, path, data);
+            return;
+        }
+        
+        // One result per record, as when the input is queried on its own; a
+        // record that fails is reported and the rest still run
+        readRecords(
+            *in, path,
+            [&](const Dictionary& record, size_t line, bool) {
+                try {
+                    result.output += runner.runFile(args, path, record);
+                } catch (const std::exception& e) {
+                    result.errors.push_back(line == 0 ? e.what()
+                                                      : "line " + std::to_string(line) + ": " + e.what());
+                }
+            },
+            [&result](const std::string& message) { result.errors.push_back(message); });
+    } catch (const std::exception& e) {
+        result.errors.push_back(e.what());
+    }
+}
+
+} // namespace
+
+int runBatch(const CliArgs& args) {
+    const auto& paths = args.getFilePaths();
+    std::vector<FileResult> results(paths.size());
+    std::mutex resultsMutex;
+    std::condition_variable resultsReady;
+    std::atomic<size_t> nextFile{0};
+    
+    auto worker = [&]() {
+        for (;;) {
+            size_t i = nextFile.fetch_add(1);
+            if (i >= paths.size()) return;
+            FileResult result;
+            answerFile(args, paths[i], result);
+            {
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                results[i].output = std::move(result.output);
+                results[i].errors = std::move(result.errors);
+                results[i].done = true;
+            }
+            resultsReady.notify_all();
+        }
+    };
+    
+    unsigned jobs = args.jobs();
+    if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+    jobs = static_cast<unsigned>(std::min<size_t>(jobs, paths.size()));
+    
+    std::vector<std::thread> workers;
+    workers.reserve(jobs);
+    for (unsigned t = 0; t < jobs; ++t) workers.emplace_back(worker);
+    
+    // Print each file's result in input order as soon as it is ready
+    int status = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        FileResult result;
+        {
+            std::unique_lock<std::mutex> lock(resultsMutex);
+            resultsReady.wait(lock, [&] { return results[i].done; });
+            result.output = std::move(results[i].output);
+            result.errors = std::move(results[i].errors);
+        }
+        std::cout << result.output;
+        for (const auto& error : result.errors) {
+            status = 1;
+            if (args.outputAsJson()) {
+                Dictionary line;
+                line["file"] = paths[i];
+                line["error"] = error;
+                std::cout << Filter::toJson(line) << "\n";
+            } else {
+                std::cout << std::flush;
+                std::cerr << "Error: " << paths[i] << ": " << error << "\n" << std::flush;
+            }
+        }
+    }
+    for (auto& w : workers) w.join();
+    
+    return status;
+}
+
+} // namespace pq
+} // namespace ps
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <ps/pq/cli_args.h>
+
+namespace ps {
+namespace pq {
+
+// Answers the queries of `args` for each of its input files on a pool of
+// worker threads (--jobs). Results are printed in input order as soon as
+// each file is done; a file that can't be read, parsed or answered is
+// reported without stopping the others. Returns 1 if any file failed.
+int runBatch(const CliArgs& args);
+
+} // namespace pq
+} // namespace ps
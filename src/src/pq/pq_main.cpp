@@ -2,11 +2,14 @@
 // A shell-friendly alternative to jq
 
 #include <ps/parsec.h>
-#include <ps/pq/path_parser.h>
-#include <ps/pq/navigator.h>
 #include <ps/pq/cli_args.h>
-#include <ps/pq/output_formatter.h>
+#include <ps/pq/query_runner.h>
 
+#include "pq_batch.h"
+#include "pq_records.h"
+#include "pq_server.h"
+
+#include <filesystem>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -28,19 +31,64 @@ void showHelp() {
     std::cout << "  pq <file> --get <path> [--default <value>] [--as-json]\n";
     std::cout << "  pq <file> --count <path>\n";
     std::cout << "  pq <file> --has <path>\n";
-    std::cout << "  pq <file>\n\n";
+    std::cout << "  pq <file> <action> <path> [<action> <path> ...] [--as-shell]\n";
+    std::cout << "  pq <file> '<filter>' [-r] [--arg <name> <value>] [--argjson <name> <json>]\n";
+    std::cout << "  pq <file>\n";
+    std::cout << "  pq <action> <path> [...] [--jobs N] <file>...\n";
+    std::cout << "  <command> | pq <action> <path> [...]\n";
+    std::cout << "  pq --serve <socket>\n";
+    std::cout << "  pq --client <socket> <file> <action> <path> ...\n\n";
     std::cout << "Actions:\n";
     std::cout << "  --get, -g <path>     Extract value at path\n";
-    std::cout << "  --count <path>       Count array elements at path\n";
-    std::cout << "  --has <path>         Check if path exists (exit 0/1)\n";
-    std::cout << "  (default)            Pretty-print entire file\n\n";
+    std::cout << "  --count <path>       Count array elements at path, or the matches of a\n";
+    std::cout << "                       path with *, **, a slice or a predicate\n";
+    std::cout << "  --has <path>         Check if path exists or matches anything (exit 0/1)\n";
+    std::cout << "  (default)            Pretty-print entire file\n";
+    std::cout << "  Several actions are run on one parse and print one line each, in order\n";
+    std::cout << "  (--has prints true/false, wildcard matches print as a JSON array)\n";
+    std::cout << "  --stream             Answer a single action on a .json file while reading\n";
+    std::cout << "                       it and stop once it is answered; errors in the input\n";
+    std::cout << "                       after the answer are not reported\n\n";
+    std::cout << "Filters:\n";
+    std::cout << "  A jq-style filter prints each output on its own line as compact JSON:\n";
+    std::cout << "  .users[] | select(.age > 30) | {name, email}\n";
+    std::cout << "  Supports paths, pipes, comparisons, arithmetic, if/try/reduce/foreach,\n";
+    std::cout << "  'as $x', assignments (= |= += ...), @csv/@tsv/@sh/... and the common\n";
+    std::cout << "  builtins; not def, label, input or the date builtins. Object keys are\n";
+    std::cout << "  printed sorted.\n";
+    std::cout << "  --raw-output, -r      Print string outputs without quotes\n";
+    std::cout << "  --arg <name> <value>  Set $name to the string value\n";
+    std::cout << "  --argjson <name> <j>  Set $name to the JSON value\n\n";
+    std::cout << "Several files:\n";
+    std::cout << "  Files given after the actions are queried on N worker threads (--jobs, default\n";
+    std::cout << "  one per core). Results print in input order as 'file: result' lines, or with\n";
+    std::cout << "  --as-json as one {\"file\", \"value\"} object per file (\"values\" for several\n";
+    std::cout << "  actions). Record inputs (- and .ndjson/.jsonl) give one result per record.\n";
+    std::cout << "  A file or record that fails is reported and the rest still run; the exit\n";
+    std::cout << "  status is then 1.\n\n";
+    std::cout << "Records and stdin:\n";
+    std::cout << "  stdin (no file, or -) and .ndjson/.jsonl files are read as a sequence of\n";
+    std::cout << "  JSON objects and arrays, one per line or split by whitespace. Each is\n";
+    std::cout << "  queried as soon as it is read; a record that fails is reported with its\n";
+    std::cout << "  line and the rest still run. Other input on stdin is parsed as one document.\n";
+    std::cout << "  --slurp, -s          Query every record and file together as one array\n\n";
+    std::cout << "Query daemon:\n";
+    std::cout << "  --serve <socket>     Keep parsed files resident and answer queries on a\n";
+    std::cout << "                       Unix socket; files are re-read when they change\n";
+    std::cout << "  --client <socket>    Send the rest of the command line to the daemon\n";
+    std::cout << "                       (not for stdin or .ndjson/.jsonl files)\n\n";
     std::cout << "Options:\n";
-    std::cout << "  --default, -d <val>  Default value if path not found\n";
-    std::cout << "  --as-json            Output as JSON instead of raw\n\n";
+    std::cout << "  --default, -d <val>  Default value if the preceding path is not found\n";
+    std::cout << "  --as-json            Output as JSON instead of raw\n";
+    std::cout << "  --as-shell           Output NAME='value' lines for eval (a/b -> A_B)\n\n";
     std::cout << "Path syntax:\n";
     std::cout << "  Keys separated by /: server/port\n";
-    std::cout << "  Array indices:       users/0/name\n";
+    std::cout << "  The whole document:  .\n";
+    std::cout << "  Array indices:       users/0/name (users/-1 is the last)\n";
     std::cout << "  Wildcards:           users/*/email\n";
+    std::cout << "  Slices:              items/[100:200], items/[-10:] (either end optional)\n";
+    std::cout << "  Predicates:          zones/[type=wall]/name, zones/[type!=wall]\n";
+    std::cout << "  Any depth:           **/boundary conditions (paths below ** may be missing)\n";
     std::cout << "  Spaces in keys:      \"server config/port number\"\n\n";
     std::cout << "Examples:\n";
     std::cout << "  pq config.json --get server/port\n";
@@ -48,9 +96,19 @@ void showHelp() {
     std::cout << "  pq data.toml --count users\n";
     std::cout << "  pq settings.ron --has debug/enabled\n";
     std::cout << "  pq config.json --get \"mesh adaptation/starting mesh complexity\"\n";
+    std::cout << "  eval \"$(pq config.json -g server/host -g server/port --as-shell)\"\n";
+    std::cout << "  pq --get run/status results/*.json\n";
+    std::cout << "  tail -f log.ndjson | pq -g level\n";
+    std::cout << "  pq --slurp --count . runs/*.json\n";
+    std::cout << "  pq users.json '.users[] | select(.active) | .email' -r\n";
+    std::cout << "  pq users.json --arg team ops '[.users[] | select(.team == $team)] | length'\n";
 }
 
 int main(int argc, const char* argv[]) {
+    // Lets stdin report what it has buffered, so records already read are
+    // printed before waiting for more
+    std::ios::sync_with_stdio(false);
+    
     try {
         // Parse command-line arguments
         ps::pq::CliArgs args(argc, argv);
@@ -60,91 +118,55 @@ int main(int argc, const char* argv[]) {
             return 0;
         }
         
-        // Read and parse the file
-        std::string content = readFile(args.getFilePath());
-        ps::Dictionary data = ps::parse(content, false, args.getFilePath());
-        
-        ps::pq::PathParser pathParser;
-        ps::pq::Navigator navigator;
-        ps::pq::OutputFormatter formatter;
+        if (args.getAction() == ps::pq::CliArgs::Action::SERVE) {
+            return ps::pq::serve(args.getSocketPath());
+        }
         
-        switch (args.getAction()) {
-            case ps::pq::CliArgs::Action::PRINT: {
-                // Pretty-print the entire file
-                std::cout << data.dump(4, false) << "\n";
-                return 0;
-            }
-            
-            case ps::pq::CliArgs::Action::GET: {
-                // Extract value at path
-                auto tokens = pathParser.parse(args.getPath());
-                
-                try {
-                    // Check if path contains wildcards
-                    bool hasWildcard = false;
-                    for (const auto& token : tokens) {
-                        if (token.isWildcard()) {
-                            hasWildcard = true;
-                            break;
-                        }
-                    }
-                    
-                    if (hasWildcard) {
-                        // Use wildcard navigation
-                        auto results = navigator.navigateWildcard(data, tokens);
-                        
-                        if (results.empty() && args.hasDefault()) {
-                            std::cout << args.getDefault() << "\n";
-                        } else if (args.outputAsJson()) {
-                            std::cout << formatter.formatJson(results) << "\n";
-                        } else {
-                            std::cout << formatter.formatRaw(results) << "\n";
-                        }
-                    } else {
-                        // Use regular navigation
-                        auto result = navigator.navigate(data, tokens);
-                        
-                        if (args.outputAsJson()) {
-                            std::cout << formatter.formatJson(result) << "\n";
-                        } else {
-                            std::cout << formatter.formatRaw(result) << "\n";
-                        }
-                    }
-                } catch (const std::out_of_range&) {
-                    if (args.hasDefault()) {
-                        std::cout << args.getDefault() << "\n";
-                        return 0;
-                    }
-                    throw;
-                }
-                
-                return 0;
+        if (!args.getSocketPath().empty()) {
+            // The daemon keeps one document per file
+            if (ps::pq::isRecordInput(args.getFilePath())) {
+                throw std::invalid_argument("--client can't query the records of " + args.getFilePath() +
+                                            "; query it without --client");
             }
-            
-            case ps::pq::CliArgs::Action::COUNT: {
-                // Count array elements
-                auto tokens = pathParser.parse(args.getPath());
-                auto result = navigator.navigate(data, tokens);
-                std::cout << result.size() << "\n";
-                return 0;
+            // Let the daemon answer; it may run in another directory
+            std::vector<std::string> forwarded(argv + 3, argv + argc);
+            forwarded[0] = std::filesystem::absolute(forwarded[0]).string();
+            return ps::pq::runClient(args.getSocketPath(), forwarded);
+        }
+        
+        if (args.slurp()) {
+            return ps::pq::QueryRunner().run(args, ps::pq::slurpInputs(args), std::cout);
+        }
+        
+        if (args.getFilePaths().size() > 1) {
+            return ps::pq::runBatch(args);
+        }
+        
+        // stdin and NDJSON files are queried a record at a time as they arrive
+        if (ps::pq::isRecordInput(args.getFilePath())) {
+            std::ifstream file;
+            return ps::pq::runRecords(args, ps::pq::openInput(args.getFilePath(), file), args.getFilePath());
+        }
+        
+        // With --stream, a single query on a JSON file is answered while
+        // reading it, which can stop long before the end
+        if (ps::pq::QueryRunner::canStream(args)) {
+            std::ifstream file(args.getFilePath(), std::ios::binary);
+            if (!file.is_open()) {
+                throw std::runtime_error("Failed to open file: " + args.getFilePath());
             }
-            
-            case ps::pq::CliArgs::Action::HAS: {
-                // Check if path exists
-                auto tokens = pathParser.parse(args.getPath());
-                try {
-                    navigator.navigate(data, tokens);
-                    return 0;  // Exists
-                } catch (const std::out_of_range&) {
-                    return 1;  // Does not exist
-                }
+            ps::pq::QueryRunner runner;
+            if (auto status = runner.runStreaming(args, file, std::cout)) {
+                return *status;
             }
-            
-            case ps::pq::CliArgs::Action::HELP:
-                // Already handled above
-                return 0;
         }
         
+        // Read and parse the file
+        std::string content = readFile(args.getFilePath());
+        ps::Dictionary data = ps::parse(content, false, args.getFilePath());
+        
+        ps::pq::QueryRunner runner;
+        return runner.run(args, data, std::cout);
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
         return 1;
@@ -0,0 +1,142 @@
+#include "pq_records.h"
+
+#include <ps/parsec.h>
+#include <ps/pq/query_runner.h>
+#include <ps/pq/record_reader.h>
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+namespace ps {
+namespace pq {
+
+void readRecords(std::istream& in,
+                 const std::string& path,
+                 const std::function<void(const Dictionary&, size_t line, bool drained)>& visit,
+                 const std::function<void(const std::string&)>& fail) {
+    // The extension of a file picks its parser; stdin is detected
+    std::string name = path == "-" ? "" : path;
+    RecordReader reader(in);
+    int next = reader.peek();
+    if (next == -1) {
+        return;
+    }
+    if (next != '{' && next != '[') {
+        visit(ps::parse(reader.rest(), false, name), 0, true);
+        return;
+    }
+    
+    bool first = true;
+    std::string text;
+    for (;;) {
+        try {
+            if (!reader.next(text)) {
+                return;
+            }
+        } catch (const std::runtime_error& e) {
+            fail(e.what());
+            continue;
+        }
+        
+        Dictionary record;
+        try {
+            record = parse_json(text);
+        } catch (const std::exception& e) {
+            if (first) {
+                // Not JSON after all (RON, say): the input is one document
+                visit(ps::parse(text + reader.rest(), false, name), 0, true);
+                return;
+            }
+            fail("line " + std::to_string(reader.line()) + ": " + e.what());
+            continue;
+        }
+        first = false;
+        visit(record, reader.line(), reader.drained());
+    }
+}
+
+bool isRecordInput(const std::string& path) {
+    if (path == "-") {
+        return true;
+    }
+    size_t dot = path.rfind('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = path.substr(dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".ndjson" || extension == ".jsonl";
+}
+
+std::istream& openInput(const std::string& path, std::ifstream& file) {
+    if (path == "-") {
+        return std::cin;
+    }
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file: " + path);
+    }
+    return file;
+}
+
+int runRecords(const CliArgs& args, std::istream& in, const std::string& path) {
+    QueryRunner runner;
+    int status = 0;
+    auto fail = [&status](const std::string& message) {
+        std::cout << std::flush;
+        std::cerr << "Error: " << message << "\n" << std::flush;
+        status = 1;
+    };
+    
+    readRecords(
+        in, path,
+        [&](const Dictionary& record, size_t line, bool drained) {
+            try {
+                if (runner.run(args, record, std::cout) != 0) {
+                    status = 1;
+                }
+            } catch (const std::exception& e) {
+                fail(line == 0 ? e.what() : "line " + std::to_string(line) + ": " + e.what());
+                return;
+            }
+            // Nothing more to read yet: show what there is before waiting
+            if (drained) {
+                std::cout << std::flush;
+            }
+        },
+        fail);
+    return status;
+}
+
+Dictionary slurpInputs(const CliArgs& args) {
+    std::vector<Dictionary> documents;
+    for (const auto& path : args.getFilePaths()) {
+        std::ifstream file;
+        std::istream& in = openInput(path, file);
+        std::string prefix = path == "-" ? "" : path + ": ";
+        if (isRecordInput(path)) {
+            readRecords(
+                in, path,
+                [&documents](const Dictionary& record, size_t, bool) { documents.push_back(record); },
+                [&prefix](const std::string& message) { throw std::runtime_error(prefix + message); });
+            continue;
+        }
+        
+        std::string content{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        try {
+            documents.push_back(ps::parse(content, false, path));
+        } catch (const std::exception& e) {
+            throw std::runtime_error(prefix + e.what());
+        }
+    }
+    return Dictionary(documents);
+}
+
+} // namespace pq
+} // namespace ps
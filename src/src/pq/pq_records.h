@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ps/dictionary.h>
+#include <ps/pq/cli_args.h>
+
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <string>
+
+namespace ps {
+namespace pq {
+
+// Whether `path` is read as a stream of records rather than one document:
+// stdin ("-") and .ndjson/.jsonl files
+bool isRecordInput(const std::string& path);
+
+// stdin for "-", or else `path` opened into `file`. Throws if it can't be
+// opened.
+std::istream& openInput(const std::string& path, std::ifstream& file);
+
+// Calls `visit` with each record of `in` and its line, or once with the whole
+// input (line 0) when it is not a sequence of JSON objects and arrays.
+// `drained` tells whether more input has to be waited for. A record that
+// can't be read or parsed is passed to `fail` with its line, and reading goes
+// on.
+void readRecords(std::istream& in,
+                 const std::string& path,
+                 const std::function<void(const Dictionary&, size_t line, bool drained)>& visit,
+                 const std::function<void(const std::string&)>& fail);
+
+// Answers the queries of `args` for each JSON object or array of `in` as soon
+// as it has been read, flushing the output whenever the input has to be
+// waited for. Input that doesn't start with one, or whose first record isn't
+// JSON, is parsed as a single document instead. A record that fails is
+// reported with its line and the rest still run; returns 1 if any failed.
+int runRecords(const CliArgs& args, std::istream& in, const std::string& path);
+
+// Every input of `args` in one array (--slurp): each record of the record
+// inputs and each document of the others
+Dictionary slurpInputs(const CliArgs& args);
+
+} // namespace pq
+} // namespace ps
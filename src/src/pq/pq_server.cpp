@@ -0,0 +1,336 @@
+// pq query daemon and its client
+//
+// Protocol, one request per connection: the client sends the pq arguments
+// (file path first, made absolute) each terminated by '\0' and shuts down its
+// write side. The server answers "<status> <stdout bytes>\n", the standard
+// output of the request and then its standard error, and closes the connection.
+//
+// Requests are read from every open connection at once, so a client that is
+// slow to send (or never does) doesn't hold up the others. Each connection
+// gets kRequestTimeout to deliver its request and to take the response.
+
+#include "pq_server.h"
+#include "pq_records.h"
+
+#include <ps/pq/cli_args.h>
+#include <ps/pq/document_cache.h>
+#include <ps/pq/query_runner.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace ps {
+namespace pq {
+
+#ifdef _WIN32
+
+int serve(const std::string&) {
+    throw std::runtime_error("--serve requires Unix domain sockets");
+}
+
+int runClient(const std::string&, const std::vector<std::string>&) {
+    throw std::runtime_error("--client requires Unix domain sockets");
+}
+
+#else
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::chrono::seconds kRequestTimeout(10);
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+// Closes the descriptor when it goes out of scope
+struct FileDescriptor {
+    int fd;
+    explicit FileDescriptor(int f) : fd(f) {}
+    ~FileDescriptor() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+    FileDescriptor(FileDescriptor&& other) noexcept : fd(other.fd) { other.fd = -1; }
+    FileDescriptor& operator=(FileDescriptor&& other) noexcept {
+        std::swap(fd, other.fd);
+        return *this;
+    }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+};
+
+// A connection whose request is still arriving
+struct PendingRequest {
+    FileDescriptor client;
+    std::string request;
+    Clock::time_point deadline;
+};
+
+sockaddr_un socketAddress(const std::string& socketPath) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("Socket path too long: " + socketPath);
+    }
+    std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    return addr;
+}
+
+std::runtime_error systemError(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+bool connectTo(int fd, const std::string& socketPath) {
+    sockaddr_un addr = socketAddress(socketPath);
+    return ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+}
+
+std::string readAll(int fd) {
+    std::string data;
+    char buffer[4096];
+    for (;;) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            data.append(buffer, static_cast<size_t>(n));
+        } else if (n == 0) {
+            return data;
+        } else if (errno != EINTR) {
+            throw systemError("Failed to read from socket");
+        }
+    }
+}
+
+// Reads what `fd` has available without blocking. Returns true once the
+// peer has shut down its write side.
+bool readAvailable(int fd, std::string& data) {
+    char buffer[4096];
+    for (;;) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            data.append(buffer, static_cast<size_t>(n));
+        } else if (n == 0) {
+            return true;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return false;
+        } else if (errno != EINTR) {
+            throw systemError("Failed to read from socket");
+        }
+    }
+}
+
+void writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.data() + written, data.size() - written);
+        if (n > 0) {
+            written += static_cast<size_t>(n);
+        } else if (errno != EINTR) {
+            throw systemError("Failed to write to socket");
+        }
+    }
+}
+
+// Runs one request against the resident documents and returns the response
+std::string answer(const std::string& request, DocumentCache& cache) {
+    std::vector<std::string> args;
+    size_t start = 0;
+    for (size_t end; (end = request.find('\0', start)) != std::string::npos; start = end + 1) {
+        args.push_back(request.substr(start, end - start));
+    }
+    
+    std::ostringstream out;
+    std::string err;
+    int status = 1;
+    try {
+        std::vector<const char*> argv = {"pq"};
+        for (const auto& arg : args) {
+            argv.push_back(arg.c_str());
+        }
+        CliArgs cliArgs(static_cast<int>(argv.size()), argv.data());
+        if (cliArgs.getAction() == CliArgs::Action::HELP ||
+            cliArgs.getAction() == CliArgs::Action::SERVE ||
+            !cliArgs.getSocketPath().empty()) {
+            throw std::invalid_argument("Expected a file and a query");
+        }
+        // Cached as one document, an NDJSON file would answer for its first record
+        if (isRecordInput(cliArgs.getFilePath())) {
+            throw std::invalid_argument("Record inputs are not served: " + cliArgs.getFilePath());
+        }
+        
+        QueryRunner runner;
+        const Dictionary& data = cache.get(cliArgs.getFilePath());
+        runner.useIndex(&cache.index(cliArgs.getFilePath()));
+        status = runner.run(cliArgs, data, out);
+    } catch (const std::exception& e) {
+        err = std::string("Error: ") + e.what() + "\n";
+        status = 1;
+    }
+    
+    std::string text = out.str();
+    return std::to_string(status) + " " + std::to_string(text.size()) + "\n" + text + err;
+}
+
+} // namespace
+
+int serve(const std::string& socketPath) {
+    FileDescriptor listener(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (listener.fd < 0) {
+        throw systemError("Failed to create socket");
+    }
+    
+    // Take over a socket file left behind by a daemon that is gone
+    if (::access(socketPath.c_str(), F_OK) == 0) {
+        FileDescriptor probe(::socket(AF_UNIX, SOCK_STREAM, 0));
+        if (probe.fd >= 0 && connectTo(probe.fd, socketPath)) {
+            throw std::runtime_error("A pq daemon is already serving " + socketPath);
+        }
+        ::unlink(socketPath.c_str());
+    }
+    
+    sockaddr_un addr = socketAddress(socketPath);
+    if (::bind(listener.fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        throw systemError("Failed to bind " + socketPath);
+    }
+    if (::listen(listener.fd, SOMAXCONN) != 0) {
+        ::unlink(socketPath.c_str());
+        throw systemError("Failed to listen on " + socketPath);
+    }
+    
+    // No SA_RESTART, so poll() returns when we are asked to stop
+    struct sigaction action{};
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+    
+    DocumentCache cache;
+    std::vector<PendingRequest> pending;
+    std::vector<pollfd> watched;
+    while (!stopRequested) {
+        watched.assign(1, pollfd{listener.fd, POLLIN, 0});
+        auto now = Clock::now();
+        auto wait = std::chrono::milliseconds(-1);
+        for (const auto& p : pending) {
+            watched.push_back(pollfd{p.client.fd, POLLIN, 0});
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(p.deadline - now);
+            if (wait.count() < 0 || left < wait) {
+                wait = std::max(left, std::chrono::milliseconds(0));
+            }
+        }
+        if (::poll(watched.data(), watched.size(), static_cast<int>(wait.count())) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::unlink(socketPath.c_str());
+            throw systemError("Failed to wait for connections");
+        }
+        
+        // Serve the connections whose request is complete, drop those out of time
+        now = Clock::now();
+        std::vector<PendingRequest> waiting;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            PendingRequest& p = pending[i];
+            try {
+                if (watched[i + 1].revents == 0) {
+                    if (now >= p.deadline) {
+                        std::cerr << "pq: dropped a client that sent no complete request\n";
+                    } else {
+                        waiting.push_back(std::move(p));
+                    }
+                    continue;
+                }
+                if (!readAvailable(p.client.fd, p.request)) {
+                    waiting.push_back(std::move(p));
+                    continue;
+                }
+                // An empty request is a probe for a running daemon
+                if (!p.request.empty()) {
+                    ::fcntl(p.client.fd, F_SETFL, ::fcntl(p.client.fd, F_GETFL) & ~O_NONBLOCK);
+                    writeAll(p.client.fd, answer(p.request, cache));
+                }
+            } catch (const std::exception& e) {
+                // A client that went away must not take the daemon down
+                std::cerr << "pq: " << e.what() << "\n";
+            }
+        }
+        pending = std::move(waiting);
+        
+        if (watched[0].revents & POLLIN) {
+            FileDescriptor client(::accept(listener.fd, nullptr, nullptr));
+            if (client.fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                ::unlink(socketPath.c_str());
+                throw systemError("Failed to accept connection");
+            }
+            // Bounds how long writing the response may block on a client
+            // that doesn't read it
+            timeval timeout{static_cast<time_t>(kRequestTimeout.count()), 0};
+            ::setsockopt(client.fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+            ::fcntl(client.fd, F_SETFL, ::fcntl(client.fd, F_GETFL) | O_NONBLOCK);
+            pending.push_back({std::move(client), std::string(), Clock::now() + kRequestTimeout});
+        }
+    }
+    
+    ::unlink(socketPath.c_str());
+    return 0;
+}
+
+int runClient(const std::string& socketPath, const std::vector<std::string>& args) {
+    FileDescriptor fd(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (fd.fd < 0) {
+        throw systemError("Failed to create socket");
+    }
+    if (!connectTo(fd.fd, socketPath)) {
+        throw systemError("Failed to connect to " + socketPath);
+    }
+    
+    std::string request;
+    for (const auto& arg : args) {
+        request += arg;
+        request += '\0';
+    }
+    writeAll(fd.fd, request);
+    ::shutdown(fd.fd, SHUT_WR);
+    
+    std::string response = readAll(fd.fd);
+    size_t headerEnd = response.find('\n');
+    int status = 0;
+    size_t outBytes = 0;
+    std::istringstream header(response.substr(0, headerEnd));
+    if (headerEnd == std::string::npos || !(header >> status >> outBytes) ||
+        outBytes > response.size() - headerEnd - 1) {
+        throw std::runtime_error("Malformed response from " + socketPath);
+    }
+    
+    std::cout << response.substr(headerEnd + 1, outBytes);
+    std::cerr << response.substr(headerEnd + 1 + outBytes);
+    return status;
+}
+
+#endif
+
+} // namespace pq
+} // namespace ps
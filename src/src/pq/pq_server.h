@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace ps {
+namespace pq {
+
+// Runs the pq query daemon on the Unix socket `socketPath` until SIGINT or
+// SIGTERM. Parsed documents stay resident between requests.
+int serve(const std::string& socketPath);
+
+// Sends a pq command line (without the program name) to the daemon at
+// `socketPath`, copies its output to stdout/stderr and returns its exit status
+int runClient(const std::string& socketPath, const std::vector<std::string>& args);
+
+} // namespace pq
+} // namespace ps
@@ -0,0 +1,386 @@
+#include <ps/pq/query_runner.h>
+#include <ps/pq/filter.h>
+#include <ps/pq/stream_query.h>
+#include <ps/json.h>
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace ps {
+namespace pq {
+
+int QueryRunner::run(const CliArgs& args, const Dictionary& data, std::ostream& out) {
+    if (args.getAction() == CliArgs::Action::FILTER) {
+        return runFilter(args, data, out);
+    }
+    
+    const auto& queries = args.getQueries();
+    if (queries.size() > 1 || args.outputAsShell()) {
+        // Evaluate every query against the one parsed tree. Nothing is
+        // printed unless all of them succeed, so the lines stay in order.
+        std::ostringstream lines;
+        for (const auto& query : queries) {
+            std::string text = evaluate(query, data, args.outputAsJson(), !args.outputAsShell());
+            if (args.outputAsShell()) {
+                lines << formatter_.formatShell(query.path, text) << "\n";
+            } else {
+                lines << text << "\n";
+            }
+        }
+        out << lines.str();
+        return 0;
+    }
+    
+    switch (args.getAction()) {
+        case CliArgs::Action::PRINT: {
+            // Pretty-print the entire file
+            out << data.dump(4, false) << "\n";
+            return 0;
+        }
+        
+        case CliArgs::Action::GET: {
+            // Extract value at path
+            auto tokens = pathParser_.parse(args.getPath());
+            
+            try {
+                // Check if path contains wildcards
+                bool hasWildcard = false;
+                for (const auto& token : tokens) {
+                    if (token.matchesMany()) {
+                        hasWildcard = true;
+                        break;
+                    }
+                }
+                
+                if (hasWildcard) {
+                    // Use wildcard navigation, writing each match as soon as it is found
+                    ResultWriter writer(out, args.outputAsJson());
+                    try {
+                        navigator_.visitWildcard(data, tokens, [&writer](const Dictionary& match) {
+                            writer.write(match);
+                        });
+                    } catch (const std::out_of_range& e) {
+                        if (writer.count() == 0) {
+                            throw;
+                        }
+                        // Matches already written can't be replaced by the default
+                        writer.finish();
+                        throw std::runtime_error(e.what());
+                    }
+                    
+                    if (writer.count() == 0 && args.hasDefault()) {
+                        out << args.getDefault() << "\n";
+                    } else {
+                        writer.finish();
+                    }
+                } else {
+                    // Use regular navigation
+                    const auto& result = navigator_.resolve(data, tokens);
+                    
+                    if (args.outputAsJson()) {
+                        out << formatter_.formatJson(result) << "\n";
+                    } else {
+                        out << formatter_.formatRaw(result) << "\n";
+                    }
+                }
+            } catch (const std::out_of_range&) {
+                if (args.hasDefault()) {
+                    out << args.getDefault() << "\n";
+                    return 0;
+                }
+                throw;
+            }
+            
+            return 0;
+        }
+        
+        case CliArgs::Action::COUNT: {
+            // Count array elements
+            auto tokens = pathParser_.parse(args.getPath());
+            out << count(data, tokens) << "\n";
+            return 0;
+        }
+        
+        case CliArgs::Action::HAS: {
+            // Check if path exists
+            auto tokens = pathParser_.parse(args.getPath());
+            return has(data, tokens) ? 0 : 1;
+        }
+        
+        case CliArgs::Action::HELP:
+        case CliArgs::Action::FILTER:
+        case CliArgs::Action::SERVE:
+            // Handled by the caller
+            return 0;
+    }
+    
+    return 0;
+}
+
+bool QueryRunner::canStream(const CliArgs& args) {
+    if (!args.stream() || args.getQueries().size() != 1 || args.outputAsShell()) {
+        return false;
+    }
+    switch (args.getAction()) {
+        case CliArgs::Action::GET:
+        case CliArgs::Action::COUNT:
+        case CliArgs::Action::HAS:
+            break;
+        default:
+            return false;
+    }
+    
+    // Other formats are left to ps::parse(), as is JSON with another name
+    const std::string& path = args.getFilePath();
+    if (path.size() < 5) {
+        return false;
+    }
+    std::string extension = path.substr(path.size() - 5);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".json";
+}
+
+std::optional<int> QueryRunner::runStreaming(const CliArgs& args, std::istream& in, std::ostream& out) {
+    auto tokens = pathParser_.parse(args.getPath());
+    StreamQuery stream(in);
+    
+    try {
+        switch (args.getAction()) {
+            case CliArgs::Action::GET:
+                break;
+            case CliArgs::Action::COUNT:
+                out << stream.count(tokens) << "\n";
+                return 0;
+            case CliArgs::Action::HAS:
+                return stream.has(tokens) ? 0 : 1;
+            default:
+                return std::nullopt;
+        }
+        
+        bool hasWildcard = false;
+        for (const auto& token : tokens) {
+            if (token.matchesMany()) {
+                hasWildcard = true;
+                break;
+            }
+        }
+        
+        if (!hasWildcard) {
+            try {
+                stream.visit(tokens, [&](const Dictionary& result) {
+                    out << (args.outputAsJson() ? formatter_.formatJson(result)
+                                                : formatter_.formatRaw(result))
+                        << "\n";
+                });
+            } catch (const std::out_of_range&) {
+                if (args.hasDefault()) {
+                    out << args.getDefault() << "\n";
+                    return 0;
+                }
+                throw;
+            }
+            return 0;
+        }
+        
+        // Matches are written as they are read, as in run()
+        ResultWriter writer(out, args.outputAsJson());
+        try {
+            stream.visit(tokens, [&writer](const Dictionary& match) {
+                writer.write(match);
+            });
+        } catch (const StreamQuery::Unsupported& e) {
+            if (writer.count() == 0) {
+                throw;
+            }
+            // Matches already written can't be taken back for the full parser
+            writer.finish();
+            throw std::runtime_error(e.what());
+        } catch (const std::out_of_range& e) {
+            if (writer.count() == 0) {
+                if (args.hasDefault()) {
+                    out << args.getDefault() << "\n";
+                    return 0;
+                }
+                throw;
+            }
+            writer.finish();
+            throw std::runtime_error(e.what());
+        }
+        
+        if (writer.count() == 0 && args.hasDefault()) {
+            out << args.getDefault() << "\n";
+        } else {
+            writer.finish();
+        }
+        return 0;
+    } catch (const StreamQuery::Unsupported&) {
+        // Nothing has been written; the caller parses the whole document
+        return std::nullopt;
+    }
+}
+
+int QueryRunner::runFilter(const CliArgs& args, const Dictionary& data, std::ostream& out) {
+    std::map<std::string, Dictionary> arguments;
+    for (const auto& argument : args.getFilterArguments()) {
+        if (!argument.isJson) {
+            arguments[argument.name] = Dictionary(argument.value);
+            continue;
+        }
+        // Wrapped in an array so that scalars parse too
+        Dictionary parsed = parse_json("[" + argument.value + "]");
+        if (parsed.size() != 1) {
+            throw std::invalid_argument("--argjson " + argument.name + ": not a single JSON value");
+        }
+        arguments[argument.name] = parsed.at(0);
+    }
+    
+    Filter filter(args.getFilter(), arguments);
+    bool raw = args.rawOutput();
+    filter.run(data, [&out, raw](const Dictionary& value) {
+        if (raw && value.isString()) {
+            out << value.asStringRef() << "\n";
+        } else {
+            out << Filter::toJson(value) << "\n";
+        }
+    });
+    return 0;
+}
+
+std::string QueryRunner::runFile(const CliArgs& args, const std::string& path, const Dictionary& data) {
+    const auto& queries = args.getQueries();
+    if (!args.outputAsJson()) {
+        std::string lines;
+        for (const auto& query : queries) {
+            lines += path + ": " + evaluate(query, data, false, true) + "\n";
+        }
+        return lines;
+    }
+    
+    Dictionary line;
+    line["file"] = path;
+    if (queries.size() == 1) {
+        line["value"] = resolve(queries.front(), data);
+    } else {
+        std::vector<Dictionary> values;
+        for (const auto& query : queries) {
+            values.push_back(resolve(query, data));
+        }
+        line["values"] = values;
+    }
+    // dump() breaks long objects over several lines
+    return Filter::toJson(line) + "\n";
+}
+
+std::string QueryRunner::evaluate(const CliArgs::Query& query,
+                                  const Dictionary& data,
+                                  bool asJson,
+                                  bool oneLine) {
+    auto tokens = pathParser_.parse(query.path);
+    try {
+        switch (query.action) {
+            case CliArgs::Action::GET: {
+                bool hasWildcard = false;
+                for (const auto& token : tokens) {
+                    if (token.matchesMany()) {
+                        hasWildcard = true;
+                        break;
+                    }
+                }
+                
+                if (hasWildcard) {
+                    auto results = navigator_.resolveWildcard(data, tokens);
+                    if (results.empty() && query.defaultValue) {
+                        return *query.defaultValue;
+                    }
+                    if (asJson || oneLine) {
+                        return formatter_.formatJson(results);
+                    }
+                    return formatter_.formatRaw(results);
+                }
+                const auto& result = navigator_.resolve(data, tokens);
+                return asJson ? formatter_.formatJson(result) : formatter_.formatRaw(result);
+            }
+            
+            case CliArgs::Action::COUNT:
+                return std::to_string(count(data, tokens));
+            
+            case CliArgs::Action::HAS:
+                return has(data, tokens) ? "true" : "false";
+            
+            default:
+                throw std::logic_error("Not a query action");
+        }
+    } catch (const std::out_of_range& e) {
+        if (query.defaultValue) {
+            return *query.defaultValue;
+        }
+        throw std::out_of_range(query.path + ": " + e.what());
+    }
+}
+
+Dictionary QueryRunner::resolve(const CliArgs::Query& query, const Dictionary& data) {
+    auto tokens = pathParser_.parse(query.path);
+    try {
+        switch (query.action) {
+            case CliArgs::Action::GET: {
+                for (const auto& token : tokens) {
+                    if (!token.matchesMany()) {
+                        continue;
+                    }
+                    std::vector<Dictionary> matches;
+                    navigator_.visitWildcard(data, tokens, [&matches](const Dictionary& match) {
+                        matches.push_back(match);
+                    });
+                    if (matches.empty() && query.defaultValue) {
+                        return Dictionary(*query.defaultValue);
+                    }
+                    return Dictionary(matches);
+                }
+                return navigator_.resolve(data, tokens);
+            }
+            
+            case CliArgs::Action::COUNT:
+                return Dictionary(static_cast<int64_t>(count(data, tokens)));
+            
+            case CliArgs::Action::HAS:
+                return Dictionary(has(data, tokens));
+            
+            default:
+                throw std::logic_error("Not a query action");
+        }
+    } catch (const std::out_of_range& e) {
+        if (query.defaultValue) {
+            return Dictionary(*query.defaultValue);
+        }
+        throw std::out_of_range(query.path + ": " + e.what());
+    }
+}
+
+size_t QueryRunner::count(const Dictionary& data, const std::vector<PathToken>& tokens) const {
+    for (const auto& token : tokens) {
+        if (token.matchesMany()) {
+            return navigator_.countMatches(data, tokens);
+        }
+    }
+    return navigator_.resolve(data, tokens).size();
+}
+
+bool QueryRunner::has(const Dictionary& data, const std::vector<PathToken>& tokens) const {
+    for (const auto& token : tokens) {
+        if (token.matchesMany()) {
+            return navigator_.matchesAny(data, tokens);
+        }
+    }
+    try {
+        navigator_.resolve(data, tokens);
+        return true;
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+}
+
+} // namespace pq
+} // namespace ps
@@ -0,0 +1,140 @@
+#include <ps/pq/record_reader.h>
+#include <cctype>
+#include <iterator>
+#include <stdexcept>
+
+namespace ps {
+namespace pq {
+
+int RecordReader::peek() {
+    while (fill()) {
+        unsigned char c = static_cast<unsigned char>(line_[pos_]);
+        if (!std::isspace(c)) {
+            return c;
+        }
+        ++pos_;
+    }
+    return -1;
+}
+
+bool RecordReader::next(std::string& text) {
+    text.clear();
+    
+    // Whitespace and comments between records
+    for (;;) {
+        if (!fill()) {
+            return false;
+        }
+        char c = line_[pos_];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++pos_;
+        } else if (c == '#' || line_.compare(pos_, 2, "//") == 0) {
+            pos_ = line_.size();
+        } else {
+            break;
+        }
+    }
+    
+    recordLine_ = lineNumber_;
+    if (line_[pos_] != '{' && line_[pos_] != '[') {
+        pos_ = line_.size();
+        throw std::runtime_error("line " + std::to_string(recordLine_) + ": expected a JSON object or array");
+    }
+    
+    int depth = 0;
+    bool inString = false;
+    bool escaped = false;
+    bool inComment = false;  // /* ... */
+    for (;;) {
+        if (!fill()) {
+            throw std::runtime_error("line " + std::to_string(recordLine_) +
+                                     ": unexpected end of input in record");
+        }
+        
+        size_t start = pos_;
+        size_t i = pos_;
+        bool done = false;
+        for (; i < line_.size() && !done; ++i) {
+            char c = line_[i];
+            if (inString) {
+                if (escaped) {
+                    escaped = false;
+                } else if (c == '\\') {
+                    escaped = true;
+                } else if (c == '"') {
+                    inString = false;
+                }
+                continue;
+            }
+            if (inComment) {
+                if (c == '*' && line_.compare(i, 2, "*/") == 0) {
+                    inComment = false;
+                    ++i;
+                }
+                continue;
+            }
+            switch (c) {
+                case '"':
+                    inString = true;
+                    break;
+                case '{':
+                case '[':
+                    ++depth;
+                    break;
+                case '}':
+                case ']':
+                    done = --depth == 0;
+                    break;
+                case '#':
+                    i = line_.size() - 1;
+                    break;
+                case '/':
+                    if (line_.compare(i, 2, "//") == 0) {
+                        i = line_.size() - 1;
+                    } else if (line_.compare(i, 2, "/*") == 0) {
+                        inComment = true;
+                        ++i;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        
+        text.append(line_, start, i - start);
+        pos_ = i;
+        if (done) {
+            return true;
+        }
+    }
+}
+
+bool RecordReader::drained() {
+    return line_.find_first_not_of(" \t\r\n", pos_) == std::string::npos && in_.rdbuf()->in_avail() <= 0;
+}
+
+std::string RecordReader::rest() {
+    std::string text = line_.substr(std::min(pos_, line_.size()));
+    pos_ = line_.size();
+    text.append(std::istreambuf_iterator<char>(in_), std::istreambuf_iterator<char>());
+    return text;
+}
+
+bool RecordReader::fill() {
+    while (pos_ >= line_.size()) {
+        if (!std::getline(in_, line_)) {
+            line_.clear();
+            pos_ = 0;
+            return false;
+        }
+        if (!in_.eof()) {
+            line_ += '\n';
+        }
+        pos_ = 0;
+        ++lineNumber_;
+    }
+    return true;
+}
+
+} // namespace pq
+} // namespace ps
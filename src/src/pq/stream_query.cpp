@@ -0,0 +1,470 @@
+#include <ps/pq/stream_query.h>
+#include <ps/json.h>
+#include <cctype>
+#include <climits>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace ps {
+namespace pq {
+
+namespace {
+
+// Read size; large enough that skipping runs over long stretches of memory
+const size_t BUFFER_SIZE = 1 << 20;
+
+bool startsValue(int c) {
+    return c == '{' || c == '[' || c == '"' || c == '-' || c == 't' || c == 'f' || c == 'n' ||
+           std::isdigit(c);
+}
+
+bool endsScalar(int c) {
+    return c < 0 || std::isspace(c) || c == ',' || c == ']' || c == '}' || c == ':' || c == '/' ||
+           c == '#';
+}
+
+} // namespace
+
+StreamQuery::StreamQuery(std::istream& in) : in_(in), buffer_(BUFFER_SIZE) {}
+
+void StreamQuery::visit(const std::vector<PathToken>& tokens,
+                        const std::function<void(const Dictionary&)>& visit) {
+    visit_ = &visit;
+    run(tokens, Target::Parse);
+}
+
+bool StreamQuery::has(const std::vector<PathToken>& tokens) {
+    try {
+        run(tokens, Target::Exists);
+        return true;
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+}
+
+int StreamQuery::count(const std::vector<PathToken>& tokens) {
+    run(tokens, Target::Count);
+    return count_;
+}
+
+void StreamQuery::run(const std::vector<PathToken>& tokens, Target target) {
+    for (const auto& token : tokens) {
+        if (token.isDescent()) {
+            unsupported("recursive descent needs the whole document");
+        }
+        // Counting from the end needs the size first, and a predicate each
+        // element parsed
+        if ((token.isIndex() && token.asIndex() < 0) ||
+            (token.isSlice() && (token.sliceBegin().value_or(0) < 0 || token.sliceEnd().value_or(0) < 0))) {
+            unsupported("negative indices need the whole array");
+        }
+        if (token.isPredicate()) {
+            unsupported("predicates need the whole document");
+        }
+    }
+    if (target != Target::Parse) {
+        for (const auto& token : tokens) {
+            if (token.matchesMany()) {
+                unsupported("counting matches needs the whole document");
+            }
+        }
+    }
+    tokens_ = &tokens;
+    target_ = target;
+
+    // Comments before the root may hold a format hint, and anything but an
+    // object or array may be another format; leave those to the full parser
+    while (peek() >= 0 && std::isspace(peek())) get();
+    if (peek() != '{' && peek() != '[') {
+        unsupported("not a JSON object or array");
+    }
+    match(0, false);
+}
+
+void StreamQuery::match(size_t depth, bool consume) {
+    skipSpace();
+    if (depth == tokens_->size()) {
+        arrive();
+        return;
+    }
+
+    const PathToken& token = (*tokens_)[depth];
+    if (token.isKey()) {
+        matchKey(depth, consume);
+    } else if (token.isIndex()) {
+        matchIndex(depth, consume);
+    } else {
+        matchEach(depth);
+    }
+}
+
+void StreamQuery::matchKey(size_t depth, bool consume) {
+    const std::string& key = (*tokens_)[depth].asKey();
+    if (peek() != '{') {
+        throw std::out_of_range("Key '" + key + "' not found");
+    }
+
+    get();
+    std::string name;
+    std::unordered_set<std::string> seen;
+    for (bool first = true; nextMember(first, name); first = false) {
+        checkUnique(seen, name);
+        if (name != key) {
+            skipValue();
+            continue;
+        }
+        match(depth + 1, consume);
+        if (consume) {
+            while (nextMember(false, name)) {
+                checkUnique(seen, name);
+                skipValue();
+            }
+        }
+        return;
+    }
+    throw std::out_of_range("Key '" + key + "' not found");
+}
+
+void StreamQuery::matchIndex(size_t depth, bool consume) {
+    int index = (*tokens_)[depth].asIndex();
+    int c = peek();
+
+    if (c == '{') {
+        // Mirrors Navigator: objects have a size but can't be indexed
+        int size = countChildren();
+        if (size == 0) {
+            throw std::out_of_range("Cannot index into empty value");
+        }
+        if (index >= size) {
+            throw std::out_of_range("Index " + std::to_string(index) + " out of range (size: " +
+                                    std::to_string(size) + ")");
+        }
+        throw std::logic_error("Not a list");
+    }
+    if (c != '[') {
+        throw std::out_of_range("Cannot index into empty value");
+    }
+
+    get();
+    int size = 0;
+    for (bool first = true; nextElement(first); first = false, ++size) {
+        if (size != index) {
+            skipValue();
+            continue;
+        }
+        match(depth + 1, consume);
+        if (consume) {
+            while (nextElement(false)) skipValue();
+        }
+        return;
+    }
+    if (size == 0) {
+        throw std::out_of_range("Cannot index into empty value");
+    }
+    throw std::out_of_range("Index " + std::to_string(index) + " out of range (size: " +
+                            std::to_string(size) + ")");
+}
+
+void StreamQuery::matchEach(size_t depth) {
+    // * or a slice with bounds from the start
+    const PathToken& token = (*tokens_)[depth];
+    int begin = token.isSlice() ? token.sliceBegin().value_or(0) : 0;
+    int end = token.isSlice() ? token.sliceEnd().value_or(INT_MAX) : INT_MAX;
+    
+    int c = peek();
+    if (c == '[') {
+        get();
+        int index = 0;
+        for (bool first = true; nextElement(first); first = false, ++index) {
+            if (index < begin || index >= end) {
+                skipValue();
+                continue;
+            }
+            match(depth + 1, true);
+        }
+        return;
+    }
+    if (c == '{') {
+        if (countChildren() > 0) {
+            throw std::logic_error("Not a list");
+        }
+        return;
+    }
+    // Scalars have no elements
+    skipValue();
+}
+
+void StreamQuery::arrive() {
+    switch (target_) {
+        case Target::Parse: {
+            std::string text;
+            beginCapture(text);
+            skipValue();
+            endCapture();
+            Dictionary value;
+            try {
+                value = parse_json(text);
+            } catch (const std::exception& e) {
+                unsupported(e.what());
+            }
+            (*visit_)(value);
+            return;
+        }
+        case Target::Count: {
+            int c = peek();
+            count_ = c == '[' || c == '{' ? countChildren() : 0;
+            return;
+        }
+        case Target::Exists:
+            // Found; the rest of the input doesn't matter
+            return;
+    }
+}
+
+int StreamQuery::countChildren() {
+    int n = 0;
+    if (get() == '[') {
+        for (bool first = true; nextElement(first); first = false, ++n) skipValue();
+    } else {
+        std::string key;
+        std::unordered_set<std::string> seen;
+        for (bool first = true; nextMember(first, key); first = false, ++n) {
+            checkUnique(seen, key);
+            skipValue();
+        }
+    }
+    return n;
+}
+
+void StreamQuery::checkUnique(std::unordered_set<std::string>& seen, const std::string& key) {
+    // The JSON parser rejects duplicate keys; so does the scanner in the
+    // objects it reads member by member
+    if (!seen.insert(key).second) {
+        unsupported("duplicate key '" + key + "'");
+    }
+}
+
+bool StreamQuery::nextElement(bool first) {
+    skipSpace();
+    int c = peek();
+    if (c == ']') {
+        get();
+        return false;
+    }
+    if (!first) {
+        if (c == ',') {
+            get();
+            skipSpace();
+            c = peek();
+        } else if (!startsValue(c)) {
+            // (a value right after the previous one, without a comma, is accepted)
+            unsupported("expected ',' or ']'");
+        }
+    }
+    if (!startsValue(c)) {
+        unsupported("expected a value");
+    }
+    return true;
+}
+
+bool StreamQuery::nextMember(bool first, std::string& key) {
+    skipSpace();
+    int c = peek();
+    if (c == '}') {
+        get();
+        return false;
+    }
+    if (!first) {
+        if (c == ',') {
+            get();
+            skipSpace();
+            c = peek();
+            // A trailing comma is accepted
+            if (c == '}') {
+                get();
+                return false;
+            }
+        } else if (c != '"') {
+            unsupported("expected ',' or '}'");
+        }
+    }
+    if (c != '"') {
+        unsupported("expected string key");
+    }
+    key = readKey();
+    skipSpace();
+    if (get() != ':') {
+        unsupported("expected ':' after object key");
+    }
+    skipSpace();
+    return true;
+}
+
+void StreamQuery::skipValue() {
+    skipSpace();
+    int c = peek();
+    if (c == '"') {
+        skipString();
+    } else if (c == '{' || c == '[') {
+        skipContainer();
+    } else if (startsValue(c)) {
+        skipScalar();
+    } else {
+        unsupported("expected a value");
+    }
+}
+
+void StreamQuery::skipContainer() {
+    // Only quotes, brackets and comments matter here; the scalars and
+    // separators in the subtree are not checked. Each bracket must close the
+    // one it belongs to, so a subtree the parser would reject as unbalanced
+    // is rejected here too.
+    brackets_.clear();
+    for (;;) {
+        if (pos_ == end_ && !fill()) {
+            unsupported("unexpected end of input");
+        }
+        const char* data = buffer_.data();
+        size_t i = pos_;
+        for (; i < end_; ++i) {
+            char c = data[i];
+            if (c == '{' || c == '[') {
+                brackets_.push_back(c == '{' ? '}' : ']');
+            } else if (c == '}' || c == ']') {
+                if (brackets_.back() != c) {
+                    pos_ = i;
+                    unsupported(std::string("unexpected '") + c + "'");
+                }
+                brackets_.pop_back();
+                if (brackets_.empty()) {
+                    pos_ = i + 1;
+                    return;
+                }
+            } else if (c == '"' || c == '/' || c == '#') {
+                break;
+            }
+        }
+        pos_ = i;
+        if (i == end_) continue;
+        if (data[i] == '"') {
+            skipString();
+        } else {
+            skipComment();
+        }
+    }
+}
+
+void StreamQuery::skipString() {
+    get();  // opening quote
+    for (;;) {
+        if (pos_ == end_ && !fill()) {
+            unsupported("unterminated string");
+        }
+        const char* data = buffer_.data();
+        size_t i = pos_;
+        while (i < end_ && data[i] != '"' && data[i] != '\\') ++i;
+        pos_ = i;
+        if (i == end_) continue;
+        ++pos_;
+        if (data[i] == '"') return;
+        if (get() < 0) {
+            unsupported("unterminated string");
+        }
+    }
+}
+
+void StreamQuery::skipScalar() {
+    while (!endsScalar(peek())) get();
+}
+
+void StreamQuery::skipSpace() {
+    for (;;) {
+        int c = peek();
+        if (c >= 0 && std::isspace(c)) {
+            get();
+        } else if (c == '/' || c == '#') {
+            skipComment();
+        } else {
+            return;
+        }
+    }
+}
+
+void StreamQuery::skipComment() {
+    // The comments the JSON parser accepts: //, # and /* */
+    if (get() == '#') {
+        while (peek() >= 0 && peek() != '\n') get();
+        return;
+    }
+    int c = get();
+    if (c == '/') {
+        while (peek() >= 0 && peek() != '\n') get();
+        return;
+    }
+    if (c != '*') {
+        unsupported("unexpected character '/'");
+    }
+    for (int previous = 0;;) {
+        c = get();
+        if (c < 0) {
+            unsupported("unterminated block comment");
+        }
+        if (previous == '*' && c == '/') return;
+        previous = c;
+    }
+}
+
+std::string StreamQuery::readKey() {
+    std::string raw;
+    beginCapture(raw);
+    skipString();
+    endCapture();
+    if (raw.find('\\') == std::string::npos) {
+        return raw.substr(1, raw.size() - 2);
+    }
+    // Let the JSON parser decode escapes
+    try {
+        return parse_json(raw).asString();
+    } catch (const std::exception& e) {
+        unsupported(e.what());
+    }
+}
+
+void StreamQuery::beginCapture(std::string& text) {
+    capture_ = &text;
+    captureFrom_ = pos_;
+}
+
+void StreamQuery::endCapture() {
+    capture_->append(buffer_.data() + captureFrom_, pos_ - captureFrom_);
+    capture_ = nullptr;
+}
+
+int StreamQuery::peek() {
+    if (pos_ == end_ && !fill()) return -1;
+    return static_cast<unsigned char>(buffer_[pos_]);
+}
+
+int StreamQuery::get() {
+    if (pos_ == end_ && !fill()) return -1;
+    return static_cast<unsigned char>(buffer_[pos_++]);
+}
+
+bool StreamQuery::fill() {
+    if (capture_) {
+        capture_->append(buffer_.data() + captureFrom_, end_ - captureFrom_);
+        captureFrom_ = 0;
+    }
+    offset_ += end_;
+    in_.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    end_ = static_cast<size_t>(in_.gcount());
+    pos_ = 0;
+    return end_ > 0;
+}
+
+void StreamQuery::unsupported(const std::string& what) const {
+    throw Unsupported("JSON at byte " + std::to_string(offset_ + pos_) + ": " + what);
+}
+
+} // namespace pq
+} // namespace ps
@@ -25,6 +25,16 @@ int main(int argc, char* argv[]) {
                 std::cout << "index:" << token.asIndex() << "\n";
             } else if (token.isWildcard()) {
                 std::cout << "wildcard:*\n";
+            } else if (token.isDescent()) {
+                std::cout << "descent:**\n";
+            } else if (token.isSlice()) {
+                auto bound = [](std::optional<int> index) {
+                    return index ? std::to_string(*index) : std::string();
+                };
+                std::cout << "slice:" << bound(token.sliceBegin()) << ":" << bound(token.sliceEnd()) << "\n";
+            } else if (token.isPredicate()) {
+                std::cout << "predicate:" << token.predicateKey() << (token.predicateNegated() ? "!=" : "=")
+                          << token.predicateValue() << "\n";
             }
         }
         
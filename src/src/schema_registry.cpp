@@ -0,0 +1,187 @@
+#include "ps/schema_registry.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include "ps/parse.h"
+
+namespace ps {
+
+namespace fs = std::filesystem;
+
+// Keywords whose values are data rather than subschemas; a "$ref" key in
+// there is an ordinary value and must not be rewritten.
+static const std::set<std::string> kLiteralKeywords = {"const", "enum", "default", "examples"};
+
+// Keywords whose values map arbitrary names to subschemas
+static const std::set<std::string> kSchemaMaps = {
+            "properties", "patternProperties", "definitions", "$defs", "dependentSchemas"};
+
+static bool is_absolute_uri(const std::string& s) {
+    return s.find("://") != std::string::npos || s.rfind("urn:", 0) == 0;
+}
+
+// Resolve `ref` against the directory part of `base` ("https://x/a/b.json" + "c.json")
+static std::string join_uri(const std::string& base, const std::string& ref) {
+    if (is_absolute_uri(ref)) return ref;
+    size_t slash = base.rfind('/');
+    if (slash == std::string::npos) return ref;
+    return base.substr(0, slash + 1) + ref;
+}
+
+// Last path component of a uri or file path, used to name embedded documents
+static std::string base_name(const std::string& key) {
+    size_t slash = key.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? key : key.substr(slash + 1);
+    return name.empty() ? std::string("schema") : name;
+}
+
+// Bookkeeping for one resolve() call: where each document ends up in the
+// resolved schema, and which ones still have to be copied in.
+struct SchemaRegistry::Bundle {
+    std::map<std::string, std::string> names;  // documents_ key -> key in "$defs" ("" = root)
+    std::set<std::string> used_names;          // keys taken in the root's "$defs"
+    std::vector<std::string> pending;          // documents referenced but not yet embedded
+
+    // JSON pointer prefix of a document inside the resolved schema
+    std::string pointer_to(const std::string& doc_key) {
+        auto it = names.find(doc_key);
+        if (it == names.end()) {
+            std::string name = base_name(doc_key);
+            for (int n = 2; used_names.count(name); ++n)
+                name = base_name(doc_key) + "-" + std::to_string(n);
+            used_names.insert(name);
+            pending.push_back(doc_key);
+            it = names.emplace(doc_key, name).first;
+        }
+        return it->second.empty() ? std::string() : "/$defs/" + it->second;
+    }
+};
+
+std::shared_ptr<const Dictionary> SchemaRegistry::load(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return documents_.at(load_locked(path)).schema;
+}
+
+void SchemaRegistry::add(const std::string& uri, const Dictionary& schema) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Document& doc = documents_[uri];
+    doc.id = uri;
+    doc.dir.clear();
+    doc.schema = std::make_shared<const Dictionary>(schema);
+    ids_[uri] = uri;
+    if (schema.has("$id") && schema.at("$id").type() == Dictionary::String)
+        ids_[schema.at("$id").asString()] = uri;
+    resolved_.clear();
+}
+
+std::shared_ptr<const Dictionary> SchemaRegistry::resolve(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::string& key = load_locked(path);
+    auto cached = resolved_.find(key);
+    if (cached != resolved_.end()) return cached->second;
+
+    Dictionary out = *documents_.at(key).schema;
+    Bundle bundle;
+    bundle.names[key] = "";
+    if (out.has("$defs") && out.at("$defs").isMappedObject()) {
+        for (auto const& name : out.at("$defs").keys()) bundle.used_names.insert(name);
+    }
+    rewrite_refs(out, key, bundle);
+
+    // Embedding a document can pull in further documents, so `pending` may
+    // grow while this loop runs.
+    for (size_t i = 0; i < bundle.pending.size(); ++i) {
+        const std::string doc_key = bundle.pending[i];
+        Dictionary copy = *documents_.at(doc_key).schema;
+        rewrite_refs(copy, doc_key, bundle);
+        out["$defs"][bundle.names.at(doc_key)] = copy;
+    }
+    auto resolved = std::make_shared<const Dictionary>(std::move(out));
+    resolved_.emplace(key, resolved);
+    return resolved;
+}
+
+size_t SchemaRegistry::document_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return documents_.size();
+}
+
+void SchemaRegistry::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    documents_.clear();
+    ids_.clear();
+    resolved_.clear();
+}
+
+const std::string& SchemaRegistry::load_locked(const std::string& path) {
+    std::error_code ec;
+    fs::path canonical = fs::weakly_canonical(fs::absolute(path), ec);
+    const std::string key = ec ? path : canonical.string();
+    auto it = documents_.find(key);
+    if (it != documents_.end()) return it->first;
+
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open schema: " + path);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    Document doc;
+    doc.dir = fs::path(key).parent_path().string();
+    try {
+        doc.schema = std::make_shared<const Dictionary>(parse(content, false, path));
+    } catch (const std::exception& e) {
+        throw std::runtime_error(path + ": " + e.what());
+    }
+    if (doc.schema->has("$id") && doc.schema->at("$id").type() == Dictionary::String)
+        doc.id = doc.schema->at("$id").asString();
+
+    it = documents_.emplace(key, std::move(doc)).first;
+    if (!it->second.id.empty()) ids_.emplace(it->second.id, key);
+    return it->first;
+}
+
+// Find the document a $ref target (the part before '#') names, as seen from
+// the document `from_key`: first by $id, then as a file next to the referrer.
+const std::string& SchemaRegistry::locate(const std::string& target, const std::string& from_key) {
+    const Document& from = documents_.at(from_key);
+    if (!from.id.empty()) {
+        auto it = ids_.find(join_uri(from.id, target));
+        if (it != ids_.end()) return it->second;
+    }
+    auto it = ids_.find(target);
+    if (it != ids_.end()) return it->second;
+    if (!is_absolute_uri(target) && !from.dir.empty())
+        return load_locked((fs::path(from.dir) / target).string());
+    throw std::runtime_error("cannot resolve $ref to '" + target + "' from " + from_key);
+}
+
+void SchemaRegistry::rewrite_refs(Dictionary& node, const std::string& doc_key, Bundle& bundle) {
+    if (node.isArrayObject()) {
+        for (int i = 0; i < node.size(); ++i) rewrite_refs(node.at(i), doc_key, bundle);
+        return;
+    }
+    if (!node.isMappedObject()) return;
+
+    if (node.has("$ref") && node.at("$ref").type() == Dictionary::String) {
+        const std::string ref = node.at("$ref").asString();
+        size_t hash = ref.find('#');
+        std::string target = ref.substr(0, hash);
+        std::string fragment = hash == std::string::npos ? std::string() : ref.substr(hash + 1);
+        const std::string& target_key = target.empty() ? doc_key : locate(target, doc_key);
+        node["$ref"] = "#" + bundle.pointer_to(target_key) + fragment;
+    }
+    for (auto const& key : node.keys()) {
+        if (kLiteralKeywords.count(key)) continue;
+        Dictionary& child = node.at(key);
+        if (kSchemaMaps.count(key) && child.isMappedObject()) {
+            for (auto const& name : child.keys()) rewrite_refs(child.at(name), doc_key, bundle);
+        } else {
+            rewrite_refs(child, doc_key, bundle);
+        }
+    }
+}
+
+}  // namespace ps
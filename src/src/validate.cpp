@@ -1,13 +1,19 @@
+#include <chrono>
+#include <iomanip>
 #include <limits>
 #include <string>
 #include "ps/validate.h"
+#include "ps/defaults.h"
 #include <ps/ron.h>
 #include <sstream>
 #include <vector>
 #include <algorithm>
 #include <regex>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <cstdlib>
+#include <deque>
 #include <iostream>
 
 namespace ps {
@@ -148,6 +154,61 @@ std::string ValidationResult::format() const {
         ss << "  " << err.message << "\n\n";
     }
 
+    if (truncated) {
+        ss << "(validation stopped early; further issues may exist)\n";
+    }
+
+    return ss.str();
+}
+
+static void merge_entries(std::vector<ValidationProfile::Entry>& into,
+                          const std::vector<ValidationProfile::Entry>& from) {
+    for (const auto& entry : from) {
+        auto it = std::find_if(into.begin(), into.end(), [&](const ValidationProfile::Entry& e) {
+            return e.name == entry.name;
+        });
+        if (it == into.end()) {
+            into.push_back(entry);
+            continue;
+        }
+        it->calls += entry.calls;
+        it->total_ms += entry.total_ms;
+        it->self_ms += entry.self_ms;
+    }
+}
+
+void ValidationProfile::merge(const ValidationProfile& other) {
+    merge_entries(keywords, other.keywords);
+    merge_entries(locations, other.locations);
+    std::sort(keywords.begin(), keywords.end(), [](const Entry& a, const Entry& b) {
+        return a.self_ms > b.self_ms;
+    });
+    std::sort(locations.begin(), locations.end(), [](const Entry& a, const Entry& b) {
+        return a.total_ms > b.total_ms;
+    });
+    nodes += other.nodes;
+    total_ms += other.total_ms;
+}
+
+std::string ValidationProfile::format(size_t top) const {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "Validation profile: " << total_ms << " ms, " << nodes << " nodes visited\n";
+
+    auto table = [&](const char* title, const std::vector<Entry>& entries) {
+        if (entries.empty()) return;
+        ss << "\n  " << std::left << std::setw(48) << title << std::right << std::setw(10)
+           << "calls" << std::setw(12) << "self ms" << std::setw(12) << "total ms" << "\n";
+        for (size_t i = 0; i < entries.size() && i < top; ++i) {
+            const Entry& e = entries[i];
+            std::string name = e.name.size() > 46 ? e.name.substr(0, 43) + "..." : e.name;
+            ss << "  " << std::left << std::setw(48) << name << std::right << std::setw(10)
+               << e.calls << std::setw(12) << e.self_ms << std::setw(12) << e.total_ms << "\n";
+        }
+        if (entries.size() > top) ss << "  ... " << entries.size() - top << " more\n";
+    };
+    table("keyword", keywords);
+    table("schema location", locations);
     return ss.str();
 }
 
@@ -160,59 +221,147 @@ static std::string to_lower(const std::string& s) {
     return result;
 }
 
-// Helper: compute Levenshtein distance between two strings
-static int levenshtein_distance(const std::string& a, const std::string& b) {
-    size_t n = a.size();
-    size_t m = b.size();
+// Helper: Levenshtein distance between two strings, computed in a single row.
+// Once every entry of the row exceeds `bound` the result can only grow, so
+// the scan stops there and returns bound + 1: the distance is exact when it
+// is at most `bound`.
+static int levenshtein_distance(const std::string& a,
+                                const std::string& b,
+                                int bound = std::numeric_limits<int>::max() - 1) {
+    const size_t n = a.size();
+    const size_t m = b.size();
+    const int gap = n > m ? static_cast<int>(n - m) : static_cast<int>(m - n);
+    if (gap > bound) return bound + 1;
     if (n == 0) return (int)m;
     if (m == 0) return (int)n;
-    std::vector<int> prev(m + 1), cur(m + 1);
-    for (size_t j = 0; j <= m; ++j) prev[j] = (int)j;
+    thread_local std::vector<int> row;
+    row.resize(m + 1);
+    for (size_t j = 0; j <= m; ++j) row[j] = (int)j;
     for (size_t i = 1; i <= n; ++i) {
-        cur[0] = (int)i;
+        int diagonal = row[0];  // row[i-1][j-1]
+        row[0] = (int)i;
+        int row_min = row[0];
         for (size_t j = 1; j <= m; ++j) {
             int cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
-            cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + cost});
+            int value = std::min({row[j] + 1, row[j - 1] + 1, diagonal + cost});
+            diagonal = row[j];
+            row[j] = value;
+            row_min = std::min(row_min, value);
         }
-        prev.swap(cur);
+        if (row_min > bound) return bound + 1;
     }
-    return prev[m];
+    return std::min(row[m], bound + 1);
+}
+
+// Largest distance a suggestion of `length` characters may have from `key`:
+// the ratio of distance to the longer length stays within `threshold`, or the
+// distance is at most `absolute`.
+static int suggestion_bound(size_t key_length, size_t length, double threshold, int absolute) {
+    size_t maxlen = std::max(key_length, length);
+    int d = absolute;
+    while (d < static_cast<int>(maxlen) &&
+           static_cast<double>(d + 1) / static_cast<double>(maxlen) <= threshold)
+        ++d;
+    return d;
 }
 
+// A BK-tree over Levenshtein distance. Every child hangs off its parent by
+// their distance, so by the triangle inequality a lookup within `bound` of a
+// key only descends into children whose edge is within `bound` of the key's
+// distance to the parent.
+class BkTree {
+public:
+    void insert(const std::string* name) {
+        if (nodes_.empty()) {
+            nodes_.push_back({name, {}});
+            return;
+        }
+        size_t cur = 0;
+        for (;;) {
+            int d = levenshtein_distance(*name, *nodes_[cur].name);
+            if (d == 0) return;
+            auto& children = nodes_[cur].children;
+            auto child = std::find_if(children.begin(), children.end(),
+                                      [d](auto const& c) { return c.first == d; });
+            if (child == children.end()) {
+                children.emplace_back(d, nodes_.size());
+                nodes_.push_back({name, {}});
+                return;
+            }
+            cur = child->second;
+        }
+    }
+
+    // Call visit(name, distance) for every name within `bound` of `key`
+    template <class Visit>
+    void find(const std::string& key, int bound, Visit&& visit) const {
+        if (nodes_.empty()) return;
+        std::vector<size_t> pending{0};
+        while (!pending.empty()) {
+            const Node& node = nodes_[pending.back()];
+            pending.pop_back();
+            int d = levenshtein_distance(key, *node.name);
+            if (d <= bound) visit(*node.name, d);
+            for (auto const& [edge, index] : node.children) {
+                if (edge >= d - bound && edge <= d + bound) pending.push_back(index);
+            }
+        }
+    }
+
+    bool empty() const { return nodes_.empty(); }
+
+private:
+    struct Node {
+        const std::string* name;
+        std::vector<std::pair<int, size_t>> children;  // (distance, node)
+    };
+    std::vector<Node> nodes_;
+};
+
+// The declared names of one "properties" object, in one BK-tree per name
+// length. A name can only be within the suggestion bound of a key when their
+// lengths differ by at most that bound, so lookups skip whole lengths, and
+// the bound is fixed within one length, which is what a BK-tree search needs.
+struct KeySuggestionIndex {
+    const std::map<std::string, Dictionary>* names = nullptr;
+    std::vector<BkTree> by_length;
+
+    explicit KeySuggestionIndex(const Dictionary& properties) : names(&properties.members()) {
+        for (auto const& [name, value] : *names) {
+            if (by_length.size() <= name.size()) by_length.resize(name.size() + 1);
+            by_length[name.size()].insert(&name);
+        }
+    }
+};
+
 // Helper: find nearby keys from a properties dictionary. Returns at most
 // `max_suggestions` keys sorted by increasing distance. Uses a normalized
 // distance threshold (ratio <= threshold) or small absolute distance.
 // Also checks for prefix/substring matches.
 static std::vector<std::string> find_nearby_keys(const std::string& key,
-                                                 const Dictionary* properties,
+                                                 const KeySuggestionIndex& index,
                                                  double threshold = 0.40,
                                                  int max_suggestions = 5) {
     std::vector<std::pair<int, std::string>> cands;
-    if (!properties) return {};
-    for (auto const& p : properties->items()) {
-        const std::string& cand = p.first;
-
-        // Check if key is a prefix of candidate (e.g., "norm" is prefix of "norm order")
-        bool is_prefix = (cand.size() > key.size() && cand.substr(0, key.size()) == key);
-        // Check if key is contained in candidate (substring match)
-        bool is_substring = cand.find(key) != std::string::npos;
-
-        int d = levenshtein_distance(key, cand);
-        size_t maxlen = std::max(key.size(), cand.size());
-        double ratio = maxlen == 0 ? 0.0 : static_cast<double>(d) / static_cast<double>(maxlen);
-
-        // Accept if: ratio small enough, absolute distance small, or prefix/substring match
-        if (ratio <= threshold || d <= 2 || is_prefix) {
-            // Prioritize prefix matches by giving them distance 0
-            if (is_prefix) {
-                cands.emplace_back(0, cand);
-            } else if (is_substring && d > 3) {
-                // Give substring matches a bonus (better distance)
-                cands.emplace_back(d / 2, cand);
-            } else {
-                cands.emplace_back(d, cand);
-            }
-        }
+
+    // Names that extend the key (e.g., "norm" is prefix of "norm order") are
+    // suggested first, whatever their distance
+    for (auto it = index.names->upper_bound(key);
+         it != index.names->end() && it->first.compare(0, key.size(), key) == 0;
+         ++it)
+        cands.emplace_back(0, it->first);
+
+    for (size_t length = 0; length < index.by_length.size(); ++length) {
+        if (index.by_length[length].empty()) continue;
+        int bound = suggestion_bound(key.size(), length, threshold, 2);
+        size_t gap = length > key.size() ? length - key.size() : key.size() - length;
+        if (gap > static_cast<size_t>(bound)) continue;
+        index.by_length[length].find(key, bound, [&](const std::string& cand, int d) {
+            if (cand.size() > key.size() && cand.compare(0, key.size(), key) == 0) return;
+            // Give substring matches a bonus (better distance)
+            bool is_substring = cand.find(key) != std::string::npos;
+            cands.emplace_back(is_substring && d > 3 ? d / 2 : d, cand);
+        });
     }
     if (cands.empty()) return {};
     std::sort(cands.begin(), cands.end(), [](auto const& a, auto const& b) {
@@ -449,26 +598,382 @@ static const Dictionary* resolve_local_ref(const Dictionary& root, const std::st
     return cur;
 }
 
-// Forward declarations of recursive validators
-static std::optional<std::string> validate_node(const Dictionary& data,
-                                                const Dictionary& schema_root,
-                                                const Dictionary& schema_node,
-                                                const std::string& path,
-                                                const std::string& raw_content = "",
-                                                std::set<std::string>* evaluated_props_out = nullptr);
-
-// New error-collecting validator
-static void validate_node_collect(const Dictionary& data,
-                                  const Dictionary& schema_root,
-                                  const Dictionary& schema_node,
-                                  const std::string& path,
-                                  int depth,
-                                  const std::string& raw_content,
-                                  std::vector<ValidationError>& errors);
+// Hash/equality on Dictionary contents for sets of pointers into the data or
+// schema trees, which outlive the sets built during a single validation.
+struct DictionaryPtrHash {
+    size_t operator()(const Dictionary* d) const { return d->hash(); }
+};
+struct DictionaryPtrEqual {
+    bool operator()(const Dictionary* a, const Dictionary* b) const {
+        return a->structurallyEquals(*b);
+    }
+};
+using DictionaryPtrSet =
+        std::unordered_set<const Dictionary*, DictionaryPtrHash, DictionaryPtrEqual>;
+
+// Enums at or below this size are scanned linearly; larger ones get a hashed index.
+static constexpr int kEnumIndexThreshold = 16;
+
+static DictionaryPtrSet build_enum_index(const Dictionary& values) {
+    DictionaryPtrSet index;
+    index.reserve(static_cast<size_t>(values.size()));
+    for (int i = 0; i < values.size(); ++i) index.insert(&values[i]);
+    return index;
+}
+
+// Branch lookup for an anyOf/oneOf array whose alternatives all pin a common
+// property (e.g. "type") to string const/enum values.
+struct DiscriminatorIndex {
+    std::string property;  // empty when no common discriminator exists
+    std::unordered_map<std::string, std::vector<int>> branches;
+};
 
 // Forward declaration for line number finding
 static int find_line_number(const std::string& raw_content, const std::string& path);
 
+// One step of a data path given by a caller, e.g. revalidate()'s changed paths
+struct PathStep {
+    std::string key;  // unused for an array index
+    int index = -1;   // -1 for an object key
+};
+
+// Split a dotted/bracketed path ("a.b[2].c") into steps; "" is the root
+static std::vector<PathStep> parse_data_path(const std::string& path) {
+    std::vector<PathStep> steps;
+    size_t i = 0;
+    while (i < path.size()) {
+        if (path[i] == '[') {
+            size_t close = path.find(']', i);
+            if (close == std::string::npos) close = path.size();
+            steps.push_back({std::string(), std::atoi(path.substr(i + 1, close - i - 1).c_str())});
+            i = close + 1;
+        } else {
+            size_t end = path.find_first_of(".[", i);
+            if (end == std::string::npos) end = path.size();
+            steps.push_back({path.substr(i, end - i), -1});
+            i = end;
+        }
+        if (i < path.size() && path[i] == '.') ++i;
+    }
+    return steps;
+}
+
+static bool same_step(const PathStep& a, const PathStep& b) {
+    return a.index == b.index && (a.index >= 0 || a.key == b.key);
+}
+
+// True when `prefix` is `path` or one of its ancestors
+static bool is_path_prefix(const std::vector<PathStep>& prefix, const std::vector<PathStep>& path) {
+    if (prefix.size() > path.size()) return false;
+    for (size_t i = 0; i < prefix.size(); ++i)
+        if (!same_step(prefix[i], path[i])) return false;
+    return true;
+}
+
+// Location of the node being validated. Segments borrow the key strings of the
+// document being walked, so the dotted/bracketed text ("a.b[2].c") is only
+// built when an issue or a line lookup actually needs it.
+class PathStack {
+public:
+    void push(const std::string& key) { segments_.push_back({&key, -1}); }
+    void push(int index) { segments_.push_back({nullptr, index}); }
+    void pop() { segments_.pop_back(); }
+    bool empty() const { return segments_.empty(); }
+    size_t size() const { return segments_.size(); }
+
+    // True when segment `i` names the same key or index as `step`
+    bool matches(size_t i, const PathStep& step) const {
+        const Segment& seg = segments_[i];
+        return seg.key ? step.index < 0 && *seg.key == step.key : seg.index == step.index;
+    }
+
+    std::string str() const {
+        std::string out;
+        for (const auto& seg : segments_) {
+            if (seg.key) {
+                if (!out.empty()) out.push_back('.');
+                out += *seg.key;
+            } else {
+                out.push_back('[');
+                out += std::to_string(seg.index);
+                out.push_back(']');
+            }
+        }
+        return out;
+    }
+
+    // str() of the child `key` of the current node
+    std::string child(const std::string& key) const {
+        std::string out = str();
+        if (!out.empty()) out.push_back('.');
+        out += key;
+        return out;
+    }
+
+private:
+    struct Segment {
+        const std::string* key;  // nullptr for an array index
+        int index;
+    };
+    std::vector<Segment> segments_;
+};
+
+// Pushes one path segment for the lifetime of the scope
+class PathScope {
+public:
+    PathScope(PathStack& path, const std::string& key) : path_(path) { path_.push(key); }
+    PathScope(PathStack& path, int index) : path_(path) { path_.push(index); }
+    ~PathScope() { path_.pop(); }
+    PathScope(const PathScope&) = delete;
+    PathScope& operator=(const PathScope&) = delete;
+
+private:
+    PathStack& path_;
+};
+
+// Collects a ValidationProfile. Scopes nest like the validator's recursion.
+// Time spent in a nested keyword is that keyword's self time and is taken out
+// of the self time of the enclosing entries up to the next keyword outside it.
+// Location scopes (a $ref target, an anyOf branch) overlap keyword scopes and
+// take nothing away from them.
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stat {
+        long long calls = 0;
+        double total_ms = 0.0;
+        double self_ms = 0.0;
+    };
+
+    Stat& keyword(const char* name) { return keywords_[name]; }
+    Stat& location(const std::string& name) { return locations_[name]; }
+
+    void enter(Stat& stat, bool is_location) {
+        stack_.push_back({&stat, Clock::now(), 0.0, is_location});
+    }
+
+    void leave() {
+        Frame frame = stack_.back();
+        stack_.pop_back();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - frame.start).count();
+        frame.stat->calls += 1;
+        frame.stat->total_ms += ms;
+        frame.stat->self_ms += ms - frame.child_ms;
+        if (frame.is_location) return;
+        for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
+            it->child_ms += ms;
+            if (!it->is_location) break;
+        }
+    }
+
+    long long nodes = 0;
+
+    ValidationProfile finish(double total_ms) const {
+        ValidationProfile profile;
+        profile.total_ms = total_ms;
+        profile.nodes = nodes;
+        for (const auto& [name, stat] : keywords_)
+            profile.keywords.push_back({name, stat.calls, stat.total_ms, stat.self_ms});
+        for (const auto& [name, stat] : locations_)
+            profile.locations.push_back({name, stat.calls, stat.total_ms, stat.self_ms});
+        profile.merge(ValidationProfile{});  // sorts both tables
+        return profile;
+    }
+
+private:
+    struct Frame {
+        Stat* stat;
+        Clock::time_point start;
+        double child_ms;
+        bool is_location;
+    };
+    std::unordered_map<std::string, Stat> keywords_;
+    std::unordered_map<std::string, Stat> locations_;
+    std::vector<Frame> stack_;
+};
+
+// Times one keyword, or one schema location, for the lifetime of the scope.
+// Does nothing when profiling is off; location names are only built when on.
+class ProfileScope {
+public:
+    ProfileScope(Profiler* profiler, const char* keyword) : profiler_(profiler) {
+        if (profiler_) profiler_->enter(profiler_->keyword(keyword), false);
+    }
+    template <class MakeName>
+    ProfileScope(Profiler* profiler, MakeName make_location) : profiler_(profiler) {
+        if (profiler_) profiler_->enter(profiler_->location(make_location()), true);
+    }
+    ~ProfileScope() { end(); }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    // Stop timing before the scope closes
+    void end() {
+        if (profiler_) profiler_->leave();
+        profiler_ = nullptr;
+    }
+
+private:
+    Profiler* profiler_;
+};
+
+// Lookup tables of a CompiledSchema, keyed by the schema node they were built for
+struct CompiledSchema::Tables {
+    std::shared_ptr<const Dictionary> schema;
+    // Root to validate from when `schema` is given as a bare property map
+    std::unique_ptr<const Dictionary> wrapper;
+    // Hashed membership sets for large enums, keyed by the schema's enum array
+    std::unordered_map<const Dictionary*, DictionaryPtrSet> enum_index;
+    // Discriminator indexes for anyOf/oneOf, keyed by the schema's alternatives array
+    std::unordered_map<const Dictionary*, DiscriminatorIndex> discriminator_index;
+    // "Did you mean" indexes of declared property names, keyed by the schema's
+    // properties, for objects that allow no additional properties
+    std::unordered_map<const Dictionary*, KeySuggestionIndex> suggestion_index;
+
+    const Dictionary& root() const { return wrapper ? *wrapper : *schema; }
+    // What local $refs resolve against: the wrapper's copy of a bare property
+    // map, so that every node reached has its tables
+    const Dictionary& ref_root() const { return wrapper ? wrapper->at("properties") : *schema; }
+};
+
+// State shared by the recursive validator for one validate_all() call
+struct ValidationContext {
+    const Dictionary& schema_root;
+    const std::string& raw_content;
+    const ValidationOptions& options;
+    std::vector<ValidationError>& errors;
+    size_t error_limit = 0;  // 0 = unlimited
+    bool truncated = false;  // set once the traversal is cut short by the error budget
+    // Tables built up front for the schema, or nullptr
+    const CompiledSchema::Tables* compiled = nullptr;
+    // Tables built on first use during this validation, for nodes `compiled`
+    // does not cover.
+    std::unordered_map<const Dictionary*, DictionaryPtrSet> enum_index;
+    std::unordered_map<const Dictionary*, DiscriminatorIndex> discriminator_index;
+    std::unordered_map<const Dictionary*, KeySuggestionIndex> suggestion_index;
+    // Location of the node currently being validated
+    PathStack path;
+    // Set by revalidate() to the edited paths: until the traversal reaches
+    // one of them, containers only descend into children on the way there.
+    const std::vector<std::vector<PathStep>>* focus = nullptr;
+    // Non-null when ValidationOptions::profile is set
+    Profiler* profiler = nullptr;
+    // PS_VALIDATE_DEBUG tracing, looked up once per validation
+    const bool debug = std::getenv("PS_VALIDATE_DEBUG") != nullptr;
+
+    ValidationContext(const Dictionary& root,
+                      const std::string& raw,
+                      const ValidationOptions& opts,
+                      std::vector<ValidationError>& errs)
+        : schema_root(root), raw_content(raw), options(opts), errors(errs) {
+        if (opts.stop_on_first_error)
+            error_limit = 1;
+        else if (opts.max_errors > 0)
+            error_limit = static_cast<size_t>(opts.max_errors);
+    }
+
+    // True when the error budget is spent and the caller should stop
+    // traversing. Only ask when there is more work left to do.
+    bool out_of_budget() {
+        if (error_limit == 0 || errors.size() < error_limit) return false;
+        truncated = true;
+        return true;
+    }
+
+    // Membership set of the enum array `values`
+    const DictionaryPtrSet& enum_index_for(const Dictionary& values) {
+        if (compiled) {
+            auto found = compiled->enum_index.find(&values);
+            if (found != compiled->enum_index.end()) return found->second;
+        }
+        auto it = enum_index.find(&values);
+        if (it == enum_index.end()) it = enum_index.emplace(&values, build_enum_index(values)).first;
+        return it->second;
+    }
+
+    // "Did you mean" index of the declared names in `properties`
+    const KeySuggestionIndex& suggestion_index_for(const Dictionary& properties) {
+        if (compiled) {
+            auto found = compiled->suggestion_index.find(&properties);
+            if (found != compiled->suggestion_index.end()) return found->second;
+        }
+        auto it = suggestion_index.find(&properties);
+        if (it == suggestion_index.end()) it = suggestion_index.emplace(&properties, properties).first;
+        return it->second;
+    }
+
+    // Where issues are recorded: `errors` itself, or a scratch list while an
+    // anyOf/oneOf/not alternative is being tried.
+    std::vector<ValidationError>* sink = &errors;
+    // Set while trying an alternative: its first issue decides the outcome, so
+    // the traversal stops there and line lookups are skipped.
+    bool first_only = false;
+
+    // True when the current traversal should unwind
+    bool stop() { return first_only ? !sink->empty() : out_of_budget(); }
+
+    int line_of(const std::string& path) const {
+        if (first_only || raw_content.empty()) return -1;
+        return find_line_number(raw_content, path);
+    }
+
+    void report(const std::string& where,
+                const std::string& message,
+                int line,
+                int depth,
+                ErrorSeverity severity,
+                ErrorCategory category) {
+        sink->emplace_back(display_path(where), message, line, depth, severity, category);
+        if (!first_only) sink->back().node_path = path.str();
+    }
+
+    // True when `steps` continues below the current node
+    bool leads_through(const std::vector<PathStep>& steps) const {
+        if (steps.size() <= path.size()) return false;
+        for (size_t i = 0; i < path.size(); ++i)
+            if (!path.matches(i, steps[i])) return false;
+        return true;
+    }
+
+    // True when the current node is one of the focus paths
+    bool at_focus_target() const {
+        for (auto const& steps : *focus) {
+            if (steps.size() != path.size()) continue;
+            bool same = true;
+            for (size_t i = 0; i < path.size() && same; ++i) same = path.matches(i, steps[i]);
+            if (same) return true;
+        }
+        return false;
+    }
+
+    // Whether the child `key` / `index` of the current node has to be visited
+    bool descends(const std::string& key) const {
+        if (focus == nullptr) return true;
+        for (auto const& steps : *focus) {
+            if (!leads_through(steps)) continue;
+            const PathStep& next = steps[path.size()];
+            if (next.index < 0 && next.key == key) return true;
+        }
+        return false;
+    }
+    bool descends(int index) const {
+        if (focus == nullptr) return true;
+        for (auto const& steps : *focus) {
+            if (leads_through(steps) && steps[path.size()].index == index) return true;
+        }
+        return false;
+    }
+};
+
+// Forward declaration of the recursive validator. Every issue is recorded in
+// ctx.sink with its category, severity and path at the point it is detected.
+static void validate_node(const Dictionary& data,
+                          const Dictionary& schema_node,
+                          int depth,
+                          ValidationContext& ctx,
+                          std::set<std::string>* evaluated_props_out = nullptr);
+
 // Helper: get a child schema dictionary from a Value that is expected to be an
 // object. Some schema positions allow either a schema object or a string
 // $ref (local JSON pointer). Accept the schema root so we can resolve local
@@ -543,12 +1048,96 @@ static bool schema_accepts_discriminator(const Dictionary& schema,
     return enum_values.find(discriminator_value) != enum_values.end();
 }
 
+// Build the discriminator index for an anyOf/oneOf alternatives array. The
+// conventional names are preferred; otherwise any property that every
+// alternative constrains will do.
+static DiscriminatorIndex build_discriminator_index(const Dictionary& alternatives,
+                                                    const Dictionary& schema_root) {
+    DiscriminatorIndex index;
+    std::vector<const Dictionary*> subs;
+    for (int i = 0; i < alternatives.size(); ++i)
+        subs.push_back(schema_from_value(schema_root, alternatives[i]));
+
+    const Dictionary* first = nullptr;
+    for (const Dictionary* sub : subs) {
+        if (sub) {
+            first = sub;
+            break;
+        }
+    }
+    if (!first || alternatives.size() < 2) return index;
+
+    std::vector<std::string> names = {"type", "kind", "variant"};
+    const Dictionary* resolved = first;
+    if (first->has("$ref") && first->at("$ref").type() == Dictionary::String) {
+        resolved = resolve_local_ref(schema_root, first->at("$ref").asString());
+        if (!resolved) resolved = first;
+    }
+    if (resolved->has("properties") && resolved->at("properties").isMappedObject()) {
+        for (const auto& name : resolved->at("properties").keys()) {
+            if (std::find(names.begin(), names.end(), name) == names.end()) names.push_back(name);
+        }
+    }
+
+    for (const auto& name : names) {
+        std::unordered_map<std::string, std::vector<int>> branches;
+        bool all_constrained = true;
+        for (size_t i = 0; i < subs.size() && all_constrained; ++i) {
+            if (!subs[i]) continue;  // unresolvable alternatives never match
+            auto values = get_property_enum_values(*subs[i], schema_root, name);
+            if (values.empty()) {
+                all_constrained = false;
+                break;
+            }
+            for (const auto& v : values) branches[v].push_back(static_cast<int>(i));
+        }
+        if (all_constrained) {
+            index.property = name;
+            index.branches = std::move(branches);
+            return index;
+        }
+    }
+    return index;
+}
+
+// Alternatives of an anyOf/oneOf that can possibly accept `data`, or nullptr
+// when every alternative has to be tried. A discriminator value that no
+// alternative accepts also falls back to the full scan so the error message
+// can list all alternatives.
+static const std::vector<int>* discriminator_candidates(const Dictionary& data,
+                                                        const Dictionary& alternatives,
+                                                        ValidationContext& ctx) {
+    if (!data.isMappedObject()) return nullptr;
+    const DiscriminatorIndex* compiled = nullptr;
+    if (ctx.compiled) {
+        auto found = ctx.compiled->discriminator_index.find(&alternatives);
+        if (found != ctx.compiled->discriminator_index.end()) compiled = &found->second;
+    }
+    if (!compiled) {
+        auto it = ctx.discriminator_index.find(&alternatives);
+        if (it == ctx.discriminator_index.end()) {
+            it = ctx.discriminator_index
+                         .emplace(&alternatives,
+                                  build_discriminator_index(alternatives, ctx.schema_root))
+                         .first;
+        }
+        compiled = &it->second;
+    }
+    const DiscriminatorIndex& index = *compiled;
+    if (index.property.empty() || !data.has(index.property)) return nullptr;
+    const Dictionary& value = data.at(index.property);
+    if (value.type() != Dictionary::String) return nullptr;
+    auto found = index.branches.find(value.asString());
+    if (found == index.branches.end()) return nullptr;
+    return &found->second;
+}
+
 // Not needed: Dictionary represents objects directly.
 
 // Validate a primitive numeric value against minimum/maximum/exclusive bounds in schema_node
 static std::optional<std::string> check_numeric_constraints(const Dictionary& data,
                                                             const Dictionary& schema_node,
-                                                            const std::string& path) {
+                                                            const PathStack& path) {
     if (!(data.type() == Dictionary::Integer || data.type() == Dictionary::Double))
         return std::nullopt;
     double val = (data.type() == Dictionary::Integer) ? static_cast<double>(data.asInt())
@@ -560,7 +1149,7 @@ static std::optional<std::string> check_numeric_constraints(const Dictionary& da
             double m = (minv.type() == Dictionary::Integer) ? static_cast<double>(minv.asInt())
                                                             : minv.asDouble();
             if (val < m)
-                return std::optional<std::string>("property '" + path + "' value " +
+                return std::optional<std::string>("property '" + path.str() + "' value " +
                                                   std::to_string(val) + " below minimum " +
                                                   std::to_string(m));
         }
@@ -571,7 +1160,7 @@ static std::optional<std::string> check_numeric_constraints(const Dictionary& da
             double m = (minv.type() == Dictionary::Integer) ? static_cast<double>(minv.asInt())
                                                             : minv.asDouble();
             if (val <= m)
-                return std::optional<std::string>("property '" + path + "' value " +
+                return std::optional<std::string>("property '" + path.str() + "' value " +
                                                   std::to_string(val) + " <= exclusiveMinimum " +
                                                   std::to_string(m));
         }
@@ -582,7 +1171,7 @@ static std::optional<std::string> check_numeric_constraints(const Dictionary& da
             double M = (maxv.type() == Dictionary::Integer) ? static_cast<double>(maxv.asInt())
                                                             : maxv.asDouble();
             if (val > M)
-                return std::optional<std::string>("property '" + path + "' value " +
+                return std::optional<std::string>("property '" + path.str() + "' value " +
                                                   std::to_string(val) + " above maximum " +
                                                   std::to_string(M));
         }
@@ -593,7 +1182,7 @@ static std::optional<std::string> check_numeric_constraints(const Dictionary& da
             double M = (maxv.type() == Dictionary::Integer) ? static_cast<double>(maxv.asInt())
                                                             : maxv.asDouble();
             if (val >= M)
-                return std::optional<std::string>("property '" + path + "' value " +
+                return std::optional<std::string>("property '" + path.str() + "' value " +
                                                   std::to_string(val) + " >= exclusiveMaximum " +
                                                   std::to_string(M));
         }
@@ -601,6 +1190,104 @@ static std::optional<std::string> check_numeric_constraints(const Dictionary& da
     return std::nullopt;
 }
 
+// An `items` schema that only constrains numbers: an optional "type" of
+// "number" or "integer" plus minimum/maximum bounds. Such arrays are checked
+// in a single pass over their elements instead of one validate_node() each.
+struct NumericItems {
+    bool typed = false;    // "type" present: every element must be a number
+    bool integer = false;  // "type": "integer"
+    std::optional<double> minimum, exclusive_minimum, maximum, exclusive_maximum;
+};
+
+static std::optional<NumericItems> numeric_items(const Dictionary& schema_root,
+                                                 const Dictionary* items) {
+    // Follow $ref chains the way validate_node() does
+    for (int hops = 0; items && items->has("$ref"); ++hops) {
+        const Dictionary& ref = items->at("$ref");
+        if (ref.type() != Dictionary::String || hops > 8) return std::nullopt;
+        items = resolve_local_ref(schema_root, ref.asStringRef());
+    }
+    if (!items) return std::nullopt;
+
+    auto bound = [](const Dictionary& v) -> std::optional<double> {
+        // Bounds of any other type are ignored by check_numeric_constraints()
+        if (v.type() == Dictionary::Integer) return static_cast<double>(v.asInt());
+        if (v.type() == Dictionary::Double) return v.asDouble();
+        return std::nullopt;
+    };
+    NumericItems out;
+    for (auto const& [key, value] : items->members()) {
+        if (key == "type") {
+            if (value.type() != Dictionary::String) return std::nullopt;
+            const std::string& t = value.asStringRef();
+            if (t != "number" && t != "integer") return std::nullopt;
+            out.typed = true;
+            out.integer = t == "integer";
+        } else if (key == "minimum") {
+            out.minimum = bound(value);
+        } else if (key == "exclusiveMinimum") {
+            out.exclusive_minimum = bound(value);
+        } else if (key == "maximum") {
+            out.maximum = bound(value);
+        } else if (key == "exclusiveMaximum") {
+            out.exclusive_maximum = bound(value);
+        } else if (key != "description" && key != "title" && key != "default" &&
+                   key != "examples" && key != "$comment") {
+            return std::nullopt;
+        }
+    }
+    return out;
+}
+
+// True when the elements of `data` from index `first` on all satisfy `items`.
+// The loop only reduces the values to their extremes; the bounds are compared
+// once at the end. A false result says nothing about which element failed.
+static bool numeric_items_pass(const Dictionary& data, int first, const NumericItems& items) {
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -std::numeric_limits<double>::infinity();
+    bool any = false;
+    const auto& elements = data.elements();
+    for (auto it = elements.lower_bound(first); it != elements.end(); ++it) {
+        const Dictionary& e = it->second;
+        double v;
+        if (e.type() == Dictionary::Integer) {
+            v = static_cast<double>(e.asInt());
+        } else if (e.type() == Dictionary::Double && !items.integer) {
+            v = e.asDouble();
+        } else if (items.typed) {
+            return false;
+        } else {
+            continue;
+        }
+        // NaN compares false, and passes every bound, as it does element-wise
+        lo = v < lo ? v : lo;
+        hi = v > hi ? v : hi;
+        any = true;
+    }
+    if (!any) return true;
+    if (items.minimum && lo < *items.minimum) return false;
+    if (items.exclusive_minimum && lo <= *items.exclusive_minimum) return false;
+    if (items.maximum && hi > *items.maximum) return false;
+    if (items.exclusive_maximum && hi >= *items.exclusive_maximum) return false;
+    return true;
+}
+
+// True when the elements of `data` from `first` on need no validate_node()
+// walk because they all satisfy the numeric `items` schema. When some element
+// fails, the caller walks them all so the issues are reported as usual.
+static bool numeric_items_skip(const Dictionary& data,
+                               int first,
+                               const Dictionary* items,
+                               ValidationContext& ctx) {
+    if (ctx.focus || ctx.debug) return false;
+    std::optional<NumericItems> numeric = numeric_items(ctx.schema_root, items);
+    if (!numeric) return false;
+    ProfileScope scope(ctx.profiler, "items (numeric scan)");
+    if (!numeric_items_pass(data, first, *numeric)) return false;
+    if (ctx.profiler) ctx.profiler->nodes += std::max(0, data.size() - first);
+    return true;
+}
+
 // Helper: Find line number of "enum" keyword in schema
 static int find_enum_in_schema(const std::string& schema_content, const std::string& enum_value) {
     // Search for the pattern: "enum" followed by : and the value
@@ -647,21 +1334,27 @@ static int find_enum_in_schema(const std::string& schema_content, const std::str
     return -1;
 }
 
-// Global variables to store schema context for error messages
+// Global variables to store schema context for error messages.
+// The schema context is shared; the data file context is per-thread so that
+// several documents can be validated concurrently against one schema.
 static std::string g_schema_filename;
 static std::string g_schema_content;
-static std::string g_data_filename;
-static const Dictionary* g_original_data = nullptr;
+static thread_local std::string g_data_filename;
+static thread_local const Dictionary* g_original_data = nullptr;
+// Set by validate_with_defaults(): what applyDefaults() changed, and the
+// values rebuilt from it for error messages while validating
+static thread_local const std::vector<DefaultEdit>* g_default_edits = nullptr;
+static thread_local std::deque<Dictionary> g_rebuilt_originals;
 
 // Check enum keyword: schema_node.data["enum"] should be an array of literal values
 static std::optional<std::string> check_enum(const Dictionary& data,
                                              const Dictionary& schema_node,
-                                             const std::string& path,
-                                             const std::string& raw_content) {
+                                             ValidationContext& ctx) {
+    const std::string& raw_content = ctx.raw_content;
     if (!schema_node.has("enum")) return std::nullopt;
     const Dictionary& ev = schema_node.at("enum");
     if (!ev.isArrayObject()) {
-        int data_line = find_line_number(raw_content, path);
+        int data_line = find_line_number(raw_content, ctx.path.str());
 
         // Build detailed error message
         std::ostringstream msg;
@@ -688,7 +1381,7 @@ static std::optional<std::string> check_enum(const Dictionary& data,
                     << enum_str_val << "\"]";
             }
         } else {
-            msg << "The 'enum' keyword at path '" << path
+            msg << "The 'enum' keyword at path '" << ctx.path.str()
                 << "' must be an array, but found non-array type.";
         }
 
@@ -703,8 +1396,8 @@ static std::optional<std::string> check_enum(const Dictionary& data,
         throw std::runtime_error(msg.str());
     }
 
-    if (std::getenv("PS_VALIDATE_DEBUG")) {
-        std::cerr << "check_enum at path '" << path << "' data=" << data.dump() << "\n";
+    if (ctx.debug) {
+        std::cerr << "check_enum at path '" << ctx.path.str() << "' data=" << data.dump() << "\n";
         std::cerr << "  enum options: ";
         for (int i = 0; i < ev.size(); ++i) {
             std::cerr << ev[i].dump() << " ";
@@ -712,21 +1405,30 @@ static std::optional<std::string> check_enum(const Dictionary& data,
         std::cerr << "\n";
     }
 
-    for (int i = 0; i < ev.size(); ++i) {
-        if (ev[i] == data) {
-            if (std::getenv("PS_VALIDATE_DEBUG")) {
-                std::cerr << "  -> MATCHED option " << i << "\n";
+    if (ev.size() > kEnumIndexThreshold) {
+        if (ctx.enum_index_for(ev).count(&data)) {
+            if (ctx.debug) {
+                std::cerr << "  -> MATCHED option\n";
             }
             return std::nullopt;
         }
+    } else {
+        for (int i = 0; i < ev.size(); ++i) {
+            if (ev[i].structurallyEquals(data)) {
+                if (ctx.debug) {
+                    std::cerr << "  -> MATCHED option " << i << "\n";
+                }
+                return std::nullopt;
+            }
+        }
     }
 
-    if (std::getenv("PS_VALIDATE_DEBUG")) {
+    if (ctx.debug) {
         std::cerr << "  -> NO MATCH, returning error\n";
     }
 
     // Build error message with actual value and list of valid options
-    std::string msg = "'" + path + "' has value " + value_preview(data) + ".\n";
+    std::string msg = "'" + ctx.path.str() + "' has value " + value_preview(data) + ".\n";
     msg += "But the valid options are:\n";
 
     // Collect enum values as strings for display and suggestions
@@ -743,7 +1445,7 @@ static std::optional<std::string> check_enum(const Dictionary& data,
     }
 
     // Try to suggest the closest match if data is a string
-    if (data.type() == Dictionary::String) {
+    if (data.type() == Dictionary::String && !ctx.options.skip_suggestions) {
         std::string data_str = data.asString();
         std::string data_lower = to_lower(data_str);
         int best_distance = std::numeric_limits<int>::max();
@@ -758,8 +1460,8 @@ static std::optional<std::string> check_enum(const Dictionary& data,
                 break;
             }
 
-            // Otherwise compute regular distance
-            int d = levenshtein_distance(data_str, enum_val);
+            // Otherwise compute regular distance, as far as it can still improve
+            int d = levenshtein_distance(data_str, enum_val, best_distance - 1);
             if (d < best_distance) {
                 best_distance = d;
                 best_match = enum_val;
@@ -780,22 +1482,206 @@ static std::optional<std::string> check_enum(const Dictionary& data,
     return std::optional<std::string>(msg);
 }
 
-static std::optional<std::string> validate_node(const Dictionary& data,
-                                                const Dictionary& schema_root,
-                                                const Dictionary& schema_node,
-                                                const std::string& path,
-                                                const std::string& raw_content,
-                                                std::set<std::string>* evaluated_props_out) {
-    // Minimal validator: primarily checks declared "type", numeric constraints and enum.
+// The member or element of `node` named by `step`, or nullptr
+template <typename D>
+static D* child_at(D& node, const PathStep& step) {
+    if (step.index >= 0)
+        return node.isArrayObject() && step.index < node.size() ? &node.at(step.index) : nullptr;
+    return node.isMappedObject() && node.has(step.key) ? &node.at(step.key) : nullptr;
+}
+
+// The value at `path` before the defaults in g_default_edits were applied,
+// given `data`, the value there now. Only the edits at or inside `path` are
+// undone, on a copy of `data`. Falls back to `data` for values the defaults
+// added.
+static const Dictionary* value_before_defaults(const Dictionary& data, const std::string& path) {
+    const std::vector<PathStep> target = parse_data_path(path);
+    std::vector<std::vector<PathStep>> inside;
+    std::vector<const DefaultEdit*> inside_edits;
+    for (const auto& edit : *g_default_edits) {
+        std::vector<PathStep> steps = parse_data_path(edit.path);
+        if (is_path_prefix(steps, target)) {
+            // The value itself, or one of its ancestors, was added or replaced
+            if (!edit.previous) return &data;
+            const Dictionary* node = &*edit.previous;
+            for (size_t i = steps.size(); i < target.size() && node; ++i)
+                node = child_at(*node, target[i]);
+            return node ? node : &data;
+        }
+        if (is_path_prefix(target, steps)) {
+            inside.push_back(std::move(steps));
+            inside_edits.push_back(&edit);
+        }
+    }
+    if (inside.empty()) return &data;
+
+    Dictionary& rebuilt = g_rebuilt_originals.emplace_back(data);
+    for (size_t e = inside.size(); e-- > 0;) {
+        const std::vector<PathStep>& steps = inside[e];
+        Dictionary* parent = &rebuilt;
+        for (size_t i = target.size(); i + 1 < steps.size() && parent; ++i)
+            parent = child_at(*parent, steps[i]);
+        if (!parent) continue;
+        if (!inside_edits[e]->previous) {
+            parent->erase(steps.back().key);
+        } else if (Dictionary* node = child_at(*parent, steps.back())) {
+            *node = *inside_edits[e]->previous;
+        }
+    }
+    return &rebuilt;
+}
+
+// Find the value at `path` (dotted/bracketed, as built by validate_node) in the
+// data as the user wrote it, before defaults were applied. Falls back to `data`.
+static const Dictionary* original_value_at(const Dictionary& data, const std::string& path) {
+    if (g_original_data == nullptr)
+        return g_default_edits ? value_before_defaults(data, path) : &data;
+
+    const Dictionary* orig = g_original_data;
+    bool found = true;
+
+    // Parse the path and navigate through it
+    if (!path.empty()) {
+        size_t pos = 0;
+        while (pos < path.size() && found) {
+            // Find next separator (. or [)
+            size_t dot_pos = path.find('.', pos);
+            size_t bracket_pos = path.find('[', pos);
+
+            if (dot_pos == std::string::npos && bracket_pos == std::string::npos) {
+                // Last component
+                std::string key = path.substr(pos);
+                if (orig->has(key)) {
+                    orig = &orig->at(key);
+                } else {
+                    found = false;
+                }
+                break;
+            }
+
+            size_t next_sep = (dot_pos != std::string::npos && bracket_pos != std::string::npos)
+                                      ? std::min(dot_pos, bracket_pos)
+                                      : (dot_pos != std::string::npos ? dot_pos : bracket_pos);
+
+            if (path[next_sep] == '.') {
+                // Navigate by key
+                std::string key = path.substr(pos, next_sep - pos);
+                if (!key.empty() && orig->has(key)) {
+                    orig = &orig->at(key);
+                    pos = next_sep + 1;
+                } else {
+                    found = false;
+                }
+            } else {
+                // Navigate by key then index
+                std::string key = path.substr(pos, next_sep - pos);
+                if (!key.empty() && orig->has(key)) {
+                    orig = &orig->at(key);
+                } else if (key.empty() && next_sep == pos) {
+                    // Already at the right place, just need to handle index
+                } else {
+                    found = false;
+                    break;
+                }
+
+                // Now handle the [N] part
+                size_t close_bracket = path.find(']', next_sep);
+                if (close_bracket != std::string::npos) {
+                    std::string index_str = path.substr(next_sep + 1, close_bracket - next_sep - 1);
+                    int index = std::atoi(index_str.c_str());
+                    if (orig->isArrayObject() && index >= 0 && index < orig->size()) {
+                        orig = &(*orig)[index];
+                        pos = close_bracket + 1;
+                        if (pos < path.size() && path[pos] == '.') {
+                            pos++;  // skip the dot
+                        }
+                    } else {
+                        found = false;
+                    }
+                } else {
+                    found = false;
+                }
+            }
+        }
+    }
+
+    return found ? orig : &data;
+}
+
+// Line used for a missing required key: the parent object's line, or at the
+// root the line of the first key that is present.
+static int missing_key_line(const Dictionary& data,
+                            const std::string& path,
+                            const std::string& raw_content) {
+    if (raw_content.empty()) return -1;
+    if (!path.empty()) return find_line_number(raw_content, path);
+    for (auto const& key : data.keys()) {
+        int line = find_line_number(raw_content, key);
+        if (line > 0) return line;
+    }
+    return -1;
+}
+
+// Inside an alternative only the message survives (it becomes the "because"
+// text of the anyOf/oneOf report), so it carries the line number itself.
+static std::string with_line_prefix(const ValidationContext& ctx,
+                                    int line,
+                                    const std::string& msg) {
+    if (!ctx.first_only || line <= 0) return msg;
+    return "line " + std::to_string(line) + ": " + msg;
+}
+
+// Try `data` against one anyOf/oneOf/not alternative. Returns the message of
+// the first issue that rejects it, or nullopt when it matches.
+static std::optional<std::string> try_alternative(const Dictionary& data,
+                                                  const Dictionary& schema_node,
+                                                  int depth,
+                                                  ValidationContext& ctx,
+                                                  std::set<std::string>* evaluated_props_out) {
+    std::vector<ValidationError> issues;
+    std::vector<ValidationError>* saved_sink = ctx.sink;
+    bool saved_first_only = ctx.first_only;
+    // Whether an alternative matches depends on the whole value, edited or not
+    const std::vector<std::vector<PathStep>>* saved_focus = ctx.focus;
+    ctx.sink = &issues;
+    ctx.first_only = true;
+    ctx.focus = nullptr;
+    validate_node(data, schema_node, depth, ctx, evaluated_props_out);
+    ctx.sink = saved_sink;
+    ctx.first_only = saved_first_only;
+    ctx.focus = saved_focus;
+    if (issues.empty()) return std::nullopt;
+    return issues.front().message;
+}
+
+static void validate_node(const Dictionary& data,
+                          const Dictionary& schema_node,
+                          int depth,
+                          ValidationContext& ctx,
+                          std::set<std::string>* evaluated_props_out) {
+    const Dictionary& schema_root = ctx.schema_root;
+    const std::string& raw_content = ctx.raw_content;
+    if (ctx.stop()) return;
+
+    if (ctx.focus && ctx.at_focus_target()) {
+        // Everything below an edited node is validated again
+        const std::vector<std::vector<PathStep>>* focus = ctx.focus;
+        ctx.focus = nullptr;
+        validate_node(data, schema_node, depth, ctx, evaluated_props_out);
+        ctx.focus = focus;
+        return;
+    }
+    if (ctx.profiler) ++ctx.profiler->nodes;
+
     std::set<std::string> evaluated_here;
-    if (std::getenv("PS_VALIDATE_DEBUG")) {
-        std::cerr << "validate_node enter: path='" << path << "' data=" << data.dump()
+    if (ctx.debug) {
+        std::cerr << "validate_node enter: path='" << ctx.path.str() << "' data=" << data.dump()
                   << " schema_keys={";
         bool firstk = true;
-        for (auto const& p : schema_node.items()) {
+        for (auto const& k : schema_node.keys()) {
             if (!firstk) std::cerr << ",";
             firstk = false;
-            std::cerr << p.first;
+            std::cerr << k;
         }
         std::cerr << "}\n";
     }
@@ -803,59 +1689,105 @@ static std::optional<std::string> validate_node(const Dictionary& data,
     // resolve $ref if present
     if (schema_node.has("$ref") && schema_node.at("$ref").type() == Dictionary::String) {
         const std::string ref = schema_node.at("$ref").asString();
+        ProfileScope ref_scope(ctx.profiler, "$ref");
+        ProfileScope target_scope(ctx.profiler, [&] { return "$ref " + ref; });
         const Dictionary* target = resolve_local_ref(schema_root, ref);
-        if (!target) return std::optional<std::string>("unresolved $ref '" + ref + "' at " + path);
-        return validate_node(data, schema_root, *target, path, raw_content, evaluated_props_out);
+        if (!target) {
+            const std::string path = ctx.path.str();
+            ctx.report(path,
+                       "unresolved $ref '" + ref + "' at " + path,
+                       ctx.line_of(path),
+                       depth,
+                       ErrorSeverity::ERROR,
+                       ErrorCategory::OTHER);
+            return;
+        }
+        validate_node(data, *target, depth, ctx, evaluated_props_out);
+        return;
     }
 
+    // A scalar stops at its first failing keyword. Objects and arrays keep
+    // going so that problems further down the tree are reported as well.
+    const bool container = data.isMappedObject() || data.isArrayObject();
+    const size_t issues_before = ctx.sink->size();
+    auto halt = [&]() { return ctx.stop() || (!container && ctx.sink->size() > issues_before); };
+    auto fail = [&](const std::string& msg,
+                    ErrorCategory category,
+                    ErrorSeverity severity = ErrorSeverity::ERROR) {
+        const std::string path = ctx.path.str();
+        ctx.report(path, msg, ctx.line_of(path), depth, severity, category);
+        return halt();
+    };
+    auto type_mismatch = [&](const std::string& expected) {
+        // Only worth reporting when nothing more specific was found at this node
+        if (ctx.sink->size() > issues_before) return;
+        const std::string path = ctx.path.str();
+        ctx.report(path,
+                   limit_line_length("expected type '" + expected + "' at '" + display_path(path) +
+                                     "' but found '" + value_type_name(data) +
+                                     "' (value: " + value_preview(data) + ")"),
+                   ctx.line_of(path),
+                   depth,
+                   ErrorSeverity::ERROR,
+                   ErrorCategory::TYPE_MISMATCH);
+    };
+
     // enum check
     if (schema_node.has("enum")) {
-        if (auto e = check_enum(data, schema_node, path, raw_content)) return e;
+        ProfileScope scope(ctx.profiler, "enum");
+        if (auto e = check_enum(data, schema_node, ctx)) {
+            if (fail(*e, ErrorCategory::INVALID_ENUM)) return;
+        }
     }
 
     // const keyword: value must equal the provided literal
     if (schema_node.has("const")) {
+        ProfileScope scope(ctx.profiler, "const");
         if (!(schema_node.at("const") == data)) {
-            return std::optional<std::string>("key '" + path + "' does not match const value");
+            if (fail("key '" + ctx.path.str() + "' does not match const value",
+                     ErrorCategory::INVALID_ENUM))
+                return;
         }
     }
 
-    // allOf/anyOf/oneOf - basic handling
+    // allOf: every sub-schema applies, so its issues are reported directly
     if (schema_node.has("allOf") && schema_node.at("allOf").isArrayObject()) {
+        ProfileScope scope(ctx.profiler, "allOf");
         const Dictionary& arr = schema_node.at("allOf");
         for (int i = 0; i < arr.size(); ++i) {
-            const Dictionary& sub = arr[i];
-            const Dictionary* subSchema = schema_from_value(schema_root, sub);
+            const Dictionary* subSchema = schema_from_value(schema_root, arr[i]);
             if (!subSchema) continue;
             std::set<std::string> sub_evaluated;
-            if (auto err = validate_node(data,
-                                         schema_root,
-                                         *subSchema,
-                                         path,
-                                         raw_content,
-                                         &sub_evaluated))
-                return err;
+            validate_node(data, *subSchema, depth, ctx, &sub_evaluated);
+            if (halt()) return;
             evaluated_here.insert(sub_evaluated.begin(), sub_evaluated.end());
         }
     }
+
     // anyOf
     if (schema_node.has("anyOf") && schema_node.at("anyOf").isArrayObject()) {
+        ProfileScope scope(ctx.profiler, "anyOf");
         const Dictionary& arr = schema_node.at("anyOf");
         bool matched = false;
         const Dictionary* deprecated_matched_schema = nullptr;
         std::vector<std::string> failures;
         std::set<std::string> any_evaluated;
-        for (int i = 0; i < arr.size(); ++i) {
+        const std::vector<int>* candidates = discriminator_candidates(data, arr, ctx);
+        int n_candidates = candidates ? static_cast<int>(candidates->size()) : arr.size();
+        for (int k = 0; k < n_candidates; ++k) {
+            int i = candidates ? (*candidates)[k] : k;
             const Dictionary& sub = arr[i];
             const Dictionary* subSchema = schema_from_value(schema_root, sub);
             if (!subSchema) continue;
             std::set<std::string> sub_evaluated;
-            auto err = validate_node(data,
-                                     schema_root,
-                                     *subSchema,
-                                     path,
-                                     raw_content,
-                                     &sub_evaluated);
+            std::optional<std::string> err;
+            {
+                ProfileScope branch_scope(ctx.profiler, [&] {
+                    return "anyOf[" + std::to_string(i) + "] " +
+                           extract_schema_name(*subSchema, schema_root);
+                });
+                err = try_alternative(data, *subSchema, depth, ctx, &sub_evaluated);
+            }
             if (!err.has_value()) {
                 // This alternative matched
                 matched = true;
@@ -882,102 +1814,28 @@ static std::optional<std::string> validate_node(const Dictionary& data,
             }
         }
         if (!matched) {
-            std::string msg = "anyOf did not match any schema at '" + display_path(path) + "'";
-            
-            // Try to get the original value (before defaults) for display
-            const Dictionary* display_data = &data;
-            if (g_original_data != nullptr) {
-                // Navigate to the same path in the original data
-                const Dictionary* orig = g_original_data;
-                bool found = true;
-                
-                // Parse the path and navigate through it
-                if (!path.empty()) {
-                    std::string temp_path = path;
-                    size_t pos = 0;
-                    while (pos < temp_path.size() && found) {
-                        // Find next separator (. or [)
-                        size_t dot_pos = temp_path.find('.', pos);
-                        size_t bracket_pos = temp_path.find('[', pos);
-                        
-                        if (dot_pos == std::string::npos && bracket_pos == std::string::npos) {
-                            // Last component
-                            std::string key = temp_path.substr(pos);
-                            if (orig->has(key)) {
-                                orig = &orig->at(key);
-                            } else {
-                                found = false;
-                            }
-                            break;
-                        }
-                        
-                        size_t next_sep = (dot_pos != std::string::npos && bracket_pos != std::string::npos) 
-                            ? std::min(dot_pos, bracket_pos)
-                            : (dot_pos != std::string::npos ? dot_pos : bracket_pos);
-                        
-                        if (temp_path[next_sep] == '.') {
-                            // Navigate by key
-                            std::string key = temp_path.substr(pos, next_sep - pos);
-                            if (!key.empty() && orig->has(key)) {
-                                orig = &orig->at(key);
-                                pos = next_sep + 1;
-                            } else {
-                                found = false;
-                            }
-                        } else {
-                            // Navigate by key then index
-                            std::string key = temp_path.substr(pos, next_sep - pos);
-                            if (!key.empty() && orig->has(key)) {
-                                orig = &orig->at(key);
-                            } else if (key.empty() && next_sep == pos) {
-                                // Already at the right place, just need to handle index
-                            } else {
-                                found = false;
-                                break;
-                            }
-                            
-                            // Now handle the [N] part
-                            size_t close_bracket = temp_path.find(']', next_sep);
-                            if (close_bracket != std::string::npos) {
-                                std::string index_str = temp_path.substr(next_sep + 1, close_bracket - next_sep - 1);
-                                int index = std::atoi(index_str.c_str());
-                                if (orig->isArrayObject() && index >= 0 && index < orig->size()) {
-                                    orig = &(*orig)[index];
-                                    pos = close_bracket + 1;
-                                    if (pos < temp_path.size() && temp_path[pos] == '.') {
-                                        pos++; // skip the dot
-                                    }
-                                } else {
-                                    found = false;
-                                }
-                            } else {
-                                found = false;
-                            }
-                        }
-                    }
-                }
-                
-                if (found) {
-                    display_data = orig;
-                }
-            }
-            
+            std::string msg =
+                        "anyOf did not match any schema at '" + display_path(ctx.path.str()) + "'";
+
+            // Show the original value (before defaults) when it is available
+            const Dictionary* display_data = original_value_at(data, ctx.path.str());
+
             // format with ron parser
             msg += std::string("\n Your value: ") + ps::dump_ron(*display_data);
-            
+
             if (!failures.empty()) {
                 // Try to reduce the number of alternatives shown by using discriminator filtering
                 std::vector<std::string> filtered_failures = failures;
-                
+
                 // Common discriminator field names to check
                 std::vector<std::string> discriminator_candidates = {"type", "kind", "variant"};
-                
+
                 // Only apply filtering if we have an object with potential discriminators
                 if (data.isMappedObject()) {
                     for (const auto& disc_name : discriminator_candidates) {
                         if (data.has(disc_name) && data.at(disc_name).type() == Dictionary::String) {
                             std::string disc_value = data.at(disc_name).asString();
-                            
+
                             // Check how many schemas actually constrain this discriminator
                             int schemas_with_constraint = 0;
                             for (int i = 0; i < arr.size(); ++i) {
@@ -988,7 +1846,7 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                                     schemas_with_constraint++;
                                 }
                             }
-                            
+
                             // Only filter if at least half the schemas use this discriminator
                             if (schemas_with_constraint >= arr.size() / 2) {
                                 std::vector<std::string> temp_failures;
@@ -996,7 +1854,7 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                                     const Dictionary& sub = arr[i];
                                     const Dictionary* subSchema = schema_from_value(schema_root, sub);
                                     if (!subSchema) continue;
-                                    
+
                                     if (schema_accepts_discriminator(*subSchema, schema_root, disc_name, disc_value)) {
                                         // Find the corresponding failure message
                                         std::string schemaName = extract_schema_name(*subSchema, schema_root);
@@ -1008,7 +1866,7 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                                         }
                                     }
                                 }
-                                
+
                                 // Use filtered list if it's not empty and significantly shorter
                                 if (!temp_failures.empty() && temp_failures.size() < failures.size() * 0.7) {
                                     filtered_failures = temp_failures;
@@ -1018,7 +1876,7 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                         }
                     }
                 }
-                
+
                 // Limit the number of alternatives shown to keep errors concise
                 const size_t max_alternatives = 5;
                 msg += "\n\nAlternatives:";
@@ -1029,11 +1887,8 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                     msg += "\n... and " + std::to_string(filtered_failures.size() - max_alternatives) + " more alternatives";
                 }
             }
-            return std::optional<std::string>(msg);
-        }
-
-        // Check if any deprecated alternative matched
-        if (matched && deprecated_matched_schema != nullptr) {
+            if (fail(msg, ErrorCategory::ANY_OF_MISMATCH)) return;
+        } else if (deprecated_matched_schema != nullptr) {
             std::string msg = "Using deprecated option";
             if (deprecated_matched_schema->has("const")) {
                 msg = "Value '" + deprecated_matched_schema->at("const").dump() + "' is deprecated";
@@ -1042,33 +1897,37 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                 deprecated_matched_schema->at("description").type() == Dictionary::String) {
                 msg += ": " + deprecated_matched_schema->at("description").asString();
             }
-            return std::optional<std::string>(msg);
-        }
-
-        if (matched) {
+            if (fail(msg, ErrorCategory::DEPRECATED_VALUE, ErrorSeverity::DEPRECATION)) return;
+        } else {
             evaluated_here.insert(any_evaluated.begin(), any_evaluated.end());
         }
     }
 
     // oneOf
     if (schema_node.has("oneOf") && schema_node.at("oneOf").isArrayObject()) {
+        ProfileScope scope(ctx.profiler, "oneOf");
         const Dictionary& arr = schema_node.at("oneOf");
         int matches = 0;
         std::vector<std::string> failures;
         std::vector<int> matched_indices;
         std::vector<const Dictionary*> matched_schemas;
         std::vector<std::set<std::string>> matched_evaluated;
-        for (int i = 0; i < arr.size(); ++i) {
+        const std::vector<int>* candidates = discriminator_candidates(data, arr, ctx);
+        int n_candidates = candidates ? static_cast<int>(candidates->size()) : arr.size();
+        for (int k = 0; k < n_candidates; ++k) {
+            int i = candidates ? (*candidates)[k] : k;
             const Dictionary& sub = arr[i];
             const Dictionary* subSchema = schema_from_value(schema_root, sub);
             if (!subSchema) continue;
             std::set<std::string> sub_evaluated;
-            auto err = validate_node(data,
-                                     schema_root,
-                                     *subSchema,
-                                     path,
-                                     raw_content,
-                                     &sub_evaluated);
+            std::optional<std::string> err;
+            {
+                ProfileScope branch_scope(ctx.profiler, [&] {
+                    return "oneOf[" + std::to_string(i) + "] " +
+                           extract_schema_name(*subSchema, schema_root);
+                });
+                err = try_alternative(data, *subSchema, depth, ctx, &sub_evaluated);
+            }
             if (!err.has_value()) {
                 ++matches;
                 matched_indices.push_back(i);
@@ -1079,85 +1938,70 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                 failures.push_back("Option: " + schemaName + "\n  Failed because: " + *err);
             }
         }
-        if (matches != 1) {
-            if (matches == 0) {
-                std::string msg = "oneOf did not match any schema at '" + display_path(path) + "'";
-                msg += std::string("\n Your value: ") + ps::dump_ron(data);
-                if (!failures.empty()) {
-                    msg += "\n\nAlternatives:";
-                    for (const auto& f : failures) {
-                        msg += "\n" + f + "\n";
-                    }
-                }
-                return std::optional<std::string>(msg);
-            } else {
-                std::string msg = "oneOf matched multiple schemas (" + std::to_string(matches) +
-                                  ") at '" + display_path(path) + "'";
-                msg += std::string("\n Your value: ") + ps::dump_ron(data);
-                msg += "\n  Matched alternatives:";
-                for (int idx : matched_indices) {
-                    msg += " " + std::to_string(idx);
+        if (matches == 0) {
+            std::string msg =
+                        "oneOf did not match any schema at '" + display_path(ctx.path.str()) + "'";
+            msg += std::string("\n Your value: ") + ps::dump_ron(data);
+            if (!failures.empty()) {
+                msg += "\n\nAlternatives:";
+                for (const auto& f : failures) {
+                    msg += "\n" + f + "\n";
                 }
-                return std::optional<std::string>(msg);
             }
-        }
-
-        // Exactly one schema matched; inherit its evaluated properties.
-        if (matched_evaluated.size() == 1) {
+            if (fail(msg, ErrorCategory::ONE_OF_MISMATCH)) return;
+        } else if (matches > 1) {
+            std::string msg = "oneOf matched multiple schemas (" + std::to_string(matches) +
+                              ") at '" + display_path(ctx.path.str()) + "'";
+            msg += std::string("\n Your value: ") + ps::dump_ron(data);
+            msg += "\n  Matched alternatives:";
+            for (int idx : matched_indices) {
+                msg += " " + std::to_string(idx);
+            }
+            if (fail(msg, ErrorCategory::ONE_OF_MISMATCH)) return;
+        } else {
+            // Exactly one schema matched; inherit its evaluated properties.
             evaluated_here.insert(matched_evaluated[0].begin(), matched_evaluated[0].end());
-        }
 
-        // Check if any of the matched alternatives are deprecated
-        if (matches >= 1) {
-            for (const Dictionary* matched_schema : matched_schemas) {
-                // Resolve $ref if present
-                const Dictionary* resolved_schema = matched_schema;
-                if (matched_schema->has("$ref") &&
-                    matched_schema->at("$ref").type() == Dictionary::String) {
-                    resolved_schema = resolve_local_ref(schema_root,
-                                                        matched_schema->at("$ref").asString());
-                    if (!resolved_schema) resolved_schema = matched_schema;
-                }
+            // Check if the matched alternative is deprecated
+            const Dictionary* resolved_schema = matched_schemas[0];
+            if (resolved_schema->has("$ref") &&
+                resolved_schema->at("$ref").type() == Dictionary::String) {
+                resolved_schema = resolve_local_ref(schema_root,
+                                                    resolved_schema->at("$ref").asString());
+                if (!resolved_schema) resolved_schema = matched_schemas[0];
+            }
 
-                if (resolved_schema->has("deprecated") &&
-                    resolved_schema->at("deprecated").type() == Dictionary::Boolean &&
-                    resolved_schema->at("deprecated").asBool()) {
-                    std::string msg = "Using deprecated option";
-                    if (resolved_schema->has("const")) {
-                        msg = "Value '" + resolved_schema->at("const").dump() + "' is deprecated";
-                    }
-                    if (resolved_schema->has("description") &&
-                        resolved_schema->at("description").type() == Dictionary::String) {
-                        msg += ": " + resolved_schema->at("description").asString();
-                    }
-                    return std::optional<std::string>(msg);
+            if (resolved_schema->has("deprecated") &&
+                resolved_schema->at("deprecated").type() == Dictionary::Boolean &&
+                resolved_schema->at("deprecated").asBool()) {
+                std::string msg = "Using deprecated option";
+                if (resolved_schema->has("const")) {
+                    msg = "Value '" + resolved_schema->at("const").dump() + "' is deprecated";
+                }
+                if (resolved_schema->has("description") &&
+                    resolved_schema->at("description").type() == Dictionary::String) {
+                    msg += ": " + resolved_schema->at("description").asString();
                 }
+                if (fail(msg, ErrorCategory::DEPRECATED_VALUE, ErrorSeverity::DEPRECATION))
+                    return;
             }
         }
     }
 
     // not: data must NOT validate against the given schema
     if (schema_node.has("not")) {
+        ProfileScope scope(ctx.profiler, "not");
         const Dictionary* notSchema = schema_from_value(schema_root, schema_node.at("not"));
         if (notSchema) {
             std::set<std::string> not_evaluated;
-            auto err = validate_node(data,
-                                     schema_root,
-                                     *notSchema,
-                                     path,
-                                     raw_content,
-                                     &not_evaluated);
+            auto err = try_alternative(data, *notSchema, depth, ctx, &not_evaluated);
             // If validation succeeded (no error), the 'not' constraint is violated
             if (!err.has_value()) {
-                // Try to provide a more specific error message by analyzing the 'not' schema
-                std::string msg;
-                std::string error_path = path;
-                
                 // Check if 'not' contains anyOf with required fields - common pattern for forbidden properties
+                std::vector<std::string> forbidden_found;
                 if (notSchema->has("anyOf") && notSchema->at("anyOf").isArrayObject() && data.isMappedObject()) {
                     const Dictionary& anyOfArray = notSchema->at("anyOf");
-                    std::vector<std::string> forbidden_found;
-                    
+
                     // Check each anyOf alternative for required fields that exist in data
                     for (int i = 0; i < anyOfArray.size(); ++i) {
                         const Dictionary* alt = schema_from_value(schema_root, anyOfArray[i]);
@@ -1173,30 +2017,34 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                             }
                         }
                     }
-                    
-                    if (!forbidden_found.empty()) {
-                        // Point to the first forbidden property instead of the parent
-                        std::string forbidden_key = forbidden_found[0];
-                        error_path = path.empty() ? forbidden_key : path + "." + forbidden_key;
-                        
-                        msg = "propert";
-                        msg += (forbidden_found.size() == 1) ? "y '" : "ies '";
-                        for (size_t i = 0; i < forbidden_found.size(); ++i) {
-                            if (i > 0) msg += "', '";
-                            msg += forbidden_found[i];
-                        }
-                        msg += "' not allowed at '" + display_path(error_path) + "'";
-                        
-                        // Store the path to the forbidden property in a special format
-                        // that signals to line number lookup to use this path
-                        msg = "@@PATH:" + error_path + "@@" + msg;
-                        return std::optional<std::string>(msg);
+                }
+
+                if (!forbidden_found.empty()) {
+                    // Point to the first forbidden property instead of the parent
+                    std::string forbidden_key = forbidden_found[0];
+                    std::string error_path = ctx.path.child(forbidden_key);
+
+                    std::string msg = "propert";
+                    msg += (forbidden_found.size() == 1) ? "y '" : "ies '";
+                    for (size_t i = 0; i < forbidden_found.size(); ++i) {
+                        if (i > 0) msg += "', '";
+                        msg += forbidden_found[i];
                     }
+                    msg += "' not allowed at '" + display_path(error_path) + "'";
+                    ctx.report(error_path,
+                               msg,
+                               ctx.line_of(error_path),
+                               depth + 1,
+                               ErrorSeverity::ERROR,
+                               ErrorCategory::ADDITIONAL_PROPERTY);
+                    if (halt()) return;
+                } else {
+                    // Fallback generic message
+                    if (fail("value at '" + display_path(ctx.path.str()) +
+                                     "' must not validate against the 'not' schema",
+                             ErrorCategory::OTHER))
+                        return;
                 }
-                
-                // Fallback generic message
-                msg = "value at '" + display_path(path) + "' must not validate against the 'not' schema";
-                return std::optional<std::string>(msg);
             }
             // Otherwise, validation failed as expected for 'not', so continue
         }
@@ -1221,10 +2069,10 @@ static std::optional<std::string> validate_node(const Dictionary& data,
     if (should_validate_as_object) {
         // Validate mapped object: properties, required, additionalProperties,
         // patternProperties, minProperties/maxProperties
-        if (!data.isMappedObject())
-            return std::optional<std::string>(limit_line_length(
-                        "expected type 'object' at '" + display_path(path) + "' but found '" +
-                        value_type_name(data) + "' (value: " + value_preview(data) + ")"));
+        if (!data.isMappedObject()) {
+            type_mismatch("object");
+            return;
+        }
 
         // gather property schemas
         const Dictionary* properties = nullptr;
@@ -1245,6 +2093,7 @@ static std::optional<std::string> validate_node(const Dictionary& data,
             it_add = &schema_node.at("additionalProperties");
 
         // required can be specified in two styles: per-property boolean or parent-level array
+        ProfileScope required_scope(ctx.profiler, "required");
         std::set<std::string> required_names;
         if (schema_node.has("required")) {
             const Dictionary& r = schema_node.at("required");
@@ -1261,186 +2110,152 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                 }
             }
         }
-
-        // Enforce parent-level required names even if no explicit "properties" are listed
-        for (auto const& rn : required_names) {
-            if (!data.has(rn)) {
-                // Before reporting as missing, check if a deprecated alternative exists
-                // that should be validated instead
-                bool found_deprecated_alternative = false;
-                if (properties) {
-                    for (auto const& dprop : data.items()) {
-                        const std::string& candidate = dprop.first;
-                        // Check if this key is in properties and marked as deprecated
-                        if (properties->has(candidate)) {
-                            const Dictionary& prop_schema = properties->at(candidate);
-                            if (prop_schema.has("deprecated") &&
-                                prop_schema.at("deprecated").type() == Dictionary::Boolean &&
-                                prop_schema.at("deprecated").asBool()) {
-                                // Found a deprecated alternative - it will be validated below
-                                found_deprecated_alternative = true;
-                                break;
-                            }
-                        }
-                    }
+        if (properties) {
+            for (auto const& key : properties->keys()) {
+                const Dictionary& propSchema = properties->at(key);
+                if (propSchema.has("required") &&
+                    propSchema.at("required").type() == Dictionary::Boolean &&
+                    propSchema.at("required").asBool()) {
+                    required_names.insert(key);
                 }
+            }
+        }
 
-                if (found_deprecated_alternative) {
-                    // Don't report as missing - the deprecated alternative will be
-                    // validated and flagged in the property iteration below
-                    continue;
-                }
+        std::set<std::string> suggested_keys;  // already reported as likely typos
+        for (auto const& rn : required_names) {
+            if (data.has(rn)) continue;
 
-                // Check if there's a similar key in the data that might be a typo of the
-                // required name. Only suggest keys that are NOT already allowed by the schema.
-                std::string suggestion;
-                for (auto const& dprop : data.items()) {
-                    const std::string& candidate = dprop.first;
+            // Check if there's a similar key in the data that might be a typo of the
+            // required name. Only suggest keys that are NOT already allowed by the schema.
+            std::string suggestion;
+            if (!ctx.options.skip_suggestions) {
+                for (auto const& candidate : data.keys()) {
                     // Skip if this key is explicitly allowed in properties
                     if (properties && properties->has(candidate)) continue;
 
-                    int d = levenshtein_distance(candidate, rn);
-                    size_t maxlen = std::max(candidate.size(), rn.size());
-                    double ratio =
-                                maxlen == 0 ? 0.0
-                                            : static_cast<double>(d) / static_cast<double>(maxlen);
-                    if (ratio <= 0.40 || d <= 2) {
+                    int bound = suggestion_bound(rn.size(), candidate.size(), 0.40, 2);
+                    if (levenshtein_distance(candidate, rn, bound) <= bound) {
                         suggestion = candidate;
                         break;
                     }
                 }
+            }
 
-                if (!suggestion.empty()) {
-                    std::string msg = "key '" + suggestion + "' not allowed";
-                    msg += " Did you mean '" + rn + "'?";
-                    return std::optional<std::string>(msg);
-                }
-                std::string full_key = path.empty() ? rn : path + "." + rn;
-                std::string msg = "missing required key '" + full_key + "'";
-                // Add line number context if available
-                if (!raw_content.empty()) {
-                    int line = -1;
-                    if (!path.empty()) {
-                        // For nested objects, find the parent object
-                        line = find_line_number(raw_content, path);
-                    } else if (data.size() > 0) {
-                        // For root level, find the first existing key for context
-                        for (auto const& item : data.items()) {
-                            line = find_line_number(raw_content, item.first);
-                            if (line > 0) break;
-                        }
-                    }
-                    if (line > 0) {
-                        msg = "line " + std::to_string(line) + ": " + msg;
-                    }
-                }
-                return std::optional<std::string>(msg);
+            const std::string path = ctx.path.str();
+            std::string full_key = ctx.path.child(rn);
+            int line = missing_key_line(data, path, raw_content);
+            if (!suggestion.empty()) {
+                suggested_keys.insert(suggestion);
+                std::string child_path = ctx.path.child(suggestion);
+                ctx.report(path,
+                           "key '" + suggestion + "' not allowed Did you mean '" + rn + "'?",
+                           ctx.line_of(child_path),
+                           depth,
+                           ErrorSeverity::ERROR,
+                           ErrorCategory::ADDITIONAL_PROPERTY);
+                if (ctx.stop()) return;
             }
+            ctx.report(full_key,
+                       with_line_prefix(ctx, line, "missing required key '" + full_key + "'"),
+                       line,
+                       depth,
+                       ErrorSeverity::ERROR,
+                       ErrorCategory::MISSING_REQUIRED);
+            if (ctx.stop()) return;
         }
 
         // minProperties/maxProperties
         if (schema_node.has("minProperties") &&
             schema_node.at("minProperties").type() == Dictionary::Integer) {
-            if (data.size() < schema_node.at("minProperties").asInt())
-                return std::optional<std::string>("object has fewer properties than minProperties");
+            if (data.size() < schema_node.at("minProperties").asInt()) {
+                const std::string path = ctx.path.str();
+                ctx.report(path,
+                           "object has fewer properties than minProperties",
+                           ctx.line_of(path),
+                           depth,
+                           ErrorSeverity::ERROR,
+                           ErrorCategory::OTHER);
+                if (ctx.stop()) return;
+            }
         }
         if (schema_node.has("maxProperties") &&
             schema_node.at("maxProperties").type() == Dictionary::Integer) {
-            if (data.size() > schema_node.at("maxProperties").asInt())
-                return std::optional<std::string>("object has more properties than maxProperties");
+            if (data.size() > schema_node.at("maxProperties").asInt()) {
+                const std::string path = ctx.path.str();
+                ctx.report(path,
+                           "object has more properties than maxProperties",
+                           ctx.line_of(path),
+                           depth,
+                           ErrorSeverity::ERROR,
+                           ErrorCategory::OTHER);
+                if (ctx.stop()) return;
+            }
         }
 
+        required_scope.end();
+
         // iterate expected properties
         if (properties) {
-            for (auto const& p : properties->items()) {
-                const std::string& key = p.first;
-                const Dictionary& propSchema = p.second;
-                bool has = data.has(key);
-                // per-property required as boolean
-                auto itreq = propSchema.has("required") ? &propSchema.at("required") : nullptr;
-                if (!has) {
-                    std::string full_key = path.empty() ? key : path + "." + key;
-                    std::string msg = "missing required key '" + full_key + "'";
-                    // Add line number context if available
-                    if (!raw_content.empty()) {
-                        int line = -1;
-                        if (!path.empty()) {
-                            // For nested objects, find the parent object
-                            line = find_line_number(raw_content, path);
-                        } else if (data.size() > 0) {
-                            // For root level, find the first existing key for context
-                            for (auto const& item : data.items()) {
-                                line = find_line_number(raw_content, item.first);
-                                if (line > 0) break;
-                            }
-                        }
-                        if (line > 0) {
-                            msg = "line " + std::to_string(line) + ": " + msg;
-                        }
-                    }
-                    if (itreq != nullptr && itreq->type() == Dictionary::Boolean && itreq->asBool())
-                        return std::optional<std::string>(msg);
-                    if (required_names.find(key) != required_names.end())
-                        return std::optional<std::string>(msg);
+            ProfileScope scope(ctx.profiler, "properties");
+            for (auto const& key : properties->keys()) {
+                if (!data.has(key)) continue;
+                const Dictionary& propSchema = properties->at(key);
+                if (!ctx.descends(key)) {
+                    // Not edited: its earlier issues stand, only evaluation is tracked
+                    if (schema_from_value(schema_root, propSchema)) evaluated_here.insert(key);
                     continue;
                 }
+                PathScope child_scope(ctx.path, key);
+
                 // validate present property
-                const Dictionary& subSchemaValue = propSchema;
-                const Dictionary* subSchema = schema_from_value(schema_root, subSchemaValue);
+                const Dictionary* subSchema = schema_from_value(schema_root, propSchema);
                 if (subSchema) {
-                    if (auto err = validate_node(data.at(key),
-                                                 schema_root,
-                                                 *subSchema,
-                                                 path.empty() ? key : path + "." + key,
-                                                 raw_content))
-                        return err;
-
+                    validate_node(data.at(key), *subSchema, depth + 1, ctx);
+                    if (ctx.stop()) return;
                     evaluated_here.insert(key);
+                }
 
-                    // Check if property is deprecated
-                    if (propSchema.has("deprecated") &&
-                        propSchema.at("deprecated").type() == Dictionary::Boolean &&
-                        propSchema.at("deprecated").asBool()) {
-                        std::string full_key = path.empty() ? key : path + "." + key;
-                        std::string msg = "Property '" + full_key + "' is deprecated";
-                        if (propSchema.has("description") &&
-                            propSchema.at("description").type() == Dictionary::String) {
-                            msg += ": " + propSchema.at("description").asString();
-                        }
-                        // Add line number if raw_content is available
-                        if (!raw_content.empty()) {
-                            int line = find_line_number(raw_content, full_key);
-                            if (line > 0) {
-                                msg = "line " + std::to_string(line) + ": " + msg;
-                            }
-                        }
-                        return std::optional<std::string>(msg);
+                // Check if property is deprecated
+                if (propSchema.has("deprecated") &&
+                    propSchema.at("deprecated").type() == Dictionary::Boolean &&
+                    propSchema.at("deprecated").asBool()) {
+                    const std::string child_path = ctx.path.str();
+                    std::string msg = "Property '" + child_path + "' is deprecated";
+                    if (propSchema.has("description") &&
+                        propSchema.at("description").type() == Dictionary::String) {
+                        msg += ": " + propSchema.at("description").asString();
                     }
+                    int line = raw_content.empty() ? -1 : find_line_number(raw_content, child_path);
+                    ctx.report(child_path,
+                               with_line_prefix(ctx, line, msg),
+                               line,
+                               depth + 1,
+                               ErrorSeverity::DEPRECATION,
+                               ErrorCategory::DEPRECATED_PROPERTY);
+                    if (ctx.stop()) return;
                 }
             }
         }
 
         // now check each data property for patternProperties/additionalProperties
-        for (auto const& dprop : data.items()) {
-            const std::string& key = dprop.first;
-            bool handled = false;
-            if (properties && properties->has(key)) {
-                handled = true;
-            }
+        ProfileScope additional_scope(ctx.profiler, "additionalProperties");
+        for (auto const& key : data.keys()) {
+            if (properties && properties->has(key)) continue;
+
             // check patternProperties
-            if (!handled && patternProps) {
-                for (auto const& pp : patternProps->items()) {
+            bool handled = false;
+            if (patternProps) {
+                ProfileScope scope(ctx.profiler, "patternProperties");
+                for (auto const& pattern : patternProps->keys()) {
                     try {
-                        std::regex rx(pp.first);
+                        std::regex rx(pattern);
                         if (std::regex_match(key, rx)) {
-                            const Dictionary* sub = schema_from_value(schema_root, pp.second);
-                            if (sub) {
-                                if (auto err = validate_node(data.at(key),
-                                                             schema_root,
-                                                             *sub,
-                                                             path.empty() ? key : path + "." + key,
-                                                             raw_content))
-                                    return err;
+                            const Dictionary* sub =
+                                        schema_from_value(schema_root, patternProps->at(pattern));
+                            if (sub && ctx.descends(key)) {
+                                PathScope child_scope(ctx.path, key);
+                                validate_node(data.at(key), *sub, depth + 1, ctx);
+                                if (ctx.stop()) return;
                             }
                             handled = true;
                             evaluated_here.insert(key);
@@ -1461,8 +2276,13 @@ static std::optional<std::string> validate_node(const Dictionary& data,
             const Dictionary& ap = *it_add;
             if (ap.type() == Dictionary::Boolean) {
                 if (!ap.asBool()) {
+                    if (suggested_keys.count(key)) continue;
                     // Try to suggest nearby property names from the declared properties
-                    std::vector<std::string> suggestions = find_nearby_keys(key, properties);
+                    std::vector<std::string> suggestions;
+                    if (!ctx.options.skip_suggestions && properties) {
+                        suggestions = find_nearby_keys(key, ctx.suggestion_index_for(*properties));
+                    }
+                    const std::string path = ctx.path.str();
                     std::string msg = "key '" + key + "' not valid";
                     if (!path.empty()) {
                         msg += " in '" + path + "'";
@@ -1485,42 +2305,55 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                             msg += "?";
                         }
                     }
-                    return std::optional<std::string>(msg);
+                    ctx.report(path,
+                               msg,
+                               ctx.line_of(ctx.path.child(key)),
+                               depth,
+                               ErrorSeverity::ERROR,
+                               ErrorCategory::ADDITIONAL_PROPERTY);
+                    if (ctx.stop()) return;
+                    continue;
                 }
 
                 // additionalProperties: true => treat as evaluated for unevaluatedProperties.
                 evaluated_here.insert(key);
             } else {
                 const Dictionary* sub = schema_from_value(schema_root, ap);
-                if (sub) {
-                    if (auto err = validate_node(data.at(key),
-                                                 schema_root,
-                                                 *sub,
-                                                 path.empty() ? key : path + "." + key,
-                                                 raw_content))
-                        return err;
+                if (sub && ctx.descends(key)) {
+                    PathScope child_scope(ctx.path, key);
+                    validate_node(data.at(key), *sub, depth + 1, ctx);
+                    if (ctx.stop()) return;
                 }
 
                 evaluated_here.insert(key);
             }
         }
+        additional_scope.end();
 
         // unevaluatedProperties (draft 2019-09+): apply after properties/patternProperties/
         // additionalProperties and applicators (e.g., allOf) have evaluated properties.
         if (schema_node.has("unevaluatedProperties")) {
+            ProfileScope scope(ctx.profiler, "unevaluatedProperties");
             const Dictionary& up = schema_node.at("unevaluatedProperties");
-            for (auto const& dprop : data.items()) {
-                const std::string& key = dprop.first;
+            for (auto const& key : data.keys()) {
                 if (evaluated_here.find(key) != evaluated_here.end()) continue;
 
                 if (up.type() == Dictionary::Boolean) {
                     if (!up.asBool()) {
+                        const std::string path = ctx.path.str();
                         std::string msg = "key '" + key + "' not valid";
                         if (!path.empty()) {
                             msg += " in '" + path + "'";
                         }
                         msg += ".";
-                        return std::optional<std::string>(msg);
+                        ctx.report(path,
+                                   msg,
+                                   ctx.line_of(ctx.path.child(key)),
+                                   depth,
+                                   ErrorSeverity::ERROR,
+                                   ErrorCategory::ADDITIONAL_PROPERTY);
+                        if (ctx.stop()) return;
+                        continue;
                     }
 
                     evaluated_here.insert(key);
@@ -1528,13 +2361,10 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                 }
 
                 const Dictionary* sub = schema_from_value(schema_root, up);
-                if (sub) {
-                    if (auto err = validate_node(data.at(key),
-                                                 schema_root,
-                                                 *sub,
-                                                 path.empty() ? key : path + "." + key,
-                                                 raw_content))
-                        return err;
+                if (sub && ctx.descends(key)) {
+                    PathScope child_scope(ctx.path, key);
+                    validate_node(data.at(key), *sub, depth + 1, ctx);
+                    if (ctx.stop()) return;
                 }
                 evaluated_here.insert(key);
             }
@@ -1543,77 +2373,77 @@ static std::optional<std::string> validate_node(const Dictionary& data,
         if (evaluated_props_out != nullptr) {
             evaluated_props_out->insert(evaluated_here.begin(), evaluated_here.end());
         }
-
-        return std::nullopt;
+        return;
     }
 
     // Continue with type checking for other types
     if (schema_node.has("type") && schema_node.at("type").type() == Dictionary::String) {
         std::string t = schema_node.at("type").asString();
         if (t == "array") {
-            if (!data.isArrayObject())
-                return std::optional<std::string>(limit_line_length(
-                            "expected type 'array' at '" + display_path(path) + "' but found '" +
-                            value_type_name(data) + "' (value: " + value_preview(data) + ")"));
+            if (!data.isArrayObject()) {
+                type_mismatch("array");
+                return;
+            }
 
             // minItems / maxItems
             if (schema_node.has("minItems") &&
                 schema_node.at("minItems").type() == Dictionary::Integer) {
-                if (data.size() < schema_node.at("minItems").asInt())
-                    return std::optional<std::string>("array too few items");
+                if (data.size() < schema_node.at("minItems").asInt()) {
+                    if (fail("array too few items", ErrorCategory::ARRAY_SIZE)) return;
+                }
             }
             if (schema_node.has("maxItems") &&
                 schema_node.at("maxItems").type() == Dictionary::Integer) {
-                if (data.size() > schema_node.at("maxItems").asInt())
-                    return std::optional<std::string>("array too many items");
+                if (data.size() > schema_node.at("maxItems").asInt()) {
+                    if (fail("array too many items", ErrorCategory::ARRAY_SIZE)) return;
+                }
             }
 
             // uniqueItems
             if (schema_node.has("uniqueItems") &&
                 schema_node.at("uniqueItems").type() == Dictionary::Boolean &&
                 schema_node.at("uniqueItems").asBool()) {
-                std::set<std::string> seen;
+                ProfileScope scope(ctx.profiler, "uniqueItems");
+                DictionaryPtrSet seen;
+                seen.reserve(static_cast<size_t>(data.size()));
                 for (int i = 0; i < data.size(); ++i) {
-                    const Dictionary& el = data[i];
-                    std::string key = el.dump();
-                    if (seen.find(key) != seen.end())
-                        return std::optional<std::string>("array has duplicate items");
-                    seen.insert(key);
+                    if (!seen.insert(&data[i]).second) {
+                        if (fail("array has duplicate items", ErrorCategory::UNIQUE_ITEMS)) return;
+                        break;
+                    }
                 }
             }
 
             // prefixItems (Draft 2020-12): array of schemas for positional validation
             if (schema_node.has("prefixItems") && schema_node.at("prefixItems").isArrayObject()) {
+                ProfileScope scope(ctx.profiler, "prefixItems");
                 const Dictionary& prefixItems = schema_node.at("prefixItems");
                 size_t nPrefix = prefixItems.size();
                 for (size_t i = 0; i < nPrefix && i < static_cast<size_t>(data.size()); ++i) {
                     const Dictionary* sub = schema_from_value(schema_root, prefixItems[static_cast<int>(i)]);
-                    if (sub) {
-                        if (auto err = validate_node(data[static_cast<int>(i)],
-                                                     schema_root,
-                                                     *sub,
-                                                     path + "[" + std::to_string(i) + "]",
-                                                     raw_content))
-                            return err;
+                    if (sub && ctx.descends(static_cast<int>(i))) {
+                        PathScope item_scope(ctx.path, static_cast<int>(i));
+                        validate_node(data[static_cast<int>(i)], *sub, depth + 1, ctx);
+                        if (ctx.stop()) return;
                     }
                 }
 
                 // After prefixItems, validate remaining items with 'items' schema if present
                 if (schema_node.has("items")) {
                     const Dictionary* itemsSchema = schema_from_value(schema_root, schema_node.at("items"));
-                    if (itemsSchema) {
+                    if (itemsSchema &&
+                        !numeric_items_skip(data, static_cast<int>(nPrefix), itemsSchema, ctx)) {
                         for (size_t i = nPrefix; i < static_cast<size_t>(data.size()); ++i) {
-                            if (auto err = validate_node(data[static_cast<int>(i)],
-                                                         schema_root,
-                                                         *itemsSchema,
-                                                         path + "[" + std::to_string(i) + "]",
-                                                         raw_content))
-                                return err;
+                            if (!ctx.descends(static_cast<int>(i))) continue;
+                            PathScope item_scope(ctx.path, static_cast<int>(i));
+                            validate_node(data[static_cast<int>(i)], *itemsSchema, depth + 1, ctx);
+                            if (ctx.stop()) return;
                         }
                     }
                 }
             } else if (schema_node.has("items")) {
                 // items: schema or tuple (older draft support)
+                ProfileScope scope(ctx.profiler, "items");
                 const Dictionary& itemsVal = schema_node.at("items");
                 if (itemsVal.isArrayObject()) {
                     // tuple validation
@@ -1624,470 +2454,111 @@ static std::optional<std::string> validate_node(const Dictionary& data,
                     for (int i = 0; i < data.size(); ++i) {
                         if (static_cast<size_t>(i) < nSchemas) {
                             const Dictionary* sub = schema_from_value(schema_root, itemsVal[i]);
-                            if (sub) {
-                                if (auto err = validate_node(data[i],
-                                                             schema_root,
-                                                             *sub,
-                                                             path + "[" + std::to_string(i) + "]",
-                                                             raw_content))
-                                    return err;
+                            if (sub && ctx.descends(i)) {
+                                PathScope item_scope(ctx.path, i);
+                                validate_node(data[i], *sub, depth + 1, ctx);
+                                if (ctx.stop()) return;
                             }
-                        } else {
+                        } else if (itadd != nullptr) {
                             // additionalItems handling
-                            if (itadd != nullptr) {
-                                if (itadd->type() == Dictionary::Boolean) {
-                                    if (!itadd->asBool())
-                                        return std::optional<std::string>(
-                                                    "additional tuple items not allowed");
-                                } else {
-                                    const Dictionary* sub = schema_from_value(schema_root, *itadd);
-                                    if (sub) {
-                                            if (auto err = validate_node(data[i],
-                                                                         schema_root,
-                                                                         *sub,
-                                                                         path + "[" + std::to_string(i) + "]",
-                                                                         raw_content))
-                                            return err;
-                                    }
+                            if (itadd->type() == Dictionary::Boolean) {
+                                if (!itadd->asBool()) {
+                                    if (fail("additional tuple items not allowed",
+                                             ErrorCategory::ARRAY_SIZE))
+                                        return;
+                                    break;
+                                }
+                            } else {
+                                const Dictionary* sub = schema_from_value(schema_root, *itadd);
+                                if (sub && ctx.descends(i)) {
+                                    PathScope item_scope(ctx.path, i);
+                                    validate_node(data[i], *sub, depth + 1, ctx);
+                                    if (ctx.stop()) return;
                                 }
                             }
                         }
                     }
                 } else {
                     const Dictionary* sub = schema_from_value(schema_root, itemsVal);
-                    if (sub) {
+                    if (sub && !numeric_items_skip(data, 0, sub, ctx)) {
                         for (int i = 0; i < data.size(); ++i) {
-                            if (auto err = validate_node(data[i],
-                                                         schema_root,
-                                                         *sub,
-                                                         path + "[" + std::to_string(i) + "]",
-                                                         raw_content))
-                                return err;
+                            if (!ctx.descends(i)) continue;
+                            PathScope item_scope(ctx.path, i);
+                            validate_node(data[i], *sub, depth + 1, ctx);
+                            if (ctx.stop()) return;
                         }
                     }
                 }
             }
-
-            return std::nullopt;
+            return;
         }
         if (t == "string") {
-            if (data.type() != Dictionary::String)
-                return std::optional<std::string>(limit_line_length(
-                            "expected type 'string' at '" + display_path(path) + "' but found '" +
-                            value_type_name(data) + "' (value: " + value_preview(data) + ")"));
+            if (data.type() != Dictionary::String) {
+                type_mismatch("string");
+                return;
+            }
             // minLength / maxLength
             if (schema_node.has("minLength") &&
                 schema_node.at("minLength").type() == Dictionary::Integer) {
-                if ((int)data.asString().size() < schema_node.at("minLength").asInt())
-                    return std::optional<std::string>("string shorter than minLength");
+                if ((int)data.asString().size() < schema_node.at("minLength").asInt()) {
+                    if (fail("string shorter than minLength", ErrorCategory::OTHER)) return;
+                }
             }
             if (schema_node.has("maxLength") &&
                 schema_node.at("maxLength").type() == Dictionary::Integer) {
-                if ((int)data.asString().size() > schema_node.at("maxLength").asInt())
-                    return std::optional<std::string>("string longer than maxLength");
+                if ((int)data.asString().size() > schema_node.at("maxLength").asInt()) {
+                    if (fail("string longer than maxLength", ErrorCategory::OTHER)) return;
+                }
             }
             // pattern
             if (schema_node.has("pattern") &&
                 schema_node.at("pattern").type() == Dictionary::String) {
+                ProfileScope scope(ctx.profiler, "pattern");
+                ProfileScope location_scope(ctx.profiler, [&] {
+                    return "pattern " + schema_node.at("pattern").asString();
+                });
                 try {
                     std::regex rx(schema_node.at("pattern").asString());
                     if (!std::regex_match(data.asString(), rx)) {
-                        return std::optional<std::string>("string does not match pattern");
+                        if (fail("string does not match pattern", ErrorCategory::PATTERN_MISMATCH))
+                            return;
                     }
                 } catch (...) {
                     // invalid regex -> skip
                 }
             }
-            return std::nullopt;
+            return;
         }
         if (t == "integer") {
-            if (data.type() != Dictionary::Integer)
-                return std::optional<std::string>(limit_line_length(
-                            "expected type 'integer' at '" + display_path(path) + "' but found '" +
-                            value_type_name(data) + "' (value: " + value_preview(data) + ")"));
-            if (auto e = check_numeric_constraints(data, schema_node, path)) return e;
-            return std::nullopt;
+            if (data.type() != Dictionary::Integer) {
+                type_mismatch("integer");
+                return;
+            }
+            ProfileScope scope(ctx.profiler, "minimum/maximum");
+            if (auto e = check_numeric_constraints(data, schema_node, ctx.path))
+                fail(*e, ErrorCategory::OUT_OF_RANGE);
+            return;
         }
         if (t == "number") {
-            if (!(data.type() == Dictionary::Double || data.type() == Dictionary::Integer))
-                return std::optional<std::string>(limit_line_length(
-                            "expected type 'number' at '" + display_path(path) + "' but found '" +
-                            value_type_name(data) + "' (value: " + value_preview(data) + ")"));
-            if (auto e = check_numeric_constraints(data, schema_node, path)) return e;
-            return std::nullopt;
+            if (!(data.type() == Dictionary::Double || data.type() == Dictionary::Integer)) {
+                type_mismatch("number");
+                return;
+            }
+            ProfileScope scope(ctx.profiler, "minimum/maximum");
+            if (auto e = check_numeric_constraints(data, schema_node, ctx.path))
+                fail(*e, ErrorCategory::OUT_OF_RANGE);
+            return;
         }
         if (t == "boolean") {
-            if (data.type() != Dictionary::Boolean)
-                return std::optional<std::string>(limit_line_length(
-                            "expected type 'boolean' at '" + display_path(path) + "' but found '" +
-                            value_type_name(data) + "' (value: " + value_preview(data) + ")"));
-            return std::nullopt;
-        }
-    }
-
-    // fallback: apply numeric/enum constraints if present
-    if (auto e = check_enum(data, schema_node, path, raw_content)) return e;
-    if (auto e2 = check_numeric_constraints(data, schema_node, path)) return e2;
-
-    return std::nullopt;
-}
-
-// Error-collecting validator - traverses schema and collects all errors
-static void validate_node_collect(const Dictionary& data,
-                                  const Dictionary& schema_root,
-                                  const Dictionary& schema_node,
-                                  const std::string& path,
-                                  int depth,
-                                  const std::string& raw_content,
-                                  std::vector<ValidationError>& errors) {
-    // Resolve $ref if present before continuing
-    const Dictionary* effective_schema = &schema_node;
-    if (schema_node.has("$ref") && schema_node.at("$ref").type() == Dictionary::String) {
-        const std::string ref = schema_node.at("$ref").asString();
-        const Dictionary* target = resolve_local_ref(schema_root, ref);
-        if (target) {
-            effective_schema = target;
-        } else {
-            errors.emplace_back(display_path(path),
-                                "unresolved $ref '" + ref + "' at " + path,
-                                find_line_number(raw_content, path),
-                                depth,
-                                ErrorSeverity::ERROR,
-                                ErrorCategory::OTHER);
-            return;  // Can't continue without resolving ref
-        }
-    }
-
-    // Handle allOf: validate against all sub-schemas and collect all errors
-    if (effective_schema->has("allOf") && effective_schema->at("allOf").isArrayObject()) {
-        const Dictionary& allOf = effective_schema->at("allOf");
-        for (int i = 0; i < allOf.size(); ++i) {
-            const Dictionary& sub_schema = allOf[i];
-            // Recursively validate against each sub-schema in allOf
-            validate_node_collect(data, schema_root, sub_schema, path, depth, raw_content, errors);
+            if (data.type() != Dictionary::Boolean) type_mismatch("boolean");
+            return;
         }
-        return;  // allOf handling is complete
-    }
-
-    // Check if this is an object validation
-    bool is_object_validation = false;
-    if (effective_schema->has("type") &&
-        effective_schema->at("type").type() == Dictionary::String) {
-        std::string t = effective_schema->at("type").asString();
-        is_object_validation = (t == "object");
-    } else if (data.isMappedObject() &&
-               (effective_schema->has("properties") || effective_schema->has("required") ||
-                effective_schema->has("additionalProperties") ||
-                effective_schema->has("patternProperties"))) {
-        is_object_validation = true;
     }
 
-    if (is_object_validation && data.isMappedObject()) {
-        // For objects, we collect multiple errors ourselves instead of relying on validate_node
-
-        const Dictionary* properties = nullptr;
-        if (effective_schema->has("properties") &&
-            effective_schema->at("properties").isMappedObject()) {
-            properties = &effective_schema->at("properties");
-        }
-
-        // Collect required property names
-        std::set<std::string> required_names;
-        if (effective_schema->has("required")) {
-            const Dictionary& r = effective_schema->at("required");
-            try {
-                auto svec = r.asStrings();
-                for (auto const& s : svec) required_names.insert(s);
-            } catch (...) {
-                if (r.isArrayObject()) {
-                    for (int i = 0; i < r.size(); ++i) {
-                        const Dictionary& e = r[i];
-                        if (e.type() == Dictionary::String) required_names.insert(e.asString());
-                    }
-                }
-            }
-        }
-
-        // Also check per-property required flags
-        std::set<std::string> all_required = required_names;
-        if (properties) {
-            for (auto const& p : properties->items()) {
-                const std::string& key = p.first;
-                const Dictionary& propSchema = p.second;
-                if (propSchema.has("required") &&
-                    propSchema.at("required").type() == Dictionary::Boolean &&
-                    propSchema.at("required").asBool()) {
-                    all_required.insert(key);
-                }
-            }
-        }
-
-        // Check for missing required properties
-        for (auto const& rn : all_required) {
-            if (!data.has(rn)) {
-                std::string full_key = path.empty() ? rn : path + "." + rn;
-                std::string msg = "missing required key '" + full_key + "'";
-
-                int line = -1;
-                if (!raw_content.empty()) {
-                    if (!path.empty()) {
-                        line = find_line_number(raw_content, path);
-                    } else if (data.size() > 0) {
-                        for (auto const& item : data.items()) {
-                            line = find_line_number(raw_content, item.first);
-                            if (line > 0) break;
-                        }
-                    }
-                }
-
-                errors.emplace_back(display_path(full_key),
-                                    msg,
-                                    line,
-                                    depth,
-                                    ErrorSeverity::ERROR,
-                                    ErrorCategory::MISSING_REQUIRED);
-            }
-        }
-
-        // Validate each property that exists
-        if (properties) {
-            for (auto const& p : properties->items()) {
-                const std::string& key = p.first;
-                const Dictionary& propSchema = p.second;
-
-                if (data.has(key)) {
-                    std::string child_path = path.empty() ? key : path + "." + key;
-
-                    // Check if deprecated
-                    if (propSchema.has("deprecated") &&
-                        propSchema.at("deprecated").type() == Dictionary::Boolean &&
-                        propSchema.at("deprecated").asBool()) {
-                        std::string msg = "Property '" + child_path + "' is deprecated";
-                        if (propSchema.has("description") &&
-                            propSchema.at("description").type() == Dictionary::String) {
-                            msg += ": " + propSchema.at("description").asString();
-                        }
-
-                        int line = find_line_number(raw_content, child_path);
-                        errors.emplace_back(display_path(child_path),
-                                            msg,
-                                            line,
-                                            depth + 1,
-                                            ErrorSeverity::DEPRECATION,
-                                            ErrorCategory::DEPRECATED_PROPERTY);
-                    }
-
-                    // Recursively validate the property value
-                    const Dictionary* subSchema = schema_from_value(schema_root, propSchema);
-                    if (subSchema) {
-                        validate_node_collect(data.at(key),
-                                              schema_root,
-                                              *subSchema,
-                                              child_path,
-                                              depth + 1,
-                                              raw_content,
-                                              errors);
-                    }
-                }
-            }
-        }
-
-        // Also check for other object-level errors using validate_node
-        // This catches: additionalProperties, patternProperties, minProperties/maxProperties, etc.
-        auto object_error = validate_node(data, schema_root, *effective_schema, path, raw_content);
-        if (object_error.has_value()) {
-            // Only add if it's not a missing required or deprecated error (we already handled
-            // those)
-            std::string error_msg = *object_error;
-            if (error_msg.find("missing required") == std::string::npos &&
-                error_msg.find("deprecated") == std::string::npos) {
-                std::string line_path = path;
-                
-                // Check for path marker from 'not' constraint
-                if (error_msg.find("@@PATH:") == 0) {
-                    size_t end_marker = error_msg.find("@@", 7);
-                    if (end_marker != std::string::npos) {
-                        line_path = error_msg.substr(7, end_marker - 7);
-                        error_msg = error_msg.substr(end_marker + 2);
-                    }
-                }
-                
-                int line = find_line_number(raw_content, line_path);
-                ErrorCategory cat = ErrorCategory::OTHER;
-                if (error_msg.find("not valid") != std::string::npos ||
-                    error_msg.find("not allowed") != std::string::npos) {
-                    cat = ErrorCategory::ADDITIONAL_PROPERTY;
-                } else if (error_msg.find("fewer properties") != std::string::npos ||
-                           error_msg.find("more properties") != std::string::npos) {
-                    cat = ErrorCategory::OTHER;
-                }
-
-                errors.emplace_back(display_path(path),
-                                    error_msg,
-                                    line,
-                                    depth,
-                                    ErrorSeverity::ERROR,
-                                    cat);
-            }
-        }
-    } else if (effective_schema->has("type") &&
-               effective_schema->at("type").type() == Dictionary::String) {
-        std::string t = effective_schema->at("type").asString();
-        if (t == "array" && data.isArrayObject()) {
-            // For arrays, validate each item
-            // Handle prefixItems (Draft 2020-12) first
-            if (effective_schema->has("prefixItems") && effective_schema->at("prefixItems").isArrayObject()) {
-                const Dictionary& prefixItems = effective_schema->at("prefixItems");
-                size_t nPrefix = prefixItems.size();
-                
-                for (size_t i = 0; i < nPrefix && i < static_cast<size_t>(data.size()); ++i) {
-                    const Dictionary* item_schema = schema_from_value(schema_root, prefixItems[static_cast<int>(i)]);
-                    if (item_schema) {
-                        std::string child_path = path + "[" + std::to_string(i) + "]";
-                        validate_node_collect(data[static_cast<int>(i)],
-                                              schema_root,
-                                              *item_schema,
-                                              child_path,
-                                              depth + 1,
-                                              raw_content,
-                                              errors);
-                    }
-                }
-                
-                // After prefixItems, validate remaining items with 'items' schema if present
-                if (effective_schema->has("items")) {
-                    const Dictionary* items_schema = schema_from_value(schema_root, effective_schema->at("items"));
-                    if (items_schema) {
-                        for (size_t i = nPrefix; i < static_cast<size_t>(data.size()); ++i) {
-                            std::string child_path = path + "[" + std::to_string(i) + "]";
-                            validate_node_collect(data[static_cast<int>(i)],
-                                                  schema_root,
-                                                  *items_schema,
-                                                  child_path,
-                                                  depth + 1,
-                                                  raw_content,
-                                                  errors);
-                        }
-                    }
-                }
-            } else if (effective_schema->has("items")) {
-                const Dictionary& items_schema = effective_schema->at("items");
-                const Dictionary* item_schema = schema_from_value(schema_root, items_schema);
-
-                if (item_schema) {
-                    for (int i = 0; i < data.size(); ++i) {
-                        std::string child_path = path + "[" + std::to_string(i) + "]";
-                        validate_node_collect(data[i],
-                                              schema_root,
-                                              *item_schema,
-                                              child_path,
-                                              depth + 1,
-                                              raw_content,
-                                              errors);
-                    }
-                }
-            }
-
-            // Also check array-level constraints using validate_node
-            auto array_error =
-                        validate_node(data, schema_root, *effective_schema, path, raw_content);
-            if (array_error.has_value()) {
-                // Capture any array-level errors (constraints, tuple validation, etc.)
-                std::string error_msg = *array_error;
-                std::string line_path = path;
-                
-                // Check for path marker from 'not' constraint
-                if (error_msg.find("@@PATH:") == 0) {
-                    size_t end_marker = error_msg.find("@@", 7);
-                    if (end_marker != std::string::npos) {
-                        line_path = error_msg.substr(7, end_marker - 7);
-                        error_msg = error_msg.substr(end_marker + 2);
-                    }
-                }
-                
-                int line = find_line_number(raw_content, line_path);
-                errors.emplace_back(display_path(path),
-                                    error_msg,
-                                    line,
-                                    depth,
-                                    ErrorSeverity::ERROR,
-                                    ErrorCategory::ARRAY_SIZE);
-            }
-        } else {
-            // For primitives or non-matching types, use validate_node
-            auto basic_error =
-                        validate_node(data, schema_root, *effective_schema, path, raw_content);
-            if (basic_error.has_value()) {
-                std::string error_msg = *basic_error;
-                std::string line_path = path;
-                
-                // Check for path marker from 'not' constraint
-                if (error_msg.find("@@PATH:") == 0) {
-                    size_t end_marker = error_msg.find("@@", 7);
-                    if (end_marker != std::string::npos) {
-                        line_path = error_msg.substr(7, end_marker - 7);
-                        error_msg = error_msg.substr(end_marker + 2);
-                    }
-                }
-                
-                int line = find_line_number(raw_content, line_path);
-                ErrorCategory cat = ErrorCategory::OTHER;
-                ErrorSeverity sev = ErrorSeverity::ERROR;
-
-                // Categorize the error
-                if (error_msg.find("deprecated") != std::string::npos) {
-                    cat = ErrorCategory::DEPRECATED_VALUE;
-                    sev = ErrorSeverity::DEPRECATION;
-                } else if (error_msg.find("expected type") != std::string::npos) {
-                    cat = ErrorCategory::TYPE_MISMATCH;
-                } else if (error_msg.find("enum") != std::string::npos ||
-                           error_msg.find("did not match") != std::string::npos) {
-                    cat = ErrorCategory::INVALID_ENUM;
-                } else if (error_msg.find("minimum") != std::string::npos ||
-                           error_msg.find("maximum") != std::string::npos ||
-                           error_msg.find("above") != std::string::npos ||
-                           error_msg.find("below") != std::string::npos) {
-                    cat = ErrorCategory::OUT_OF_RANGE;
-                } else if (error_msg.find("oneOf") != std::string::npos) {
-                    cat = ErrorCategory::ONE_OF_MISMATCH;
-                } else if (error_msg.find("anyOf") != std::string::npos) {
-                    cat = ErrorCategory::ANY_OF_MISMATCH;
-                } else if (error_msg.find("allOf") != std::string::npos) {
-                    cat = ErrorCategory::ALL_OF_FAILURE;
-                }
-
-                errors.emplace_back(display_path(path), error_msg, line, depth, sev, cat);
-            }
-        }
-    } else {
-        // For other complex schemas (anyOf, oneOf, allOf, etc.), use validate_node
-        auto basic_error = validate_node(data, schema_root, *effective_schema, path, raw_content);
-        if (basic_error.has_value()) {
-            std::string error_msg = *basic_error;
-            std::string line_path = path;
-            
-            // Check for path marker from 'not' constraint
-            if (error_msg.find("@@PATH:") == 0) {
-                size_t end_marker = error_msg.find("@@", 7);
-                if (end_marker != std::string::npos) {
-                    line_path = error_msg.substr(7, end_marker - 7);
-                    error_msg = error_msg.substr(end_marker + 2);
-                }
-            }
-            
-            int line = find_line_number(raw_content, line_path);
-            ErrorCategory cat = ErrorCategory::OTHER;
-            ErrorSeverity sev = ErrorSeverity::ERROR;
-
-            // Check if it's a deprecation
-            if (error_msg.find("deprecated") != std::string::npos) {
-                cat = ErrorCategory::DEPRECATED_VALUE;
-                sev = ErrorSeverity::DEPRECATION;
-            }
-
-            errors.emplace_back(display_path(path), error_msg, line, depth, sev, cat);
-        }
-    }
+    // fallback: apply numeric constraints if present
+    ProfileScope scope(ctx.profiler, "minimum/maximum");
+    if (auto e = check_numeric_constraints(data, schema_node, ctx.path))
+        fail(*e, ErrorCategory::OUT_OF_RANGE);
 }
 
 std::optional<std::string> validate(const Dictionary& data, const Dictionary& schema) {
@@ -2201,44 +2672,243 @@ void set_original_data(const Dictionary* data) { g_original_data = data; }
 ValidationResult validate_all(const Dictionary& data,
                               const Dictionary& schema,
                               const std::string& raw_content) {
+    return validate_all(data, schema, raw_content, ValidationOptions{});
+}
+
+// Schema to validate from when `schema` is given in the convenience form of
+// a bare property map, or nullptr when it is a schema itself
+static std::unique_ptr<const Dictionary> wrap_property_map(const Dictionary& schema) {
+    static const char* const schema_keys[] = {"type",
+                                              "properties",
+                                              "items",
+                                              "additionalProperties",
+                                              "unevaluatedProperties",
+                                              "patternProperties",
+                                              "required",
+                                              "enum",
+                                              "allOf",
+                                              "anyOf",
+                                              "oneOf",
+                                              "minItems",
+                                              "maxItems",
+                                              "minProperties",
+                                              "maxProperties",
+                                              "uniqueItems"};
+    if (!schema.isMappedObject()) return nullptr;
+    for (const char* key : schema_keys) {
+        if (schema.has(key)) return nullptr;
+    }
+    auto wrapper = std::make_unique<Dictionary>();
+    (*wrapper)["type"] = std::string("object");
+    (*wrapper)["properties"] = schema;
+    return wrapper;
+}
+
+// Validate `data` from the root of `schema`, which may also be given in the
+// convenience form of a bare property map.
+static void validate_root(const Dictionary& data,
+                          const Dictionary& schema,
+                          ValidationContext& ctx,
+                          std::optional<ValidationProfile>& profile_out) {
+    std::unique_ptr<const Dictionary> wrapper;
+    const Dictionary* root = &schema;
+    if (ctx.compiled)
+        root = &ctx.compiled->root();
+    else if ((wrapper = wrap_property_map(schema)))
+        root = wrapper.get();
+
+    Profiler profiler;
+    if (ctx.options.profile) ctx.profiler = &profiler;
+    auto start = Profiler::Clock::now();
+
+    validate_node(data, *root, 0, ctx);
+
+    if (ctx.profiler) {
+        ctx.profiler = nullptr;
+        profile_out = profiler.finish(std::chrono::duration<double, std::milli>(
+                                                  Profiler::Clock::now() - start)
+                                                  .count());
+    }
+}
+
+// Cut `result` down to the error budget in `options`
+static void apply_error_budget(ValidationResult& result, const ValidationOptions& options) {
+    size_t limit = options.stop_on_first_error ? 1
+                                               : static_cast<size_t>(std::max(0, options.max_errors));
+    if (limit != 0 && result.errors.size() > limit) {
+        result.errors.erase(result.errors.begin() + static_cast<long>(limit), result.errors.end());
+        result.truncated = true;
+    }
+}
+
+ValidationResult validate_all(const Dictionary& data,
+                              const Dictionary& schema,
+                              const std::string& raw_content,
+                              const ValidationOptions& options) {
+    ValidationResult result;
+    ValidationContext ctx(schema, raw_content, options, result.errors);
+    validate_root(data, schema, ctx, result.profile);
+
+    // A single subtree may report several issues at once; trim to the budget.
+    result.truncated = ctx.truncated;
+    apply_error_budget(result, options);
+    return result;
+}
+
+// Keywords whose values map arbitrary names to subschemas
+static const char* const kSchemaMaps[] = {
+            "properties", "patternProperties", "definitions", "$defs", "dependentSchemas"};
+
+// Build the tables of every schema node at or below `node`
+static void compile_tables(const Dictionary& node, CompiledSchema::Tables& tables) {
+    if (node.isArrayObject()) {
+        for (auto const& [index, item] : node.elements()) compile_tables(item, tables);
+        return;
+    }
+    if (node.has("properties") && node.at("properties").isMappedObject() &&
+        node.has("additionalProperties") &&
+        node.at("additionalProperties").type() == Dictionary::Boolean &&
+        !node.at("additionalProperties").asBool()) {
+        const Dictionary& properties = node.at("properties");
+        tables.suggestion_index.emplace(&properties, properties);
+    }
+    for (auto const& [key, value] : node.members()) {
+        if (key == "enum") {
+            if (value.isArrayObject() && value.size() > kEnumIndexThreshold)
+                tables.enum_index.emplace(&value, build_enum_index(value));
+        } else if ((key == "anyOf" || key == "oneOf") && value.isArrayObject()) {
+            tables.discriminator_index.emplace(
+                        &value, build_discriminator_index(value, tables.ref_root()));
+            compile_tables(value, tables);
+        } else if (key == "const" || key == "default" || key == "examples") {
+            // literal values, not subschemas
+        } else if (std::find(std::begin(kSchemaMaps), std::end(kSchemaMaps), key) !=
+                   std::end(kSchemaMaps)) {
+            for (auto const& [name, sub] : value.members()) compile_tables(sub, tables);
+        } else {
+            compile_tables(value, tables);
+        }
+    }
+}
+
+CompiledSchema::CompiledSchema(const Dictionary& schema)
+    : CompiledSchema(std::make_shared<const Dictionary>(schema)) {}
+
+CompiledSchema::CompiledSchema(std::shared_ptr<const Dictionary> schema) {
+    auto tables = std::make_shared<Tables>();
+    tables->schema = std::move(schema);
+    tables->wrapper = wrap_property_map(*tables->schema);
+    compile_tables(tables->root(), *tables);
+    tables_ = std::move(tables);
+}
+
+const Dictionary& CompiledSchema::schema() const { return *tables_->schema; }
+
+size_t CompiledSchema::size() const {
+    return tables_->enum_index.size() + tables_->discriminator_index.size() +
+           tables_->suggestion_index.size();
+}
+
+ValidationResult validate_all(const Dictionary& data,
+                              const CompiledSchema& schema,
+                              const std::string& raw_content,
+                              const ValidationOptions& options) {
     ValidationResult result;
+    ValidationContext ctx(schema.tables().ref_root(), raw_content, options, result.errors);
+    ctx.compiled = &schema.tables();
+    validate_root(data, schema.schema(), ctx, result.profile);
+
+    result.truncated = ctx.truncated;
+    apply_error_budget(result, options);
+    return result;
+}
+
+ValidationResult validate_with_defaults(Dictionary& data,
+                                        const Dictionary& schema,
+                                        const std::string& raw_content,
+                                        const ValidationOptions& options) {
+    return validate_with_defaults(data, DefaultsSkeleton(schema), schema, raw_content, options);
+}
+
+// While alive, error messages look values up through `edits` instead of a
+// copy of the document as parsed; restored however validation ends
+struct DefaultEditsScope {
+    const Dictionary* saved_original = g_original_data;
+    explicit DefaultEditsScope(const std::vector<DefaultEdit>& edits) {
+        g_original_data = nullptr;
+        g_default_edits = &edits;
+    }
+    ~DefaultEditsScope() {
+        g_original_data = saved_original;
+        g_default_edits = nullptr;
+        g_rebuilt_originals.clear();
+    }
+};
+
+ValidationResult validate_with_defaults(Dictionary& data,
+                                        const DefaultsSkeleton& defaults,
+                                        const Dictionary& schema,
+                                        const std::string& raw_content,
+                                        const ValidationOptions& options) {
+    std::vector<DefaultEdit> edits;
+    defaults.apply(data, &edits);
+    DefaultEditsScope scope(edits);
+    return validate_all(data, schema, raw_content, options);
+}
 
-    // Support convenience form (same logic as validate)
-    const std::set<std::string> schema_keys = {"type",
-                                               "properties",
-                                               "items",
-                                               "additionalProperties",
-                                               "unevaluatedProperties",
-                                               "patternProperties",
-                                               "required",
-                                               "enum",
-                                               "allOf",
-                                               "anyOf",
-                                               "oneOf",
-                                               "minItems",
-                                               "maxItems",
-                                               "minProperties",
-                                               "maxProperties",
-                                               "uniqueItems"};
-    bool contains_schema_keyword = false;
-    if (schema.isMappedObject()) {
-        for (auto const& p : schema.items()) {
-            if (schema_keys.find(p.first) != schema_keys.end()) {
-                contains_schema_keyword = true;
+ValidationResult validate_with_defaults(Dictionary& data,
+                                        const DefaultsSkeleton& defaults,
+                                        const CompiledSchema& schema,
+                                        const std::string& raw_content,
+                                        const ValidationOptions& options) {
+    std::vector<DefaultEdit> edits;
+    defaults.apply(data, &edits);
+    DefaultEditsScope scope(edits);
+    return validate_all(data, schema, raw_content, options);
+}
+
+ValidationResult revalidate(const ValidationResult& previous,
+                            const Dictionary& data,
+                            const Dictionary& schema,
+                            const std::vector<std::string>& changed_paths,
+                            const std::string& raw_content,
+                            const ValidationOptions& options) {
+    // A truncated result does not say what the rest of the document looked like
+    if (previous.truncated) return validate_all(data, schema, raw_content, options);
+
+    std::vector<std::vector<PathStep>> focus;
+    focus.reserve(changed_paths.size());
+    for (auto const& p : changed_paths) focus.push_back(parse_data_path(p));
+
+    // Keep issues from nodes that are neither edited, inside an edit, nor an
+    // ancestor of one: those are the nodes the focused pass below skips.
+    ValidationResult result;
+    for (auto const& err : previous.errors) {
+        std::vector<PathStep> where = parse_data_path(err.node_path);
+        bool affected = false;
+        for (auto const& steps : focus) {
+            if (is_path_prefix(where, steps) || is_path_prefix(steps, where)) {
+                affected = true;
                 break;
             }
         }
+        if (!affected) result.errors.push_back(err);
     }
 
-    if (schema.isMappedObject() && !contains_schema_keyword && !schema.has("properties")) {
-        Dictionary wrapper;
-        wrapper["type"] = std::string("object");
-        wrapper["properties"] = schema;
-        validate_node_collect(data, schema, wrapper, "", 0, raw_content, result.errors);
-    } else {
-        validate_node_collect(data, schema, schema, "", 0, raw_content, result.errors);
+    if (!focus.empty()) {
+        ValidationOptions unlimited = options;
+        unlimited.max_errors = 0;
+        unlimited.stop_on_first_error = false;
+        std::vector<ValidationError> fresh;
+        ValidationContext ctx(schema, raw_content, unlimited, fresh);
+        ctx.focus = &focus;
+        validate_root(data, schema, ctx, result.profile);
+        result.errors.insert(result.errors.end(),
+                             std::make_move_iterator(fresh.begin()),
+                             std::make_move_iterator(fresh.end()));
     }
 
+    apply_error_budget(result, options);
     return result;
 }
 
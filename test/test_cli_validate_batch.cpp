@@ -0,0 +1,121 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Run a command and capture stdout+stderr together with its exit code
+static std::pair<int, std::string> run_capture(const std::string& cmd) {
+    std::array<char, 256> buffer;
+    std::string result;
+    FILE* pipe = popen((cmd + " 2>&1").c_str(), "r");
+    if (!pipe) throw std::runtime_error("popen() failed!");
+    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) result += buffer.data();
+    int status = pclose(pipe);
+    if (WIFEXITED(status)) status = WEXITSTATUS(status);
+    return {status, result};
+}
+
+static fs::path make_temp_dir(const std::string& prefix) {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+#if defined(__unix__) || defined(__APPLE__)
+    const auto pid = static_cast<long long>(::getpid());
+#else
+    const auto pid = 0LL;
+#endif
+    fs::path tmp = fs::temp_directory_path() /
+                   (prefix + std::to_string(pid) + "-" + std::to_string(static_cast<long long>(now)));
+    fs::create_directories(tmp);
+    return tmp;
+}
+
+static void write_file(const fs::path& p, const std::string& text) {
+    std::ofstream out(p);
+    REQUIRE(out.good());
+    out << text;
+}
+
+TEST_CASE("CLI --validate accepts many files and reports them in order",
+          "[cli][validate][batch][integration]") {
+#ifndef PARSEC_EXE_PATH
+    FAIL("PARSEC_EXE_PATH not defined");
+#else
+    const std::string exe = PARSEC_EXE_PATH;
+    const fs::path tmp = make_temp_dir("parsec-batch-");
+
+    write_file(tmp / "schema.json", R"({
+  "type": "object",
+  "properties": {
+    "name": { "type": "string" },
+    "port": { "type": "integer" }
+  },
+  "required": ["name", "port"]
+})");
+    for (int i = 0; i < 6; ++i) {
+        write_file(tmp / ("good" + std::to_string(i) + ".json"),
+                   "{\"name\": \"run" + std::to_string(i) + "\", \"port\": " +
+                               std::to_string(8000 + i) + "}");
+    }
+    write_file(tmp / "bad.json", R"({"name": "broken", "port": "eighty"})");
+
+    std::ostringstream cmd;
+    cmd << '"' << exe << '"' << " --validate --jobs 3 " << '"' << (tmp / "schema.json").string()
+        << '"';
+    for (int i = 0; i < 6; ++i) cmd << ' ' << '"' << (tmp / ("good" + std::to_string(i) + ".json")).string() << '"';
+
+    SECTION("all files pass") {
+        auto [rc, out] = run_capture(cmd.str());
+        REQUIRE(rc == 0);
+        // Results are streamed in input order regardless of which worker finished first
+        size_t last = 0;
+        for (int i = 0; i < 6; ++i) {
+            size_t pos = out.find("OK: " + (tmp / ("good" + std::to_string(i) + ".json")).string());
+            REQUIRE(pos != std::string::npos);
+            REQUIRE(pos >= last);
+            last = pos;
+        }
+        REQUIRE(out.find("Validated 6 files") != std::string::npos);
+        REQUIRE(out.find("6 passed, 0 failed") != std::string::npos);
+    }
+
+    SECTION("one failing file makes the batch fail") {
+        auto [rc, out] = run_capture(cmd.str() + " \"" + (tmp / "bad.json").string() + "\"");
+        REQUIRE(rc == 1);
+        REQUIRE(out.find("FAILED: " + (tmp / "bad.json").string()) != std::string::npos);
+        REQUIRE(out.find("6 passed, 1 failed") != std::string::npos);
+    }
+
+    SECTION("@filelist expands to the listed files") {
+        write_file(tmp / "list.txt",
+                   "# runs to check\n" + (tmp / "good0.json").string() + "\n\n" +
+                               (tmp / "good1.json").string() + "\n");
+        std::ostringstream list_cmd;
+        list_cmd << '"' << exe << '"' << " --validate " << '"' << (tmp / "schema.json").string()
+                 << '"' << " @" << '"' << (tmp / "list.txt").string() << '"';
+        auto [rc, out] = run_capture(list_cmd.str());
+        REQUIRE(rc == 0);
+        REQUIRE(out.find("Validated 2 files") != std::string::npos);
+    }
+
+    SECTION("--profile reports keyword timings for the whole batch") {
+        auto [rc, out] = run_capture(cmd.str() + " --profile");
+        REQUIRE(rc == 0);
+        REQUIRE(out.find("Validation profile:") != std::string::npos);
+        REQUIRE(out.find("properties") != std::string::npos);
+        REQUIRE(out.find("required") != std::string::npos);
+    }
+
+    fs::remove_all(tmp);
+#endif
+}
@@ -0,0 +1,202 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/codegen.h>
+#include <ps/parsec.h>
+#include <ps/validate.h>
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Generated at build time by parsec_add_validator() in test/CMakeLists.txt
+#include "codegen_keywords.h"
+#include "codegen_medium.h"
+
+using namespace ps;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static void collect(Dictionary& d, std::vector<Dictionary*>& out) {
+    out.push_back(&d);
+    if (d.isMappedObject()) {
+        for (const auto& key : d.keys()) collect(d[key], out);
+    } else if (d.isArrayObject()) {
+        for (int i = 0; i < d.size(); ++i) collect(d.at(i), out);
+    }
+}
+
+// Small random edits: drop or rename a member, add an unknown one, duplicate
+// an array item or overwrite a value with one of `values`
+static Dictionary mutate(const Dictionary& base, std::mt19937& rng,
+                         const std::vector<Dictionary>& values) {
+    Dictionary d = base;
+    int edits = 1 + static_cast<int>(rng() % 3);
+    for (int e = 0; e < edits; ++e) {
+        std::vector<Dictionary*> nodes;
+        collect(d, nodes);
+        Dictionary* node = nodes[rng() % nodes.size()];
+        unsigned op = rng() % 8;
+        if (node->isMappedObject() && node->size() > 0) {
+            auto keys = node->keys();
+            std::string key = keys[rng() % keys.size()];
+            if (op == 0) {
+                node->erase(key);
+                continue;
+            }
+            if (op == 1) {
+                Dictionary value = (*node)[key];
+                node->erase(key);
+                (*node)[key + "x"] = value;
+                continue;
+            }
+            if (op == 2) {
+                (*node)["max_unknown"] = int64_t(3);
+                continue;
+            }
+            node = &(*node)[key];
+        }
+        if (op == 3 && node->isArrayObject() && node->size() > 0) {
+            Dictionary item = node->at(0);
+            (*node)[node->size()] = item;
+            continue;
+        }
+        *node = values[rng() % values.size()];
+    }
+    return d;
+}
+
+static std::vector<Dictionary> replacement_values() {
+    return {Dictionary(std::string("zzz")), Dictionary(std::string("auto")),
+            Dictionary(std::string("residual")), Dictionary(std::string("legacy")),
+            Dictionary(std::string("implicit")), Dictionary(std::string("yes")),
+            Dictionary(int64_t(-7)), Dictionary(int64_t(0)), Dictionary(int64_t(3)),
+            Dictionary(0.5), Dictionary(100.5), Dictionary(1.0e9), Dictionary(true),
+            Dictionary()};
+}
+
+TEST_CASE("generated validator accepts a valid document", "[codegen]") {
+    Dictionary data = parse_json(read_file(EXAMPLES_DIR "/codegen/keywords_valid.json"));
+    REQUIRE(generated::codegen_keywords_passes(data));
+    ValidationResult result = generated::codegen_keywords(data);
+    REQUIRE(result.errors.empty());
+    REQUIRE(validate_all(data, generated::codegen_keywords_schema()).errors.empty());
+}
+
+TEST_CASE("generated validator reports what validate_all reports", "[codegen]") {
+    const Dictionary valid = parse_json(read_file(EXAMPLES_DIR "/codegen/keywords_valid.json"));
+    const Dictionary& schema = generated::codegen_keywords_schema();
+
+    auto edited = [&](const std::string& key, const Dictionary& value) {
+        Dictionary d = valid;
+        d[key] = value;
+        return d;
+    };
+    std::vector<Dictionary> documents = {
+            edited("name", Dictionary(std::string("Wing"))),
+            edited("version", Dictionary(int64_t(3))),
+            edited("tags", parse_json(R"(["a", "a"])")),
+            edited("legacy output", Dictionary(std::string("out.dat"))),
+            edited("solver", parse_json(R"({"type": "euler"})")),
+            edited("solver", parse_json(R"({"type": "explicit", "cfl": 1})")),
+            edited("outputs", parse_json(R"(["legacy"])")),
+            edited("outputs", parse_json(R"([{"every": 2}])")),
+            edited("origin", parse_json(R"([1, 2, 3])")),
+            edited("range", parse_json(R"([1, 0])")),
+            edited("range", parse_json(R"([1, 2, 3])")),
+            edited("limits", parse_json(R"({"cfl": 100.5})")),
+            edited("limits", parse_json(R"({"max_iter": 1.5})")),
+            edited("limits", parse_json(R"({})")),
+            edited("level", parse_json(R"({"k": "w"})")),
+            edited("restart", Dictionary(std::string("no"))),
+            edited("tree", parse_json(R"({"children": [{"label": "a", "id": 1}]})")),
+            edited("extra", parse_json(R"({"a": "4"})")),
+            edited("threads", Dictionary(int64_t(0))),
+            edited("precision", Dictionary(0.25)),
+            edited("unknown", Dictionary(true)),
+    };
+    for (const auto& data : documents) {
+        ValidationResult expected = validate_all(data, schema);
+        REQUIRE_FALSE(expected.errors.empty());
+        REQUIRE_FALSE(generated::codegen_keywords_passes(data));
+        REQUIRE(generated::codegen_keywords(data).format() == expected.format());
+    }
+}
+
+TEST_CASE("generated validators agree with validate_all on edited documents", "[codegen]") {
+    struct Case {
+        Dictionary base;
+        const Dictionary& schema;
+        bool (*passes)(const Dictionary&);
+    };
+    std::vector<Case> cases = {
+            {parse_json(read_file(EXAMPLES_DIR "/codegen/keywords_valid.json")),
+             generated::codegen_keywords_schema(), generated::codegen_keywords_passes},
+            {parse(read_file(EXAMPLES_DIR "/medium_schema_check.ron")),
+             generated::codegen_medium_schema(), generated::codegen_medium_passes},
+    };
+    const std::vector<Dictionary> values = replacement_values();
+    std::mt19937 rng(20260);
+    for (const auto& c : cases) {
+        REQUIRE(c.passes(c.base));
+        for (int i = 0; i < 500; ++i) {
+            Dictionary data = mutate(c.base, rng, values);
+            bool expected = validate_all(data, c.schema).errors.empty();
+            INFO(data.dump());
+            REQUIRE(c.passes(data) == expected);
+        }
+    }
+}
+
+TEST_CASE("generated validator keeps raw content and options", "[codegen]") {
+    const std::string raw = read_file(EXAMPLES_DIR "/medium_schema_fail.ron");
+    Dictionary data = parse(raw);
+    ValidationOptions options;
+    options.max_errors = 1;
+    ValidationResult expected =
+            validate_all(data, generated::codegen_medium_schema(), raw, options);
+    ValidationResult result = generated::codegen_medium(data, raw, options);
+    REQUIRE(result.errors.size() == 1);
+    REQUIRE(result.format() == expected.format());
+
+    options.profile = true;
+    Dictionary valid = parse(read_file(EXAMPLES_DIR "/medium_schema_check.ron"));
+    REQUIRE(generated::codegen_medium(valid, "", options).profile.has_value());
+}
+
+TEST_CASE("generate_validator emits the requested entry points", "[codegen]") {
+    Dictionary schema = parse_json(R"({
+        "type": "object",
+        "properties": {
+            "mode": {"enum": ["fast", "safe"]},
+            "label": {"type": "string", "pattern": "([a-z"}
+        }
+    })");
+    CodegenOptions options;
+    options.name = "check_mode";
+    options.ns = "app::schemas";
+    options.header_include = "mode.h";
+    GeneratedValidator generated = generate_validator(schema, options);
+
+    REQUIRE(generated.header.find("namespace app::schemas {") != std::string::npos);
+    REQUIRE(generated.header.find("bool check_mode_passes(") != std::string::npos);
+    REQUIRE(generated.header.find("const ps::Dictionary& check_mode_schema()") !=
+            std::string::npos);
+    REQUIRE(generated.source.find("#include \"mode.h\"") != std::string::npos);
+    // The invalid pattern is left to validate_all() instead of failing to compile
+    REQUIRE(generated.source.find("static const std::regex") == std::string::npos);
+}
+
+TEST_CASE("generate_validator rejects schemas it cannot embed", "[codegen]") {
+    Dictionary schema;
+    schema["type"] = "number";
+    schema["maximum"] = std::numeric_limits<double>::quiet_NaN();
+    REQUIRE_THROWS_AS(generate_validator(schema, CodegenOptions{}), std::runtime_error);
+}
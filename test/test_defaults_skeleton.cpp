@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/defaults.h>
+#include <ps/parsec.h>
+#include <ps/validate.h>
+
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ps;
+
+static Dictionary shapes_schema() {
+    return parse_json(R"({
+        "type": "object",
+        "properties": {
+            "name": {"type": "string", "default": "scene"},
+            "camera": {
+                "type": "object",
+                "properties": {
+                    "fov": {"type": "number", "default": 60},
+                    "clip": {"type": "object", "properties": {"near": {"default": 0.1}}}
+                }
+            },
+            "shapes": {
+                "type": "array",
+                "items": {
+                    "anyOf": [
+                        {"$ref": "#/definitions/circle"},
+                        {"$ref": "#/definitions/square"}
+                    ]
+                }
+            }
+        },
+        "definitions": {
+            "circle": {
+                "type": "object",
+                "properties": {
+                    "type": {"enum": ["circle", "disk"]},
+                    "radius": {"type": "number", "default": 1.0}
+                }
+            },
+            "square": {
+                "type": "object",
+                "properties": {
+                    "type": {"enum": ["square"]},
+                    "size": {"type": "number", "default": 2.0}
+                }
+            }
+        }
+    })");
+}
+
+TEST_CASE("defaults skeleton fills like setDefaults", "[defaults][skeleton]") {
+    const Dictionary schema = shapes_schema();
+    const DefaultsSkeleton skeleton(schema);
+    REQUIRE(skeleton.size() > 0);
+
+    // Each document and what setDefaults() made of it before the skeleton
+    // replaced its walk
+    const std::vector<std::pair<std::string, std::string>> cases = {
+            {R"({})",
+             R"({"name": "scene", "camera": {"fov": 60, "clip": {"near": 0.1}}})"},
+            {R"({"name": "mine", "shapes": [{"type": "square"}, {"type": "disk"}, {}]})",
+             R"({"name": "mine", "camera": {"fov": 60, "clip": {"near": 0.1}},
+                 "shapes": [{"type": "square", "size": 2.0}, {"type": "disk", "radius": 1.0},
+                            {"radius": 1.0}]})"},
+            {R"({"camera": {"fov": 90}, "shapes": [{"type": "hexagon"}]})",
+             R"({"name": "scene", "camera": {"fov": 90, "clip": {"near": 0.1}},
+                 "shapes": [{"type": "hexagon", "radius": 1.0}]})"},
+            {R"({"camera": null, "shapes": "none"})",
+             R"({"name": "scene", "camera": {"fov": 60, "clip": {"near": 0.1}}, "shapes": "none"})"},
+            {R"({"camera": {"clip": {}}, "shapes": [null, 3]})",
+             R"({"name": "scene", "camera": {"fov": 60, "clip": {"near": 0.1}},
+                 "shapes": [{"radius": 1.0}, {"radius": 1.0}]})"},
+    };
+    for (const auto& [text, expected] : cases) {
+        const Dictionary data = parse_json(text);
+        INFO(text);
+        REQUIRE(skeleton.applied(data) == parse_json(expected));
+        REQUIRE(setDefaults(data, schema) == parse_json(expected));
+    }
+
+    Dictionary data = parse_json(R"({"shapes": [{"type": "square"}, {"type": "disk"}]})");
+    skeleton.apply(data);
+    REQUIRE(data.at("name").asString() == "scene");
+    REQUIRE(data.at("camera").at("fov").asInt() == 60);
+    REQUIRE(data.at("camera").at("clip").at("near").asDouble() == 0.1);
+    REQUIRE(data.at("shapes")[0].at("size").asDouble() == 2.0);
+    REQUIRE(data.at("shapes")[1].at("radius").asDouble() == 1.0);
+}
+
+TEST_CASE("defaults skeleton is reusable and independent of the schema", "[defaults][skeleton]") {
+    std::optional<Dictionary> schema = shapes_schema();
+    const DefaultsSkeleton compiled(*schema);
+    const Dictionary expected = setDefaults(parse_json(R"({"shapes": [{}]})"), *schema);
+    schema.reset();
+
+    const DefaultsSkeleton copy = compiled;
+    for (int i = 0; i < 100; ++i) {
+        Dictionary data = parse_json(R"({"shapes": [{}]})");
+        (i % 2 ? copy : compiled).apply(data);
+        REQUIRE(data == expected);
+    }
+}
+
+TEST_CASE("defaults skeleton records its edits", "[defaults][skeleton]") {
+    const Dictionary schema = shapes_schema();
+    Dictionary data = parse_json(R"({"camera": {}, "shapes": [{"type": "square"}]})");
+    std::vector<DefaultEdit> from_skeleton;
+    DefaultsSkeleton(schema).apply(data, &from_skeleton);
+
+    std::vector<std::string> paths;
+    for (const auto& edit : from_skeleton) paths.push_back(edit.path);
+    REQUIRE(paths == std::vector<std::string>{"camera.clip", "camera.fov", "name",
+                                              "shapes[0].size"});
+}
+
+TEST_CASE("defaults skeleton rejects endlessly nested object defaults", "[defaults][skeleton]") {
+    Dictionary schema = parse_json(R"({
+        "type": "object",
+        "properties": {"node": {"$ref": "#/definitions/node"}},
+        "definitions": {
+            "node": {"type": "object", "properties": {"next": {"$ref": "#/definitions/node"}}}
+        }
+    })");
+    REQUIRE_THROWS_AS(DefaultsSkeleton(schema), std::runtime_error);
+}
+
+TEST_CASE("validate_with_defaults accepts a compiled skeleton", "[defaults][skeleton]") {
+    const Dictionary schema = parse_json(R"({
+        "type": "object",
+        "required": ["mode"],
+        "properties": {
+            "mode": {"type": "string", "enum": ["fast", "safe"], "default": "fast"},
+            "threads": {"type": "integer", "minimum": 1, "default": 4}
+        }
+    })");
+    const DefaultsSkeleton skeleton(schema);
+
+    Dictionary good = parse_json(R"({})");
+    REQUIRE(validate_with_defaults(good, skeleton, schema).is_valid());
+    REQUIRE(good.at("threads").asInt() == 4);
+
+    Dictionary bad = parse_json(R"({"threads": 0})");
+    Dictionary same = bad;
+    ValidationResult result = validate_with_defaults(bad, skeleton, schema);
+    REQUIRE(result.format() == validate_with_defaults(same, schema).format());
+    REQUIRE(result.error_count() == 1);
+}
@@ -1,6 +1,7 @@
 #include <catch2/catch_all.hpp>
 #include <ps/dictionary.h>
 #include <ps/json.h>
+#include <unordered_set>
 
 using namespace ps;
 using Catch::Approx;
@@ -390,4 +391,129 @@ TEST_CASE("Nested objects don't alias", "[alias]") {
     dict2["value"] = 4;
     REQUIRE(dict1["nested"]["value"].asInt() == 3);
     REQUIRE(dict2["value"].asInt() == 4);
-}
\ No newline at end of file
+}
+TEST_CASE("Structural equality and hash agree", "[hash]") {
+    Dictionary a = parse_json(R"({"b": [1, 2, {"c": "x"}], "a": 1.5, "n": null})");
+    Dictionary b = parse_json(R"({"a": 1.5, "n": null, "b": [1, 2, {"c": "x"}]})");
+    REQUIRE(a.structurallyEquals(b));
+    REQUIRE(a.hash() == b.hash());
+
+    Dictionary c = parse_json(R"({"a": 1.5, "n": null, "b": [1, 2, {"c": "y"}]})");
+    REQUIRE_FALSE(a.structurallyEquals(c));
+
+    // Same elements stored as different array kinds are still equal
+    Dictionary ints = std::vector<int>{1, 2, 3};
+    std::vector<Dictionary> objs;
+    for (int i = 1; i <= 3; ++i) objs.emplace_back(int64_t(i));
+    Dictionary mixed;
+    mixed = objs;
+    REQUIRE(ints.structurallyEquals(mixed));
+    REQUIRE(ints.hash() == mixed.hash());
+
+    // Numbers keep their type, as with operator==
+    REQUIRE_FALSE(Dictionary(int64_t(1)).structurallyEquals(Dictionary(1.0)));
+    REQUIRE(Dictionary(0.0).hash() == Dictionary(-0.0).hash());
+
+    std::unordered_set<Dictionary, DictionaryHash, DictionaryEqual> set;
+    set.insert(a);
+    REQUIRE(set.count(b) == 1);
+    REQUIRE(set.count(c) == 0);
+}
+
+TEST_CASE("Moving a dictionary leaves the source usable", "[alias]") {
+    Dictionary a;
+    a["name"] = "pq";
+    a["list"] = std::vector<int>{1, 2};
+    Dictionary b = std::move(a);
+    REQUIRE(b["name"].asString() == "pq");
+    REQUIRE(b["list"].size() == 2);
+
+    // The moved-from dictionary is null and gets its own scalar
+    REQUIRE(a.isNull());
+    REQUIRE(a.size() == 0);
+    a = "again";
+    REQUIRE(a.asString() == "again");
+    REQUIRE(b["name"].asString() == "pq");
+
+    // Moving a child over its parent
+    Dictionary tree;
+    tree["outer"]["inner"] = 5;
+    tree = std::move(tree["outer"]);
+    REQUIRE(tree["inner"].asInt() == 5);
+}
+
+TEST_CASE("Move assignment leaves the source null and reusable", "[alias]") {
+    Dictionary source;
+    source["list"] = std::vector<std::string>{"a", "b"};
+    Dictionary target = 3;
+    target = std::move(source);
+    REQUIRE(target["list"].size() == 2);
+    REQUIRE(source.isNull());
+    REQUIRE(source.dump() == Dictionary::null().dump());
+
+    source["again"] = true;
+    REQUIRE(source["again"].asBool());
+    REQUIRE(target.has("list"));
+    REQUIRE_FALSE(target.has("again"));
+
+    // Moving a scalar keeps its value in the target only
+    Dictionary text = std::string("moved");
+    Dictionary other = std::move(text);
+    REQUIRE(other.asString() == "moved");
+    REQUIRE(text.isNull());
+    text = 7;
+    REQUIRE(text.asInt() == 7);
+    REQUIRE(other.asString() == "moved");
+}
+
+TEST_CASE("Self-assignment keeps the dictionary intact", "[alias]") {
+    Dictionary d;
+    d["name"] = "pq";
+    d["nested"]["values"] = std::vector<double>{1.5, 2.5};
+    const std::string before = d.dump();
+
+    Dictionary& same = d;
+    d = same;
+    REQUIRE(d.dump() == before);
+    d = std::move(same);
+    REQUIRE(d.dump() == before);
+
+    Dictionary scalar = 42;
+    Dictionary& alias = scalar;
+    scalar = alias;
+    REQUIRE(scalar.asInt() == 42);
+    scalar = std::move(alias);
+    REQUIRE(scalar.asInt() == 42);
+}
+
+TEST_CASE("Copy assignment copies every level once and shares nothing", "[alias]") {
+    Dictionary tree;
+    Dictionary* node = &tree;
+    for (int depth = 0; depth < 200; ++depth) {
+        (*node)["value"] = depth;
+        node = &(*node)["child"];
+    }
+    (*node)["leaf"] = "end";
+
+    Dictionary copy;
+    copy = tree;
+    REQUIRE(copy.dump() == tree.dump());
+
+    // Scalars are copied, not shared, at every depth
+    copy["value"] = 100;
+    copy["child"]["child"]["value"] = -1;
+    REQUIRE(tree["value"].asInt() == 0);
+    REQUIRE(tree["child"]["child"]["value"].asInt() == 2);
+
+    // Copying a child over its parent
+    tree = tree["child"];
+    REQUIRE(tree["value"].asInt() == 1);
+    REQUIRE(tree["child"]["value"].asInt() == 2);
+
+    // Over a dictionary of another type
+    Dictionary target = std::string("text");
+    target = copy["child"];
+    REQUIRE(target["value"].asInt() == 1);
+    target = copy["value"];
+    REQUIRE(target.asInt() == 100);
+}
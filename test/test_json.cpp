@@ -135,4 +135,17 @@ TEST_CASE("Parse JSON with @-prefixed keys") {
     REQUIRE(d.has("regular_key"));
     REQUIRE(d.at("@SCHEMA_ROOT_KEY@").at("type").asString() == "object");
     REQUIRE(d.at("regular_key").asString() == "value");
-}
\ No newline at end of file
+}
+TEST_CASE("Parsed arrays own their elements") {
+    auto d = parse_json(R"({"objects": [{"a": 1}, {"b": [2, 3]}], "mixed": [1, "two", {"c": null}]})");
+    REQUIRE(d["objects"].type() == Dictionary::ObjectArray);
+    REQUIRE(d["objects"][0]["a"].asInt() == 1);
+    REQUIRE(d["objects"][1]["b"].size() == 2);
+    REQUIRE(d["mixed"].size() == 3);
+    REQUIRE(d["mixed"][1].asString() == "two");
+    REQUIRE(d["mixed"][2]["c"].isNull());
+
+    Dictionary copy = d;
+    copy["objects"][0]["a"] = 5;
+    REQUIRE(d["objects"][0]["a"].asInt() == 1);
+}
@@ -100,7 +100,20 @@ index:0"
 assert_output "Large index" "arr/999" "key:arr
 index:999"
 
-assert_error "Negative index" "arr/-1"
+assert_output "Negative index" "arr/-1" "key:arr
+index:-1"
+
+assert_output "Slice" "items/[100:200]" "key:items
+slice:100:200"
+
+assert_output "Open slice" "items/[-3:]" "key:items
+slice:-3:"
+
+assert_output "Predicate" "zones/[type=wall]/name" "key:zones
+predicate:type=wall
+key:name"
+
+assert_error "Unclosed bracket" "zones/[type=wall"
 
 assert_output "Numeric-looking string" "obj/123abc" "key:obj
 key:123abc"
@@ -0,0 +1,266 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <tuple>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Run a command and capture stdout+stderr together with its exit code
+static std::pair<int, std::string> run_capture(const std::string& cmd) {
+    std::array<char, 256> buffer;
+    std::string result;
+    FILE* pipe = popen((cmd + " 2>&1").c_str(), "r");
+    if (!pipe) throw std::runtime_error("popen() failed!");
+    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) result += buffer.data();
+    int status = pclose(pipe);
+    if (WIFEXITED(status)) status = WEXITSTATUS(status);
+    return {status, result};
+}
+
+static fs::path make_temp_dir(const std::string& prefix) {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+#if defined(__unix__) || defined(__APPLE__)
+    const auto pid = static_cast<long long>(::getpid());
+#else
+    const auto pid = 0LL;
+#endif
+    fs::path tmp = fs::temp_directory_path() /
+                   (prefix + std::to_string(pid) + "-" + std::to_string(static_cast<long long>(now)));
+    fs::create_directories(tmp);
+    return tmp;
+}
+
+static void write_file(const fs::path& p, const std::string& text) {
+    std::ofstream out(p);
+    REQUIRE(out.good());
+    out << text;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST_CASE("pq daemon keeps answering while a client stalls", "[pq][cli][serve][integration]") {
+#ifndef PQ_EXE_PATH
+    FAIL("PQ_EXE_PATH not defined");
+#else
+    const std::string exe = PQ_EXE_PATH;
+    const fs::path tmp = make_temp_dir("pq-serve-");
+    const std::string socketPath = (tmp / "pq.sock").string();
+    write_file(tmp / "cfg.json", R"({"server": {"port": 8080}})");
+
+    pid_t daemon = ::fork();
+    REQUIRE(daemon >= 0);
+    if (daemon == 0) {
+        int devnull = ::open("/dev/null", O_WRONLY);
+        ::dup2(devnull, STDERR_FILENO);
+        ::execl(exe.c_str(), "pq", "--serve", socketPath.c_str(), static_cast<char*>(nullptr));
+        ::_exit(127);
+    }
+    for (int i = 0; i < 100 && !fs::exists(socketPath); ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(fs::exists(socketPath));
+
+    // Connects and never sends anything
+    int stalled = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(stalled >= 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socketPath.c_str());
+    REQUIRE(::connect(stalled, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+
+    auto [code, out] = run_capture("timeout 5 \"" + exe + "\" --client \"" + socketPath + "\" \"" +
+                                   (tmp / "cfg.json").string() + "\" --get server/port");
+    CHECK(code == 0);
+    CHECK(out == "8080\n");
+
+    // The daemon keeps one document per file, so records aren't sent to it
+    const std::string records = (tmp / "r.ndjson").string();
+    write_file(records, "{\"a\": 1}\n{\"a\": 2}\n");
+    std::tie(code, out) = run_capture("timeout 5 \"" + exe + "\" --client \"" + socketPath + "\" \"" + records +
+                                      "\" -g a");
+    CHECK(code == 1);
+    CHECK(out.find("--client can't query the records of") != std::string::npos);
+
+    // nor answered when a client sends them anyway
+    int raw = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(raw >= 0);
+    REQUIRE(::connect(raw, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+    const std::string request = records + std::string(1, '\0') + "-g" + std::string(1, '\0') + "a" +
+                                std::string(1, '\0');
+    REQUIRE(::write(raw, request.data(), request.size()) == static_cast<ssize_t>(request.size()));
+    ::shutdown(raw, SHUT_WR);
+    std::string response;
+    std::array<char, 256> buffer;
+    for (ssize_t n; (n = ::read(raw, buffer.data(), buffer.size())) > 0;) response.append(buffer.data(), n);
+    ::close(raw);
+    CHECK(response.rfind("1 0\n", 0) == 0);
+    CHECK(response.find("Record inputs are not served") != std::string::npos);
+
+    ::close(stalled);
+    ::kill(daemon, SIGTERM);
+    int status = 0;
+    ::waitpid(daemon, &status, 0);
+    CHECK(WIFEXITED(status));
+    fs::remove_all(tmp);
+#endif
+}
+
+TEST_CASE("pq reports malformed JSON unless asked to stream", "[pq][cli][stream][integration]") {
+#ifndef PQ_EXE_PATH
+    FAIL("PQ_EXE_PATH not defined");
+#else
+    const std::string exe = PQ_EXE_PATH;
+    const fs::path tmp = make_temp_dir("pq-stream-");
+    const std::string broken = (tmp / "broken.json").string();
+    const std::string duplicate = (tmp / "duplicate.json").string();
+    write_file(broken, R"({"a": 1, "b": [1, 2})");
+    write_file(duplicate, R"({"s": {"a": 1, "b": 2, "a": 3}})");
+
+    // By default the whole file is parsed, so errors anywhere are reported
+    auto [code, out] = run_capture("\"" + exe + "\" \"" + broken + "\" --get a");
+    CHECK(code == 1);
+    CHECK(out.find("Error:") != std::string::npos);
+    std::tie(code, out) = run_capture("\"" + exe + "\" \"" + duplicate + "\" --has s/b");
+    CHECK(code == 1);
+    CHECK(out.find("duplicate key 'a'") != std::string::npos);
+
+    // --stream stops once the answer is read; what follows is not checked
+    std::tie(code, out) = run_capture("\"" + exe + "\" \"" + broken + "\" --get a --stream");
+    CHECK(code == 0);
+    CHECK(out == "1\n");
+
+    std::tie(code, out) = run_capture("\"" + exe + "\" \"" + duplicate + "\" --get s/b --stream");
+    CHECK(code == 0);
+    CHECK(out == "2\n");
+
+    // but what it reads on the way is rejected as the parser would
+    std::tie(code, out) = run_capture("\"" + exe + "\" \"" + duplicate + "\" --count s --stream");
+    CHECK(code == 1);
+    CHECK(out.find("duplicate key 'a'") != std::string::npos);
+    fs::remove_all(tmp);
+#endif
+}
+
+TEST_CASE("pq counts and tests paths with several matches", "[pq][cli][integration]") {
+#ifndef PQ_EXE_PATH
+    FAIL("PQ_EXE_PATH not defined");
+#else
+    const std::string exe = PQ_EXE_PATH;
+    const fs::path tmp = make_temp_dir("pq-many-");
+    const std::string cfg = (tmp / "cfg.json").string();
+    write_file(cfg, R"({"items": [1, 2, 3, 4, 5, 6],
+                        "zones": [{"type": "floor"}, {"id": 2}, {"type": "wall"}, {"type": "wall"}]})");
+    const std::string pq = "\"" + exe + "\" \"" + cfg + "\" ";
+
+    // --count gives the number of matches, as many as --get prints
+    auto [code, out] = run_capture(pq + "--count 'items/[2:5]'");
+    CHECK(code == 0);
+    CHECK(out == "3\n");
+    std::tie(code, out) = run_capture(pq + "--count 'zones/[type=wall]'");
+    CHECK(code == 0);
+    CHECK(out == "2\n");
+    std::tie(code, out) = run_capture(pq + "--count 'zones/[type=roof]'");
+    CHECK(code == 0);
+    CHECK(out == "0\n");
+    std::tie(code, out) = run_capture(pq + "--count '**/type'");
+    CHECK(code == 0);
+    CHECK(out == "3\n");
+    std::tie(code, out) = run_capture(pq + "--count items");
+    CHECK(code == 0);
+    CHECK(out == "6\n");
+
+    // --has succeeds when anything matches, even if some elements lack the key
+    std::tie(code, out) = run_capture(pq + "--has 'zones/[type=wall]'");
+    CHECK(code == 0);
+    CHECK(out.empty());
+    std::tie(code, out) = run_capture(pq + "--has 'zones/*/type'");
+    CHECK(code == 0);
+    std::tie(code, out) = run_capture(pq + "--has 'zones/[type=roof]'");
+    CHECK(code == 1);
+    CHECK(out.empty());
+    std::tie(code, out) = run_capture(pq + "--has 'items/[10:]'");
+    CHECK(code == 1);
+
+    // Several queries print the same answers on one line each
+    std::tie(code, out) = run_capture(pq + "--count 'items/[2:5]' --has 'zones/*/id' --has 'zones/*/size'");
+    CHECK(code == 0);
+    CHECK(out == "3\ntrue\nfalse\n");
+
+    // and --stream leaves them to the full parse
+    std::tie(code, out) = run_capture(pq + "--count 'items/[2:5]' --stream");
+    CHECK(code == 0);
+    CHECK(out == "3\n");
+    std::tie(code, out) = run_capture(pq + "--has 'zones/*/id' --stream");
+    CHECK(code == 0);
+    fs::remove_all(tmp);
+#endif
+}
+
+TEST_CASE("pq answers each record of a record input among several files", "[pq][cli][records][integration]") {
+#ifndef PQ_EXE_PATH
+    FAIL("PQ_EXE_PATH not defined");
+#else
+    const std::string exe = PQ_EXE_PATH;
+    const fs::path tmp = make_temp_dir("pq-batch-records-");
+    const std::string records = (tmp / "r.ndjson").string();
+    const std::string single = (tmp / "s.json").string();
+    write_file(records, "{\"a\": 1}\n{\"a\": 2}\n{\"b\": 3}\n");
+    write_file(single, R"({"a": 4})");
+
+    auto [code, out] = run_capture("\"" + exe + "\" -g a -d 0 \"" + records + "\" \"" + single + "\"");
+    CHECK(code == 0);
+    CHECK(out == records + ": 1\n" + records + ": 2\n" + records + ": 0\n" + single + ": 4\n");
+
+    std::tie(code, out) = run_capture("\"" + exe + "\" -g a --as-json -j 1 \"" + records + "\" \"" + single + "\"");
+    CHECK(code == 1);
+    CHECK(out.find(R"({"file":")" + records + R"(","value":1})") != std::string::npos);
+    CHECK(out.find(R"({"file":")" + records + R"(","value":2})") != std::string::npos);
+    CHECK(out.find(R"({"error":"line 3: a: Key 'a' not found","file":")" + records + "\"}") !=
+          std::string::npos);
+    CHECK(out.find(R"({"file":")" + single + R"(","value":4})") != std::string::npos);
+
+    // stdin among files is read as records too
+    std::tie(code, out) = run_capture("printf '{\"a\": 5}\\n{\"a\": 6}\\n' | \"" + exe + "\" -g a - \"" + single + "\"");
+    CHECK(code == 0);
+    CHECK(out == "-: 5\n-: 6\n" + single + ": 4\n");
+    fs::remove_all(tmp);
+#endif
+}
+
+TEST_CASE("pq addresses the whole document as .", "[pq][cli][records][integration]") {
+#ifndef PQ_EXE_PATH
+    FAIL("PQ_EXE_PATH not defined");
+#else
+    const std::string exe = PQ_EXE_PATH;
+    const fs::path tmp = make_temp_dir("pq-root-");
+    fs::create_directories(tmp / "runs");
+    write_file(tmp / "runs" / "a.json", R"({"status": "ok"})");
+    write_file(tmp / "runs" / "b.json", R"({"status": "failed"})");
+    write_file(tmp / "runs" / "c.json", R"({"status": "ok"})");
+
+    // The example from --help
+    auto [code, out] = run_capture("cd \"" + tmp.string() + "\" && \"" + exe + "\" --slurp --count . runs/*.json");
+    CHECK(code == 0);
+    CHECK(out == "3\n");
+
+    const std::string single = (tmp / "runs" / "b.json").string();
+    std::tie(code, out) = run_capture("\"" + exe + "\" \"" + single + "\" --get . --count . --has .");
+    CHECK(code == 0);
+    CHECK(out == "{\"status\":\"failed\"}\n1\ntrue\n");
+    fs::remove_all(tmp);
+#endif
+}
+#endif
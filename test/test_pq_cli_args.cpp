@@ -220,3 +220,151 @@ TEST_CASE("Typo --counts suggests --count", "[pq][cli_args][unit][exception]") {
         REQUIRE(error_msg.find("Did you mean '--count'?") != std::string::npos);
     }
 }
+
+// Multiple queries per invocation
+
+TEST_CASE("Parse several queries in order", "[pq][cli_args][unit]") {
+    const char* argv[] = {"pq", "cfg.json", "-g", "a/b", "-d", "1", "--count", "c", "--has", "e"};
+    int argc = 10;
+    
+    ps::pq::CliArgs args(argc, argv);
+    
+    const auto& queries = args.getQueries();
+    REQUIRE(queries.size() == 3);
+    REQUIRE(queries[0].action == ps::pq::CliArgs::Action::GET);
+    REQUIRE(queries[0].path == "a/b");
+    REQUIRE(queries[0].defaultValue == "1");
+    REQUIRE(queries[1].action == ps::pq::CliArgs::Action::COUNT);
+    REQUIRE_FALSE(queries[1].defaultValue.has_value());
+    REQUIRE(queries[2].action == ps::pq::CliArgs::Action::HAS);
+    REQUIRE(queries[2].path == "e");
+    
+    // Single-query accessors refer to the first query
+    REQUIRE(args.getAction() == ps::pq::CliArgs::Action::GET);
+    REQUIRE(args.getPath() == "a/b");
+    REQUIRE_FALSE(args.outputAsShell());
+}
+
+TEST_CASE("Default before its query applies to it", "[pq][cli_args][unit]") {
+    const char* argv[] = {"pq", "cfg.json", "-d", "30", "-g", "timeout", "-g", "port", "--as-shell"};
+    int argc = 9;
+    
+    ps::pq::CliArgs args(argc, argv);
+    
+    REQUIRE(args.getQueries().size() == 2);
+    REQUIRE(args.getQueries()[0].defaultValue == "30");
+    REQUIRE_FALSE(args.getQueries()[1].defaultValue.has_value());
+    REQUIRE(args.outputAsShell());
+}
+
+// Query daemon
+
+TEST_CASE("Parse serve and client modes", "[pq][cli_args][unit]") {
+    const char* serveArgv[] = {"pq", "--serve", "/tmp/pq.sock"};
+    ps::pq::CliArgs serve(3, serveArgv);
+    REQUIRE(serve.getAction() == ps::pq::CliArgs::Action::SERVE);
+    REQUIRE(serve.getSocketPath() == "/tmp/pq.sock");
+    
+    const char* clientArgv[] = {"pq", "--client", "/tmp/pq.sock", "cfg.json", "-g", "a/b"};
+    ps::pq::CliArgs client(6, clientArgv);
+    REQUIRE(client.getAction() == ps::pq::CliArgs::Action::GET);
+    REQUIRE(client.getSocketPath() == "/tmp/pq.sock");
+    REQUIRE(client.getFilePath() == "cfg.json");
+    REQUIRE(client.getPath() == "a/b");
+    
+    const char* localArgv[] = {"pq", "cfg.json", "-g", "a/b"};
+    REQUIRE(ps::pq::CliArgs(4, localArgv).getSocketPath().empty());
+    
+    const char* missingArgv[] = {"pq", "--serve"};
+    REQUIRE_THROWS_AS(ps::pq::CliArgs(2, missingArgv), std::invalid_argument);
+    
+    // The daemon client only takes the file first
+    const char* filesLastArgv[] = {"pq", "--client", "/tmp/pq.sock", "-g", "a", "s.json"};
+    try {
+        ps::pq::CliArgs(6, filesLastArgv);
+        FAIL("expected invalid_argument");
+    } catch (const std::invalid_argument& e) {
+        REQUIRE(std::string(e.what()) == "--client expects the file before the query");
+    }
+}
+
+TEST_CASE("Parse several input files after the queries", "[pq][cli_args][unit]") {
+    const char* argv[] = {"pq", "--get", "run/status", "a.json", "-j", "4", "b.yaml", "--as-json"};
+    ps::pq::CliArgs args(8, argv);
+    
+    REQUIRE(args.getAction() == ps::pq::CliArgs::Action::GET);
+    REQUIRE(args.getPath() == "run/status");
+    REQUIRE(args.getFilePaths() == std::vector<std::string>{"a.json", "b.yaml"});
+    REQUIRE(args.getFilePath() == "a.json");
+    REQUIRE(args.jobs() == 4);
+    REQUIRE(args.outputAsJson());
+    
+    // The usual form has one file
+    const char* singleArgv[] = {"pq", "cfg.json", "-g", "a"};
+    ps::pq::CliArgs single(4, singleArgv);
+    REQUIRE(single.getFilePaths() == std::vector<std::string>{"cfg.json"});
+    REQUIRE(single.jobs() == 0);
+    
+    const char* helpArgv[] = {"pq", "--help"};
+    REQUIRE(ps::pq::CliArgs(2, helpArgv).getAction() == ps::pq::CliArgs::Action::HELP);
+}
+
+TEST_CASE("Parse stdin and slurp", "[pq][cli_args][unit]") {
+    // No file after the queries reads stdin
+    const char* pipeArgv[] = {"pq", "--get", "level"};
+    ps::pq::CliArgs pipe(3, pipeArgv);
+    REQUIRE(pipe.getAction() == ps::pq::CliArgs::Action::GET);
+    REQUIRE(pipe.getFilePath() == "-");
+    REQUIRE_FALSE(pipe.slurp());
+    
+    const char* dashArgv[] = {"pq", "-", "-g", "a"};
+    REQUIRE(ps::pq::CliArgs(4, dashArgv).getFilePath() == "-");
+    
+    const char* slurpArgv[] = {"pq", "-s", "-g", "0/a", "a.json", "-", "b.ndjson"};
+    ps::pq::CliArgs slurp(7, slurpArgv);
+    REQUIRE(slurp.slurp());
+    REQUIRE(slurp.getFilePaths() == std::vector<std::string>{"a.json", "-", "b.ndjson"});
+}
+
+TEST_CASE("Several input files errors", "[pq][cli_args][unit][exception]") {
+    const char* twiceArgv[] = {"pq", "--get", "a", "-", "-"};
+    REQUIRE_THROWS_AS(ps::pq::CliArgs(5, twiceArgv), std::invalid_argument);
+    
+    const char* clientArgv[] = {"pq", "--client", "/tmp/pq.sock", "-", "-g", "a"};
+    REQUIRE_THROWS_AS(ps::pq::CliArgs(6, clientArgv), std::invalid_argument);
+    
+    const char* shellArgv[] = {"pq", "-g", "a", "--as-shell", "a.json", "b.json"};
+    REQUIRE_THROWS_AS(ps::pq::CliArgs(6, shellArgv), std::invalid_argument);
+    
+    const char* jobsArgv[] = {"pq", "-g", "a", "-j", "many", "a.json"};
+    REQUIRE_THROWS_AS(ps::pq::CliArgs(6, jobsArgv), std::invalid_argument);
+}
+
+// Filters
+
+TEST_CASE("Parse a filter with arguments", "[pq][cli_args][unit]") {
+    const char* argv[] = {"pq", "cfg.json", ".users[] | .name", "-r", "--arg", "n", "Bob",
+                          "--argjson", "min", "30"};
+    ps::pq::CliArgs args(10, argv);
+    
+    REQUIRE(args.getAction() == ps::pq::CliArgs::Action::FILTER);
+    REQUIRE(args.getFilePath() == "cfg.json");
+    REQUIRE(args.getFilter() == ".users[] | .name");
+    REQUIRE(args.rawOutput());
+    REQUIRE(args.getFilterArguments().size() == 2);
+    REQUIRE(args.getFilterArguments()[0].name == "n");
+    REQUIRE(args.getFilterArguments()[0].value == "Bob");
+    REQUIRE_FALSE(args.getFilterArguments()[0].isJson);
+    REQUIRE(args.getFilterArguments()[1].isJson);
+}
+
+TEST_CASE("Filter argument errors", "[pq][cli_args][unit][exception]") {
+    const char* mixedArgv[] = {"pq", "cfg.json", ".a", "--get", "a"};
+    REQUIRE_THROWS_AS(ps::pq::CliArgs(5, mixedArgv), std::invalid_argument);
+    
+    const char* twoArgv[] = {"pq", "cfg.json", ".a", ".b"};
+    REQUIRE_THROWS_AS(ps::pq::CliArgs(4, twoArgv), std::invalid_argument);
+    
+    const char* argArgv[] = {"pq", "cfg.json", ".a", "--arg", "n"};
+    REQUIRE_THROWS_AS(ps::pq::CliArgs(5, argArgv), std::invalid_argument);
+}
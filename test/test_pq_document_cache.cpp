@@ -0,0 +1,58 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/pq/document_cache.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+static fs::path make_temp_file(const std::string& name, const std::string& text) {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    fs::path path = fs::temp_directory_path() /
+                    ("pq-cache-" + std::to_string(static_cast<long long>(now)) + "-" + name);
+    std::ofstream out(path);
+    out << text;
+    return path;
+}
+
+TEST_CASE("Document cache keeps documents resident", "[pq][document_cache][unit]") {
+    fs::path path = make_temp_file("config.json", R"({"server": {"port": 80}})");
+    
+    ps::pq::DocumentCache cache;
+    const ps::Dictionary& first = cache.get(path.string());
+    REQUIRE(first.at("server").at("port").asInt() == 80);
+    
+    // Unchanged file is not parsed again
+    REQUIRE(&cache.get(path.string()) == &first);
+    REQUIRE(cache.size() == 1);
+    
+    fs::remove(path);
+    REQUIRE_THROWS_AS(cache.get(path.string()), std::runtime_error);
+    REQUIRE(cache.size() == 0);
+}
+
+TEST_CASE("Document cache re-reads changed files", "[pq][document_cache][unit]") {
+    fs::path path = make_temp_file("config.json", R"({"port": 80})");
+    
+    ps::pq::DocumentCache cache;
+    REQUIRE(cache.get(path.string()).at("port").asInt() == 80);
+    
+    {
+        std::ofstream out(path);
+        out << R"({"port": 8080})";
+    }
+    // Force a different timestamp even on coarse-grained file systems
+    fs::last_write_time(path, fs::last_write_time(path) + std::chrono::seconds(2));
+    REQUIRE(cache.get(path.string()).at("port").asInt() == 8080);
+    
+    // The key index belongs to the new contents
+    int found = 0;
+    cache.index(path.string()).visit(cache.get(path.string()), "port", [&found](const ps::Dictionary& port) {
+        found = static_cast<int>(port.asInt());
+    });
+    REQUIRE(found == 8080);
+    
+    fs::remove(path);
+}
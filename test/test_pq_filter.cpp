@@ -0,0 +1,125 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/pq/filter.h>
+#include <ps/json.h>
+
+#include <string>
+#include <vector>
+
+static ps::Dictionary make_users() {
+    return ps::parse_json(R"({
+        "users": [
+            {"name": "Ann", "age": 34, "tags": ["a", "b"], "team": "ops"},
+            {"name": "Bob", "age": 27, "tags": [], "team": "dev"},
+            {"name": "Cy", "age": 41, "tags": ["b"], "team": "ops"}
+        ],
+        "title": "Hello, World"
+    })");
+}
+
+// Each output as compact JSON, joined with spaces
+static std::string run(const std::string& text, const ps::Dictionary& input = make_users()) {
+    std::string out;
+    ps::pq::Filter(text).run(input, [&out](const ps::Dictionary& value) {
+        if (!out.empty()) out += " ";
+        out += ps::pq::Filter::toJson(value);
+    });
+    return out;
+}
+
+TEST_CASE("Filter paths, pipes and iteration", "[pq][filter][unit]") {
+    REQUIRE(run(".users[0].name") == "\"Ann\"");
+    REQUIRE(run(".users[-1][\"name\"]") == "\"Cy\"");
+    REQUIRE(run(".users[].age") == "34 27 41");
+    REQUIRE(run(".users[1:] | length") == "2");
+    REQUIRE(run(".title[0:5]") == "\"Hello\"");
+    REQUIRE(run(".missing.deeper") == "null");
+    REQUIRE(run(".users[0].name?, 1") == "\"Ann\" 1");
+    REQUIRE(run("[.. | numbers]") == "[34,27,41]");
+}
+
+TEST_CASE("Filter construction and operators", "[pq][filter][unit]") {
+    REQUIRE(run(".users[] | select(.age > 30) | {name, team}") ==
+            "{\"name\":\"Ann\",\"team\":\"ops\"} {\"name\":\"Cy\",\"team\":\"ops\"}");
+    REQUIRE(run("[.users[].age] | add / length") == "34");
+    REQUIRE(run("{a: (1, 2), b: (3, 4)} | [.a, .b]") == "[1,3] [1,4] [2,3] [2,4]");
+    REQUIRE(run("\"\\(1, 2)-\\(3, 4)\"") == "\"1-3\" \"2-3\" \"1-4\" \"2-4\"");
+    REQUIRE(run("10 % 3, 1 / 4, \"ab\" * 2") == "1 0.25 \"abab\"");
+    REQUIRE(run("{\"a\": {\"b\": 1}} * {\"a\": {\"c\": 2}}") == "{\"a\":{\"b\":1,\"c\":2}}");
+    REQUIRE(run(".missing // \"none\"") == "\"none\"");
+    REQUIRE(run("if .users | length > 2 then \"many\" elif true then \"few\" else 0 end") == "\"many\"");
+}
+
+TEST_CASE("Filter builtins", "[pq][filter][unit]") {
+    REQUIRE(run(".users | sort_by(.age) | map(.name) | join(\",\")") == "\"Bob,Ann,Cy\"");
+    REQUIRE(run(".users | group_by(.team) | map(length)") == "[1,2]");
+    REQUIRE(run(".users | max_by(.age) | .name") == "\"Cy\"");
+    REQUIRE(run("[.users[].team] | unique") == "[\"dev\",\"ops\"]");
+    REQUIRE(run("reduce .users[] as $u (0; . + $u.age)") == "102");
+    REQUIRE(run("[foreach .users[] as $u (0; . + 1)]") == "[1,2,3]");
+    REQUIRE(run("[limit(2; .users[])] | length") == "2");
+    REQUIRE(run("[range(0; 10; 4)]") == "[0,4,8]");
+    REQUIRE(run("[paths(type == \"number\")] | length") == "3");
+    REQUIRE(run(".users[0] | to_entries | map(.key)") == "[\"age\",\"name\",\"tags\",\"team\"]");
+    REQUIRE(run(".title | ascii_downcase | split(\", \")") == "[\"hello\",\"world\"]");
+}
+
+TEST_CASE("Filter regular expressions", "[pq][filter][unit]") {
+    REQUIRE(run(".title | test(\"world\"; \"i\")") == "true");
+    REQUIRE(run(".title | gsub(\"o\"; \"0\")") == "\"Hell0, W0rld\"");
+    REQUIRE(run(".title | sub(\"(?<w>W\\\\w+)\"; \"<\\(.w)>\")") == "\"Hello, <World>\"");
+    REQUIRE(run(".title | capture(\"(?<a>\\\\w+), (?<b>\\\\w+)\")") == "{\"a\":\"Hello\",\"b\":\"World\"}");
+    REQUIRE(run(".title | [match(\"o\"; \"g\") | .offset]") == "[4,8]");
+    REQUIRE(run("\"a1b22\" | [scan(\"[0-9]+\")], [splits(\"[0-9]+\")]") == "[\"1\",\"22\"] [\"a\",\"b\",\"\"]");
+}
+
+TEST_CASE("Filter updates and deletion", "[pq][filter][unit]") {
+    REQUIRE(run(".users[0].age += 1 | .users[0].age") == "35");
+    REQUIRE(run(".users[].age |= . * 2 | [.users[].age]") == "[68,54,82]");
+    REQUIRE(run("del(.users[] | select(.age < 30)) | [.users[].name]") == "[\"Ann\",\"Cy\"]");
+    REQUIRE(run("[1, 2, 3] | del(.[0, 2])") == "[2]");
+    REQUIRE(run("{} | .a[2] = 1") == "{\"a\":[null,null,1]}");
+    REQUIRE(run(".x //= 5 | .x") == "5");
+    REQUIRE(run("path(.users[0].name)") == "[\"users\",0,\"name\"]");
+
+    // The input itself is never modified
+    ps::Dictionary users = make_users();
+    run(".users[0].name = \"Zed\"", users);
+    REQUIRE(users["users"][0]["name"].asString() == "Ann");
+}
+
+TEST_CASE("Filter formats", "[pq][filter][unit]") {
+    REQUIRE(run("[.users[].name] | @csv") == "\"\\\"Ann\\\",\\\"Bob\\\",\\\"Cy\\\"\"");
+    REQUIRE(run("[1, \"a\\tb\", null] | @tsv") == "\"1\\ta\\\\tb\\t\"");
+    REQUIRE(run(".users[0].tags | @sh") == "\"'a' 'b'\"");
+    REQUIRE(run(".title | @base64 | ., @base64d") == "\"SGVsbG8sIFdvcmxk\" \"Hello, World\"");
+    REQUIRE(run("@uri \"q=\\(.title)\"") == "\"q=Hello%2C%20World\"");
+}
+
+TEST_CASE("Filter arguments", "[pq][filter][unit]") {
+    ps::pq::Filter filter(".users[] | select(.age >= $min) | .name",
+                          {{"min", ps::Dictionary(34)}});
+    auto outputs = filter.evaluate(make_users());
+    REQUIRE(outputs.size() == 2);
+    REQUIRE(outputs[0].asString() == "Ann");
+    REQUIRE(outputs[1].asString() == "Cy");
+}
+
+TEST_CASE("Filter errors", "[pq][filter][unit][exception]") {
+    REQUIRE_THROWS_AS(ps::pq::Filter(".users | "), std::invalid_argument);
+    REQUIRE_THROWS_AS(ps::pq::Filter("nosuchbuiltin"), std::invalid_argument);
+    REQUIRE_THROWS_AS(ps::pq::Filter("$undefined"), std::invalid_argument);
+    REQUIRE_THROWS_AS(ps::pq::Filter("def f: .; f"), std::invalid_argument);
+
+    try {
+        run(".title.x");
+        FAIL("expected a FilterError");
+    } catch (const ps::pq::FilterError& e) {
+        REQUIRE(std::string(e.what()) == "Cannot index string with \"x\"");
+    }
+
+    REQUIRE_THROWS_AS(run("error({code: 1})"), ps::pq::FilterError);
+    REQUIRE(run("try error({code: 1}) catch .code") == "1");
+    REQUIRE(run("[.users[] | try (.age | if . > 30 then error(\"old\") else . end) catch \"x\"]") ==
+            "[\"x\",27,\"x\"]");
+    REQUIRE(run("[.[] | .name?]") == "[]");
+}
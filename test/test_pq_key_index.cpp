@@ -0,0 +1,35 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/pq/key_index.h>
+#include <ps/json.h>
+
+#include <vector>
+
+static std::vector<int> find(ps::pq::KeyIndex& index, const ps::Dictionary& from, const std::string& key) {
+    std::vector<int> found;
+    index.visit(from, key, [&found](const ps::Dictionary& value) {
+        found.push_back(static_cast<int>(value.asInt()));
+    });
+    return found;
+}
+
+TEST_CASE("Key index finds members below a value", "[pq][key_index][unit]") {
+    ps::Dictionary d = ps::parse_json(R"({
+        "a": {"id": 1, "b": {"id": 2}},
+        "c": [{"id": 3}, {"d": {"id": 4}}, 5],
+        "id": 6
+    })");
+    
+    ps::pq::KeyIndex index(d);
+    REQUIRE_FALSE(index.built());
+    
+    // In pre-order of the objects holding them
+    REQUIRE(find(index, d, "id") == std::vector<int>{6, 1, 2, 3, 4});
+    REQUIRE(index.built());
+    REQUIRE(find(index, d.at("a"), "id") == std::vector<int>{1, 2});
+    REQUIRE(find(index, d.at("c"), "id") == std::vector<int>{3, 4});
+    REQUIRE(find(index, d.at("c").at(1), "id") == std::vector<int>{4});
+    REQUIRE(find(index, d, "missing").empty());
+    
+    // Scalars hold no members
+    REQUIRE(find(index, d.at("c").at(2), "id").empty());
+}
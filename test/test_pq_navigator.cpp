@@ -225,3 +225,177 @@ TEST_CASE("Navigate without wildcard uses navigate()", "[pq][navigator][unit]")
     REQUIRE(results.size() == 1);
     REQUIRE(results[0].asInt() == 8080);
 }
+
+// Navigation in place, without copying subtrees
+
+TEST_CASE("Resolve returns the value inside the document", "[pq][navigator][unit]") {
+    ps::Dictionary d;
+    d["mesh"]["zones"][0]["name"] = "wall";
+    d["mesh"]["zones"][1]["name"] = "farfield";
+    
+    ps::pq::Navigator nav;
+    ps::pq::PathParser parser;
+    
+    const ps::Dictionary& zone = nav.resolve(d, parser.parse("mesh/zones/1"));
+    REQUIRE(&zone == &d.at("mesh").at("zones").at(1));
+    REQUIRE(&nav.resolve(d, {}) == &d);
+    REQUIRE_THROWS_AS(nav.resolve(d, parser.parse("mesh/cells")), std::out_of_range);
+    REQUIRE_THROWS_AS(nav.resolve(d, parser.parse("mesh/*")), std::invalid_argument);
+}
+
+TEST_CASE("Resolve wildcard points at every match", "[pq][navigator][unit]") {
+    ps::Dictionary d;
+    d["regions"][0]["cells"][0] = 100;
+    d["regions"][0]["cells"][1] = 101;
+    d["regions"][1]["cells"][0] = 200;
+    
+    ps::pq::Navigator nav;
+    ps::pq::PathParser parser;
+    
+    auto matches = nav.resolveWildcard(d, parser.parse("regions/*/cells/*"));
+    REQUIRE(matches.size() == 3);
+    REQUIRE(matches[0] == &d.at("regions").at(0).at("cells").at(0));
+    REQUIRE(matches[2] == &d.at("regions").at(1).at("cells").at(0));
+    REQUIRE(matches[1]->asInt() == 101);
+    REQUIRE_THROWS_AS(nav.resolveWildcard(d, parser.parse("regions/*/faces")),
+                      std::out_of_range);
+}
+
+TEST_CASE("Visit wildcard matches in document order", "[pq][navigator][unit]") {
+    ps::Dictionary d;
+    d["users"][0]["email"] = "alice@example.com";
+    d["users"][1]["email"] = "bob@example.com";
+    d["users"][2]["name"] = "Charlie";
+    
+    ps::pq::Navigator nav;
+    ps::pq::PathParser parser;
+    
+    std::vector<std::string> seen;
+    REQUIRE_THROWS_AS(nav.visitWildcard(d, parser.parse("users/*/email"),
+                                        [&seen](const ps::Dictionary& match) {
+                                            seen.push_back(match.asString());
+                                        }),
+                      std::out_of_range);
+    
+    // Matches before the missing key were already visited
+    REQUIRE(seen.size() == 2);
+    REQUIRE(seen[0] == "alice@example.com");
+    REQUIRE(seen[1] == "bob@example.com");
+}
+
+TEST_CASE("Recursive descent finds keys at any depth", "[pq][navigator][unit]") {
+    ps::Dictionary d;
+    d["name"] = "top";
+    d["solver"]["name"] = "fun3d";
+    d["solver"]["zones"][0]["name"] = "inner";
+    d["solver"]["zones"][1]["type"] = "wall";
+    d["zones"][0]["name"] = "outer";
+    
+    ps::pq::Navigator nav;
+    ps::pq::PathParser parser;
+    auto names = [&](const std::string& path) {
+        std::string joined;
+        nav.visitWildcard(d, parser.parse(path), [&joined](const ps::Dictionary& match) {
+            joined += (joined.empty() ? "" : " ") + match.asString();
+        });
+        return joined;
+    };
+    
+    // Pre-order: a value's own key before those below it
+    REQUIRE(names("**/name") == "top fun3d inner outer");
+    REQUIRE(names("solver/**/name") == "fun3d inner");
+    REQUIRE(names("**/zones/*/name") == "outer inner");
+    REQUIRE(names("**/zones/1/type") == "wall");
+    REQUIRE(names("**/missing").empty());
+    
+    // ** alone matches the value itself and everything below it
+    REQUIRE(nav.resolveWildcard(d, parser.parse("zones/**")).size() == 3);
+    REQUIRE_THROWS_AS(nav.resolve(d, parser.parse("**/name")), std::invalid_argument);
+    REQUIRE_THROWS_AS(nav.resolveWildcard(d, parser.parse("nothing/**")), std::out_of_range);
+}
+
+TEST_CASE("Recursive descent looks keys up in an index", "[pq][navigator][unit]") {
+    ps::Dictionary d;
+    d["a"]["b"]["name"] = 1;
+    d["a"]["name"] = 2;
+    d["list"][0]["name"] = 3;
+    d["list"][1]["x"]["name"] = 4;
+    d["name"] = 5;
+    
+    ps::pq::PathParser parser;
+    ps::pq::Navigator walk;
+    ps::pq::KeyIndex index(d);
+    ps::pq::Navigator indexed;
+    indexed.useIndex(&index);
+    
+    for (const std::string path : {"**/name", "a/**/name", "list/**/name", "list/1/**/name", "**/x/name",
+                                   "**/b/**", "a/b/name/**/name"}) {
+        auto expected = walk.resolveWildcard(d, parser.parse(path));
+        REQUIRE(indexed.resolveWildcard(d, parser.parse(path)) == expected);
+    }
+    REQUIRE(index.built());
+    REQUIRE(indexed.resolveWildcard(d, parser.parse("**/name")).size() == 5);
+}
+
+TEST_CASE("Negative indices count from the end", "[pq][navigator][unit]") {
+    ps::Dictionary d;
+    d["items"] = std::vector<int>{10, 20, 30};
+    
+    ps::pq::Navigator nav;
+    ps::pq::PathParser parser;
+    REQUIRE(nav.resolve(d, parser.parse("items/-1")).asInt() == 30);
+    REQUIRE(nav.resolve(d, parser.parse("items/-3")).asInt() == 10);
+    
+    try {
+        nav.resolve(d, parser.parse("items/-4"));
+        FAIL("expected out_of_range");
+    } catch (const std::out_of_range& e) {
+        REQUIRE(std::string(e.what()) == "Index -4 out of range (size: 3)");
+    }
+}
+
+TEST_CASE("Slices and predicates select elements in place", "[pq][navigator][unit]") {
+    ps::Dictionary d;
+    d["items"] = std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    d["zones"][0]["type"] = "wall";
+    d["zones"][0]["name"] = "w1";
+    d["zones"][0]["n"] = 2;
+    d["zones"][1]["type"] = "farfield";
+    d["zones"][1]["name"] = "f1";
+    d["zones"][2]["type"] = "wall";
+    d["zones"][2]["name"] = "w2";
+    d["zones"][2]["n"] = 2.5;
+    d["zones"][2]["viscous"] = true;
+    d["server"]["port"] = 8080;
+    
+    ps::pq::Navigator nav;
+    ps::pq::PathParser parser;
+    auto joined = [&](const std::string& path) {
+        std::string out;
+        nav.visitWildcard(d, parser.parse(path), [&out](const ps::Dictionary& match) {
+            out += (out.empty() ? "" : " ") + (match.isString() ? match.asString() : match.dump(0, true));
+        });
+        return out;
+    };
+    
+    REQUIRE(joined("items/[2:5]") == "2 3 4");
+    REQUIRE(joined("items/[-2:]") == "8 9");
+    REQUIRE(joined("items/[:-8]") == "0 1");
+    REQUIRE(joined("items/[7:3]").empty());
+    REQUIRE(joined("zones/[1:]/name") == "f1 w2");
+    
+    REQUIRE(joined("zones/[type=wall]/name") == "w1 w2");
+    REQUIRE(joined("zones/[type!=wall]/name") == "f1");
+    REQUIRE(joined("zones/[n=2]/name") == "w1");
+    REQUIRE(joined("zones/[n=2.50]/name") == "w2");
+    REQUIRE(joined("zones/[viscous=true]/name") == "w2");
+    REQUIRE(joined("zones/[viscous!=true]/name") == "w1 f1");
+    REQUIRE(joined("zones/[type=inlet]/name").empty());
+    REQUIRE(joined("**/[type=wall]/name") == "w1 w2");
+    
+    // Below a predicate the rest of the path has to exist, as with *
+    REQUIRE_THROWS_AS(joined("zones/[type=wall]/viscous"), std::out_of_range);
+    REQUIRE_THROWS_AS(joined("server/[0:1]"), std::logic_error);
+    REQUIRE(joined("server/port/[0:1]").empty());
+}
+
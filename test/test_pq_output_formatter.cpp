@@ -1,6 +1,7 @@
 #include <catch2/catch_test_macros.hpp>
 #include <ps/pq/output_formatter.h>
 #include <ps/parsec.h>
+#include <sstream>
 
 // Phase 4.1 - Format Raw Values
 
@@ -122,3 +123,86 @@ TEST_CASE("Format array as JSON", "[pq][output_formatter][unit]") {
     REQUIRE(result.find("Alice") != std::string::npos);
     REQUIRE(result.find("Bob") != std::string::npos);
 }
+
+TEST_CASE("Format matches found in place", "[pq][output_formatter][unit]") {
+    ps::Dictionary a("Alice");
+    ps::Dictionary b(2);
+    std::vector<const ps::Dictionary*> values = {&a, &b};
+    
+    ps::pq::OutputFormatter formatter;
+    
+    REQUIRE(formatter.formatRaw(values) == "Alice\n2");
+    REQUIRE(formatter.formatJson(values) == "[\"Alice\",2]");
+    REQUIRE(formatter.formatJson(std::vector<const ps::Dictionary*>{}) == "[]");
+}
+
+TEST_CASE("Result writer streams values", "[pq][output_formatter][unit]") {
+    ps::Dictionary a("Alice");
+    ps::Dictionary b(2);
+    
+    std::ostringstream raw;
+    ps::pq::ResultWriter rawWriter(raw, false);
+    rawWriter.write(a);
+    rawWriter.write(b);
+    rawWriter.finish();
+    REQUIRE(raw.str() == "Alice\n2\n");
+    REQUIRE(rawWriter.count() == 2);
+    
+    std::ostringstream json;
+    ps::pq::ResultWriter jsonWriter(json, true);
+    jsonWriter.write(a);
+    jsonWriter.write(b);
+    jsonWriter.finish();
+    REQUIRE(json.str() == "[\"Alice\",2]\n");
+    
+    std::ostringstream empty;
+    ps::pq::ResultWriter emptyWriter(empty, true);
+    emptyWriter.finish();
+    REQUIRE(empty.str() == "[]\n");
+}
+
+TEST_CASE("Format values by type", "[pq][output_formatter][unit]") {
+    ps::pq::OutputFormatter formatter;
+    
+    REQUIRE(formatter.formatRaw(ps::Dictionary(int64_t(5000000000))) == "5000000000");
+    REQUIRE(formatter.formatRaw(ps::Dictionary(2.0)) == "2");
+    REQUIRE(formatter.formatRaw(ps::Dictionary(1e10)) == "1e+10");
+    REQUIRE(formatter.formatRaw(ps::Dictionary(-0.125)) == "-0.125");
+    REQUIRE(formatter.formatRaw(ps::Dictionary::null()) == "null");
+    REQUIRE(formatter.formatRaw(ps::Dictionary(std::vector<int>{1, 2})) == "[1,2]");
+    
+    std::string text = "x=";
+    formatter.appendRaw(text, ps::Dictionary("y"));
+    formatter.appendJson(text, ps::Dictionary("y"));
+    REQUIRE(text == "x=y\"y\"");
+}
+
+TEST_CASE("Result writer buffers output", "[pq][output_formatter][unit]") {
+    ps::Dictionary name("a fairly long name to fill the buffer quickly");
+    const size_t line = name.asStringRef().size() + 1;
+    std::ostringstream out;
+    size_t written = 0;
+    {
+        ps::pq::ResultWriter writer(out, false);
+        writer.write(name);
+        REQUIRE(out.str().empty());
+        
+        // A full buffer is written out without waiting for finish()
+        while (out.str().empty()) {
+            writer.write(name);
+        }
+        REQUIRE(out.str().size() == writer.count() * line);
+        writer.write(name);
+        written = writer.count();
+    }
+    // The rest is written when the writer goes away, even without finish()
+    REQUIRE(out.str().size() == written * line);
+}
+
+TEST_CASE("Format shell assignment", "[pq][output_formatter][unit]") {
+    ps::pq::OutputFormatter formatter;
+    
+    REQUIRE(formatter.formatShell("server/port", "8080") == "SERVER_PORT='8080'");
+    REQUIRE(formatter.formatShell("users/*/name", "a b") == "USERS___NAME='a b'");
+    REQUIRE(formatter.formatShell("0/x", "it's") == "_0_X='it'\\''s'");
+}
@@ -39,6 +39,13 @@ TEST_CASE("Parse empty path throws error", "[pq][path_parser][unit][exception]")
     REQUIRE_THROWS_AS(parser.parse(""), std::invalid_argument);
 }
 
+TEST_CASE("Parse root path", "[pq][path_parser][unit]") {
+    ps::pq::PathParser parser;
+    
+    REQUIRE(parser.parse(".").empty());
+    REQUIRE_THROWS_AS(parser.parse(".."), std::invalid_argument);
+}
+
 TEST_CASE("Parse path with leading slash throws error", "[pq][path_parser][unit][exception]") {
     ps::pq::PathParser parser;
     
@@ -110,10 +117,14 @@ TEST_CASE("Parse large array index", "[pq][path_parser][unit]") {
     REQUIRE(tokens[1].asIndex() == 999);
 }
 
-TEST_CASE("Negative index throws error", "[pq][path_parser][unit][exception]") {
+TEST_CASE("Parse negative index", "[pq][path_parser][unit]") {
     ps::pq::PathParser parser;
+    auto tokens = parser.parse("arr/-1");
     
-    REQUIRE_THROWS_AS(parser.parse("arr/-1"), std::invalid_argument);
+    REQUIRE(tokens.size() == 2);
+    REQUIRE(tokens[1].isIndex());
+    REQUIRE(tokens[1].asIndex() == -1);
+    REQUIRE(parser.parse("arr/-").back().isKey());
 }
 
 TEST_CASE("String that looks numeric is treated as key", "[pq][path_parser][unit]") {
@@ -206,3 +217,89 @@ TEST_CASE("Slash takes precedence over dot", "[pq][path_parser][unit]") {
     REQUIRE(tokens[0].asKey() == "server.config");
     REQUIRE(tokens[1].asKey() == "port.number");
 }
+
+TEST_CASE("Parse recursive descent", "[pq][path_parser][unit]") {
+    ps::pq::PathParser parser;
+    auto tokens = parser.parse("**/boundary conditions");
+    
+    REQUIRE(tokens.size() == 2);
+    REQUIRE(tokens[0].isDescent());
+    REQUIRE(tokens[0].matchesMany());
+    REQUIRE_FALSE(tokens[0].isWildcard());
+    REQUIRE(tokens[1].asKey() == "boundary conditions");
+    
+    // Repeated descent is the same as one
+    tokens = parser.parse("a/**/**/b");
+    REQUIRE(tokens.size() == 3);
+    REQUIRE(tokens[1].isDescent());
+    
+    REQUIRE(parser.parse("a.**").back().isDescent());
+}
+
+TEST_CASE("Parse slices", "[pq][path_parser][unit]") {
+    ps::pq::PathParser parser;
+    auto tokens = parser.parse("items/[100:200]");
+    
+    REQUIRE(tokens.size() == 2);
+    REQUIRE(tokens[1].isSlice());
+    REQUIRE(tokens[1].matchesMany());
+    REQUIRE(tokens[1].sliceBegin() == 100);
+    REQUIRE(tokens[1].sliceEnd() == 200);
+    
+    auto open = parser.parse("[-3:]").front();
+    REQUIRE(open.sliceBegin() == -3);
+    REQUIRE_FALSE(open.sliceEnd().has_value());
+    REQUIRE_FALSE(parser.parse("[:]").front().sliceBegin().has_value());
+    
+    // An index in brackets is an index
+    REQUIRE(parser.parse("a/[-2]").back().asIndex() == -2);
+}
+
+TEST_CASE("Slice ranges are clamped to the array", "[pq][path_parser][unit]") {
+    ps::pq::PathParser parser;
+    auto range = [&](const std::string& slice, int size) {
+        return parser.parse(slice).front().sliceRange(size);
+    };
+    
+    REQUIRE(range("[2:5]", 10) == std::make_pair(2, 5));
+    REQUIRE(range("[-3:]", 10) == std::make_pair(7, 10));
+    REQUIRE(range("[:-8]", 10) == std::make_pair(0, 2));
+    REQUIRE(range("[5:100]", 10) == std::make_pair(5, 10));
+    REQUIRE(range("[-100:2]", 10) == std::make_pair(0, 2));
+    REQUIRE(range("[6:2]", 10) == std::make_pair(6, 6));
+    REQUIRE(range("[:]", 0) == std::make_pair(0, 0));
+}
+
+TEST_CASE("Parse predicates", "[pq][path_parser][unit]") {
+    ps::pq::PathParser parser;
+    auto tokens = parser.parse("zones/[type=wall]/name");
+    
+    REQUIRE(tokens.size() == 3);
+    REQUIRE(tokens[1].isPredicate());
+    REQUIRE(tokens[1].matchesMany());
+    REQUIRE(tokens[1].predicateKey() == "type");
+    REQUIRE(tokens[1].predicateValue() == "wall");
+    REQUIRE_FALSE(tokens[1].predicateNegated());
+    
+    auto negated = parser.parse("[\"zone type\"!=\"a/b]\"]").front();
+    REQUIRE(negated.predicateNegated());
+    REQUIRE(negated.predicateKey() == "zone type");
+    REQUIRE(negated.predicateValue() == "a/b]");
+    
+    // Separators inside brackets don't split the path
+    tokens = parser.parse("versions.[number=1.2].name");
+    REQUIRE(tokens.size() == 3);
+    REQUIRE(tokens[1].predicateValue() == "1.2");
+    REQUIRE(parser.parse("a/[empty=]").back().predicateValue().empty());
+}
+
+TEST_CASE("Invalid brackets throw error", "[pq][path_parser][unit][exception]") {
+    ps::pq::PathParser parser;
+    
+    REQUIRE_THROWS_AS(parser.parse("zones/[type=wall"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parser.parse("items/[a:b]"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parser.parse("items/[1:2]x"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parser.parse("items/[=wall]"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parser.parse("items/[]"), std::invalid_argument);
+    REQUIRE_THROWS_AS(parser.parse("items/0").back().sliceBegin(), std::logic_error);
+}
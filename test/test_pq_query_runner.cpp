@@ -0,0 +1,131 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/pq/query_runner.h>
+#include <ps/pq/filter.h>
+
+#include <sstream>
+#include <vector>
+
+static ps::Dictionary make_config() {
+    ps::Dictionary d;
+    d["server"]["host"] = "localhost";
+    d["server"]["port"] = 8080;
+    d["users"][0]["name"] = "Alice";
+    d["users"][1]["name"] = "Bob";
+    return d;
+}
+
+static int run(std::vector<const char*> argv, std::string& output) {
+    argv.insert(argv.begin(), {"pq", "config.json"});
+    ps::pq::CliArgs args(static_cast<int>(argv.size()), argv.data());
+    
+    std::ostringstream out;
+    ps::pq::QueryRunner runner;
+    int status = runner.run(args, make_config(), out);
+    output = out.str();
+    return status;
+}
+
+TEST_CASE("Query runner answers a single query", "[pq][query_runner][unit]") {
+    std::string output;
+    
+    REQUIRE(run({"--get", "server/port"}, output) == 0);
+    REQUIRE(output == "8080\n");
+    
+    REQUIRE(run({"--get", "users/*/name"}, output) == 0);
+    REQUIRE(output == "Alice\nBob\n");
+    
+    REQUIRE(run({"--get", "timeout", "--default", "30"}, output) == 0);
+    REQUIRE(output == "30\n");
+    
+    REQUIRE(run({"--has", "debug"}, output) == 1);
+    REQUIRE(output.empty());
+    
+    REQUIRE_THROWS_AS(run({"--count", "groups"}, output), std::out_of_range);
+}
+
+TEST_CASE("Query runner answers several queries in order", "[pq][query_runner][unit]") {
+    std::string output;
+    
+    REQUIRE(run({"-g", "server/host", "--count", "users", "--has", "debug", "-g", "users/*/name"},
+                output) == 0);
+    REQUIRE(output == "localhost\n2\nfalse\n[\"Alice\",\"Bob\"]\n");
+    
+    REQUIRE(run({"-g", "server/host", "-g", "server/port", "--as-shell"}, output) == 0);
+    REQUIRE(output == "SERVER_HOST='localhost'\nSERVER_PORT='8080'\n");
+    
+    // A missing path without default fails the whole invocation
+    REQUIRE_THROWS_AS(run({"-g", "server/host", "-g", "timeout"}, output), std::out_of_range);
+}
+
+TEST_CASE("Query runner answers one of several files", "[pq][query_runner][unit]") {
+    auto runFile = [](std::vector<const char*> argv) {
+        argv.insert(argv.begin(), "pq");
+        argv.insert(argv.end(), {"a.json", "b.json"});
+        ps::pq::CliArgs args(static_cast<int>(argv.size()), argv.data());
+        return ps::pq::QueryRunner().runFile(args, "a.json", make_config());
+    };
+    
+    REQUIRE(runFile({"-g", "server/port"}) == "a.json: 8080\n");
+    REQUIRE(runFile({"-g", "users/*/name", "--count", "users"}) == "a.json: [\"Alice\",\"Bob\"]\na.json: 2\n");
+    REQUIRE(runFile({"-g", "server/host", "--as-json"}) == "{\"file\":\"a.json\",\"value\":\"localhost\"}\n");
+    REQUIRE(runFile({"--has", "debug", "-g", "timeout", "-d", "30", "--as-json"}) ==
+            "{\"file\":\"a.json\",\"values\":[false,\"30\"]}\n");
+    
+    REQUIRE_THROWS_AS(runFile({"-g", "timeout"}), std::out_of_range);
+}
+
+TEST_CASE("Query runner prints filter outputs", "[pq][query_runner][unit]") {
+    std::string output;
+    
+    REQUIRE(run({".users[] | .name"}, output) == 0);
+    REQUIRE(output == "\"Alice\"\n\"Bob\"\n");
+    
+    REQUIRE(run({".users[] | .name", "-r"}, output) == 0);
+    REQUIRE(output == "Alice\nBob\n");
+    
+    REQUIRE(run({".server | {host, port: ($p + 1)}", "--argjson", "p", "80"}, output) == 0);
+    REQUIRE(output == "{\"host\":\"localhost\",\"port\":81}\n");
+    
+    REQUIRE(run({"[.users[].name | select(. == $n)]", "--arg", "n", "Bob"}, output) == 0);
+    REQUIRE(output == "[\"Bob\"]\n");
+    
+    REQUIRE_THROWS_AS(run({".server.host.x"}, output), ps::pq::FilterError);
+}
+
+TEST_CASE("Query runner answers single queries on JSON files while reading", "[pq][query_runner][unit]") {
+    auto stream = [](std::vector<const char*> argv, const std::string& json, std::string& output) {
+        argv.insert(argv.begin(), {"pq", "config.json", "--stream"});
+        ps::pq::CliArgs args(static_cast<int>(argv.size()), argv.data());
+        REQUIRE(ps::pq::QueryRunner::canStream(args));
+        
+        std::istringstream in(json);
+        std::ostringstream out;
+        auto status = ps::pq::QueryRunner().runStreaming(args, in, out);
+        output = out.str();
+        return status;
+    };
+    const std::string json = R"({"server": {"host": "localhost"}, "users": [{"name": "Alice"}, {"name": "Bob"}]})";
+    std::string output;
+    
+    REQUIRE(stream({"-g", "server/host"}, json, output) == 0);
+    REQUIRE(output == "localhost\n");
+    REQUIRE(stream({"-g", "users/*/name", "--as-json"}, json, output) == 0);
+    REQUIRE(output == "[\"Alice\",\"Bob\"]\n");
+    REQUIRE(stream({"-g", "timeout", "--default", "30"}, json, output) == 0);
+    REQUIRE(output == "30\n");
+    REQUIRE(stream({"--count", "users"}, json, output) == 0);
+    REQUIRE(output == "2\n");
+    REQUIRE(stream({"--has", "debug"}, json, output) == 1);
+    
+    // Input the scanner can't follow is left to the full parse
+    REQUIRE_FALSE(stream({"-g", "a"}, "# hint\n{\"a\": 1}", output).has_value());
+    REQUIRE(output.empty());
+    
+    // Only asked for: a full parse reports errors anywhere in the input
+    const char* plain[] = {"pq", "config.json", "-g", "a"};
+    REQUIRE_FALSE(ps::pq::QueryRunner::canStream(ps::pq::CliArgs(4, plain)));
+    const char* yaml[] = {"pq", "config.yaml", "-g", "a", "--stream"};
+    REQUIRE_FALSE(ps::pq::QueryRunner::canStream(ps::pq::CliArgs(5, yaml)));
+    const char* several[] = {"pq", "config.json", "-g", "a", "-g", "b", "--stream"};
+    REQUIRE_FALSE(ps::pq::QueryRunner::canStream(ps::pq::CliArgs(7, several)));
+}
@@ -0,0 +1,91 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/pq/record_reader.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Each record of `input` with the line it starts on, as "line:text"
+static std::vector<std::string> records(const std::string& input) {
+    std::istringstream in(input);
+    ps::pq::RecordReader reader(in);
+    std::vector<std::string> out;
+    std::string text;
+    while (reader.next(text)) {
+        out.push_back(std::to_string(reader.line()) + ":" + text);
+    }
+    return out;
+}
+
+TEST_CASE("Record reader splits NDJSON", "[pq][record_reader][unit]") {
+    REQUIRE(records("{\"a\": 1}\n{\"a\": 2}\n") == std::vector<std::string>{"1:{\"a\": 1}", "2:{\"a\": 2}"});
+    REQUIRE(records("\n\n  [1, 2]\n") == std::vector<std::string>{"3:[1, 2]"});
+    REQUIRE(records("").empty());
+    REQUIRE(records(" \n\t\n").empty());
+    
+    // Several on one line, and without a final newline
+    REQUIRE(records("{}{} [] ") == std::vector<std::string>{"1:{}", "1:{}", "1:[]"});
+    REQUIRE(records("{\"a\": 1}") == std::vector<std::string>{"1:{\"a\": 1}"});
+}
+
+TEST_CASE("Record reader follows strings and comments", "[pq][record_reader][unit]") {
+    REQUIRE(records("{\"s\": \"}{\"}\n") == std::vector<std::string>{"1:{\"s\": \"}{\"}"});
+    REQUIRE(records("{\"s\": \"\\\"}\"}\n") == std::vector<std::string>{"1:{\"s\": \"\\\"}\"}"});
+    
+    // A record spanning lines keeps them
+    REQUIRE(records("{\n  \"a\": [1,\n 2] // }\n}\n") ==
+            std::vector<std::string>{"1:{\n  \"a\": [1,\n 2] // }\n}"});
+    REQUIRE(records("[1, /* ]\n ] */ 2]") == std::vector<std::string>{"1:[1, /* ]\n ] */ 2]"});
+    
+    // Between records
+    REQUIRE(records("# header\n// note\n{}\n# trailer") == std::vector<std::string>{"3:{}"});
+}
+
+TEST_CASE("Record reader reports bad input and goes on", "[pq][record_reader][unit][exception]") {
+    std::istringstream in("{\"a\": 1}\nnull {\"skipped\": 1}\n{\"b\": 2}\n[1,\n");
+    ps::pq::RecordReader reader(in);
+    std::string text;
+    
+    REQUIRE(reader.peek() == '{');
+    REQUIRE(reader.next(text));
+    try {
+        reader.next(text);
+        FAIL("expected runtime_error");
+    } catch (const std::runtime_error& e) {
+        REQUIRE(std::string(e.what()) == "line 2: expected a JSON object or array");
+    }
+    REQUIRE(reader.next(text));
+    REQUIRE(text == "{\"b\": 2}");
+    REQUIRE(reader.line() == 3);
+    
+    REQUIRE_THROWS_AS(reader.next(text), std::runtime_error);
+    REQUIRE_FALSE(reader.next(text));
+}
+
+TEST_CASE("Record reader hands back the rest", "[pq][record_reader][unit]") {
+    std::istringstream yaml("\n  server:\n    port: 1\n");
+    ps::pq::RecordReader reader(yaml);
+    REQUIRE(reader.peek() == 's');
+    REQUIRE(reader.rest() == "server:\n    port: 1\n");
+    
+    std::istringstream empty("  \n");
+    REQUIRE(ps::pq::RecordReader(empty).peek() == -1);
+    
+    // After a record, from where it ended
+    std::istringstream json("[1] (a: 2)\n(b: 3)");
+    ps::pq::RecordReader first(json);
+    std::string text;
+    REQUIRE(first.next(text));
+    REQUIRE(first.rest() == " (a: 2)\n(b: 3)");
+}
+
+TEST_CASE("Record reader knows when it has to wait", "[pq][record_reader][unit]") {
+    std::istringstream in("{\"a\": 1} {\"a\": 2}\n");
+    ps::pq::RecordReader reader(in);
+    std::string text;
+    
+    REQUIRE(reader.next(text));
+    REQUIRE_FALSE(reader.drained());
+    REQUIRE(reader.next(text));
+    REQUIRE(reader.drained());
+}
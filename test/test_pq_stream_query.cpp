@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/pq/stream_query.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const char* CONFIG = R"({
+    // comments are skipped
+    "server": {"host": "localhost", "port": 8080, "tags": ["a", "b"]},
+    "users": [
+        {"name": "Alice", "roles": ["admin"]},
+        {"name": "Bob", "roles": []}
+    ],
+    "esc\u0061ped": {"x": "}]"},
+    "empty": []
+})";
+
+static std::vector<ps::pq::PathToken> path(const std::string& text) {
+    return ps::pq::PathParser().parse(text);
+}
+
+// Each value at `text` as a raw string, joined with spaces
+static std::string get(const std::string& text, const std::string& json = CONFIG) {
+    std::istringstream in(json);
+    std::string out;
+    ps::pq::StreamQuery(in).visit(path(text), [&out](const ps::Dictionary& value) {
+        if (!out.empty()) out += " ";
+        out += value.isString() ? value.asString() : value.dump(0, true);
+    });
+    return out;
+}
+
+static bool has(const std::string& text, const std::string& json = CONFIG) {
+    std::istringstream in(json);
+    return ps::pq::StreamQuery(in).has(path(text));
+}
+
+static int count(const std::string& text, const std::string& json = CONFIG) {
+    std::istringstream in(json);
+    return ps::pq::StreamQuery(in).count(path(text));
+}
+
+TEST_CASE("Stream query finds values", "[pq][stream_query][unit]") {
+    REQUIRE(get("server/host") == "localhost");
+    REQUIRE(get("server/port") == "8080");
+    REQUIRE(get("users/1/name") == "Bob");
+    REQUIRE(get("users/0/roles") == "[\"admin\"]");
+    REQUIRE(get("escaped/x") == "}]");
+    REQUIRE(get("users/*/name") == "Alice Bob");
+    REQUIRE(get("users/*/roles/*") == "admin");
+    REQUIRE(get("empty/*").empty());
+    REQUIRE(get("users/[1:]/name") == "Bob");
+    REQUIRE(get("server/tags/[:1]") == "a");
+
+    REQUIRE(has("server/tags/1"));
+    REQUIRE_FALSE(has("server/tags/2"));
+    REQUIRE_FALSE(has("server/timeout"));
+
+    REQUIRE(count("users") == 2);
+    REQUIRE(count("server") == 3);
+    REQUIRE(count("empty") == 0);
+    REQUIRE(count("server/port") == 0);
+}
+
+TEST_CASE("Stream query errors match the navigator", "[pq][stream_query][unit][exception]") {
+    try {
+        get("server/timeout");
+        FAIL("expected out_of_range");
+    } catch (const std::out_of_range& e) {
+        REQUIRE(std::string(e.what()) == "Key 'timeout' not found");
+    }
+    try {
+        get("users/5");
+        FAIL("expected out_of_range");
+    } catch (const std::out_of_range& e) {
+        REQUIRE(std::string(e.what()) == "Index 5 out of range (size: 2)");
+    }
+    REQUIRE_THROWS_AS(get("empty/0"), std::out_of_range);
+    REQUIRE_THROWS_AS(get("server/0"), std::logic_error);
+}
+
+TEST_CASE("Stream query leaves other input to the parser", "[pq][stream_query][unit][exception]") {
+    // Format hints and non-container roots
+    REQUIRE_THROWS_AS(get("a", "# vim: ft=json\n{\"a\": 1}"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(get("a", "a = 1"), ps::pq::StreamQuery::Unsupported);
+    // Paths that need more than the values on the way
+    REQUIRE_THROWS_AS(get("users/-1/name"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(get("users/[-1:]"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(count("users/*"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(get("users/[name=Bob]/roles"), ps::pq::StreamQuery::Unsupported);
+    // Syntax errors on the way to the value
+    REQUIRE_THROWS_AS(get("b", "{\"a\" 1, \"b\": 2}"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(get("b", "{\"a\": [1, 2"), ps::pq::StreamQuery::Unsupported);
+}
+
+TEST_CASE("Stream query rejects what the parser rejects on the way", "[pq][stream_query][unit][exception]") {
+    // Skipped subtrees must still be balanced, bracket for bracket
+    REQUIRE_THROWS_AS(get("b", "{\"a\": {\"x\": [1}], \"b\": 2}"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(get("b", "{\"a\": [{]}, \"b\": 2}"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(has("b", "{\"a\": [\"x], \"b\": 2}"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE(get("b", "{\"a\": {\"x\": \"[}\"}, \"b\": 2}") == "2");
+
+    // Duplicate keys in the objects read member by member
+    REQUIRE_THROWS_AS(get("b", "{\"a\": 1, \"a\": 2, \"b\": 3}"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(get("s/b", "{\"s\": {\"a\": 1, \"a\": 2, \"b\": 3}}"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(count("s", "{\"s\": {\"a\": 1, \"a\": 2}}"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(get("*/a", "[{\"a\": 1, \"a\": 2}]"), ps::pq::StreamQuery::Unsupported);
+    REQUIRE_THROWS_AS(get("s", "{\"s\": {\"a\": 1, \"a\": 2}}"), ps::pq::StreamQuery::Unsupported);
+}
+
+TEST_CASE("Stream query stops reading once answered", "[pq][stream_query][unit]") {
+    std::string json = "{\"first\": 1, \"rest\": [";
+    for (int i = 0; i < 200000; ++i) {
+        json += "{\"id\": " + std::to_string(i) + ", \"name\": \"item\"},";
+    }
+    json += "{}]}";
+
+    std::istringstream in(json);
+    ps::pq::StreamQuery stream(in);
+    REQUIRE(stream.has(path("first")));
+    REQUIRE(stream.bytesRead() < json.size());
+}
@@ -0,0 +1,176 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/parsec.h>
+#include <ps/schema_registry.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+using namespace ps;
+namespace fs = std::filesystem;
+
+static fs::path make_schema_dir() {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    fs::path dir = fs::temp_directory_path() /
+                   ("parsec-registry-" + std::to_string(static_cast<long long>(now)));
+    fs::create_directories(dir / "common");
+    return dir;
+}
+
+static void write_file(const fs::path& p, const std::string& text) {
+    std::ofstream out(p);
+    REQUIRE(out.good());
+    out << text;
+}
+
+TEST_CASE("SchemaRegistry resolves $refs across files", "[schema-registry]") {
+    const fs::path dir = make_schema_dir();
+    write_file(dir / "main.json", R"({
+        "type": "object",
+        "required": ["origin"],
+        "properties": {
+            "origin": {"$ref": "common/geometry.json#/definitions/point"},
+            "size": {"$ref": "common/geometry.json#/definitions/length"},
+            "scale": {"$ref": "common/geometry.json#/definitions/positive"},
+            "name": {"$ref": "#/definitions/name"}
+        },
+        "definitions": {"name": {"type": "string"}}
+    })");
+    write_file(dir / "common" / "geometry.json", R"({
+        "definitions": {
+            "point": {
+                "type": "object",
+                "required": ["x", "y"],
+                "properties": {
+                    "x": {"$ref": "units.json#/definitions/coordinate"},
+                    "y": {"$ref": "units.json#/definitions/coordinate"}
+                }
+            },
+            "length": {"$ref": "#/definitions/positive"},
+            "positive": {"type": "number", "minimum": 0, "default": 1.0}
+        }
+    })");
+    write_file(dir / "common" / "units.json", R"({
+        "definitions": {"coordinate": {"type": "number"}}
+    })");
+
+    SchemaRegistry registry;
+    const Dictionary& schema = *registry.resolve((dir / "main.json").string());
+    REQUIRE(registry.document_count() == 3);
+
+    SECTION("valid documents pass") {
+        auto ok = validate_all(parse_json(R"({"origin": {"x": 1, "y": 2}, "name": "box"})"),
+                               schema);
+        REQUIRE(ok.is_valid());
+    }
+
+    SECTION("errors come from the referenced files") {
+        auto bad = validate_all(parse_json(R"({"origin": {"x": "one", "y": 2}, "size": -1})"),
+                                schema);
+        REQUIRE(bad.error_count() == 2);
+        REQUIRE(bad.format().find("origin/x") != std::string::npos);
+        REQUIRE(bad.format().find("below minimum") != std::string::npos);
+    }
+
+    SECTION("defaults are found through external refs") {
+        Dictionary filled = setDefaults(parse_json(R"({"origin": {"x": 1, "y": 2}})"), schema);
+        REQUIRE(filled.at("scale").asDouble() == 1.0);
+    }
+
+    SECTION("documents and resolved schemas are cached") {
+        const Dictionary& again = *registry.resolve((dir / "main.json").string());
+        REQUIRE(&again == &schema);
+        registry.resolve((dir / "common" / ".." / "main.json").string());
+        REQUIRE(registry.document_count() == 3);
+    }
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("SchemaRegistry resolves $id references", "[schema-registry]") {
+    const fs::path dir = make_schema_dir();
+    write_file(dir / "main.json", R"({
+        "$id": "https://example.com/schemas/main.json",
+        "type": "object",
+        "properties": {
+            "home": {"$ref": "address.json"},
+            "work": {"$ref": "https://example.com/schemas/address.json#/definitions/street"}
+        }
+    })");
+
+    SchemaRegistry registry;
+    registry.add("https://example.com/schemas/address.json", parse_json(R"({
+        "type": "object",
+        "required": ["street"],
+        "properties": {"street": {"$ref": "#/definitions/street"}},
+        "definitions": {"street": {"type": "string"}}
+    })"));
+    const Dictionary& schema = *registry.resolve((dir / "main.json").string());
+
+    REQUIRE(validate_all(parse_json(R"({"home": {"street": "Main"}, "work": "Elm"})"), schema)
+                    .is_valid());
+    auto bad = validate_all(parse_json(R"({"home": {"street": 5}, "work": 7})"), schema);
+    REQUIRE(bad.error_count() == 2);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("SchemaRegistry handles cyclic and missing references", "[schema-registry]") {
+    const fs::path dir = make_schema_dir();
+    write_file(dir / "tree.json", R"({
+        "type": "object",
+        "properties": {
+            "label": {"type": "string"},
+            "children": {"type": "array", "items": {"$ref": "node.json"}}
+        }
+    })");
+    write_file(dir / "node.json", R"({"$ref": "tree.json"})");
+    write_file(dir / "broken.json", R"({"properties": {"a": {"$ref": "missing.json"}}})");
+
+    SchemaRegistry registry;
+    const Dictionary& schema = *registry.resolve((dir / "tree.json").string());
+    Dictionary data = parse_json(
+                R"({"label": "a", "children": [{"label": "b", "children": [{"label": 3}]}]})");
+    auto result = validate_all(data, schema);
+    REQUIRE(result.error_count() == 1);
+    REQUIRE(result.errors[0].path == "children/0/children/0/label");
+
+    REQUIRE_THROWS_AS(registry.resolve((dir / "broken.json").string()), std::runtime_error);
+    REQUIRE_THROWS_AS(registry.load((dir / "absent.json").string()), std::runtime_error);
+
+    fs::remove_all(dir);
+}
+
+TEST_CASE("SchemaRegistry results survive add() and clear()", "[schema-registry]") {
+    const fs::path dir = make_schema_dir();
+    write_file(dir / "main.json", R"({
+        "type": "object",
+        "properties": {"id": {"$ref": "id.json"}}
+    })");
+    write_file(dir / "id.json", R"({"type": "integer"})");
+
+    SchemaRegistry registry;
+    auto loaded = registry.load((dir / "id.json").string());
+    auto first = registry.resolve((dir / "main.json").string());
+    REQUIRE(validate_all(parse_json(R"({"id": 7})"), *first).is_valid());
+
+    // Replacing the referenced document drops the cached resolution, but the
+    // schemas handed out before keep their contents
+    registry.add(fs::weakly_canonical(dir / "id.json").string(),
+                 parse_json(R"({"type": "string"})"));
+    REQUIRE(loaded->at("type").asString() == "integer");
+    REQUIRE(validate_all(parse_json(R"({"id": 7})"), *first).is_valid());
+    REQUIRE_FALSE(validate_all(parse_json(R"({"id": "x"})"), *first).is_valid());
+
+    auto second = registry.resolve((dir / "main.json").string());
+    REQUIRE(second != first);
+    REQUIRE(validate_all(parse_json(R"({"id": "x"})"), *second).is_valid());
+
+    registry.clear();
+    REQUIRE(loaded->at("type").asString() == "integer");
+    REQUIRE(validate_all(parse_json(R"({"id": 7})"), *first).is_valid());
+
+    fs::remove_all(dir);
+}
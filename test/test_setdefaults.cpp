@@ -325,3 +325,81 @@ TEST_CASE("setDefaults: anyOf with implicit object schemas in array items", "[de
     REQUIRE(item.has("gradation"));
     REQUIRE(item.at("gradation").asDouble() == 1.5);
 }
+
+TEST_CASE("applyDefaults: fills missing keys in place and records them", "[defaults]") {
+    Dictionary schema = parse_json(R"({
+        "type": "object",
+        "properties": {
+            "port": {"type": "integer", "default": 8080},
+            "host": {"type": "string", "default": "localhost"},
+            "limits": {"type": "object", "properties": {"cpu": {"type": "integer", "default": 2}}},
+            "level": {"type": "integer", "default": 1},
+            "workers": {"type": "array", "items": {"$ref": "#/definitions/worker"}}
+        },
+        "definitions": {
+            "worker": {"type": "object", "properties": {"weight": {"type": "number", "default": 1.5}}}
+        }
+    })");
+    Dictionary data = parse_json(R"({"host": "example.org", "level": null,
+                                     "workers": [{"weight": 3}, {}]})");
+    Dictionary expected = setDefaults(data, schema);
+
+    std::vector<DefaultEdit> edits;
+    applyDefaults(data, schema, &edits);
+    REQUIRE(data == expected);
+    REQUIRE(data.at("host").asString() == "example.org");
+    REQUIRE(data.at("port").asInt() == 8080);
+    REQUIRE(data.at("limits").at("cpu").asInt() == 2);
+    REQUIRE(data.at("workers")[1].at("weight").asDouble() == 1.5);
+
+    std::vector<std::string> paths;
+    for (const auto& edit : edits) paths.push_back(edit.path);
+    REQUIRE(paths == std::vector<std::string>{"level", "limits", "port", "workers[1].weight"});
+    REQUIRE(edits[0].previous.has_value());
+    REQUIRE(edits[0].previous->isNull());
+    REQUIRE_FALSE(edits[1].previous.has_value());
+}
+
+TEST_CASE("applyDefaults: allOf branches fill the same object", "[defaults]") {
+    Dictionary schema = parse_json(R"({
+        "type": "object",
+        "allOf": [
+            {"$ref": "#/definitions/base"},
+            {"properties": {"b": {"default": 2}, "a": {"default": 99}}}
+        ],
+        "definitions": {"base": {"properties": {"a": {"default": 1}}}}
+    })");
+    Dictionary data = parse_json(R"({"c": 3})");
+    applyDefaults(data, schema);
+    REQUIRE(data == parse_json(R"({"a": 1, "b": 2, "c": 3})"));
+}
+
+TEST_CASE("validate_with_defaults: same report as setDefaults then validate_all", "[defaults]") {
+    Dictionary schema = parse_json(R"({
+        "type": "object",
+        "properties": {
+            "mode": {"type": "string", "default": "fast"},
+            "solver": {
+                "anyOf": [
+                    {"type": "object", "required": ["cfl"],
+                     "properties": {"cfl": {"type": "number"}, "order": {"default": 2}}},
+                    {"type": "string", "enum": ["auto"]}
+                ]
+            }
+        }
+    })");
+    const Dictionary parsed = parse_json(R"({"solver": {"steps": 10}})");
+
+    Dictionary completed = setDefaults(parsed, schema);
+    set_original_data(&parsed);
+    ValidationResult expected = validate_all(completed, schema);
+    set_original_data(nullptr);
+
+    Dictionary data = parsed;
+    ValidationResult result = validate_with_defaults(data, schema);
+    REQUIRE(data == completed);
+    REQUIRE_FALSE(result.is_valid());
+    REQUIRE(result.format() == expected.format());
+    // The anyOf report shows the solver as written, without the filled-in "order"
+    REQUIRE(result.format().find("order") == std::string::npos);
+}
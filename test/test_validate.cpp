@@ -369,6 +369,82 @@ TEST_CASE("validate phase2: uniqueItems and patternProperties", "[validate][phas
     }
 }
 
+TEST_CASE("uniqueItems and enum compare values structurally", "[validate][phase2][hash]") {
+    Dictionary arr = parse_json(R"({"type": "array", "uniqueItems": true})");
+    SECTION("distinct objects pass") {
+        Dictionary d = parse_json(R"([{"a": 1, "b": [1, 2]}, {"a": 1, "b": [2, 1]}])");
+        REQUIRE(!validate(d, arr).has_value());
+    }
+    SECTION("objects equal up to key order are duplicates") {
+        Dictionary d = parse_json(R"([{"a": 1, "b": [1, 2]}, {"b": [1, 2], "a": 1}])");
+        REQUIRE(validate(d, arr).has_value());
+    }
+    SECTION("large arrays of strings") {
+        std::vector<std::string> names;
+        for (int i = 0; i < 20000; ++i) names.push_back("item" + std::to_string(i));
+        Dictionary d;
+        d = names;
+        REQUIRE(!validate(d, arr).has_value());
+        names.push_back("item123");
+        d = names;
+        REQUIRE(validate(d, arr).has_value());
+    }
+
+    SECTION("large enum membership") {
+        Dictionary schema;
+        schema["type"] = "string";
+        std::vector<std::string> materials;
+        for (int i = 0; i < 5000; ++i) materials.push_back("mat-" + std::to_string(i));
+        schema["enum"] = materials;
+        REQUIRE(!validate(Dictionary(std::string("mat-4999")), schema).has_value());
+        REQUIRE(!validate(Dictionary(std::string("mat-0")), schema).has_value());
+        REQUIRE(validate(Dictionary(std::string("mat-5000")), schema).has_value());
+    }
+
+    SECTION("enum of objects") {
+        Dictionary schema = parse_json(R"({"enum": [{"x": 1}, [1, 2], "a", 3]})");
+        REQUIRE(!validate(parse_json(R"({"x": 1})"), schema).has_value());
+        REQUIRE(!validate(parse_json("[1, 2]"), schema).has_value());
+        REQUIRE(validate(parse_json(R"({"x": 2})"), schema).has_value());
+    }
+}
+
+TEST_CASE("CompiledSchema indexes large enums once", "[validate][phase2][hash]") {
+    std::vector<std::string> materials;
+    for (int i = 0; i < 5000; ++i) materials.push_back("mat-" + std::to_string(i));
+    Dictionary material;
+    material["type"] = "string";
+    material["enum"] = materials;
+    Dictionary small;
+    small["enum"] = std::vector<std::string>{"a", "b"};
+    Dictionary schema;
+    schema["type"] = "object";
+    schema["properties"]["material"] = material;
+    schema["properties"]["mode"] = small;
+    schema["definitions"]["other"] = material;
+
+    const CompiledSchema compiled(schema);
+    REQUIRE(compiled.size() == 2);  // the small enum is scanned linearly
+
+    for (const char* doc : {R"({"material": "mat-4999", "mode": "a"})",
+                            R"({"material": "mat-5000"})",
+                            R"({"mode": "c"})"}) {
+        Dictionary data = parse_json(doc);
+        REQUIRE(validate_all(data, compiled).format() == validate_all(data, schema).format());
+    }
+    REQUIRE(validate_all(parse_json(R"({"material": "mat-7"})"), compiled).is_valid());
+    REQUIRE(!validate_all(parse_json(R"({"material": "mat-5000"})"), compiled).is_valid());
+
+    SECTION("bare property maps") {
+        Dictionary props;
+        props["material"] = material;
+        const CompiledSchema bare(props);
+        REQUIRE(bare.size() == 1);
+        REQUIRE(validate_all(parse_json(R"({"material": "mat-1"})"), bare).is_valid());
+        REQUIRE(!validate_all(parse_json(R"({"material": "x"})"), bare).is_valid());
+    }
+}
+
 // Additional-properties tests merged
 TEST_CASE("validate additionalProperties as schema", "[validate][additionalProperties]") {
     Dictionary schema;
@@ -595,4 +671,56 @@ TEST_CASE("Schema error: enum as string in nested schema", "[validate][exception
 
     REQUIRE_THROWS_WITH(validate(data, root_schema),
                         Catch::Matchers::ContainsSubstring("Invalid schema file"));
-}
\ No newline at end of file
+}
+TEST_CASE("Unknown keys are matched against many declared properties", "[validate][suggestions]") {
+    Dictionary schema;
+    schema["type"] = "object";
+    schema["additionalProperties"] = false;
+    for (int i = 0; i < 2000; ++i)
+        schema["properties"]["field_" + std::to_string(i)]["type"] = "integer";
+    schema["properties"]["wall distance"]["type"] = "number";
+    schema["properties"]["wall distance limiter"]["type"] = "number";
+
+    Dictionary data;
+    data["wall distanse"] = 1.0;
+    data["wall"] = 2.0;
+    data["fleld_1234"] = int64_t(3);
+    data["completely unrelated"] = int64_t(4);
+
+    auto result = validate_all(data, schema);
+    REQUIRE(result.errors.size() == 4);
+    std::map<std::string, std::string> messages;
+    for (auto const& e : result.errors) {
+        size_t open = e.message.find('\'') + 1;
+        messages[e.message.substr(open, e.message.find('\'', open) - open)] = e.message;
+    }
+    CHECK_THAT(messages["wall distanse"],
+               Catch::Matchers::ContainsSubstring("Did you mean 'wall distance'?"));
+    // A prefix of declared names suggests all of them
+    CHECK_THAT(messages["wall"],
+               Catch::Matchers::ContainsSubstring("'wall distance' or 'wall distance limiter'"));
+    CHECK_THAT(messages["fleld_1234"],
+               Catch::Matchers::ContainsSubstring("Did you mean 'field_1234'"));
+    CHECK(messages["completely unrelated"].find("Did you mean") == std::string::npos);
+}
+
+TEST_CASE("CompiledSchema keeps the suggestion index", "[validate][suggestions]") {
+    Dictionary schema;
+    schema["type"] = "object";
+    schema["additionalProperties"] = false;
+    for (int i = 0; i < 2000; ++i)
+        schema["properties"]["field_" + std::to_string(i)]["type"] = "integer";
+    schema["properties"]["inner"]["type"] = "object";
+    schema["properties"]["inner"]["properties"]["alpha"]["type"] = "integer";
+
+    const CompiledSchema compiled(schema);
+    REQUIRE(compiled.size() == 1);  // "inner" allows additional properties
+
+    for (const char* doc : {R"({"fleld_1234": 1})", R"({"field_12345": 1, "feild_7": 2})",
+                            R"({"field": 1, "x": 2})", R"({"inner": {"alpah": 1}})"}) {
+        Dictionary data = parse_json(doc);
+        REQUIRE(validate_all(data, compiled).format() == validate_all(data, schema).format());
+    }
+    CHECK_THAT(validate_all(parse_json(R"({"feild_7": 2})"), compiled).format(),
+               Catch::Matchers::ContainsSubstring("'field_7'"));
+}
@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/parsec.h>
+#include <ps/validate.h>
+
+using namespace ps;
+
+// oneOf with many boundary-condition variants, each pinned by a "type" const
+static Dictionary boundary_schema(int variants) {
+    Dictionary alternatives;
+    std::vector<Dictionary> list;
+    for (int i = 0; i < variants; ++i) {
+        std::string name = "bc" + std::to_string(i);
+        list.push_back(parse_json(R"({"title": ")" + name + R"(", "type": "object",
+            "properties": {"type": {"const": ")" + name + R"("}, "value": {"type": "number"}},
+            "required": ["type", "value"], "additionalProperties": false})"));
+    }
+    alternatives = list;
+    Dictionary schema;
+    schema["type"] = "array";
+    schema["items"]["oneOf"] = alternatives;
+    return schema;
+}
+
+TEST_CASE("oneOf dispatches on a discriminator", "[validate][oneof][discriminator]") {
+    Dictionary schema = boundary_schema(64);
+
+    SECTION("matching variants validate") {
+        Dictionary data = parse_json(R"([{"type": "bc0", "value": 1}, {"type": "bc63", "value": 2.5}])");
+        REQUIRE(validate_all(data, schema).is_valid());
+    }
+
+    SECTION("errors report only the selected variant") {
+        Dictionary data = parse_json(R"([{"type": "bc7", "value": "hot"}])");
+        auto result = validate_all(data, schema);
+        REQUIRE_FALSE(result.is_valid());
+        std::string text = result.format();
+        REQUIRE(text.find("Option: bc7") != std::string::npos);
+        REQUIRE(text.find("Option: bc8") == std::string::npos);
+    }
+
+    SECTION("unknown discriminator values still list the alternatives") {
+        Dictionary data = parse_json(R"([{"type": "bc99", "value": 1}])");
+        auto result = validate_all(data, schema);
+        REQUIRE_FALSE(result.is_valid());
+        REQUIRE(result.format().find("Option: bc0") != std::string::npos);
+    }
+
+    SECTION("missing discriminator falls back to the full scan") {
+        Dictionary data = parse_json(R"([{"value": 1}])");
+        REQUIRE_FALSE(validate_all(data, schema).is_valid());
+    }
+}
+
+TEST_CASE("discriminator index keeps oneOf ambiguity checks", "[validate][oneof][discriminator]") {
+    Dictionary schema = parse_json(R"({
+        "oneOf": [
+            {"properties": {"kind": {"enum": ["a", "b"]}}},
+            {"properties": {"kind": {"enum": ["b", "c"]}}},
+            {"properties": {"kind": {"const": "d"}}}
+        ]
+    })");
+    REQUIRE(validate_all(parse_json(R"({"kind": "a"})"), schema).is_valid());
+    REQUIRE(validate_all(parse_json(R"({"kind": "d"})"), schema).is_valid());
+    auto result = validate_all(parse_json(R"({"kind": "b"})"), schema);
+    REQUIRE_FALSE(result.is_valid());
+    REQUIRE(result.format().find("matched multiple schemas") != std::string::npos);
+}
+
+TEST_CASE("anyOf without a common discriminator scans every branch",
+          "[validate][anyof][discriminator]") {
+    Dictionary schema = parse_json(R"({
+        "anyOf": [
+            {"properties": {"type": {"const": "circle"}, "r": {"type": "number"}}, "required": ["r"]},
+            {"properties": {"w": {"type": "number"}}, "required": ["w"]}
+        ]
+    })");
+    REQUIRE(validate_all(parse_json(R"({"type": "square", "w": 2})"), schema).is_valid());
+    REQUIRE(validate_all(parse_json(R"({"type": "circle", "r": 2})"), schema).is_valid());
+    REQUIRE_FALSE(validate_all(parse_json(R"({"type": "circle"})"), schema).is_valid());
+}
+
+TEST_CASE("CompiledSchema builds discriminator indexes once", "[validate][oneof][discriminator]") {
+    Dictionary schema = boundary_schema(64);
+    const CompiledSchema compiled(schema);
+    REQUIRE(compiled.size() == 65);  // the discriminator index, one key index per variant
+
+    for (const char* doc : {R"([{"type": "bc0", "value": 1}, {"type": "bc63", "value": 2.5}])",
+                            R"([{"type": "bc7", "value": "hot"}])",
+                            R"([{"type": "bc99", "value": 1}])",
+                            R"([{"value": 1}])"}) {
+        Dictionary data = parse_json(doc);
+        auto expected = validate_all(data, schema);
+        auto result = validate_all(data, compiled);
+        REQUIRE(result.is_valid() == expected.is_valid());
+        REQUIRE(result.format() == expected.format());
+    }
+}
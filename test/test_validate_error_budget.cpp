@@ -0,0 +1,86 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/parsec.h>
+#include <ps/validate.h>
+
+using namespace ps;
+
+static Dictionary budget_schema() {
+    return parse_json(R"({
+        "type": "object",
+        "required": ["a", "b", "c", "d"],
+        "additionalProperties": false,
+        "properties": {
+            "a": {"type": "string"},
+            "b": {"type": "string"},
+            "c": {"type": "string"},
+            "d": {"type": "string"},
+            "mode": {"type": "string", "enum": ["fast", "accurate"]},
+            "items": {"type": "array", "items": {"type": "integer"}}
+        }
+    })");
+}
+
+TEST_CASE("validate_all without options collects every error", "[validate][budget]") {
+    Dictionary data = parse_json(R"({"items": [1, "x", "y", 4]})");
+    auto result = validate_all(data, budget_schema());
+    REQUIRE(result.error_count() >= 6);
+    REQUIRE_FALSE(result.truncated);
+}
+
+TEST_CASE("max_errors stops the traversal once the budget is spent", "[validate][budget]") {
+    Dictionary data = parse_json(R"({"items": [1, "x", "y", 4]})");
+    ValidationOptions opts;
+    opts.max_errors = 2;
+    auto result = validate_all(data, budget_schema(), "", opts);
+    REQUIRE(result.errors.size() == 2);
+    REQUIRE(result.truncated);
+    REQUIRE(result.format().find("stopped early") != std::string::npos);
+}
+
+TEST_CASE("stop_on_first_error returns a single error", "[validate][budget]") {
+    Dictionary data = parse_json(R"({"items": ["x", "y"]})");
+    ValidationOptions opts;
+    opts.stop_on_first_error = true;
+    auto result = validate_all(data, budget_schema(), "", opts);
+    REQUIRE_FALSE(result.is_valid());
+    REQUIRE(result.errors.size() == 1);
+    REQUIRE(result.truncated);
+}
+
+TEST_CASE("error budget does not affect valid documents", "[validate][budget]") {
+    Dictionary data = parse_json(R"({"a": "1", "b": "2", "c": "3", "d": "4", "items": [1, 2]})");
+    ValidationOptions opts;
+    opts.stop_on_first_error = true;
+    auto result = validate_all(data, budget_schema(), "", opts);
+    REQUIRE(result.is_valid());
+    REQUIRE_FALSE(result.truncated);
+}
+
+TEST_CASE("budget larger than the error count is not truncated", "[validate][budget]") {
+    Dictionary data = parse_json(R"({"a": "1", "b": "2", "c": "3"})");
+    ValidationOptions opts;
+    opts.max_errors = 10;
+    auto result = validate_all(data, budget_schema(), "", opts);
+    REQUIRE(result.errors.size() == 1);
+    REQUIRE_FALSE(result.truncated);
+}
+
+TEST_CASE("skip_suggestions omits did-you-mean hints", "[validate][budget][suggestions]") {
+    Dictionary data = parse_json(R"({"a": "1", "b": "2", "c": "3", "d": "4", "mdoe": "fast"})");
+
+    auto with = validate_all(data, budget_schema());
+    REQUIRE(with.format().find("Did you mean 'mode'?") != std::string::npos);
+
+    ValidationOptions opts;
+    opts.skip_suggestions = true;
+    auto without = validate_all(data, budget_schema(), "", opts);
+    REQUIRE_FALSE(without.is_valid());
+    REQUIRE(without.format().find("key 'mdoe' not valid") != std::string::npos);
+    REQUIRE(without.format().find("Did you mean") == std::string::npos);
+
+    Dictionary bad_enum = parse_json(R"({"a": "1", "b": "2", "c": "3", "d": "4", "mode": "fsat"})");
+    auto enum_result = validate_all(bad_enum, budget_schema(), "", opts);
+    REQUIRE_FALSE(enum_result.is_valid());
+    REQUIRE(enum_result.format().find("valid options are") != std::string::npos);
+    REQUIRE(enum_result.format().find("Did you mean") == std::string::npos);
+}
@@ -0,0 +1,99 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/parsec.h>
+#include <ps/validate.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace ps;
+
+static Dictionary incremental_schema() {
+    return parse_json(R"({
+        "type": "object",
+        "required": ["name", "runs"],
+        "additionalProperties": false,
+        "properties": {
+            "name": {"type": "string"},
+            "runs": {
+                "type": "array",
+                "maxItems": 4,
+                "items": {
+                    "type": "object",
+                    "required": ["steps"],
+                    "properties": {
+                        "steps": {"type": "integer", "minimum": 1},
+                        "solver": {
+                            "oneOf": [
+                                {"type": "object", "required": ["cfl"],
+                                 "properties": {"cfl": {"type": "number"}}},
+                                {"type": "string", "enum": ["implicit", "explicit"]}
+                            ]
+                        }
+                    }
+                }
+            }
+        }
+    })");
+}
+
+// Errors as sorted "path: message" lines, so results can be compared regardless of order
+static std::vector<std::string> summary(const ValidationResult& result) {
+    std::vector<std::string> lines;
+    for (const auto& err : result.errors) lines.push_back(err.path + ": " + err.message);
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+TEST_CASE("revalidate matches a full validation after edits", "[validate][incremental]") {
+    const Dictionary schema = incremental_schema();
+    Dictionary data = parse_json(R"({
+        "name": "case",
+        "runs": [{"steps": 0}, {"steps": 5, "solver": "implicit"}, {"steps": "ten"}]
+    })");
+    ValidationResult previous = validate_all(data, schema);
+    REQUIRE(previous.error_count() == 2);
+
+    SECTION("fixing an item drops only its error") {
+        data["runs"][0]["steps"] = 3;
+        auto result = revalidate(previous, data, schema, {"runs[0].steps"});
+        REQUIRE(summary(result) == summary(validate_all(data, schema)));
+        REQUIRE(result.error_count() == 1);
+    }
+
+    SECTION("new errors inside the edited subtree are found") {
+        data["runs"][1]["solver"] = "fast";
+        auto result = revalidate(previous, data, schema, {"runs[1].solver"});
+        REQUIRE(summary(result) == summary(validate_all(data, schema)));
+        REQUIRE(result.error_count() == 3);
+    }
+
+    SECTION("ancestors re-check required and additional properties") {
+        data.erase("name");
+        data["nmae"] = "case";
+        auto result = revalidate(previous, data, schema, {"name", "nmae"});
+        REQUIRE(summary(result) == summary(validate_all(data, schema)));
+    }
+
+    SECTION("array size checks see appended items") {
+        data["runs"][3] = parse_json(R"({"steps": 1})");
+        data["runs"][4] = parse_json(R"({"steps": 2})");
+        auto result = revalidate(previous, data, schema, {"runs[3]", "runs[4]"});
+        REQUIRE(summary(result) == summary(validate_all(data, schema)));
+    }
+}
+
+TEST_CASE("revalidate falls back to a full pass for truncated results",
+          "[validate][incremental][budget]") {
+    const Dictionary schema = incremental_schema();
+    Dictionary data = parse_json(R"({"name": 1, "runs": [{"steps": 0}, {"steps": 0}]})");
+    ValidationOptions opts;
+    opts.max_errors = 1;
+    ValidationResult previous = validate_all(data, schema, "", opts);
+    REQUIRE(previous.truncated);
+
+    data["name"] = "fixed";
+    auto result = revalidate(previous, data, schema, {"name"}, "", opts);
+    REQUIRE(summary(result) == summary(validate_all(data, schema, "", opts)));
+    REQUIRE(result.truncated);
+}
@@ -361,3 +361,42 @@ TEST_CASE("validate_all with allOf reports no errors when all requirements met",
     REQUIRE(result.is_valid());
     REQUIRE(result.error_count() == 0);
 }
+
+TEST_CASE("validate_all categorizes errors where they are detected", "[validate][multi-error][category]") {
+    Dictionary schema = parse_json(R"({
+        "type": "object",
+        "properties": {
+            "tag": {"type": "string", "pattern": "^[a-z]+$"},
+            "mode": {"anyOf": [{"type": "integer"}, {"type": "boolean"}]},
+            "sizes": {"type": "array", "maxItems": 1, "items": {"type": "integer", "minimum": 0}}
+        }
+    })");
+
+    Dictionary data = parse_json(R"({
+        "tag": "ABC",
+        "mode": "fast",
+        "sizes": [2, -1]
+    })");
+
+    auto result = validate_all(data, schema);
+
+    auto category_at = [&](const std::string& path) {
+        int count = 0;
+        ErrorCategory category = ErrorCategory::OTHER;
+        for (const auto& err : result.errors) {
+            if (err.path == path) {
+                ++count;
+                category = err.category;
+            }
+        }
+        REQUIRE(count == 1);
+        return category;
+    };
+
+    REQUIRE(category_at("tag") == ErrorCategory::PATTERN_MISMATCH);
+    REQUIRE(category_at("mode") == ErrorCategory::ANY_OF_MISMATCH);
+    REQUIRE(category_at("sizes") == ErrorCategory::ARRAY_SIZE);
+    REQUIRE(category_at("sizes/1") == ErrorCategory::OUT_OF_RANGE);
+    // Child errors are not repeated at the enclosing object
+    REQUIRE(result.error_count() == 4);
+}
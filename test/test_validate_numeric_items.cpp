@@ -0,0 +1,87 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/parsec.h>
+#include <ps/validate.h>
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace ps;
+
+// `items` schemas made only of numeric bounds are checked in one pass over
+// the array. Wrapping the same bounds in an allOf keeps them on the
+// element-by-element walk, which the results are compared against.
+static Dictionary array_schema(const std::string& items) {
+    return parse_json(R"({"type": "object", "properties": {
+        "fast": {"type": "array", "items": )" + items + R"(},
+        "slow": {"type": "array", "items": {"allOf": [)" + items + R"(]}}
+    }, "definitions": {"distance": {"type": "number", "minimum": 0}}})");
+}
+
+static void require_same_result(const Dictionary& values, const std::string& items) {
+    Dictionary schema = array_schema(items);
+    Dictionary fast, slow;
+    fast["fast"] = values;
+    slow["slow"] = values;
+    ValidationResult expected = validate_all(slow, schema);
+    ValidationResult result = validate_all(fast, schema);
+    INFO(items << " " << values.dump());
+    REQUIRE(result.errors.size() == expected.errors.size());
+    for (size_t i = 0; i < result.errors.size(); ++i) {
+        std::string path = expected.errors[i].path;
+        path.replace(0, 4, "fast");
+        REQUIRE(result.errors[i].path == path);
+        REQUIRE(result.errors[i].category == expected.errors[i].category);
+    }
+}
+
+TEST_CASE("numeric items report what the element walk reports", "[validate][items]") {
+    const std::vector<std::string> schemas = {
+            R"({"type": "number", "minimum": 0, "maximum": 1})",
+            R"({"type": "integer", "exclusiveMinimum": -1, "exclusiveMaximum": 10})",
+            R"({"minimum": 0.5, "description": "no type"})",
+            R"({"$ref": "#/definitions/distance"})",
+            R"({"type": "number"})",
+    };
+    const std::vector<Dictionary> arrays = {
+            Dictionary(std::vector<double>{0.0, 0.25, 1.0}),
+            Dictionary(std::vector<double>{0.5, -0.1, 2.0, 0.75}),
+            Dictionary(std::vector<int>{0, 1, 9}),
+            Dictionary(std::vector<int>{-1, 10, 3}),
+            parse_json(R"([1, 2.5, "x", null, {"a": 1}])"),
+            parse_json(R"([])"),
+    };
+    for (const auto& items : schemas)
+        for (const auto& values : arrays) require_same_result(values, items);
+}
+
+TEST_CASE("numeric items scan large arrays", "[validate][items]") {
+    Dictionary schema = array_schema(R"({"type": "number", "minimum": 0, "maximum": 100})");
+    std::vector<double> distances(100000);
+    for (size_t i = 0; i < distances.size(); ++i) distances[i] = static_cast<double>(i % 101);
+    Dictionary data;
+    data["fast"] = distances;
+    REQUIRE(validate_all(data, schema).is_valid());
+
+    data["fast"][70000] = 100.5;
+    data["fast"][123] = -1.0;
+    ValidationResult result = validate_all(data, schema);
+    REQUIRE(result.errors.size() == 2);
+    REQUIRE(result.errors[0].node_path == "fast[123]");
+    REQUIRE(result.errors[1].node_path == "fast[70000]");
+    REQUIRE(result.errors[1].category == ErrorCategory::OUT_OF_RANGE);
+
+    ValidationOptions options;
+    options.profile = true;
+    data["fast"] = distances;
+    ValidationResult profiled = validate_all(data, schema, "", options);
+    REQUIRE(profiled.is_valid());
+    REQUIRE(profiled.profile->nodes > 100000);
+}
+
+TEST_CASE("numeric items keep element-wise NaN handling", "[validate][items]") {
+    std::vector<double> values = {1.0, std::numeric_limits<double>::quiet_NaN(), 2.0};
+    require_same_result(Dictionary(values), R"({"type": "number", "minimum": 0, "maximum": 3})");
+    require_same_result(Dictionary(values), R"({"type": "integer", "minimum": 0})");
+}
@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+#include <ps/parsec.h>
+#include <ps/validate.h>
+
+#include <string>
+#include <vector>
+
+using namespace ps;
+
+using Entry = ValidationProfile::Entry;
+
+static const Entry* find_entry(const std::vector<Entry>& entries, const std::string& name) {
+    for (const auto& e : entries) {
+        if (e.name == name) return &e;
+    }
+    return nullptr;
+}
+
+static Dictionary profiled_schema() {
+    return parse_json(R"({
+        "type": "object",
+        "required": ["cells"],
+        "properties": {
+            "name": {"type": "string", "pattern": "^[a-z]+$"},
+            "cells": {"type": "array", "items": {"$ref": "#/definitions/cell"}}
+        },
+        "definitions": {
+            "cell": {
+                "anyOf": [
+                    {"type": "integer", "minimum": 0},
+                    {"type": "string", "enum": ["auto", "none"]}
+                ]
+            }
+        }
+    })");
+}
+
+TEST_CASE("validation is only profiled on request", "[validate][profile]") {
+    Dictionary data = parse_json(R"({"name": "mesh", "cells": [1, 2, "auto"]})");
+    REQUIRE_FALSE(validate_all(data, profiled_schema()).profile.has_value());
+}
+
+TEST_CASE("profile counts keywords and schema locations", "[validate][profile]") {
+    Dictionary data = parse_json(R"({"name": "mesh", "cells": [1, 2, "auto", -4]})");
+    ValidationOptions opts;
+    opts.profile = true;
+    ValidationResult result = validate_all(data, profiled_schema(), "", opts);
+
+    // Profiling does not change what is reported
+    REQUIRE(result.error_count() == validate_all(data, profiled_schema()).error_count());
+    REQUIRE(result.profile.has_value());
+    const ValidationProfile& profile = *result.profile;
+    REQUIRE(profile.nodes > 0);
+    REQUIRE(profile.total_ms >= 0.0);
+
+    const auto* any_of = find_entry(profile.keywords, "anyOf");
+    REQUIRE(any_of != nullptr);
+    REQUIRE(any_of->calls == 4);
+    REQUIRE(any_of->total_ms >= any_of->self_ms);
+    REQUIRE(find_entry(profile.keywords, "pattern") != nullptr);
+
+    const auto* ref = find_entry(profile.locations, "$ref #/definitions/cell");
+    REQUIRE(ref != nullptr);
+    REQUIRE(ref->calls == 4);
+    REQUIRE(find_entry(profile.locations, "pattern ^[a-z]+$") != nullptr);
+
+    // Keywords are ranked by self time, locations by total time
+    for (size_t i = 1; i < profile.keywords.size(); ++i)
+        REQUIRE(profile.keywords[i - 1].self_ms >= profile.keywords[i].self_ms);
+    for (size_t i = 1; i < profile.locations.size(); ++i)
+        REQUIRE(profile.locations[i - 1].total_ms >= profile.locations[i].total_ms);
+
+    SECTION("merging adds up calls") {
+        ValidationProfile merged = profile;
+        merged.merge(profile);
+        REQUIRE(merged.nodes == 2 * profile.nodes);
+        REQUIRE(find_entry(merged.keywords, "anyOf")->calls == 8);
+        REQUIRE(merged.format().find("$ref #/definitions/cell") != std::string::npos);
+    }
+}